@@ -0,0 +1,53 @@
+//-----------------------------------------------------------------------------
+// File: Bench.h
+//
+// Desc: Shared declarations for the GameBench performance measurement tool.
+//       Each benchmark suite lives in its own source file and reports its
+//       results through BenchReport.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+//-----------------------------------------------------------------------------
+// Bench Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/Main.h"
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+typedef void (*BENCHFUNC)( bool bQuick );
+
+//-----------------------------------------------------------------------------
+// Shared Bench Functions
+//-----------------------------------------------------------------------------
+double  BenchTime       ( );
+double  BenchCPUTime    ( );
+void    BenchReport     ( const char * Suite, const char * Name, double Value, const char * Units );
+ULONG   BenchRandom     ( ULONG & Seed );
+ULONG   BenchMaxThreads ( );
+
+//-----------------------------------------------------------------------------
+// Benchmark Suites
+//-----------------------------------------------------------------------------
+void    BenchRasterizer ( bool bQuick );
+void    BenchTransform  ( bool bQuick );
+void    BenchMesh       ( bool bQuick );
+void    BenchTiles      ( bool bQuick );
+void    BenchJobs       ( bool bQuick );
+void    BenchFill       ( bool bQuick );
+void    BenchOcclusion  ( bool bQuick );
+void    BenchBVH        ( bool bQuick );
+void    BenchLOD        ( bool bQuick );
+void    BenchMeshFile   ( bool bQuick );
+void    BenchOBJ        ( bool bQuick );
+void    BenchEntity     ( bool bQuick );
+void    BenchPacing     ( bool bQuick );
+void    BenchProfiler   ( bool bQuick );
+void    BenchFlight     ( bool bQuick );
+void    BenchCounters   ( bool bQuick );
+
+#endif // _BENCH_H_
@@ -0,0 +1,297 @@
+//-----------------------------------------------------------------------------
+// File: BenchBVH.cpp
+//
+// Desc: Measures building, refitting and querying the scene bounding volume
+//       hierarchy, and compares each query with a linear walk of every
+//       object.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchBVH Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CBVH.h"
+#include "../Includes/CTransformStage.h"
+#include <new>
+#include <float.h>
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : RandomFloat () (Local)
+// Desc : Returns a random value between fMin and fMax.
+//-----------------------------------------------------------------------------
+static float RandomFloat( ULONG & Seed, float fMin, float fMax )
+{
+    return fMin + (fMax - fMin) * (float)(BenchRandom( Seed ) % 100001) / 100000.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RandomBox () (Local)
+// Desc : Builds a small box somewhere within 1000 units of the origin.
+//-----------------------------------------------------------------------------
+static void RandomBox( ULONG & Seed, CBounds & Bounds )
+{
+    D3DXVECTOR3 vecCentre( RandomFloat( Seed, -1000.0f, 1000.0f ), RandomFloat( Seed, -1000.0f, 1000.0f ),
+                           RandomFloat( Seed, -1000.0f, 1000.0f ) );
+    float       fSize = RandomFloat( Seed, 0.5f, 4.0f );
+
+    Bounds.m_vecMin = vecCentre - D3DXVECTOR3( fSize, fSize, fSize );
+    Bounds.m_vecMax = vecCentre + D3DXVECTOR3( fSize, fSize, fSize );
+}
+
+//-----------------------------------------------------------------------------
+// Name : LinearFrustum () (Local)
+// Desc : Counts the boxes not entirely outside any of the planes.
+//-----------------------------------------------------------------------------
+static ULONG LinearFrustum( const CBounds * pBounds, ULONG Count, const D3DXPLANE * pPlanes )
+{
+    ULONG Found = 0;
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const D3DXVECTOR3 & Min = pBounds[i].m_vecMin, & Max = pBounds[i].m_vecMax;
+        ULONG               p;
+
+        for ( p = 0; p < 6; p++ )
+        {
+            const D3DXPLANE & Plane = pPlanes[p];
+            if ( Plane.a * (Plane.a > 0.0f ? Max.x : Min.x) + Plane.b * (Plane.b > 0.0f ? Max.y : Min.y) +
+                 Plane.c * (Plane.c > 0.0f ? Max.z : Min.z) + Plane.d < 0.0f ) break;
+
+        } // Next Plane
+        if ( p == 6 ) Found++;
+
+    } // Next Box
+
+    return Found;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LinearRay () (Local)
+// Desc : Finds the box a ray enters first by testing every one of them.
+//-----------------------------------------------------------------------------
+static bool LinearRay( const CBounds * pBounds, ULONG Count, const D3DXVECTOR3 & vecOrigin, const D3DXVECTOR3 & vecDir,
+                       ULONG & Item, float & fHitT )
+{
+    D3DXVECTOR3 vecInv( 1.0f / vecDir.x, 1.0f / vecDir.y, 1.0f / vecDir.z );
+    bool        bHit = false;
+
+    fHitT = FLT_MAX;
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const D3DXVECTOR3 & Min = pBounds[i].m_vecMin, & Max = pBounds[i].m_vecMax;
+        float tNear = 0.0f, tFar = FLT_MAX;
+
+        for ( ULONG a = 0; a < 3; a++ )
+        {
+            float t1 = ((&Min.x)[a] - (&vecOrigin.x)[a]) * (&vecInv.x)[a];
+            float t2 = ((&Max.x)[a] - (&vecOrigin.x)[a]) * (&vecInv.x)[a];
+            if ( t1 > t2 ) { float t = t1; t1 = t2; t2 = t; }
+            if ( t1 > tNear ) tNear = t1;
+            if ( t2 < tFar  ) tFar  = t2;
+
+        } // Next Axis
+
+        if ( tNear <= tFar && (!bHit || tNear < fHitT) ) { fHitT = tNear; Item = i; bHit = true; }
+
+    } // Next Box
+
+    return bHit;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LinearBounds () (Local)
+// Desc : Counts the boxes overlapping the query box.
+//-----------------------------------------------------------------------------
+static ULONG LinearBounds( const CBounds * pBounds, ULONG Count, const CBounds & Query )
+{
+    const D3DXVECTOR3 & Min = Query.m_vecMin, & Max = Query.m_vecMax;
+    ULONG               Found = 0;
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const D3DXVECTOR3 & BoxMin = pBounds[i].m_vecMin, & BoxMax = pBounds[i].m_vecMax;
+        if ( BoxMin.x > Max.x || BoxMax.x < Min.x || BoxMin.y > Max.y || BoxMax.y < Min.y ||
+             BoxMin.z > Max.z || BoxMax.z < Min.z ) continue;
+        Found++;
+
+    } // Next Box
+
+    return Found;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchHierarchy () (Local)
+// Desc : Builds a hierarchy over randomly placed boxes, then reports build
+//        and refit times along with frustum, ray and box query rates for
+//        both the hierarchy and a linear walk (with any disagreements).
+//-----------------------------------------------------------------------------
+static void BenchHierarchy( ULONG Count, ULONG Queries )
+{
+    CBVH         BVH;
+    CBounds    * pBounds = NULL;
+    ULONG      * pResults = NULL;
+    ULONG        Seed = 0xB7B7, Mismatches = 0, Found = 0;
+    double       Start, Elapsed, Linear;
+    char         szName[64];
+
+    pBounds  = new (std::nothrow) CBounds[ Count ];
+    pResults = new (std::nothrow) ULONG[ Count ];
+    if ( !pBounds || !pResults ) { delete []pBounds; delete []pResults; return; }
+    for ( ULONG i = 0; i < Count; i++ ) RandomBox( Seed, pBounds[i] );
+
+    // Build
+    Start = BenchTime();
+    if ( !BVH.Build( pBounds, Count ) ) { delete []pBounds; delete []pResults; return; }
+    Elapsed = BenchTime() - Start;
+    sprintf( szName, "build %u objects", (unsigned int)Count );
+    BenchReport( "bvh", szName, Elapsed * 1000.0, "ms" );
+    sprintf( szName, "build %u objects depth", (unsigned int)Count );
+    BenchReport( "bvh", szName, (double)BVH.GetDepth(), "levels" );
+
+    // Move every object a little, then refit in one pass
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        D3DXVECTOR3 vecMove( RandomFloat( Seed, -2.0f, 2.0f ), RandomFloat( Seed, -2.0f, 2.0f ), RandomFloat( Seed, -2.0f, 2.0f ) );
+        pBounds[i].m_vecMin = pBounds[i].m_vecMin + vecMove;
+        pBounds[i].m_vecMax = pBounds[i].m_vecMax + vecMove;
+
+    } // Next Object
+    Start = BenchTime();
+    for ( ULONG i = 0; i < Count; i++ ) BVH.SetBounds( i, pBounds[i] );
+    BVH.Refit();
+    Elapsed = BenchTime() - Start;
+    sprintf( szName, "refit all %u objects", (unsigned int)Count );
+    BenchReport( "bvh", szName, Elapsed * 1000.0, "ms" );
+
+    // Incremental refits of a few objects
+    Start = BenchTime();
+    for ( ULONG i = 0; i < Queries; i++ )
+    {
+        ULONG Item = BenchRandom( Seed ) % Count;
+        pBounds[ Item ].m_vecMin.y += 0.5f;
+        pBounds[ Item ].m_vecMax.y += 0.5f;
+        BVH.UpdateBounds( Item, pBounds[ Item ] );
+
+    } // Next Update
+    Elapsed = BenchTime() - Start;
+    BenchReport( "bvh", "refit single object", Elapsed * 1e9 / Queries, "ns/update" );
+
+    // Frustum queries, looking in random directions from the origin
+    {
+        D3DXMATRIX  mtxView, mtxPitch, mtxProjection, mtxViewProj;
+        D3DXPLANE * pPlanes = new D3DXPLANE[ Queries * 6 ];
+        for ( ULONG q = 0; q < Queries; q++ )
+        {
+            D3DXMatrixRotationY( &mtxView, RandomFloat( Seed, 0.0f, 2.0f * D3DX_PI ) );
+            D3DXMatrixRotationX( &mtxPitch, RandomFloat( Seed, -0.5f, 0.5f ) );
+            D3DXMatrixMultiply( &mtxView, &mtxView, &mtxPitch );
+            D3DXMatrixPerspectiveFovLH( &mtxProjection, D3DXToRadian( 60.0f ), 4.0f / 3.0f, 1.0f, 500.0f );
+            D3DXMatrixMultiply( &mtxViewProj, &mtxView, &mtxProjection );
+            CTransformStage::GetFrustumPlanes( mtxViewProj, &pPlanes[ q * 6 ] );
+
+        } // Next Query
+
+        Start = BenchTime();
+        for ( ULONG q = 0; q < Queries; q++ ) Found += BVH.QueryFrustum( &pPlanes[ q * 6 ], 6, pResults, Count );
+        Elapsed = BenchTime() - Start;
+
+        Start = BenchTime();
+        for ( ULONG q = 0; q < Queries; q++ ) Mismatches += LinearFrustum( pBounds, Count, &pPlanes[ q * 6 ] );
+        Linear = BenchTime() - Start;
+        Mismatches = (Mismatches > Found) ? Mismatches - Found : Found - Mismatches;
+        delete []pPlanes;
+
+        BenchReport( "bvh", "frustum query", Elapsed * 1e6 / Queries, "us/query" );
+        BenchReport( "bvh", "frustum linear", Linear * 1e6 / Queries, "us/query" );
+        BenchReport( "bvh", "frustum objects found", (double)Found / Queries, "objects/query" );
+        BenchReport( "bvh", "frustum mismatches", (double)Mismatches, "objects" );
+
+    } // End Scope
+
+    // Ray casts from random points in random directions
+    {
+        ULONG Hits = 0;
+        Mismatches = 0;
+        Elapsed = Linear = 0.0;
+
+        for ( ULONG q = 0; q < Queries; q++ )
+        {
+            D3DXVECTOR3 vecOrigin( RandomFloat( Seed, -1000.0f, 1000.0f ), RandomFloat( Seed, -1000.0f, 1000.0f ),
+                                   RandomFloat( Seed, -1000.0f, 1000.0f ) );
+            D3DXVECTOR3 vecDir( RandomFloat( Seed, -1.0f, 1.0f ), RandomFloat( Seed, -1.0f, 1.0f ), RandomFloat( Seed, -1.0f, 1.0f ) );
+            ULONG       ItemTree = 0, ItemLinear = 0;
+            float       fTree = 0.0f, fLinear = 0.0f;
+            bool        bTree, bLinear;
+
+            Start   = BenchTime();
+            bTree   = BVH.RayCast( vecOrigin, vecDir, FLT_MAX, ItemTree, fTree );
+            Elapsed += BenchTime() - Start;
+
+            Start   = BenchTime();
+            bLinear = LinearRay( pBounds, Count, vecOrigin, vecDir, ItemLinear, fLinear );
+            Linear  += BenchTime() - Start;
+
+            // Distances are compared rather than items, as boxes may overlap
+            if ( bTree ) Hits++;
+            if ( bTree != bLinear || (bTree && fTree != fLinear) ) Mismatches++;
+
+        } // Next Ray
+
+        BenchReport( "bvh", "ray cast", Elapsed * 1e6 / Queries, "us/ray" );
+        BenchReport( "bvh", "ray cast linear", Linear * 1e6 / Queries, "us/ray" );
+        BenchReport( "bvh", "ray cast hits", 100.0 * Hits / Queries, "% of rays" );
+        BenchReport( "bvh", "ray cast mismatches", (double)Mismatches, "rays" );
+
+    } // End Scope
+
+    // Box overlap queries, each around 50 units across
+    {
+        CBounds Query;
+        Found = Mismatches = 0;
+        Elapsed = Linear = 0.0;
+
+        for ( ULONG q = 0; q < Queries; q++ )
+        {
+            ULONG TreeCount, LinearCount;
+
+            RandomBox( Seed, Query );
+            Query.m_vecMin = Query.m_vecMin - D3DXVECTOR3( 25.0f, 25.0f, 25.0f );
+            Query.m_vecMax = Query.m_vecMax + D3DXVECTOR3( 25.0f, 25.0f, 25.0f );
+
+            Start = BenchTime();
+            TreeCount = BVH.QueryBounds( Query, pResults, Count );
+            Elapsed += BenchTime() - Start;
+
+            Start = BenchTime();
+            LinearCount = LinearBounds( pBounds, Count, Query );
+            Linear += BenchTime() - Start;
+
+            Found += TreeCount;
+            if ( TreeCount != LinearCount ) Mismatches++;
+
+        } // Next Query
+
+        BenchReport( "bvh", "box query", Elapsed * 1e6 / Queries, "us/query" );
+        BenchReport( "bvh", "box linear", Linear * 1e6 / Queries, "us/query" );
+        BenchReport( "bvh", "box objects found", (double)Found / Queries, "objects/query" );
+        BenchReport( "bvh", "box mismatches", (double)Mismatches, "queries" );
+
+    } // End Scope
+
+    delete []pBounds;
+    delete []pResults;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchBVH ()
+// Desc : Scene hierarchy benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchBVH( bool bQuick )
+{
+    BenchHierarchy( bQuick ? 100000 : 1000000, bQuick ? 200 : 1000 );
+}
@@ -0,0 +1,101 @@
+//-----------------------------------------------------------------------------
+// File: BenchCounters.cpp
+//
+// Desc: Measures the cost of attributing hardware counters to a stage, and
+//       shows them telling a miss-bound walk of memory (chasing indices in a
+//       random order) from a compute-bound one (the same memory in order).
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchCounters Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CPerfCounters.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static volatile ULONG g_nSink = 0;          // Keeps each walk's result alive
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : ReportWalk () (Local)
+// Desc : Reports what was counted over a walk of Count elements.
+//-----------------------------------------------------------------------------
+static void ReportWalk( const char * pszWalk, const PERFSAMPLE & Sample, ULONG Count )
+{
+    char szName[ 64 ];
+
+    if ( CPerfCounters::IsCounting( PERF_CYCLES ) && CPerfCounters::IsCounting( PERF_INSTRUCTIONS ) && Sample.Count[ PERF_CYCLES ] > 0 )
+    {
+        sprintf( szName, "%s, ipc", pszWalk );
+        BenchReport( "counters", szName, (double)Sample.Count[ PERF_INSTRUCTIONS ] / (double)Sample.Count[ PERF_CYCLES ], "" );
+
+    } // End if ipc
+
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ )
+    {
+        if ( !CPerfCounters::IsCounting( (PERFCOUNTER)c ) ) continue;
+        sprintf( szName, "%s, %s", pszWalk, CPerfCounters::GetCounterName( (PERFCOUNTER)c ) );
+        BenchReport( "counters", szName, (double)Sample.Count[c] / Count, "/element" );
+
+    } // Next Counter
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchCounters ()
+// Desc : Runs the hardware counter suite.
+//-----------------------------------------------------------------------------
+void BenchCounters( bool bQuick )
+{
+    const ULONG   Count = bQuick ? (1 << 20) : (1 << 23);
+    const ULONG   Marks = bQuick ? 10000 : 100000;
+    CPerfCounters Counters;
+    ULONG       * pNext, Seed = 1, Index = 0, Sum = 0, Opened = 0;
+    double        Start;
+
+    // Nothing more can be measured without the counters
+    if ( !CPerfCounters::OpenThread() )
+    {
+        printf( "%-12s %-40s %16s (%s)\n", "counters", "unavailable", "", CPerfCounters::GetError() );
+        return;
+
+    } // End if unavailable
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ ) if ( CPerfCounters::IsCounting( (PERFCOUNTER)c ) ) Opened++;
+    BenchReport( "counters", "counters opened", (double)Opened, "counters" );
+
+    Counters.Reset();
+    Start = BenchTime();
+    for ( ULONG i = 0; i < Marks; i++ ) Counters.MarkStage( i & 1 );
+    BenchReport( "counters", "mark stage", (BenchTime() - Start) * 1e9 / Marks, "ns" );
+
+    // Link every element into a single random cycle (Sattolo's shuffle)
+    if (!( pNext = new (std::nothrow) ULONG[ Count ] )) { CPerfCounters::CloseAll(); return; }
+    for ( ULONG i = 0; i < Count; i++ ) pNext[i] = i;
+    for ( ULONG i = Count - 1; i > 0; i-- )
+    {
+        ULONG j = BenchRandom( Seed ) % i, Swap = pNext[i];
+        pNext[i] = pNext[j];
+        pNext[j] = Swap;
+
+    } // Next Element
+
+    // The same elements, in order, then in the order of the cycle
+    Counters.Reset();
+    for ( ULONG i = 0; i < Count; i++ ) Sum += pNext[i];
+    Counters.MarkStage( 0 );
+    for ( ULONG i = 0; i < Count; i++ ) Index = pNext[ Index ];
+    Counters.MarkStage( 1 );
+    g_nSink = Sum + Index;
+
+    ReportWalk( "sequential", Counters.GetStage( 0 ), Count );
+    ReportWalk( "random", Counters.GetStage( 1 ), Count );
+
+    delete []pNext;
+    CPerfCounters::CloseAll();
+}
@@ -0,0 +1,303 @@
+//-----------------------------------------------------------------------------
+// File: BenchEntity.cpp
+//
+// Desc: Measures per entity animation cost in the archetype entity store at
+//       increasing scene sizes, against an array of objects which branches
+//       on each one, the rate at which posed entities are turned compared
+//       with rotating their matrices (and how far each drifts from a
+//       rotation), and the cost of creating and destroying entities.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchEntity Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CEntityStore.h"
+#include "../Includes/CJobSystem.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const float  FRAME_TIME   = 1.0f / 60.0f;   // Time step animated each frame
+static const ULONG  DRIFT_FRAMES = 36000;           // Frames animated when measuring drift (ten minutes)
+static const ULONG  DRIFT_COUNT  = 1024;            // Entities animated when measuring drift
+
+//-----------------------------------------------------------------------------
+// Module Local Structures
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : OBJECTRECORD (Local Struct)
+// Desc : One object of the comparison array, everything in one place as the
+//        application used to keep it.
+//-----------------------------------------------------------------------------
+struct OBJECTRECORD
+{
+    CObject     Object;
+    D3DXVECTOR3 vecSpin;
+    bool        bSpinning;
+};
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : GetSpin () (Local)
+// Desc : Returns the spin of the i'th bench entity; every fourth is still.
+//-----------------------------------------------------------------------------
+static D3DXVECTOR3 GetSpin( ULONG i, ULONG & Seed )
+{
+    float fX = (float)(BenchRandom( Seed ) % 256) - 128.0f;
+    float fY = (float)(BenchRandom( Seed ) % 256) - 128.0f;
+    float fZ = (float)(BenchRandom( Seed ) % 256) - 128.0f;
+
+    if ( i % 4 == 3 ) return D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+    return D3DXVECTOR3( fX, fY, fZ ) * (D3DX_PI / 180.0f);
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateRecord () (Local)
+// Desc : Animates one comparison object, as the store animates an entity.
+//-----------------------------------------------------------------------------
+static void AnimateRecord( OBJECTRECORD & Record, float fTimeElapsed )
+{
+    D3DXMATRIX mtxYaw, mtxPitch, mtxRoll, mtxRotate;
+
+    if ( !Record.bSpinning ) return;
+    D3DXMatrixRotationY( &mtxYaw,   Record.vecSpin.y * fTimeElapsed );
+    D3DXMatrixRotationX( &mtxPitch, Record.vecSpin.x * fTimeElapsed );
+    D3DXMatrixRotationZ( &mtxRoll,  Record.vecSpin.z * fTimeElapsed );
+    D3DXMatrixMultiply( &mtxRotate, &mtxYaw, &mtxPitch );
+    D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxRoll );
+    D3DXMatrixMultiply( &Record.Object.m_mtxWorld, &mtxRotate, &Record.Object.m_mtxWorld );
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetDrift () (Local)
+// Desc : Returns how far the upper 3x3 of a matrix is from being a rotation,
+//        as the largest error in the dot products of its rows.
+//-----------------------------------------------------------------------------
+static double GetDrift( const D3DXMATRIX & mtx )
+{
+    const float * pRow[3] = { &mtx._11, &mtx._21, &mtx._31 };
+    double        fDrift  = 0.0;
+
+    for ( ULONG r = 0; r < 3; r++ )
+    {
+        for ( ULONG c = 0; c < 3; c++ )
+        {
+            double fDot = (double)pRow[r][0] * pRow[c][0] + (double)pRow[r][1] * pRow[c][1] + (double)pRow[r][2] * pRow[c][2];
+            double fErr = fabs( fDot - ((r == c) ? 1.0 : 0.0) );
+            if ( fErr > fDrift ) fDrift = fErr;
+
+        } // Next Column
+
+    } // Next Row
+    return fDrift;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildSpinScene () (Local)
+// Desc : Fills a store with Count entities spread over a grid, every fourth
+//        still, the rest spinning; posed if requested.
+//-----------------------------------------------------------------------------
+static bool BuildSpinScene( CEntityStore & Store, ULONG Count, bool bPosed )
+{
+    ULONG Seed = 1;
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        D3DXVECTOR3 vecSpin  = GetSpin( i, Seed );
+        D3DXVECTOR3 vecPlace( (float)(i % 100), 0.0f, (float)(i / 100) );
+        bool        bSpin    = ( i % 4 != 3 );
+        ULONG       Entity   = Store.Create( COMPONENT_WORLD | COMPONENT_MESH | COMPONENT_FLAGS |
+                                             (bSpin ? COMPONENT_SPIN : 0) | (bSpin && bPosed ? COMPONENT_POSE : 0) );
+        if ( Entity == ENTITY_INVALID ) return false;
+
+        D3DXMatrixTranslation( Store.GetWorld( Entity ), vecPlace.x, vecPlace.y, vecPlace.z );
+        if ( bSpin ) { *Store.GetSpin( Entity ) = vecSpin; *Store.GetFlags( Entity ) = ENTITY_SPINNING; }
+        if ( bSpin && bPosed ) Store.SetPose( Entity, vecPlace, 1.0f );
+
+    } // Next Entity
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateChunksJob () (Local)
+// Desc : Job system entry point, animates a range of entity chunks.
+//-----------------------------------------------------------------------------
+static void AnimateChunksJob( void * pContext, ULONG Begin, ULONG End )
+{
+    for ( ULONG i = Begin; i < End; i++ ) ((CEntityStore*)pContext)->AnimateChunk( i, FRAME_TIME );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchAnimate () (Local)
+// Desc : Animates Count entities for a number of frames, in the store (on
+//        one thread and on every thread) and in the comparison array,
+//        reporting the time taken per entity.
+//-----------------------------------------------------------------------------
+static void BenchAnimate( ULONG Count, ULONG Frames )
+{
+    CEntityStore   Store;
+    CJobSystem     Jobs;
+    OBJECTRECORD * pRecords;
+    ULONG          Seed = 1;
+    double         Start, Elapsed;
+    char           szName[64];
+
+    if (!( pRecords = new (std::nothrow) OBJECTRECORD[ Count ] )) return;
+
+    // Same scene in both
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        D3DXVECTOR3 vecSpin = GetSpin( i, Seed );
+        bool        bSpin   = ( i % 4 != 3 );
+        ULONG       Entity  = Store.Create( COMPONENT_WORLD | COMPONENT_MESH | COMPONENT_FLAGS | (bSpin ? COMPONENT_SPIN : 0) );
+        if ( Entity == ENTITY_INVALID ) { delete []pRecords; return; }
+
+        D3DXMatrixTranslation( Store.GetWorld( Entity ), (float)(i % 100), 0.0f, (float)(i / 100) );
+        if ( bSpin ) { *Store.GetSpin( Entity ) = vecSpin; *Store.GetFlags( Entity ) = ENTITY_SPINNING; }
+
+        pRecords[i].Object.m_mtxWorld = *Store.GetWorld( Entity );
+        pRecords[i].vecSpin           = vecSpin;
+        pRecords[i].bSpinning         = bSpin;
+
+    } // Next Entity
+
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ )
+        for ( ULONG i = 0; i < Count; i++ ) AnimateRecord( pRecords[i], FRAME_TIME );
+    Elapsed = (BenchTime() - Start) / Frames;
+    sprintf( szName, "object array %u entities", (unsigned int)Count );
+    BenchReport( "entity", szName, Elapsed * 1e9 / Count, "ns/entity" );
+
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ )
+        for ( ULONG c = 0; c < Store.GetChunkCount(); c++ ) Store.AnimateChunk( c, FRAME_TIME );
+    Elapsed = (BenchTime() - Start) / Frames;
+    sprintf( szName, "chunks %u entities", (unsigned int)Count );
+    BenchReport( "entity", szName, Elapsed * 1e9 / Count, "ns/entity" );
+
+    if ( Jobs.Create( BenchMaxThreads() ) )
+    {
+        Start = BenchTime();
+        for ( ULONG f = 0; f < Frames; f++ ) Jobs.ParallelFor( AnimateChunksJob, &Store, Store.GetChunkCount(), 1 );
+        Elapsed = (BenchTime() - Start) / Frames;
+        sprintf( szName, "chunks %u entities %u threads", (unsigned int)Count, (unsigned int)Jobs.GetThreadCount() );
+        BenchReport( "entity", szName, Elapsed * 1e9 / Count, "ns/entity" );
+
+    } // End if jobs
+
+    delete []pRecords;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchPose () (Local)
+// Desc : Animates Count entities for a number of frames with their world
+//        matrices rotated in place, and again with posed entities turned by
+//        the quaternion kernel, reporting instances animated per second.
+//-----------------------------------------------------------------------------
+static void BenchPose( ULONG Count, ULONG Frames )
+{
+    static const char * pszPath[2] = { "matrix", "pose" };
+    CJobSystem          Jobs;
+    double              Start, Elapsed;
+    char                szName[64];
+    bool                bJobs = Jobs.Create( BenchMaxThreads() );
+
+    for ( ULONG p = 0; p < 2; p++ )
+    {
+        CEntityStore Store;
+        if ( !BuildSpinScene( Store, Count, p == 1 ) ) return;
+
+        Start = BenchTime();
+        for ( ULONG f = 0; f < Frames; f++ )
+            for ( ULONG c = 0; c < Store.GetChunkCount(); c++ ) Store.AnimateChunk( c, FRAME_TIME );
+        Elapsed = (BenchTime() - Start) / Frames;
+        sprintf( szName, "%s %u entities", pszPath[p], (unsigned int)Count );
+        BenchReport( "entity", szName, Count / Elapsed * 1e-6, "M instances/s" );
+
+        if ( !bJobs ) continue;
+        Start = BenchTime();
+        for ( ULONG f = 0; f < Frames; f++ ) Jobs.ParallelFor( AnimateChunksJob, &Store, Store.GetChunkCount(), 1 );
+        Elapsed = (BenchTime() - Start) / Frames;
+        sprintf( szName, "%s %u entities %u threads", pszPath[p], (unsigned int)Count, (unsigned int)Jobs.GetThreadCount() );
+        BenchReport( "entity", szName, Count / Elapsed * 1e-6, "M instances/s" );
+
+    } // Next Path
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchDrift () (Local)
+// Desc : Animates a small scene for a long time down both paths, reporting
+//        how far the worst world matrix has drifted from a rotation.
+//-----------------------------------------------------------------------------
+static void BenchDrift( )
+{
+    static const char * pszPath[2] = { "matrix drift", "pose drift" };
+
+    for ( ULONG p = 0; p < 2; p++ )
+    {
+        CEntityStore Store;
+        double       fDrift = 0.0;
+        if ( !BuildSpinScene( Store, DRIFT_COUNT, p == 1 ) ) return;
+
+        for ( ULONG f = 0; f < DRIFT_FRAMES; f++ )
+            for ( ULONG c = 0; c < Store.GetChunkCount(); c++ ) Store.AnimateChunk( c, FRAME_TIME );
+        for ( ULONG i = 0; i < DRIFT_COUNT; i++ )
+        {
+            double fErr = GetDrift( *Store.GetWorld( i ) );
+            if ( fErr > fDrift ) fDrift = fErr;
+
+        } // Next Entity
+        BenchReport( "entity", pszPath[p], fDrift * 1e6, "ppm" );
+
+    } // Next Path
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchChurn () (Local)
+// Desc : Creates Count entities, then destroys and recreates half of them
+//        in a scattered order, reporting the time per operation.
+//-----------------------------------------------------------------------------
+static void BenchChurn( ULONG Count )
+{
+    CEntityStore Store;
+    ULONG        Seed = 7;
+    double       Start, Elapsed;
+
+    Start = BenchTime();
+    for ( ULONG i = 0; i < Count; i++ ) Store.Create( (i & 1) ? COMPONENT_ALL : (COMPONENT_ALL & ~COMPONENT_SPIN) );
+    Elapsed = BenchTime() - Start;
+    BenchReport( "entity", "create", Elapsed * 1e9 / Count, "ns/entity" );
+
+    Start = BenchTime();
+    for ( ULONG i = 0; i < Count / 2; i++ )
+    {
+        ULONG Entity = BenchRandom( Seed ) % Count;
+        Store.Destroy( Entity );
+        Store.Create( (Entity & 1) ? COMPONENT_ALL : (COMPONENT_ALL & ~COMPONENT_SPIN) );
+
+    } // Next Operation
+    Elapsed = BenchTime() - Start;
+    BenchReport( "entity", "destroy + create", Elapsed * 1e9 / (Count / 2), "ns/pair" );
+    BenchReport( "entity", "chunks in use", (double)Store.GetChunkCount(), "chunks" );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchEntity ()
+// Desc : Runs the entity store suite.
+//-----------------------------------------------------------------------------
+void BenchEntity( bool bQuick )
+{
+    const ULONG Largest = bQuick ? 100000 : 1000000;
+    const ULONG Frames  = bQuick ? 5 : 20;
+
+    for ( ULONG Count = 1000; Count <= Largest; Count *= 10 ) BenchAnimate( Count, Frames );
+    for ( ULONG Count = 1000; Count <= Largest; Count *= 10 ) BenchPose( Count, Frames );
+    BenchDrift();
+    BenchChurn( Largest );
+}
@@ -0,0 +1,161 @@
+//-----------------------------------------------------------------------------
+// File: BenchFill.cpp
+//
+// Desc: Measures the fill rate of the half-space triangle rasterizer, with
+//       depth testing, at resolutions from 800x600 up to 4K.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchFill Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CTileRenderer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : BuildTriangles () (Local)
+// Desc : Generates random screen space triangles of mixed size and depth,
+//        some partly off screen, and returns the total area they cover.
+//-----------------------------------------------------------------------------
+static CScreenVertex * BuildTriangles( ULONG Width, ULONG Height, ULONG Count, double & Area )
+{
+    CScreenVertex * pVertices = NULL;
+    ULONG           Seed = 0xF111;
+
+    if (!( pVertices = new CScreenVertex[ Count * 3 ] )) return NULL;
+    Area = 0.0;
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        CScreenVertex * v  = &pVertices[ i * 3 ];
+        float           cx = (float)(BenchRandom( Seed ) % (Width + 64)) - 32.0f;
+        float           cy = (float)(BenchRandom( Seed ) % (Height + 64)) - 32.0f;
+        float           s  = 8.0f + (float)(BenchRandom( Seed ) % (Height / 8));
+
+        for ( ULONG j = 0; j < 3; j++ )
+        {
+            v[j].x   = cx + s * ((float)(BenchRandom( Seed ) % 2001) / 1000.0f - 1.0f);
+            v[j].y   = cy + s * ((float)(BenchRandom( Seed ) % 2001) / 1000.0f - 1.0f);
+            v[j].z   = (float)(BenchRandom( Seed ) % 1000) / 1000.0f;
+            v[j].w   = 1.0f;
+
+        } // Next Vertex
+
+        // Area as submitted (including any part off screen)
+        Area += fabs( (double)(v[1].x - v[0].x) * (v[2].y - v[0].y) - (double)(v[2].x - v[0].x) * (v[1].y - v[0].y) ) * 0.5;
+
+    } // Next Triangle
+
+    return pVertices;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CountMismatches () (Local)
+// Desc : Returns the number of pixels which differ between the two buffers.
+//-----------------------------------------------------------------------------
+static ULONG CountMismatches( const CFrameBuffer & a, const CFrameBuffer & b )
+{
+    ULONG Count = 0;
+
+    for ( ULONG y = 0; y < a.GetHeight(); y++ )
+    {
+        const ULONG * pA = a.GetBits() + y * a.GetPitch();
+        const ULONG * pB = b.GetBits() + y * b.GetPitch();
+        for ( ULONG x = 0; x < a.GetWidth(); x++ ) if ( pA[x] != pB[x] ) Count++;
+
+    } // Next Row
+
+    return Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchFillRate () (Local)
+// Desc : Fills the triangles serially, then through the tile renderer on
+//        every thread, reporting pixels and triangles per second and any
+//        pixel differences between the two.
+//-----------------------------------------------------------------------------
+static void BenchFillRate( ULONG Width, ULONG Height, ULONG Count, ULONG Frames )
+{
+    CMemoryFrameBuffer  Reference, FrameBuffer;
+    CRasterizer         Rasterizer;
+    CJobSystem          Jobs;
+    CTileRenderer       Renderer;
+    CScreenVertex     * pVertices = NULL;
+    ULONG               Threads = BenchMaxThreads();
+    double              Start, Elapsed, Area;
+    char                szName[64];
+
+    // Build the scene
+    if ( !Reference.Create( Width, Height ) || !Reference.CreateDepthBuffer() ) return;
+    if ( !FrameBuffer.Create( Width, Height ) || !FrameBuffer.CreateDepthBuffer() ) return;
+    if (!( pVertices = BuildTriangles( Width, Height, Count, Area ) )) return;
+
+    // Serial reference
+    Rasterizer.SetRenderTarget( &Reference );
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ )
+    {
+        Reference.Clear( 0x00FFFFFF );
+        Reference.ClearDepth( 1.0f );
+        for ( ULONG i = 0; i < Count; i++ )
+        {
+            Rasterizer.SetColor( (i * 0x9E3779B1) & 0x00FFFFFF );
+            Rasterizer.DrawTriangle( pVertices[ i * 3 ], pVertices[ i * 3 + 1 ], pVertices[ i * 3 + 2 ] );
+
+        } // Next Triangle
+
+    } // Next Frame
+    Elapsed = (BenchTime() - Start) / Frames;
+
+    sprintf( szName, "serial %ux%u", (unsigned int)Width, (unsigned int)Height );
+    BenchReport( "fill", szName, Area / Elapsed / 1e6, "Mpixels/s" );
+    sprintf( szName, "serial %ux%u triangles", (unsigned int)Width, (unsigned int)Height );
+    BenchReport( "fill", szName, Count / Elapsed / 1e6, "Mtris/s" );
+
+    // Tiled, on every thread
+    if ( Jobs.Create( Threads ) )
+    {
+        Renderer.SetRenderTarget( &FrameBuffer );
+        Renderer.SetJobSystem( &Jobs );
+
+        // Warm up (sizes the bins), then time complete frames
+        for ( ULONG f = 0; f <= Frames; f++ )
+        {
+            if ( f == 1 ) Start = BenchTime();
+            FrameBuffer.Clear( 0x00FFFFFF );
+            FrameBuffer.ClearDepth( 1.0f );
+            Renderer.BeginFrame();
+            for ( ULONG i = 0; i < Count; i++ )
+                Renderer.AddTriangle( pVertices[ i * 3 ], pVertices[ i * 3 + 1 ], pVertices[ i * 3 + 2 ], (i * 0x9E3779B1) & 0x00FFFFFF );
+            Renderer.EndFrame();
+
+        } // Next Frame
+        Elapsed = (BenchTime() - Start) / Frames;
+
+        sprintf( szName, "tiled %ux%u %u threads", (unsigned int)Width, (unsigned int)Height, (unsigned int)Threads );
+        BenchReport( "fill", szName, Area / Elapsed / 1e6, "Mpixels/s" );
+        sprintf( szName, "tiled %ux%u %u threads triangles", (unsigned int)Width, (unsigned int)Height, (unsigned int)Threads );
+        BenchReport( "fill", szName, Count / Elapsed / 1e6, "Mtris/s" );
+        sprintf( szName, "tiled %ux%u mismatches", (unsigned int)Width, (unsigned int)Height );
+        BenchReport( "fill", szName, (double)CountMismatches( FrameBuffer, Reference ), "pixels" );
+
+    } // End if jobs created
+
+    delete []pVertices;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchFill ()
+// Desc : Triangle fill rate benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchFill( bool bQuick )
+{
+    static const ULONG Sizes[4][2] = { { 800, 600 }, { 1920, 1080 }, { 2560, 1440 }, { 3840, 2160 } };
+
+    for ( ULONG i = 0; i < 4; i++ )
+        BenchFillRate( Sizes[i][0], Sizes[i][1], bQuick ? 2000 : 20000, bQuick ? 2 : 10 );
+}
@@ -0,0 +1,78 @@
+//-----------------------------------------------------------------------------
+// File: BenchFlight.cpp
+//
+// Desc: Measures what the flight recorder adds to each frame, and the cost
+//       of writing out a dump when a hitch is caught.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchFlight Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CFlightRecorder.h"
+#include "../Includes/CTimer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const char * BENCH_FILE_NAME = "GameBench_";  // Scratch dump prefix, removed afterwards
+const float         BENCH_FRAME_TIME = 1.0f / 60.0f; // Budget the overhead is compared with
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : RecordFrames () (Local)
+// Desc : Records the given number of frames, marking every stage as the
+//        engine does, and returns the time taken per frame.
+//-----------------------------------------------------------------------------
+static double RecordFrames( CFlightRecorder & Recorder, ULONG Count, float fFrameTime )
+{
+    double Start = BenchTime();
+
+    for ( ULONG i = 0; i < Count; ++i )
+    {
+        Recorder.BeginFrame( fFrameTime );
+        for ( ULONG Stage = 0; Stage < FLIGHT_WAIT; ++Stage )
+            Recorder.MarkStage( (FLIGHTSTAGE)Stage );
+
+        Recorder.GetRecord().ObjectsDrawn = i;
+
+    } // Next Frame
+    return (BenchTime() - Start) / Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchFlight ()
+// Desc : Runs the flight recorder suite.
+//-----------------------------------------------------------------------------
+void BenchFlight( bool bQuick )
+{
+    const ULONG     Count = bQuick ? 100000 : 1000000;
+    CFlightRecorder Recorder;
+    double          Time, Start;
+    char            szFile[64];
+
+    if ( !Recorder.Create( TIMER_HITCH_TIME, FLIGHT_PRE_FRAMES, FLIGHT_POST_FRAMES, BENCH_FILE_NAME ) ) return;
+
+    // Steady frames never reach the hitch threshold
+    Time = RecordFrames( Recorder, Count, BENCH_FRAME_TIME );
+    BenchReport( "flight", "record frame", Time * 1e9, "ns" );
+    BenchReport( "flight", "frame overhead", Time * 100.0 / BENCH_FRAME_TIME, "%" );
+
+    // One hitch, then enough frames to close its dump
+    Start = BenchTime();
+    RecordFrames( Recorder, 1, TIMER_HITCH_TIME * 2.0f );
+    RecordFrames( Recorder, FLIGHT_POST_FRAMES + 1, BENCH_FRAME_TIME );
+    Time = BenchTime() - Start;
+    BenchReport( "flight", "dumps written", (double)Recorder.GetDumpCount(), "dumps" );
+    if ( Recorder.GetDumpCount() > 0 )
+        BenchReport( "flight", "write dump", Time * 1e6, "us" );
+
+    // The hitch time is committed against the last steady frame
+    sprintf( szFile, "%s%u.csv", BENCH_FILE_NAME, (unsigned int)(Count - 1) );
+    remove( szFile );
+    Recorder.Release();
+}
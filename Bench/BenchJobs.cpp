@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------------
+// File: BenchJobs.cpp
+//
+// Desc: Measures the overheads of the work stealing job system, and how the
+//       per object animation workload scales with thread count.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchJobs Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CJobSystem.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static std::atomic<ULONG> g_nSink( 0 );    // Touched by the empty jobs
+
+//-----------------------------------------------------------------------------
+// Name : EmptyJob () (Local)
+// Desc : Job which does (next to) nothing, so that only overhead is measured.
+//-----------------------------------------------------------------------------
+static void EmptyJob( void *, ULONG Begin, ULONG End )
+{
+    g_nSink.fetch_add( End - Begin, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateJob () (Local)
+// Desc : Same work per object as CGameApp::AnimateObject, a yaw / pitch / roll
+//        rotation built from three matrices and applied to the world matrix.
+//-----------------------------------------------------------------------------
+static void AnimateJob( void * pContext, ULONG Begin, ULONG End )
+{
+    D3DXMATRIX * pWorld = (D3DXMATRIX*)pContext;
+    D3DXMATRIX   mtxYaw, mtxPitch, mtxRoll, mtxRotate;
+
+    for ( ULONG i = Begin; i < End; i++ )
+    {
+        float fElapsed = 0.016f + (float)(i & 7) * 0.001f;
+
+        D3DXMatrixIdentity( &mtxRotate );
+        D3DXMatrixRotationY( &mtxYaw,   D3DXToRadian( 75.0f * fElapsed ) );
+        D3DXMatrixRotationX( &mtxPitch, D3DXToRadian( 50.0f * fElapsed ) );
+        D3DXMatrixRotationZ( &mtxRoll,  D3DXToRadian( 25.0f * fElapsed ) );
+        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxYaw );
+        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxPitch );
+        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxRoll );
+        D3DXMatrixMultiply( &pWorld[i], &mtxRotate, &pWorld[i] );
+
+    } // Next Object
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchOverheads () (Local)
+// Desc : Reports the cost of spawning individual jobs, of parallel-for
+//        splitting, of releasing dependent jobs, and how often work is stolen.
+//-----------------------------------------------------------------------------
+static void BenchOverheads( ULONG Threads, ULONG JobCount )
+{
+    CJobSystem  Jobs;
+    JOBSTATS    Stats;
+    double      Start, Elapsed;
+    char        szName[64];
+    const ULONG Batch = 1024;
+
+    if ( !Jobs.Create( Threads ) ) return;
+
+    // Individually submitted jobs, in batches which fit a deque
+    Jobs.ResetStats();
+    Start = BenchTime();
+    for ( ULONG n = 0; n < JobCount; n += Batch )
+    {
+        CJobCounter Counter;
+        for ( ULONG i = 0; i < Batch; i++ ) Jobs.Submit( EmptyJob, NULL, 0, 1, &Counter );
+        Jobs.Wait( &Counter );
+
+    } // Next Batch
+    Elapsed = BenchTime() - Start;
+    Jobs.GetStats( Stats );
+
+    sprintf( szName, "spawn %u threads", (unsigned int)Threads );
+    BenchReport( "jobs", szName, Elapsed * 1e9 / (double)JobCount, "ns/job" );
+    sprintf( szName, "spawn %u threads stolen", (unsigned int)Threads );
+    BenchReport( "jobs", szName, (Stats.Executed > 0) ? 100.0 * Stats.Stolen / Stats.Executed : 0.0, "% of jobs" );
+    sprintf( szName, "spawn %u threads steal success", (unsigned int)Threads );
+    BenchReport( "jobs", szName, (Stats.StealAttempts > 0) ? 100.0 * Stats.Stolen / Stats.StealAttempts : 0.0, "% of attempts" );
+
+    // Parallel-for down to single indices
+    Jobs.ResetStats();
+    Start = BenchTime();
+    Jobs.ParallelFor( EmptyJob, NULL, JobCount, 1 );
+    Elapsed = BenchTime() - Start;
+    Jobs.GetStats( Stats );
+
+    sprintf( szName, "parallel-for %u threads", (unsigned int)Threads );
+    BenchReport( "jobs", szName, Elapsed * 1e9 / (double)Stats.Executed, "ns/job" );
+    sprintf( szName, "parallel-for %u threads stolen", (unsigned int)Threads );
+    BenchReport( "jobs", szName, (Stats.Executed > 0) ? 100.0 * Stats.Stolen / Stats.Executed : 0.0, "% of jobs" );
+
+    // Chains of dependent jobs, each released by the completion of the last
+    {
+        const ULONG  ChainLength = 256;
+        CJobCounter *pCounters = new CJobCounter[ ChainLength ];
+        ULONG        Chains = JobCount / ChainLength / 4 + 1;
+
+        Start = BenchTime();
+        for ( ULONG c = 0; c < Chains; c++ )
+        {
+            for ( ULONG i = 0; i < ChainLength; i++ )
+                Jobs.Submit( EmptyJob, NULL, 0, 1, &pCounters[i], (i > 0) ? &pCounters[i - 1] : NULL );
+            Jobs.Wait( &pCounters[ ChainLength - 1 ] );
+
+        } // Next Chain
+        Elapsed = BenchTime() - Start;
+        delete []pCounters;
+
+        sprintf( szName, "dependency chain %u threads", (unsigned int)Threads );
+        BenchReport( "jobs", szName, Elapsed * 1e9 / ((double)Chains * ChainLength), "ns/job" );
+
+    } // End Scope
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchAnimationScaling () (Local)
+// Desc : Animates a large number of objects through the job system at
+//        increasing thread counts, reporting time per frame and speed up.
+//-----------------------------------------------------------------------------
+static void BenchAnimationScaling( ULONG Objects, ULONG Frames )
+{
+    D3DXMATRIX * pWorld = NULL;
+    ULONG        MaxThreads = BenchMaxThreads();
+    double       Start, Elapsed, Single = 0.0;
+    char         szName[64];
+
+    if (!( pWorld = new D3DXMATRIX[ Objects ] )) return;
+
+    for ( ULONG Threads = 1; ; Threads = (Threads * 2 < MaxThreads) ? Threads * 2 : MaxThreads )
+    {
+        CJobSystem Jobs;
+        if ( !Jobs.Create( Threads ) ) break;
+
+        // Same starting state for every thread count
+        for ( ULONG i = 0; i < Objects; i++ ) D3DXMatrixTranslation( &pWorld[i], (float)(i % 100), 0.0f, 14.0f );
+
+        Start = BenchTime();
+        for ( ULONG f = 0; f < Frames; f++ ) Jobs.ParallelFor( AnimateJob, pWorld, Objects, 256 );
+        Elapsed = (BenchTime() - Start) / Frames;
+        if ( Threads == 1 ) Single = Elapsed;
+
+        sprintf( szName, "animate %u objects %u threads", (unsigned int)Objects, (unsigned int)Threads );
+        BenchReport( "jobs", szName, Elapsed * 1000.0, "ms/frame" );
+        sprintf( szName, "animate %u threads speedup", (unsigned int)Threads );
+        BenchReport( "jobs", szName, Single / Elapsed, "x" );
+
+        if ( Threads == MaxThreads ) break;
+
+    } // Next Thread Count
+
+    delete []pWorld;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchJobs ()
+// Desc : Job system benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchJobs( bool bQuick )
+{
+    BenchOverheads( 1, bQuick ? 65536 : 1048576 );
+    if ( BenchMaxThreads() > 1 ) BenchOverheads( BenchMaxThreads(), bQuick ? 65536 : 1048576 );
+    BenchAnimationScaling( bQuick ? 20000 : 200000, bQuick ? 5 : 20 );
+}
@@ -0,0 +1,219 @@
+//-----------------------------------------------------------------------------
+// File: BenchLOD.cpp
+//
+// Desc: Measures quadric error simplification of a dense mesh, and the time
+//       to draw a deep field of such meshes with and without level of
+//       detail selection.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchLOD Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CObject.h"
+#include "../Includes/CLODChain.h"
+#include "../Includes/CRasterizer.h"
+#include <new>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const ULONG  BENCH_WIDTH    = 800;   // Render target size
+static const ULONG  BENCH_HEIGHT   = 600;
+static const float  SPHERE_RADIUS  = 2.0f;  // Radius of the generated sphere
+static const float  BENCH_LOD_SIZE = 200.0f;// Projected size at which the first simplified level is used
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : SphereDeviation () (Local)
+// Desc : Returns the furthest any vertex of the mesh lies from the sphere it
+//        was simplified from.
+//-----------------------------------------------------------------------------
+static float SphereDeviation( const CIndexedMesh & Mesh )
+{
+    float fMax = 0.0f;
+
+    for ( ULONG i = 0; i < Mesh.m_nVertexCount; i++ )
+    {
+        const CVertex & v = Mesh.m_pVertex[i];
+        float fDistance = fabsf( sqrtf( v.x * v.x + v.y * v.y + v.z * v.z ) - SPHERE_RADIUS );
+        if ( fDistance > fMax ) fMax = fDistance;
+
+    } // Next Vertex
+
+    return fMax;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RenderFrame () (Local)
+// Desc : Draws every sphere (solid, back faces culled), choosing each one's
+//        level from its projected size when a chain is given, and counting
+//        the triangles drawn at each level.
+//-----------------------------------------------------------------------------
+static void RenderFrame( CFrameBuffer & FrameBuffer, CTransformStage & Stage, const CLODChain & Chain, bool bLOD,
+                         const D3DXMATRIX & mtxProjection, const D3DXMATRIX * pWorld, ULONG ObjectCount,
+                         CScreenVertex * pScreen, ULONG * pTriangles )
+{
+    static const ULONG Colors[6] = { 0x00C04040, 0x0040C040, 0x004040C0, 0x00C0C040, 0x00C040C0, 0x0040C0C0 };
+    CRasterizer        Rasterizer;
+    const CIndexedMesh & Source = *Chain.GetLevel( 0 );
+
+    FrameBuffer.Clear( 0x00FFFFFF );
+    FrameBuffer.ClearDepth( 1.0f );
+    Rasterizer.SetRenderTarget( &FrameBuffer );
+
+    for ( ULONG i = 0; i < ObjectCount; i++ )
+    {
+        ULONG Level = 0;
+
+        Stage.SetWorld( pWorld[i] );
+        if ( Stage.TestBounds( Source.m_Bounds ) != CULL_INSIDE ) continue;
+
+        // Projected diameter, as CGameApp::GetProjectedSize (the camera is
+        // at the origin looking down z, and the spheres are unscaled)
+        if ( bLOD ) Level = Chain.SelectLevel( Source.m_Bounds.m_fRadius * mtxProjection._22 * (float)BENCH_HEIGHT / pWorld[i]._43 );
+        const CIndexedMesh & Mesh = *Chain.GetLevel( Level );
+
+        Stage.Transform( Mesh.m_pVertex, pScreen, Mesh.m_nVertexCount );
+        D3DXVECTOR3 vecEye( -pWorld[i]._41, -pWorld[i]._42, -pWorld[i]._43 );
+        for ( ULONG f = 0; f < Mesh.m_nPolygonCount; f++ )
+        {
+            const D3DXPLANE & Plane  = Mesh.m_pPolygonPlane[f];
+            const ULONG     * pIndex = Mesh.GetPolygonIndices( f );
+            ULONG             nCount = Mesh.GetPolygonVertexCount( f );
+            if ( Plane.a * vecEye.x + Plane.b * vecEye.y + Plane.c * vecEye.z + Plane.d < 0.0f ) continue;
+
+            Rasterizer.SetColor( Colors[ f % 6 ] );
+            for ( ULONG v = 2; v < nCount; v++ )
+                Rasterizer.DrawTriangle( pScreen[ pIndex[0] ], pScreen[ pIndex[v - 1] ], pScreen[ pIndex[v] ] );
+            pTriangles[ Level ] += nCount - 2;
+
+        } // Next Face
+
+    } // Next Object
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchSimplify () (Local)
+// Desc : Builds a chain from a sphere of the given tessellation, reporting
+//        the time taken and the triangles, error and switch size of each
+//        level.
+//-----------------------------------------------------------------------------
+static void BenchSimplify( ULONG Slices, ULONG Stacks, ULONG Repeats )
+{
+    CIndexedMesh Sphere;
+    CLODChain    Chain;
+    double       Start, Elapsed;
+    char         szName[64];
+
+    if ( !Sphere.BuildSphere( SPHERE_RADIUS, Slices, Stacks ) ) return;
+
+    Start = BenchTime();
+    for ( ULONG r = 0; r < Repeats; r++ ) if ( !Chain.Build( &Sphere, LOD_MAX_LEVELS, BENCH_LOD_SIZE ) ) return;
+    Elapsed = (BenchTime() - Start) / Repeats;
+
+    sprintf( szName, "%u triangle sphere, build chain", (unsigned int)CLODChain::CountTriangles( Sphere ) );
+    BenchReport( "lod", szName, Elapsed * 1000.0, "ms" );
+    sprintf( szName, "%u triangle sphere, collapses", (unsigned int)CLODChain::CountTriangles( Sphere ) );
+    BenchReport( "lod", szName, (Sphere.m_nVertexCount - Chain.GetLevel( Chain.GetLevelCount() - 1 )->m_nVertexCount) / (Elapsed * 1000000.0), "M/s" );
+
+    for ( ULONG i = 0; i < Chain.GetLevelCount(); i++ )
+    {
+        const CIndexedMesh * pLevel = Chain.GetLevel( i );
+        sprintf( szName, "level %u, triangles", (unsigned int)i );
+        BenchReport( "lod", szName, (double)CLODChain::CountTriangles( *pLevel ), "triangles" );
+        sprintf( szName, "level %u, deviation", (unsigned int)i );
+        BenchReport( "lod", szName, 100.0 * SphereDeviation( *pLevel ) / SPHERE_RADIUS, "% of radius" );
+        sprintf( szName, "level %u, quadric error", (unsigned int)i );
+        BenchReport( "lod", szName, 100.0 * Chain.GetLevelError( i ) / SPHERE_RADIUS, "% of radius" );
+
+    } // Next Level
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchField () (Local)
+// Desc : Scatters spheres through a deep view volume and reports the time per
+//        frame and triangles drawn at each level, with and without LOD.
+//-----------------------------------------------------------------------------
+static void BenchField( ULONG ObjectCount, ULONG Frames )
+{
+    CMemoryFrameBuffer  FrameBuffer;
+    CTransformStage     Stage;
+    CIndexedMesh        Sphere;
+    CLODChain           Chain;
+    CScreenVertex     * pScreen = NULL;
+    D3DXMATRIX        * pWorld = NULL;
+    D3DXMATRIX          mtxView, mtxProjection;
+    ULONG               Seed = 0x10D5, pTriangles[ LOD_MAX_LEVELS ];
+    double              Start, Off, On;
+    char                szName[64];
+
+    // Half extents of the view at unit distance
+    const float fHalfY = tanf( D3DXToRadian( 30.0f ) );
+    const float fHalfX = fHalfY * (float)BENCH_WIDTH / (float)BENCH_HEIGHT;
+
+    if ( !FrameBuffer.Create( BENCH_WIDTH, BENCH_HEIGHT ) || !FrameBuffer.CreateDepthBuffer() ) return;
+    if ( !Sphere.BuildSphere( SPHERE_RADIUS, 64, 32 ) || !Chain.Build( &Sphere, LOD_MAX_LEVELS, BENCH_LOD_SIZE ) ) return;
+    if (!( pScreen = new (std::nothrow) CScreenVertex[ Sphere.m_nVertexCount ] )) return;
+    if (!( pWorld = new (std::nothrow) D3DXMATRIX[ ObjectCount ] )) { delete []pScreen; return; }
+
+    // Spheres from just in front of the camera to far away, thinning out
+    // with distance as a real scene would
+    for ( ULONG i = 0; i < ObjectCount; i++ )
+    {
+        float t = (float)(BenchRandom( Seed ) % 1001) / 1000.0f;
+        float z = 6.0f + 300.0f * t * t;
+        float x = ((float)(BenchRandom( Seed ) % 2001) / 1000.0f - 1.0f) * fHalfX * z * 0.8f;
+        float y = ((float)(BenchRandom( Seed ) % 2001) / 1000.0f - 1.0f) * fHalfY * z * 0.8f;
+        D3DXMatrixTranslation( &pWorld[i], x, y, z );
+
+    } // Next Object
+
+    D3DXMatrixIdentity( &mtxView );
+    D3DXMatrixPerspectiveFovLH( &mtxProjection, D3DXToRadian( 60.0f ), (float)BENCH_WIDTH / (float)BENCH_HEIGHT, 1.01f, 1000.0f );
+    Stage.SetViewport( 0, 0, BENCH_WIDTH, BENCH_HEIGHT );
+    Stage.SetViewProjection( mtxView, mtxProjection );
+
+    // Full detail, then LOD (after a warm up frame)
+    ZeroMemory( pTriangles, sizeof(pTriangles) );
+    RenderFrame( FrameBuffer, Stage, Chain, false, mtxProjection, pWorld, ObjectCount, pScreen, pTriangles );
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ ) RenderFrame( FrameBuffer, Stage, Chain, false, mtxProjection, pWorld, ObjectCount, pScreen, pTriangles );
+    Off = (BenchTime() - Start) / Frames;
+    sprintf( szName, "%u objects, full detail", (unsigned int)ObjectCount );
+    BenchReport( "lod", szName, Off * 1000.0, "ms/frame" );
+    sprintf( szName, "%u objects, full detail, triangles", (unsigned int)ObjectCount );
+    BenchReport( "lod", szName, (double)pTriangles[0] / (Frames + 1), "per frame" );
+
+    ZeroMemory( pTriangles, sizeof(pTriangles) );
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ ) RenderFrame( FrameBuffer, Stage, Chain, true, mtxProjection, pWorld, ObjectCount, pScreen, pTriangles );
+    On = (BenchTime() - Start) / Frames;
+    sprintf( szName, "%u objects, lod", (unsigned int)ObjectCount );
+    BenchReport( "lod", szName, On * 1000.0, "ms/frame" );
+    for ( ULONG i = 0; i < Chain.GetLevelCount(); i++ )
+    {
+        sprintf( szName, "%u objects, lod, level %u triangles", (unsigned int)ObjectCount, (unsigned int)i );
+        BenchReport( "lod", szName, (double)pTriangles[i] / Frames, "per frame" );
+
+    } // Next Level
+
+    delete []pWorld;
+    delete []pScreen;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchLOD ()
+// Desc : Level of detail benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchLOD( bool bQuick )
+{
+    BenchSimplify( 64, 32, bQuick ? 2 : 10 );
+    BenchSimplify( 256, 128, bQuick ? 1 : 3 );
+    BenchField( bQuick ? 500 : 2000, bQuick ? 3 : 20 );
+}
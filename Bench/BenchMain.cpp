@@ -0,0 +1,153 @@
+//-----------------------------------------------------------------------------
+// File: BenchMain.cpp
+//
+// Desc: Entry point for the GameBench performance measurement tool. Runs
+//       every suite, or only those named on the command line. Passing
+//       -quick reduces the workload for a fast sanity run, and -threads <n>
+//       caps (or raises) the thread counts used by scaling tests.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchMain Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CJobSystem.h"
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+struct BENCHSUITE
+{
+    const char * Name;          // Name used to select the suite
+    BENCHFUNC    Function;      // Suite entry point
+};
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static const BENCHSUITE g_Suites[] =
+{
+    { "rasterizer",     BenchRasterizer },
+    { "transform",      BenchTransform },
+    { "mesh",           BenchMesh },
+    { "tiles",          BenchTiles },
+    { "jobs",           BenchJobs },
+    { "fill",           BenchFill },
+    { "occlusion",      BenchOcclusion },
+    { "bvh",            BenchBVH },
+    { "lod",            BenchLOD },
+    { "meshfile",       BenchMeshFile },
+    { "obj",            BenchOBJ },
+    { "entity",         BenchEntity },
+    { "pacing",         BenchPacing },
+    { "profiler",       BenchProfiler },
+    { "flight",         BenchFlight },
+    { "counters",       BenchCounters },
+};
+
+static ULONG g_nMaxThreads = 0;         // Thread count limit for scaling tests (0 = hardware)
+
+//-----------------------------------------------------------------------------
+// Name : BenchTime ()
+// Desc : Returns a high resolution time stamp, in seconds.
+//-----------------------------------------------------------------------------
+double BenchTime( )
+{
+    static __int64 Frequency = 0;
+    __int64        Counter;
+
+    if ( !Frequency ) QueryPerformanceFrequency( (LARGE_INTEGER*)&Frequency );
+    QueryPerformanceCounter( (LARGE_INTEGER*)&Counter );
+    return (double)Counter / (double)Frequency;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchCPUTime ()
+// Desc : Returns the processor time used by the process so far, in seconds.
+//-----------------------------------------------------------------------------
+double BenchCPUTime( )
+{
+#ifdef _WIN32
+    FILETIME ftCreate, ftExit, ftKernel, ftUser;
+    if ( !GetProcessTimes( GetCurrentProcess(), &ftCreate, &ftExit, &ftKernel, &ftUser ) ) return 0.0;
+    ULARGE_INTEGER Kernel, User;
+    Kernel.LowPart = ftKernel.dwLowDateTime; Kernel.HighPart = ftKernel.dwHighDateTime;
+    User.LowPart   = ftUser.dwLowDateTime;   User.HighPart   = ftUser.dwHighDateTime;
+    return (double)(Kernel.QuadPart + User.QuadPart) * 1e-7;
+#else
+    timespec ts;
+    clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts );
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchReport ()
+// Desc : Outputs a single measured result.
+//-----------------------------------------------------------------------------
+void BenchReport( const char * Suite, const char * Name, double Value, const char * Units )
+{
+    printf( "%-12s %-40s %16.3f %s\n", Suite, Name, Value, Units );
+    fflush( stdout );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchRandom ()
+// Desc : Small deterministic pseudo random generator (xorshift32), so that
+//        every run of a suite processes identical data.
+//-----------------------------------------------------------------------------
+ULONG BenchRandom( ULONG & Seed )
+{
+    Seed ^= Seed << 13;
+    Seed ^= Seed >> 17;
+    Seed ^= Seed << 5;
+    return Seed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchMaxThreads ()
+// Desc : Returns the highest thread count scaling tests should measure, which
+//        is the number of hardware threads unless overridden by -threads.
+//-----------------------------------------------------------------------------
+ULONG BenchMaxThreads( )
+{
+    return (g_nMaxThreads > 0) ? g_nMaxThreads : CJobSystem::GetHardwareThreads();
+}
+
+//-----------------------------------------------------------------------------
+// Name : main() (Application Entry Point)
+// Desc : Entry point for program, App flow starts here.
+//-----------------------------------------------------------------------------
+int main( int argc, char * argv[] )
+{
+    bool   bQuick    = false;
+    bool   bSelected = false;
+    ULONG  SuiteCount = sizeof(g_Suites) / sizeof(g_Suites[0]);
+
+    // Process options first
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strcmp( argv[i], "-quick" ) == 0 ) bQuick = true;
+        else if ( strcmp( argv[i], "-threads" ) == 0 && i + 1 < argc ) g_nMaxThreads = (ULONG)atoi( argv[++i] );
+        else bSelected = true;
+
+    } // Next Argument
+
+    // Run each selected suite
+    for ( ULONG s = 0; s < SuiteCount; s++ )
+    {
+        bool bRun = !bSelected;
+        for ( int i = 1; i < argc && !bRun; i++ )
+        {
+            if ( strcmp( argv[i], "-threads" ) == 0 ) { i++; continue; }
+            bRun = (strcmp( argv[i], g_Suites[s].Name ) == 0);
+
+        } // Next Argument
+        if ( bRun ) g_Suites[s].Function( bQuick );
+
+    } // Next Suite
+
+    return 0;
+}
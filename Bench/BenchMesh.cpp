@@ -0,0 +1,110 @@
+//-----------------------------------------------------------------------------
+// File: BenchMesh.cpp
+//
+// Desc: Measures mesh construction cost through the CMesh / CPolygon
+//       interface, with and without up front reservation.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchMesh Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CObject.h"
+
+//-----------------------------------------------------------------------------
+// Name : FillQuad () (Local)
+// Desc : Sets the four vertices of a grid quad.
+//-----------------------------------------------------------------------------
+static void FillQuad( CPolygon * pPoly, ULONG Index, USHORT First )
+{
+    float x = (float)(Index % 1024), z = (float)(Index / 1024);
+
+    pPoly->m_pVertex[ First + 0 ] = CVertex( x,        0.0f, z );
+    pPoly->m_pVertex[ First + 1 ] = CVertex( x + 1.0f, 0.0f, z );
+    pPoly->m_pVertex[ First + 2 ] = CVertex( x + 1.0f, 0.0f, z + 1.0f );
+    pPoly->m_pVertex[ First + 3 ] = CVertex( x,        0.0f, z + 1.0f );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchBuild () (Local)
+// Desc : Builds a grid of PolygonCount quads, one element at a time, or with
+//        everything reserved up front, then converts it to a CIndexedMesh.
+//-----------------------------------------------------------------------------
+static void BenchBuild( ULONG PolygonCount, bool bReserve )
+{
+    CMesh        * pMesh = new CMesh;
+    CIndexedMesh   Indexed;
+    double         Start, Build, Convert;
+    char           szName[64];
+
+    Start = BenchTime();
+    if ( bReserve )
+    {
+        // Reserve everything, then add in bulk
+        pMesh->Reserve( PolygonCount, PolygonCount * 4 );
+        pMesh->AddPolygon( PolygonCount );
+        for ( ULONG i = 0; i < PolygonCount; i++ )
+        {
+            CPolygon * pPoly = pMesh->m_pPolygon[i];
+            pPoly->AddVertex( 4 );
+            FillQuad( pPoly, i, 0 );
+
+        } // Next Polygon
+
+    } // End if reserve
+    else
+    {
+        // Worst case, one polygon and one vertex at a time
+        for ( ULONG i = 0; i < PolygonCount; i++ )
+        {
+            long       nIndex = pMesh->AddPolygon( 1 );
+            CPolygon * pPoly  = pMesh->m_pPolygon[ nIndex ];
+            for ( USHORT v = 0; v < 4; v++ ) pPoly->AddVertex( 1 );
+            FillQuad( pPoly, i, 0 );
+
+        } // Next Polygon
+
+    } // End if incremental
+    Build = BenchTime() - Start;
+
+    // Conversion to the render representation
+    Start = BenchTime();
+    Indexed.BuildFromMesh( *pMesh );
+    Convert = BenchTime() - Start;
+
+    sprintf( szName, "%s build (%u polys)", bReserve ? "reserved" : "incremental", (unsigned int)PolygonCount );
+    BenchReport( "mesh", szName, Build * 1e9 / PolygonCount, "ns/polygon" );
+    sprintf( szName, "%s arena blocks (%u polys)", bReserve ? "reserved" : "incremental", (unsigned int)PolygonCount );
+    BenchReport( "mesh", szName, (double)pMesh->m_Arena.GetBlockCount(), "blocks" );
+    if ( bReserve )
+    {
+        sprintf( szName, "indexed conversion (%u polys)", (unsigned int)PolygonCount );
+        BenchReport( "mesh", szName, Convert * 1e9 / PolygonCount, "ns/polygon" );
+
+    } // End if
+
+    // Destruction is part of the cost of a temporary build mesh
+    Start = BenchTime();
+    delete pMesh;
+    sprintf( szName, "%s destroy (%u polys)", bReserve ? "reserved" : "incremental", (unsigned int)PolygonCount );
+    BenchReport( "mesh", szName, (BenchTime() - Start) * 1e9 / PolygonCount, "ns/polygon" );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchMesh ()
+// Desc : Mesh construction benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchMesh( bool bQuick )
+{
+    ULONG Sizes[] = { 10000, 100000, 1000000 };
+    ULONG Count   = bQuick ? 2 : 3;
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        BenchBuild( Sizes[i], false );
+        BenchBuild( Sizes[i], true );
+
+    } // Next Size
+}
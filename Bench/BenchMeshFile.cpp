@@ -0,0 +1,275 @@
+//-----------------------------------------------------------------------------
+// File: BenchMeshFile.cpp
+//
+// Desc: Measures loading of a large mesh file: opening and attaching every
+//       mesh in place, then the first pass over the geometry (paged in on
+//       demand, with and without a prefetch hint) against reading and
+//       copying the same data into memory.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchMeshFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CObject.h"
+#include "../Includes/CMeshFile.h"
+#include <new>
+#ifndef _WIN32
+#include <sys/resource.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const char * BENCH_FILE_NAME = "GameBench.gmf";  // Scratch file, removed afterwards
+static const ULONG  GRID_SIZE       = 256;              // Grid mesh is GRID_SIZE x GRID_SIZE quads
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : BuildGrid () (Local)
+// Desc : Builds a rippled grid of quads, roughly 2.6MB as a mesh file entry.
+//-----------------------------------------------------------------------------
+static bool BuildGrid( CIndexedMesh & Mesh )
+{
+    ULONG Row = GRID_SIZE + 1;
+
+    if ( !Mesh.Create( Row * Row, GRID_SIZE * GRID_SIZE * 4, GRID_SIZE * GRID_SIZE ) ) return false;
+    for ( ULONG y = 0; y < Row; y++ )
+    {
+        for ( ULONG x = 0; x < Row; x++ )
+            Mesh.m_pVertex[ y * Row + x ] = CVertex( (float)x, sinf( x * 0.1f ) * cosf( y * 0.1f ), (float)y );
+
+    } // Next Row
+    for ( ULONG y = 0, p = 0; y < GRID_SIZE; y++ )
+    {
+        for ( ULONG x = 0; x < GRID_SIZE; x++, p++ )
+        {
+            ULONG * pIndex = &Mesh.m_pIndex[ p * 4 ];
+            Mesh.m_pPolygonStart[p] = p * 4;
+            pIndex[0] = y * Row + x;        pIndex[1] = (y + 1) * Row + x;
+            pIndex[2] = (y + 1) * Row + x + 1; pIndex[3] = y * Row + x + 1;
+
+        } // Next Column
+
+    } // Next Row
+
+    Mesh.CalculateBounds();
+    return Mesh.CalculatePlanes();
+}
+
+//-----------------------------------------------------------------------------
+// Name : DropFileCache () (Local)
+// Desc : Asks the operating system to forget its cached copy of the file so
+//        that the next load reads it from disk. Returns false if this is not
+//        supported, in which case 'cold' results are really warm ones.
+//-----------------------------------------------------------------------------
+static bool DropFileCache( const char * pFileName )
+{
+#if !defined(_WIN32) && defined(POSIX_FADV_DONTNEED)
+    int nFile = open( pFileName, O_RDONLY );
+    if ( nFile < 0 ) return false;
+    fdatasync( nFile );
+    bool bResult = (posix_fadvise( nFile, 0, 0, POSIX_FADV_DONTNEED ) == 0);
+    close( nFile );
+    return bResult;
+#else
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPageFaults () (Local)
+// Desc : Returns the page faults taken by the process so far (major faults,
+//        those needing disk access, in Major). Zero where not available.
+//-----------------------------------------------------------------------------
+static double GetPageFaults( double & Major )
+{
+#ifndef _WIN32
+    struct rusage Usage;
+    getrusage( RUSAGE_SELF, &Usage );
+    Major = (double)Usage.ru_majflt;
+    return (double)(Usage.ru_minflt + Usage.ru_majflt);
+#else
+    Major = 0.0;
+    return 0.0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : SeekTo () (Local)
+// Desc : Moves to a 64 bit offset within a file (fseek only takes a long).
+//-----------------------------------------------------------------------------
+static bool SeekTo( FILE * pFile, unsigned __int64 Offset )
+{
+#ifdef _WIN32
+    return _fseeki64( pFile, (__int64)Offset, SEEK_SET ) == 0;
+#else
+    return fseeko( pFile, (off_t)Offset, SEEK_SET ) == 0;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : TouchMesh () (Local)
+// Desc : Reads every vertex, index, polygon start and plane of a mesh, as a
+//        first use of it would, returning a checksum so nothing is skipped.
+//-----------------------------------------------------------------------------
+static double TouchMesh( const CIndexedMesh & Mesh )
+{
+    double fSum = 0.0;
+    ULONG  nSum = 0;
+
+    for ( ULONG i = 0; i < Mesh.m_nVertexCount; i++ ) fSum += Mesh.m_pVertex[i].y;
+    for ( ULONG i = 0; i < Mesh.m_nIndexCount; i++ ) nSum += Mesh.m_pIndex[i];
+    for ( ULONG i = 0; i <= Mesh.m_nPolygonCount; i++ ) nSum += Mesh.m_pPolygonStart[i];
+    for ( ULONG i = 0; i < Mesh.m_nPolygonCount; i++ ) fSum += Mesh.m_pPolygonPlane[i].d;
+    return fSum + nSum;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadMapped () (Local)
+// Desc : Opens the file and attaches every mesh, timing that separately from
+//        the first pass over the geometry, and reports both along with the
+//        page faults taken.
+//-----------------------------------------------------------------------------
+static double LoadMapped( const char * pTest, bool bPrefetch, double MegaBytes )
+{
+    CMeshFile      File;
+    CIndexedMesh * pMeshes;
+    double         Start, Opened, Touched, Faults, Major, EndMajor, fSum = 0.0;
+    char           szName[64];
+
+    Faults = GetPageFaults( Major );
+    Start  = BenchTime();
+    if ( !File.Open( BENCH_FILE_NAME ) ) return 0.0;
+    if (!( pMeshes = new (std::nothrow) CIndexedMesh[ File.GetMeshCount() ] )) return 0.0;
+    for ( ULONG i = 0; i < File.GetMeshCount(); i++ ) File.GetMesh( i, pMeshes[i] );
+    if ( bPrefetch ) File.Prefetch();
+    Opened = BenchTime();
+
+    for ( ULONG i = 0; i < File.GetMeshCount(); i++ ) fSum += TouchMesh( pMeshes[i] );
+    Touched = BenchTime();
+    Faults  = GetPageFaults( EndMajor ) - Faults;
+
+    sprintf( szName, "%s, open + attach", pTest );
+    BenchReport( "meshfile", szName, (Opened - Start) * 1000.0, "ms" );
+    sprintf( szName, "%s, first pass", pTest );
+    BenchReport( "meshfile", szName, MegaBytes / (Touched - Start), "MB/s" );
+    sprintf( szName, "%s, page faults", pTest );
+    BenchReport( "meshfile", szName, Faults, "faults" );
+    sprintf( szName, "%s, major page faults", pTest );
+    BenchReport( "meshfile", szName, EndMajor - Major, "faults" );
+
+    delete []pMeshes;
+    return fSum;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadCopied () (Local)
+// Desc : Reads the file conventionally, each block into newly allocated mesh
+//        arrays, then makes the same first pass over the geometry.
+//-----------------------------------------------------------------------------
+static double LoadCopied( double MegaBytes )
+{
+    MESHFILEHEADER  Header;
+    MESHFILEENTRY * pEntries = NULL;
+    CIndexedMesh  * pMeshes  = NULL;
+    FILE          * pFile;
+    double          Start, fSum = 0.0;
+    bool            bResult = true;
+
+    Start = BenchTime();
+    if (!( pFile = fopen( BENCH_FILE_NAME, "rb" ) )) return 0.0;
+    if ( fread( &Header, sizeof(Header), 1, pFile ) != 1 ) { fclose( pFile ); return 0.0; }
+    pEntries = new (std::nothrow) MESHFILEENTRY[ Header.MeshCount ];
+    pMeshes  = new (std::nothrow) CIndexedMesh[ Header.MeshCount ];
+    if ( !pEntries || !pMeshes ) bResult = false;
+    if ( bResult ) bResult = SeekTo( pFile, Header.TableOffset ) &&
+                             fread( pEntries, sizeof(MESHFILEENTRY), Header.MeshCount, pFile ) == Header.MeshCount;
+
+    // Blocks are stored in order, so seek past the padding and read each
+    for ( ULONG i = 0; i < Header.MeshCount && bResult; i++ )
+    {
+        const MESHFILEENTRY & Entry = pEntries[i];
+        CIndexedMesh        & Mesh  = pMeshes[i];
+
+        bResult = Mesh.Create( Entry.VertexCount, Entry.IndexCount, Entry.PolygonCount ) &&
+                  (Mesh.m_pPolygonPlane = new (std::nothrow) D3DXPLANE[ Entry.PolygonCount ]) != NULL;
+        if ( !bResult ) break;
+
+        bResult = SeekTo( pFile, Entry.VertexOffset ) &&
+                  fread( Mesh.m_pVertex, sizeof(CVertex), Entry.VertexCount, pFile ) == Entry.VertexCount &&
+                  SeekTo( pFile, Entry.IndexOffset ) &&
+                  fread( Mesh.m_pIndex, sizeof(ULONG), Entry.IndexCount, pFile ) == Entry.IndexCount &&
+                  SeekTo( pFile, Entry.PolygonOffset ) &&
+                  fread( Mesh.m_pPolygonStart, sizeof(ULONG), Entry.PolygonCount + 1, pFile ) == Entry.PolygonCount + 1 &&
+                  SeekTo( pFile, Entry.PlaneOffset ) &&
+                  fread( Mesh.m_pPolygonPlane, sizeof(D3DXPLANE), Entry.PolygonCount, pFile ) == Entry.PolygonCount;
+
+    } // Next Mesh
+    fclose( pFile );
+
+    for ( ULONG i = 0; i < Header.MeshCount && bResult; i++ ) fSum += TouchMesh( pMeshes[i] );
+    if ( bResult ) BenchReport( "meshfile", "read + copy, first pass", MegaBytes / (BenchTime() - Start), "MB/s" );
+
+    if ( pEntries ) delete []pEntries;
+    if ( pMeshes  ) delete []pMeshes;
+    return fSum;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchMeshFile ()
+// Desc : Mesh file loading benchmark suite entry point. Writes a scratch file
+//        of the requested size (in megabytes) made of copies of one mesh.
+//-----------------------------------------------------------------------------
+void BenchMeshFile( bool bQuick )
+{
+    const double          TargetMB = bQuick ? 256.0 : 4096.0;
+    CIndexedMesh          Grid;
+    CMeshFile             File;
+    const CIndexedMesh ** ppMeshes;
+    ULONG                 nCount;
+    double                Start, MegaBytes, fSum;
+    bool                  bCold;
+
+    if ( !BuildGrid( Grid ) ) return;
+
+    // Enough copies of the grid to reach the target size
+    const CIndexedMesh * pTable[1] = { &Grid };
+    if ( !CMeshFile::Write( BENCH_FILE_NAME, pTable, NULL, NULL, 1 ) || !File.Open( BENCH_FILE_NAME ) ) return;
+    nCount = (ULONG)(TargetMB * 1024.0 * 1024.0 / (double)File.GetFileSize()) + 1;
+    File.Close();
+
+    if (!( ppMeshes = new (std::nothrow) const CIndexedMesh*[ nCount ] )) return;
+    for ( ULONG i = 0; i < nCount; i++ ) ppMeshes[i] = &Grid;
+
+    Start = BenchTime();
+    if ( !CMeshFile::Write( BENCH_FILE_NAME, ppMeshes, NULL, NULL, nCount ) ) { delete []ppMeshes; remove( BENCH_FILE_NAME ); return; }
+    if ( !File.Open( BENCH_FILE_NAME ) ) { delete []ppMeshes; remove( BENCH_FILE_NAME ); return; }
+    MegaBytes = File.GetFileSize() / (1024.0 * 1024.0);
+    File.Close();
+    BenchReport( "meshfile", "file size", MegaBytes, "MB" );
+    BenchReport( "meshfile", "write", MegaBytes / (BenchTime() - Start), "MB/s" );
+
+    // Loads from disk (where the cache can be dropped), then from memory
+    bCold = DropFileCache( BENCH_FILE_NAME );
+    BenchReport( "meshfile", "cold cache available", bCold ? 1.0 : 0.0, "bool" );
+    fSum  = LoadMapped( "mapped cold", false, MegaBytes );
+    DropFileCache( BENCH_FILE_NAME );
+    fSum += LoadMapped( "mapped cold, prefetch", true, MegaBytes );
+    DropFileCache( BENCH_FILE_NAME );
+    fSum += LoadCopied( MegaBytes );
+    fSum += LoadMapped( "mapped warm", false, MegaBytes );
+    fSum += LoadCopied( MegaBytes );
+
+    // Keep the checksum alive
+    if ( fSum == 0.12345 ) printf( "\n" );
+
+    delete []ppMeshes;
+    remove( BENCH_FILE_NAME );
+}
@@ -0,0 +1,202 @@
+//-----------------------------------------------------------------------------
+// File: BenchOBJ.cpp
+//
+// Desc: Measures OBJ import throughput against the number of threads
+//       parsing, on a large generated file of mixed face types.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchOBJ Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CObject.h"
+#include "../Includes/COBJImporter.h"
+#include "../Includes/CJobSystem.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const char * BENCH_FILE_NAME = "GameBench.obj";  // Scratch file, removed afterwards
+static const ULONG  TILE_SIZE       = 64;               // Each tile is TILE_SIZE x TILE_SIZE cells
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : WriteTile () (Local)
+// Desc : Writes one tile of a rippled terrain, as an exporter might: its
+//        own copy of the edge vertices it shares with its neighbours, with
+//        texture coordinates and normals, and faces which are mostly quads
+//        but with some split into triangles and some pairs merged into
+//        hexagons. Every other tile refers to its vertices relatively.
+//        Returns the number of bytes written.
+//-----------------------------------------------------------------------------
+static size_t WriteTile( FILE * pFile, ULONG Tile, ULONG TilesPerRow, ULONG & VertexBase )
+{
+    ULONG  Row = TILE_SIZE + 1, OriginX = (Tile % TilesPerRow) * TILE_SIZE, OriginZ = (Tile / TilesPerRow) * TILE_SIZE;
+    bool   bRelative = (Tile & 1) != 0;
+    size_t Bytes = 0;
+    int    Written;
+
+    Written = fprintf( pFile, "# tile %u\no tile%u\n", (unsigned int)Tile, (unsigned int)Tile );
+    Bytes += ( Written > 0 ) ? Written : 0;
+
+    for ( ULONG z = 0; z < Row; z++ )
+    {
+        for ( ULONG x = 0; x < Row; x++ )
+        {
+            float fX = (float)(OriginX + x), fZ = (float)(OriginZ + z);
+            Written = fprintf( pFile, "v %.6f %.6f %.6f\nvt %.4f %.4f\nvn 0 1 0\n", fX, sinf( fX * 0.1f ) * cosf( fZ * 0.1f ) * 4.0f,
+                               fZ, x / (float)TILE_SIZE, z / (float)TILE_SIZE );
+            Bytes += ( Written > 0 ) ? Written : 0;
+
+        } // Next Column
+
+    } // Next Row
+
+    for ( ULONG z = 0; z < TILE_SIZE; z++ )
+    {
+        for ( ULONG x = 0; x < TILE_SIZE; x++ )
+        {
+            long Corner[6], Base = bRelative ? -(long)(Row * Row) : (long)VertexBase + 1;
+
+            Corner[0] = Base + (long)(z * Row + x);
+            Corner[1] = Corner[0] + 1;
+            Corner[2] = Corner[1] + (long)Row;
+            Corner[3] = Corner[0] + (long)Row;
+
+            if ( (x + z) % 7 == 0 )
+            {
+                // Two triangles
+                Written = fprintf( pFile, "f %ld/%ld %ld/%ld %ld/%ld\nf %ld/%ld %ld/%ld %ld/%ld\n",
+                                   Corner[0], Corner[0], Corner[1], Corner[1], Corner[2], Corner[2],
+                                   Corner[0], Corner[0], Corner[2], Corner[2], Corner[3], Corner[3] );
+
+            } // End if triangles
+            else if ( x % 5 == 1 && x + 1 < TILE_SIZE )
+            {
+                // Hexagon over this cell and the next
+                Corner[4] = Corner[1] + 1;
+                Corner[5] = Corner[2] + 1;
+                Written = fprintf( pFile, "f %ld//%ld %ld//%ld %ld//%ld %ld//%ld %ld//%ld %ld//%ld\n",
+                                   Corner[0], Corner[0], Corner[1], Corner[1], Corner[4], Corner[4],
+                                   Corner[5], Corner[5], Corner[2], Corner[2], Corner[3], Corner[3] );
+                x++;
+
+            } // End if hexagon
+            else
+            {
+                Written = fprintf( pFile, "f %ld/%ld/%ld %ld/%ld/%ld %ld/%ld/%ld %ld/%ld/%ld\n",
+                                   Corner[0], Corner[0], Corner[0], Corner[1], Corner[1], Corner[1],
+                                   Corner[2], Corner[2], Corner[2], Corner[3], Corner[3], Corner[3] );
+
+            } // End if quad
+            Bytes += ( Written > 0 ) ? Written : 0;
+
+        } // Next Cell
+
+    } // Next Row
+
+    VertexBase += Row * Row;
+    return Bytes;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteTerrain () (Local)
+// Desc : Writes tiles until the file reaches the requested size.
+//-----------------------------------------------------------------------------
+static bool WriteTerrain( const char * pFileName, double TargetMB )
+{
+    FILE * pFile;
+    ULONG  Tile = 0, VertexBase = 0;
+    double Bytes = 0.0;
+
+    if (!( pFile = fopen( pFileName, "wb" ) )) return false;
+    while ( Bytes < TargetMB * 1024.0 * 1024.0 ) Bytes += (double)WriteTile( pFile, Tile++, 32, VertexBase );
+    return fclose( pFile ) == 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : TimeImport () (Local)
+// Desc : Imports the file once to warm the cache, then reports the best of
+//        a few timed imports.
+//-----------------------------------------------------------------------------
+static bool TimeImport( COBJImporter & Importer, CIndexedMesh & Mesh, ULONG Runs, double & Elapsed )
+{
+    Elapsed = 0.0;
+    if ( !Importer.Import( BENCH_FILE_NAME, Mesh ) ) return false;
+    for ( ULONG i = 0; i < Runs; i++ )
+    {
+        double Start = BenchTime(), Time;
+
+        if ( !Importer.Import( BENCH_FILE_NAME, Mesh ) ) return false;
+        Time = BenchTime() - Start;
+        if ( i == 0 || Time < Elapsed ) Elapsed = Time;
+
+    } // Next Run
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchOBJ ()
+// Desc : Runs the OBJ import suite.
+//-----------------------------------------------------------------------------
+void BenchOBJ( bool bQuick )
+{
+    const double TargetMB = bQuick ? 32.0 : 512.0;
+    const ULONG  Runs     = bQuick ? 2 : 3;
+    ULONG        MaxThreads = BenchMaxThreads();
+    double       MegaBytes, Elapsed, Single = 0.0;
+    char         szName[64];
+
+    if ( !WriteTerrain( BENCH_FILE_NAME, TargetMB ) ) { remove( BENCH_FILE_NAME ); return; }
+
+    for ( ULONG Threads = 1; ; Threads = (Threads * 2 < MaxThreads) ? Threads * 2 : MaxThreads )
+    {
+        CJobSystem   Jobs;
+        COBJImporter Importer;
+        CIndexedMesh Mesh;
+
+        if ( !Jobs.Create( Threads ) ) break;
+        Importer.SetJobSystem( &Jobs );
+        if ( !TimeImport( Importer, Mesh, Runs, Elapsed ) ) break;
+
+        const OBJSTATS & Stats = Importer.GetStats();
+        MegaBytes = Stats.FileSize / (1024.0 * 1024.0);
+        if ( Threads == 1 )
+        {
+            Single = Elapsed;
+            BenchReport( "obj", "file size", MegaBytes, "MB" );
+            BenchReport( "obj", "chunks", (double)Stats.ChunkCount, "chunks" );
+            BenchReport( "obj", "positions read", (double)Stats.PositionCount, "vertices" );
+            BenchReport( "obj", "vertices welded", (double)Stats.VertexCount, "vertices" );
+            BenchReport( "obj", "polygons", (double)Stats.PolygonCount, "polygons" );
+
+        } // End if first
+
+        sprintf( szName, "import %u threads", (unsigned int)Threads );
+        BenchReport( "obj", szName, MegaBytes / Elapsed, "MB/s" );
+        sprintf( szName, "import %u threads speedup", (unsigned int)Threads );
+        BenchReport( "obj", szName, Single / Elapsed, "x" );
+
+        // Welding is serial, so show what it costs at the widest setting
+        if ( Threads == MaxThreads )
+        {
+            Importer.SetWeld( false );
+            if ( TimeImport( Importer, Mesh, Runs, Elapsed ) )
+            {
+                sprintf( szName, "import %u threads, no weld", (unsigned int)Threads );
+                BenchReport( "obj", szName, MegaBytes / Elapsed, "MB/s" );
+
+            } // End if imported
+            break;
+
+        } // End if last
+
+    } // Next Thread Count
+
+    remove( BENCH_FILE_NAME );
+}
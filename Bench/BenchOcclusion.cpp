@@ -0,0 +1,234 @@
+//-----------------------------------------------------------------------------
+// File: BenchOcclusion.cpp
+//
+// Desc: Measures frame time with and without hierarchical depth occlusion
+//       culling, as more and more of a dense scene is hidden behind a wall.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchOcclusion Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CObject.h"
+#include "../Includes/CRasterizer.h"
+#include "../Includes/COcclusionBuffer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const ULONG  BENCH_WIDTH  = 800;     // Render target size
+static const ULONG  BENCH_HEIGHT = 600;
+static const float  WALL_DEPTH   = 20.0f;   // Distance to the occluding wall
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : BuildCube () (Local)
+// Desc : Builds a closed 4x4x4 cube, wound as in CGameApp::BuildObjects.
+//-----------------------------------------------------------------------------
+static bool BuildCube( CIndexedMesh & Mesh )
+{
+    static const ULONG Faces[6][4] = { { 2, 3, 1, 0 }, { 6, 7, 3, 2 }, { 4, 5, 7, 6 },
+                                       { 0, 1, 5, 4 }, { 6, 2, 0, 4 }, { 3, 7, 5, 1 } };
+
+    if ( !Mesh.Create( 8, 24, 6 ) ) return false;
+    for ( ULONG i = 0; i < 8; i++ )
+        Mesh.m_pVertex[i] = CVertex( (i & 1) ? 2.0f : -2.0f, (i & 2) ? 2.0f : -2.0f, (i & 4) ? 2.0f : -2.0f );
+    for ( ULONG f = 0; f < 6; f++ )
+    {
+        Mesh.m_pPolygonStart[f] = f * 4;
+        for ( ULONG v = 0; v < 4; v++ ) Mesh.m_pIndex[ f * 4 + v ] = Faces[f][v];
+
+    } // Next Face
+
+    Mesh.CalculateBounds();
+    return Mesh.CalculatePlanes();
+}
+
+//-----------------------------------------------------------------------------
+// Name : CountMismatches () (Local)
+// Desc : Returns the number of pixels which differ between the two buffers.
+//-----------------------------------------------------------------------------
+static ULONG CountMismatches( const CFrameBuffer & a, const CFrameBuffer & b )
+{
+    ULONG Count = 0;
+
+    for ( ULONG y = 0; y < a.GetHeight(); y++ )
+    {
+        const ULONG * pA = a.GetBits() + y * a.GetPitch();
+        const ULONG * pB = b.GetBits() + y * b.GetPitch();
+        for ( ULONG x = 0; x < a.GetWidth(); x++ ) if ( pA[x] != pB[x] ) Count++;
+
+    } // Next Row
+
+    return Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RenderFrame () (Local)
+// Desc : Draws the wall, then every cube (solid, back faces culled), with or
+//        without testing each cube against the wall first. Returns the
+//        number of cubes found to be occluded.
+//-----------------------------------------------------------------------------
+static ULONG RenderFrame( CFrameBuffer & FrameBuffer, COcclusionBuffer * pOcclusion, CTransformStage & Stage,
+                          const CIndexedMesh & Wall, const CIndexedMesh & Cube, const D3DXMATRIX * pWorld,
+                          ULONG ObjectCount, CScreenVertex * pScreen )
+{
+    static const ULONG Colors[6] = { 0x00C04040, 0x0040C040, 0x004040C0, 0x00C0C040, 0x00C040C0, 0x0040C0C0 };
+    CRasterizer        Rasterizer;
+    D3DXMATRIX         mtxIdentity;
+    ULONG              Occluded = 0;
+
+    FrameBuffer.Clear( 0x00FFFFFF );
+    FrameBuffer.ClearDepth( 1.0f );
+    Rasterizer.SetRenderTarget( &FrameBuffer );
+
+    // The wall is drawn first, and is the only occluder
+    if ( Wall.m_nPolygonCount )
+    {
+        D3DXMatrixIdentity( &mtxIdentity );
+        Stage.SetWorld( mtxIdentity );
+        Stage.Transform( Wall.m_pVertex, pScreen, Wall.m_nVertexCount );
+        Rasterizer.SetColor( 0x00808080 );
+        Rasterizer.DrawTriangle( pScreen[0], pScreen[1], pScreen[2] );
+        Rasterizer.DrawTriangle( pScreen[0], pScreen[2], pScreen[3] );
+
+        if ( pOcclusion )
+        {
+            pOcclusion->Clear();
+            pOcclusion->DrawPolygon( pScreen, Wall.GetPolygonIndices( 0 ), 4 );
+            pOcclusion->BuildPyramid();
+
+        } // End if occlusion
+
+    } // End if wall
+
+    for ( ULONG i = 0; i < ObjectCount; i++ )
+    {
+        SCREENRECT Rect;
+
+        // Frustum, then occlusion
+        Stage.SetWorld( pWorld[i] );
+        if ( Stage.TestBounds( Cube.m_Bounds ) == CULL_OUTSIDE ) continue;
+        if ( pOcclusion && Wall.m_nPolygonCount && Stage.ProjectBounds( Cube.m_Bounds, Rect ) && pOcclusion->IsOccluded( Rect ) )
+        {
+            Occluded++;
+            continue;
+
+        } // End if occluded
+
+        // Transform and draw the front faces (the camera is at the origin)
+        Stage.Transform( Cube.m_pVertex, pScreen, Cube.m_nVertexCount );
+        D3DXVECTOR3 vecEye( -pWorld[i]._41, -pWorld[i]._42, -pWorld[i]._43 );
+        for ( ULONG f = 0; f < Cube.m_nPolygonCount; f++ )
+        {
+            const D3DXPLANE & Plane  = Cube.m_pPolygonPlane[f];
+            const ULONG     * pIndex = Cube.GetPolygonIndices( f );
+            if ( Plane.a * vecEye.x + Plane.b * vecEye.y + Plane.c * vecEye.z + Plane.d < 0.0f ) continue;
+
+            Rasterizer.SetColor( Colors[f] );
+            Rasterizer.DrawTriangle( pScreen[ pIndex[0] ], pScreen[ pIndex[1] ], pScreen[ pIndex[2] ] );
+            Rasterizer.DrawTriangle( pScreen[ pIndex[0] ], pScreen[ pIndex[2] ], pScreen[ pIndex[3] ] );
+
+        } // Next Face
+
+    } // Next Object
+
+    return Occluded;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchOcclusionRatio () (Local)
+// Desc : Scatters cubes evenly across the view behind a wall covering the
+//        given fraction of the screen, then reports the time per frame with
+//        and without occlusion culling, how many cubes were culled, and any
+//        pixels which differ between the two.
+//-----------------------------------------------------------------------------
+static void BenchOcclusionRatio( float Ratio, ULONG ObjectCount, ULONG Frames )
+{
+    CMemoryFrameBuffer  Reference, FrameBuffer;
+    COcclusionBuffer    Occlusion;
+    CTransformStage     Stage;
+    CIndexedMesh        Cube, Wall;
+    D3DXMATRIX        * pWorld = NULL;
+    D3DXMATRIX          mtxView, mtxProjection;
+    CScreenVertex       Screen[8];
+    ULONG               Seed = 0x0CC1, Occluded = 0;
+    double              Start, Off, On;
+    char                szName[64];
+
+    // Half extents of the view at unit distance
+    const float fHalfY = tanf( D3DXToRadian( 30.0f ) );
+    const float fHalfX = fHalfY * (float)BENCH_WIDTH / (float)BENCH_HEIGHT;
+
+    if ( !Reference.Create( BENCH_WIDTH, BENCH_HEIGHT ) || !Reference.CreateDepthBuffer() ) return;
+    if ( !FrameBuffer.Create( BENCH_WIDTH, BENCH_HEIGHT ) || !FrameBuffer.CreateDepthBuffer() ) return;
+    if ( !Occlusion.Create( BENCH_WIDTH, BENCH_HEIGHT ) || !BuildCube( Cube ) ) return;
+
+    // Wall from the left edge of the screen across the requested fraction
+    if ( Ratio > 0.0f )
+    {
+        float fLeft  = -fHalfX * WALL_DEPTH * 1.5f, fRight = fHalfX * WALL_DEPTH * (2.0f * Ratio - 1.0f);
+        float fExtent = fHalfY * WALL_DEPTH * 1.5f;
+        if ( !Wall.Create( 4, 4, 1 ) ) return;
+        Wall.m_pVertex[0] = CVertex( fLeft,   fExtent, WALL_DEPTH );
+        Wall.m_pVertex[1] = CVertex( fRight,  fExtent, WALL_DEPTH );
+        Wall.m_pVertex[2] = CVertex( fRight, -fExtent, WALL_DEPTH );
+        Wall.m_pVertex[3] = CVertex( fLeft,  -fExtent, WALL_DEPTH );
+        for ( ULONG i = 0; i < 4; i++ ) Wall.m_pIndex[i] = i;
+
+    } // End if wall
+
+    // Cubes spread evenly over the view, well behind the wall
+    if (!( pWorld = new D3DXMATRIX[ ObjectCount ] )) return;
+    for ( ULONG i = 0; i < ObjectCount; i++ )
+    {
+        float z = 40.0f + (float)(BenchRandom( Seed ) % 4000) / 100.0f;
+        float x = ((float)(BenchRandom( Seed ) % 2001) / 1000.0f - 1.0f) * fHalfX * z;
+        float y = ((float)(BenchRandom( Seed ) % 2001) / 1000.0f - 1.0f) * fHalfY * z;
+        D3DXMatrixTranslation( &pWorld[i], x, y, z );
+
+    } // Next Object
+
+    D3DXMatrixIdentity( &mtxView );
+    D3DXMatrixPerspectiveFovLH( &mtxProjection, D3DXToRadian( 60.0f ), (float)BENCH_WIDTH / (float)BENCH_HEIGHT, 1.01f, 1000.0f );
+    Stage.SetViewport( 0, 0, BENCH_WIDTH, BENCH_HEIGHT );
+    Stage.SetViewProjection( mtxView, mtxProjection );
+
+    // Without, then with occlusion culling (after a warm up frame)
+    RenderFrame( Reference, NULL, Stage, Wall, Cube, pWorld, ObjectCount, Screen );
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ ) RenderFrame( Reference, NULL, Stage, Wall, Cube, pWorld, ObjectCount, Screen );
+    Off = (BenchTime() - Start) / Frames;
+
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ ) Occluded = RenderFrame( FrameBuffer, &Occlusion, Stage, Wall, Cube, pWorld, ObjectCount, Screen );
+    On = (BenchTime() - Start) / Frames;
+
+    // Report
+    sprintf( szName, "%u%% hidden, no occlusion", (unsigned int)(Ratio * 100.0f + 0.5f) );
+    BenchReport( "occlusion", szName, Off * 1000.0, "ms/frame" );
+    sprintf( szName, "%u%% hidden, occlusion", (unsigned int)(Ratio * 100.0f + 0.5f) );
+    BenchReport( "occlusion", szName, On * 1000.0, "ms/frame" );
+    sprintf( szName, "%u%% hidden, occluded", (unsigned int)(Ratio * 100.0f + 0.5f) );
+    BenchReport( "occlusion", szName, 100.0 * Occluded / ObjectCount, "% of objects" );
+    sprintf( szName, "%u%% hidden, mismatches", (unsigned int)(Ratio * 100.0f + 0.5f) );
+    BenchReport( "occlusion", szName, (double)CountMismatches( FrameBuffer, Reference ), "pixels" );
+
+    delete []pWorld;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchOcclusion ()
+// Desc : Occlusion culling benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchOcclusion( bool bQuick )
+{
+    static const float Ratios[5] = { 0.0f, 0.25f, 0.5f, 0.75f, 0.95f };
+
+    for ( ULONG i = 0; i < 5; i++ )
+        BenchOcclusionRatio( Ratios[i], bQuick ? 2000 : 20000, bQuick ? 3 : 20 );
+}
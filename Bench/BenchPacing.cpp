@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+// File: BenchPacing.cpp
+//
+// Desc: Measures how closely, and at what processor cost, each of the timer's
+//       pacing modes holds a locked frame rate with a fixed amount of work
+//       done each frame, and the cost of the timer's own bookkeeping.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchPacing Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CTimer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const float  LOCK_FPS   = 120.0f;        // Frame rate each mode is locked to
+static const double FRAME_WORK = 0.002;         // Work done each frame (seconds)
+static const ULONG  TICK_COUNT = 1000000;       // Uncapped ticks timed for their cost
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : DoWork () (Local)
+// Desc : Keeps the processor busy for the given time, standing in for a
+//        frame's simulation and rendering.
+//-----------------------------------------------------------------------------
+static void DoWork( double fSeconds )
+{
+    double fEnd = BenchTime() + fSeconds;
+    while ( BenchTime() < fEnd ) { }
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchMode () (Local)
+// Desc : Runs a number of locked frames in the given pacing mode, reporting
+//        processor use, pacing error and wake up jitter.
+//-----------------------------------------------------------------------------
+static void BenchMode( TIMERPACING Pacing, const char * pszName, ULONG Frames )
+{
+    CTimer  Timer;
+    double  Start, CPUStart, Elapsed, CPUTime;
+    char    szName[64];
+
+    Timer.SetPacing( Pacing );
+    Timer.Tick( LOCK_FPS );
+    Timer.ResetStats();
+
+    Start    = BenchTime();
+    CPUStart = BenchCPUTime();
+    for ( ULONG f = 0; f < Frames; f++ )
+    {
+        DoWork( FRAME_WORK );
+        Timer.Tick( LOCK_FPS );
+
+    } // Next Frame
+    Elapsed = BenchTime() - Start;
+    CPUTime = BenchCPUTime() - CPUStart;
+
+    const TIMERSTATS & Stats = Timer.GetStats();
+    TIMERFRAMESTATS    FrameTimes;
+    Timer.GetFrameStats( FrameTimes );
+    sprintf( szName, "%s frame time", pszName );
+    BenchReport( "pacing", szName, Elapsed * 1e3 / Frames, "ms" );
+    sprintf( szName, "%s frame time p99", pszName );
+    BenchReport( "pacing", szName, FrameTimes.P99 * 1e3, "ms" );
+    sprintf( szName, "%s frame time max", pszName );
+    BenchReport( "pacing", szName, FrameTimes.Max * 1e3, "ms" );
+    sprintf( szName, "%s cpu use", pszName );
+    BenchReport( "pacing", szName, CPUTime * 100.0 / Elapsed, "%" );
+    if ( Stats.Frames == 0 ) return;
+
+    sprintf( szName, "%s pacing error", pszName );
+    BenchReport( "pacing", szName, Stats.PacingError * 1e6 / Stats.Frames, "us" );
+    sprintf( szName, "%s pacing error max", pszName );
+    BenchReport( "pacing", szName, Stats.PacingErrorMax * 1e6, "us" );
+    sprintf( szName, "%s spin", pszName );
+    BenchReport( "pacing", szName, Stats.SpinTime * 1e6 / Stats.Frames, "us/frame" );
+    if ( Stats.Sleeps == 0 ) return;
+
+    sprintf( szName, "%s wake jitter", pszName );
+    BenchReport( "pacing", szName, Stats.WakeError * 1e6 / Stats.Sleeps, "us" );
+    sprintf( szName, "%s wake jitter max", pszName );
+    BenchReport( "pacing", szName, Stats.WakeErrorMax * 1e6, "us" );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchTick () (Local)
+// Desc : Reports the cost of an uncapped tick, counter read, averaging and
+//        statistics included, and of reading the rolling window.
+//-----------------------------------------------------------------------------
+static void BenchTick( ULONG Count )
+{
+    CTimer          Timer;
+    TIMERFRAMESTATS FrameTimes;
+    double          Start;
+
+    Start = BenchTime();
+    for ( ULONG i = 0; i < Count; i++ ) Timer.Tick();
+    BenchReport( "pacing", "tick", (BenchTime() - Start) * 1e9 / Count, "ns" );
+
+    Start = BenchTime();
+    for ( ULONG i = 0; i < 1000; i++ ) Timer.GetFrameStats( FrameTimes, true );
+    BenchReport( "pacing", "window stats", (BenchTime() - Start) * 1e9 / 1000, "ns" );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchPacing ()
+// Desc : Runs the frame pacing suite.
+//-----------------------------------------------------------------------------
+void BenchPacing( bool bQuick )
+{
+    const ULONG Frames = bQuick ? 60 : 600;
+
+    BenchTick( bQuick ? TICK_COUNT / 10 : TICK_COUNT );
+
+    BenchMode( PACING_UNCAPPED, "uncapped", Frames );
+    BenchMode( PACING_SPIN,     "spin",     Frames );
+    BenchMode( PACING_LOCK,     "lock",     Frames );
+    BenchMode( PACING_ADAPTIVE, "adaptive", Frames );
+}
@@ -0,0 +1,75 @@
+//-----------------------------------------------------------------------------
+// File: BenchProfiler.cpp
+//
+// Desc: Measures the cost of a profiling zone while recording is disabled
+//       and enabled, and of writing out the resulting trace.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchProfiler Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CProfiler.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const char * BENCH_FILE_NAME = "GameBench.json"; // Scratch file, removed afterwards
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static volatile ULONG g_nSink = 0;          // Touched inside each zone
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : TimeZones () (Local)
+// Desc : Returns the time taken per zone opened and closed, nested two deep
+//        as the engine's are.
+//-----------------------------------------------------------------------------
+static double TimeZones( ULONG Count )
+{
+    double Start = BenchTime();
+
+    for ( ULONG i = 0; i < Count; i += 2 )
+    {
+        PROFILE_ZONE( "Outer" );
+        {
+            PROFILE_ZONE( "Inner" );
+            g_nSink = g_nSink + 1;
+
+        } // End Inner zone
+
+    } // Next Pair
+    return (BenchTime() - Start) / Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchProfiler ()
+// Desc : Runs the profiler suite.
+//-----------------------------------------------------------------------------
+void BenchProfiler( bool bQuick )
+{
+    const ULONG Count = bQuick ? 100000 : 1000000;
+    double      Start;
+
+    CProfiler::Enable( false );
+    BenchReport( "profiler", "zone disabled", TimeZones( Count ) * 1e9, "ns" );
+
+    // Stay within the ring, so that no zone is overwritten
+    CProfiler::Reset();
+    CProfiler::Enable( true );
+    BenchReport( "profiler", "zone enabled", TimeZones( PROFILER_EVENT_LIMIT ) * 1e9, "ns" );
+    CProfiler::Enable( false );
+    BenchReport( "profiler", "zones dropped", (double)CProfiler::GetDroppedCount(), "zones" );
+
+    Start = BenchTime();
+    if ( CProfiler::WriteTrace( BENCH_FILE_NAME ) )
+        BenchReport( "profiler", "write trace", (BenchTime() - Start) * 1e9 / CProfiler::GetEventCount(), "ns/zone" );
+    remove( BENCH_FILE_NAME );
+    CProfiler::Reset();
+}
@@ -0,0 +1,69 @@
+//-----------------------------------------------------------------------------
+// File: BenchRasterizer.cpp
+//
+// Desc: Measures line rasterization throughput into a headless frame buffer.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchRasterizer Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CRasterizer.h"
+
+//-----------------------------------------------------------------------------
+// Name : BenchLines () (Local)
+// Desc : Draws a fixed set of random lines, whose end points lie within the
+//        specified distance of the buffer, and reports the throughput.
+//-----------------------------------------------------------------------------
+static void BenchLines( const char * Name, ULONG Width, ULONG Height, long Overscan, ULONG LineCount )
+{
+    CMemoryFrameBuffer  FrameBuffer;
+    CRasterizer         Rasterizer;
+    float             * pCoords = NULL;
+    ULONG               Seed = 0x1234567;
+    double              Start, Elapsed;
+    char                szName[64];
+
+    // Generate the line end points up front
+    if ( !FrameBuffer.Create( Width, Height ) ) return;
+    if (!( pCoords = new float[ LineCount * 4 ] )) return;
+    for ( ULONG i = 0; i < LineCount * 4; i += 2 )
+    {
+        pCoords[i]     = (float)((long)(BenchRandom( Seed ) % (Width  + 2 * Overscan)) - Overscan);
+        pCoords[i + 1] = (float)((long)(BenchRandom( Seed ) % (Height + 2 * Overscan)) - Overscan);
+
+    } // Next Coordinate
+
+    Rasterizer.SetRenderTarget( &FrameBuffer );
+    Rasterizer.SetColor( 0 );
+
+    // Draw them all
+    Start = BenchTime();
+    for ( ULONG i = 0; i < LineCount; i++ )
+    {
+        const float * p = &pCoords[ i * 4 ];
+        Rasterizer.DrawLine( p[0], p[1], p[2], p[3] );
+
+    } // Next Line
+    Elapsed = BenchTime() - Start;
+
+    sprintf( szName, "%s %ux%u", Name, (unsigned int)Width, (unsigned int)Height );
+    BenchReport( "rasterizer", szName, LineCount / Elapsed, "lines/s" );
+
+    delete []pCoords;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchRasterizer ()
+// Desc : Rasterizer benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchRasterizer( bool bQuick )
+{
+    ULONG LineCount = bQuick ? 100000 : 2000000;
+
+    BenchLines( "lines in view",     800,  600,    0, LineCount );
+    BenchLines( "lines clipped",     800,  600, 1600, LineCount );
+    BenchLines( "lines in view",    3840, 2160,    0, LineCount / 4 );
+}
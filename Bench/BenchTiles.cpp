@@ -0,0 +1,174 @@
+//-----------------------------------------------------------------------------
+// File: BenchTiles.cpp
+//
+// Desc: Measures how the tile binned renderer scales with thread count, and
+//       checks that its output matches serial rasterization exactly.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchTiles Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CTileRenderer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : BuildScene () (Local)
+// Desc : Generates the screen space edges of many small wireframe boxes, as
+//        seen when drawing a large number of instances, plus a handful of
+//        long lines which cross many tiles.
+//-----------------------------------------------------------------------------
+static float * BuildScene( ULONG Width, ULONG Height, ULONG Instances, ULONG & LineCount )
+{
+    float * pCoords = NULL, * p;
+    ULONG   Seed = 0x7117E5;
+
+    LineCount = Instances * 12 + 64;
+    if (!( pCoords = new float[ LineCount * 4 ] )) return NULL;
+    p = pCoords;
+
+    for ( ULONG i = 0; i < Instances; i++ )
+    {
+        // Front and back faces of a box, offset to give a perspective look
+        float cx = (float)(BenchRandom( Seed ) % (Width + 64)) - 32.0f;
+        float cy = (float)(BenchRandom( Seed ) % (Height + 64)) - 32.0f;
+        float s  = 4.0f + (float)(BenchRandom( Seed ) % 36);
+        float ox = s * 0.3f, oy = s * 0.2f;
+        float x[8] = { cx - s, cx + s, cx + s, cx - s, cx - s + ox, cx + s + ox, cx + s + ox, cx - s + ox };
+        float y[8] = { cy - s, cy - s, cy + s, cy + s, cy - s - oy, cy - s - oy, cy + s - oy, cy + s - oy };
+        static const int Edges[12][2] = { {0,1},{1,2},{2,3},{3,0},{4,5},{5,6},{6,7},{7,4},{0,4},{1,5},{2,6},{3,7} };
+
+        for ( int e = 0; e < 12; e++ )
+        {
+            *p++ = x[ Edges[e][0] ]; *p++ = y[ Edges[e][0] ];
+            *p++ = x[ Edges[e][1] ]; *p++ = y[ Edges[e][1] ];
+
+        } // Next Edge
+
+    } // Next Instance
+
+    // Long lines, some of which leave the screen
+    for ( ULONG i = 0; i < 64; i++ )
+    {
+        *p++ = (float)((long)(BenchRandom( Seed ) % (Width  * 2)) - (long)Width  / 2);
+        *p++ = (float)((long)(BenchRandom( Seed ) % (Height * 2)) - (long)Height / 2);
+        *p++ = (float)((long)(BenchRandom( Seed ) % (Width  * 2)) - (long)Width  / 2);
+        *p++ = (float)((long)(BenchRandom( Seed ) % (Height * 2)) - (long)Height / 2);
+
+    } // Next Line
+
+    return pCoords;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CountMismatches () (Local)
+// Desc : Returns the number of pixels which differ between the two buffers.
+//-----------------------------------------------------------------------------
+static ULONG CountMismatches( const CFrameBuffer & a, const CFrameBuffer & b )
+{
+    ULONG Count = 0;
+
+    for ( ULONG y = 0; y < a.GetHeight(); y++ )
+    {
+        const ULONG * pA = a.GetBits() + y * a.GetPitch();
+        const ULONG * pB = b.GetBits() + y * b.GetPitch();
+        for ( ULONG x = 0; x < a.GetWidth(); x++ ) if ( pA[x] != pB[x] ) Count++;
+
+    } // Next Row
+
+    return Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchTileScaling () (Local)
+// Desc : Renders the scene serially for reference, then through the tile
+//        renderer with 1, 2, 4 ... N threads, reporting the time per frame,
+//        the speed up over a single thread, and any pixel differences.
+//-----------------------------------------------------------------------------
+static void BenchTileScaling( ULONG Width, ULONG Height, ULONG Instances, ULONG Frames )
+{
+    CMemoryFrameBuffer  Reference, FrameBuffer;
+    CRasterizer         Rasterizer;
+    float             * pCoords = NULL;
+    ULONG               LineCount, MaxThreads = BenchMaxThreads();
+    double              Start, Elapsed, Single = 0.0;
+    char                szName[64];
+
+    // Build the scene
+    if ( !Reference.Create( Width, Height ) || !FrameBuffer.Create( Width, Height ) ) return;
+    if (!( pCoords = BuildScene( Width, Height, Instances, LineCount ) )) return;
+
+    // Serial reference
+    Reference.Clear( 0x00FFFFFF );
+    Rasterizer.SetRenderTarget( &Reference );
+    Start = BenchTime();
+    for ( ULONG f = 0; f < Frames; f++ )
+    {
+        for ( ULONG i = 0; i < LineCount; i++ )
+        {
+            const float * p = &pCoords[ i * 4 ];
+            Rasterizer.SetColor( (i * 0x9E3779B1) & 0x00FFFFFF );
+            Rasterizer.DrawLine( p[0], p[1], p[2], p[3] );
+
+        } // Next Line
+
+    } // Next Frame
+    Elapsed = BenchTime() - Start;
+    sprintf( szName, "serial %ux%u (%u lines)", (unsigned int)Width, (unsigned int)Height, (unsigned int)LineCount );
+    BenchReport( "tiles", szName, Elapsed * 1000.0 / Frames, "ms/frame" );
+
+    // Tiled, at increasing thread counts (always finishing with all of them)
+    for ( ULONG Threads = 1; ; Threads = (Threads * 2 < MaxThreads) ? Threads * 2 : MaxThreads )
+    {
+        CJobSystem    Jobs;
+        CTileRenderer Renderer;
+
+        if ( !Jobs.Create( Threads ) ) break;
+        Renderer.SetRenderTarget( &FrameBuffer );
+        Renderer.SetJobSystem( &Jobs );
+
+        // Warm up (sizes the bins), then time complete frames
+        for ( ULONG f = 0; f <= Frames; f++ )
+        {
+            if ( f == 1 ) Start = BenchTime();
+            FrameBuffer.Clear( 0x00FFFFFF );
+            Renderer.BeginFrame();
+            for ( ULONG i = 0; i < LineCount; i++ )
+            {
+                const float * p = &pCoords[ i * 4 ];
+                Renderer.AddLine( p[0], p[1], p[2], p[3], (i * 0x9E3779B1) & 0x00FFFFFF );
+
+            } // Next Line
+            Renderer.EndFrame();
+
+        } // Next Frame
+        Elapsed = (BenchTime() - Start) / Frames;
+        if ( Threads == 1 ) Single = Elapsed;
+
+        // Report
+        sprintf( szName, "tiled %u threads", (unsigned int)Threads );
+        BenchReport( "tiles", szName, Elapsed * 1000.0, "ms/frame" );
+        sprintf( szName, "tiled %u threads speedup", (unsigned int)Threads );
+        BenchReport( "tiles", szName, Single / Elapsed, "x" );
+        sprintf( szName, "tiled %u threads mismatches", (unsigned int)Threads );
+        BenchReport( "tiles", szName, (double)CountMismatches( FrameBuffer, Reference ), "pixels" );
+
+        if ( Threads == MaxThreads ) break;
+
+    } // Next Thread Count
+
+    delete []pCoords;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchTiles ()
+// Desc : Tile renderer benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchTiles( bool bQuick )
+{
+    BenchTileScaling( 1920, 1080, bQuick ? 5000 : 40000, bQuick ? 2 : 10 );
+}
@@ -0,0 +1,290 @@
+//-----------------------------------------------------------------------------
+// File: BenchTransform.cpp
+//
+// Desc: Measures the cost per vertex of the original three stage D3DX
+//       transform against the concatenated CTransformStage path, the
+//       throughput of each of the batch transform kernels, and the saving
+//       made by frustum culling whole objects.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// BenchTransform Specific Includes
+//-----------------------------------------------------------------------------
+#include "Bench.h"
+#include "../Includes/CTransformStage.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static volatile float g_fSink = 0.0f;     // Prevents results being optimised away
+
+//-----------------------------------------------------------------------------
+// Name : BenchTransformMesh () (Local)
+// Desc : Transforms a random vertex cloud of the size specified via both
+//        paths, over a number of passes, reporting ns per vertex.
+//-----------------------------------------------------------------------------
+static void BenchTransformMesh( ULONG VertexCount, ULONG Passes )
+{
+    const ULONG     ViewX = 0, ViewY = 0, ViewWidth = 800, ViewHeight = 600;
+    CTransformStage Stage;
+    CVertex       * pVertices = NULL;
+    CScreenVertex * pOut = NULL;
+    D3DXMATRIX      mtxWorld, mtxView, mtxProjection;
+    ULONG           Seed = 0xC0FFEE;
+    double          Start, Legacy, Combined;
+    float           fSum = 0.0f;
+    char            szName[64];
+
+    // Allocate and fill the mesh
+    pVertices = new CVertex[ VertexCount ];
+    pOut      = new CScreenVertex[ VertexCount ];
+    if ( !pVertices || !pOut ) { delete []pVertices; delete []pOut; return; }
+    memset( pOut, 0, VertexCount * sizeof(CScreenVertex) );
+    for ( ULONG i = 0; i < VertexCount; i++ )
+    {
+        pVertices[i] = CVertex( (BenchRandom( Seed ) % 2000) / 500.0f - 2.0f,
+                                (BenchRandom( Seed ) % 2000) / 500.0f - 2.0f,
+                                (BenchRandom( Seed ) % 2000) / 500.0f - 2.0f );
+
+    } // Next Vertex
+
+    // Same matrices as the demo scene
+    D3DXMatrixTranslation( &mtxWorld, -3.5f, 2.0f, 14.0f );
+    D3DXMatrixIdentity( &mtxView );
+    D3DXMatrixPerspectiveFovLH( &mtxProjection, D3DXToRadian( 60.0f ), (float)ViewWidth / (float)ViewHeight, 1.01f, 1000.0f );
+
+    // Original path: three transforms, each with its own divide
+    Start = BenchTime();
+    for ( ULONG p = 0; p < Passes; p++ )
+    {
+        for ( ULONG i = 0; i < VertexCount; i++ )
+        {
+            D3DXVECTOR3 vtx( pVertices[i].x, pVertices[i].y, pVertices[i].z );
+            D3DXVec3TransformCoord( &vtx, &vtx, &mtxWorld );
+            D3DXVec3TransformCoord( &vtx, &vtx, &mtxView );
+            D3DXVec3TransformCoord( &vtx, &vtx, &mtxProjection );
+            vtx.x =   vtx.x * ViewWidth  / 2 + ViewX + ViewWidth  / 2;
+            vtx.y =  -vtx.y * ViewHeight / 2 + ViewY + ViewHeight / 2;
+            fSum += vtx.x + vtx.y;
+
+        } // Next Vertex
+
+    } // Next Pass
+    Legacy = BenchTime() - Start;
+
+    // Concatenated path (matrix set up cost included, as it is per object)
+    Start = BenchTime();
+    for ( ULONG p = 0; p < Passes; p++ )
+    {
+        Stage.SetViewport( ViewX, ViewY, ViewWidth, ViewHeight );
+        Stage.SetViewProjection( mtxView, mtxProjection );
+        Stage.SetWorld( mtxWorld );
+        Stage.Transform( pVertices, pOut, VertexCount );
+        fSum += pOut[ p % VertexCount ].x;
+
+    } // Next Pass
+    Combined = BenchTime() - Start;
+    g_fSink = fSum;
+
+    // Report
+    sprintf( szName, "d3dx x3 (%u verts)", (unsigned int)VertexCount );
+    BenchReport( "transform", szName, Legacy * 1e9 / ((double)VertexCount * Passes), "ns/vertex" );
+    sprintf( szName, "concatenated (%u verts)", (unsigned int)VertexCount );
+    BenchReport( "transform", szName, Combined * 1e9 / ((double)VertexCount * Passes), "ns/vertex" );
+
+    delete []pVertices;
+    delete []pOut;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchTransformKernels () (Local)
+// Desc : Runs every kernel supported on this machine over the same vertex
+//        cloud, reporting vertices per second, and verifies that each one
+//        produces exactly the same output as the scalar kernel.
+//-----------------------------------------------------------------------------
+static void BenchTransformKernels( ULONG VertexCount, ULONG Passes )
+{
+    CTransformStage Stage;
+    CVertex       * pVertices = NULL;
+    CScreenVertex * pReference = NULL, * pOut = NULL;
+    D3DXMATRIX      mtxWorld, mtxView, mtxProjection;
+    ULONG           Seed = 0xBEEF, Mismatch;
+    double          Start, Elapsed;
+    float           fSum = 0.0f;
+    char            szName[64];
+
+    // Allocate and fill the mesh (odd count exercises the remainder path)
+    pVertices  = new CVertex[ VertexCount ];
+    pReference = new CScreenVertex[ VertexCount ];
+    pOut       = new CScreenVertex[ VertexCount ];
+    if ( !pVertices || !pReference || !pOut ) { delete []pVertices; delete []pReference; delete []pOut; return; }
+    for ( ULONG i = 0; i < VertexCount; i++ )
+    {
+        pVertices[i] = CVertex( (BenchRandom( Seed ) % 20000) / 1000.0f - 10.0f,
+                                (BenchRandom( Seed ) % 20000) / 1000.0f - 10.0f,
+                                (BenchRandom( Seed ) % 20000) / 1000.0f - 10.0f );
+
+    } // Next Vertex
+
+    // Scene matrices, rotated so that no matrix element is trivially zero
+    D3DXMatrixRotationY( &mtxWorld, 0.7f );
+    D3DXMatrixMultiply( &mtxWorld, &mtxWorld, D3DXMatrixRotationX( &mtxView, 0.3f ) );
+    mtxWorld._43 = 14.0f;
+    D3DXMatrixIdentity( &mtxView );
+    D3DXMatrixPerspectiveFovLH( &mtxProjection, D3DXToRadian( 60.0f ), 800.0f / 600.0f, 1.01f, 1000.0f );
+    Stage.SetViewport( 0, 0, 800, 600 );
+    Stage.SetViewProjection( mtxView, mtxProjection );
+    Stage.SetWorld( mtxWorld );
+
+    // Reference results
+    Stage.SetKernel( TRANSFORM_SCALAR );
+    Stage.Transform( pVertices, pReference, VertexCount );
+
+    for ( int k = 0; k < TRANSFORM_KERNEL_COUNT; k++ )
+    {
+        if ( !Stage.SetKernel( (TRANSFORMKERNEL)k ) ) continue;
+
+        // Warm up, then compare bit for bit against the reference
+        memset( pOut, 0, VertexCount * sizeof(CScreenVertex) );
+        Stage.Transform( pVertices, pOut, VertexCount );
+        Mismatch = 0;
+        for ( ULONG i = 0; i < VertexCount; i++ )
+        {
+            if ( memcmp( &pOut[i], &pReference[i], sizeof(CScreenVertex) ) != 0 ) Mismatch++;
+
+        } // Next Vertex
+
+        // Time it
+        Start = BenchTime();
+        for ( ULONG p = 0; p < Passes; p++ )
+        {
+            Stage.Transform( pVertices, pOut, VertexCount );
+            fSum += pOut[ p % VertexCount ].x;
+
+        } // Next Pass
+        Elapsed = BenchTime() - Start;
+
+        // Report
+        sprintf( szName, "%s (%u verts)", CTransformStage::GetKernelName( (TRANSFORMKERNEL)k ), (unsigned int)VertexCount );
+        BenchReport( "transform", szName, ((double)VertexCount * Passes) / Elapsed / 1e6, "Mverts/s" );
+        sprintf( szName, "%s mismatches (%u verts)", CTransformStage::GetKernelName( (TRANSFORMKERNEL)k ), (unsigned int)VertexCount );
+        BenchReport( "transform", szName, (double)Mismatch, "verts" );
+
+    } // Next Kernel
+    g_fSink = fSum;
+
+    delete []pVertices;
+    delete []pReference;
+    delete []pOut;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchCulling () (Local)
+// Desc : Scatters cube objects all around the camera, so that most are off
+//        screen, then compares transforming every object against testing
+//        each object's bounds first and transforming only the visible ones.
+//-----------------------------------------------------------------------------
+static void BenchCulling( ULONG ObjectCount, ULONG Passes )
+{
+    CTransformStage Stage;
+    CIndexedMesh    Mesh;
+    D3DXMATRIX    * pWorld = NULL;
+    CScreenVertex * pOut = NULL;
+    D3DXMATRIX      mtxView, mtxProjection;
+    ULONG           Seed = 0xB0B5, Culled = 0, Clipped = 0;
+    double          Start, All, Tested;
+    char            szName[64];
+
+    // A 1000 vertex sphere-ish cloud per object
+    if ( !Mesh.Create( 1000, 0, 0 ) ) return;
+    for ( ULONG i = 0; i < Mesh.m_nVertexCount; i++ )
+    {
+        Mesh.m_pVertex[i] = CVertex( (BenchRandom( Seed ) % 2000) / 500.0f - 2.0f,
+                                     (BenchRandom( Seed ) % 2000) / 500.0f - 2.0f,
+                                     (BenchRandom( Seed ) % 2000) / 500.0f - 2.0f );
+
+    } // Next Vertex
+    Mesh.CalculateBounds();
+
+    // Objects placed anywhere within 200 units of the camera
+    pWorld = new D3DXMATRIX[ ObjectCount ];
+    pOut   = new CScreenVertex[ Mesh.m_nVertexCount ];
+    if ( !pWorld || !pOut ) { delete []pWorld; delete []pOut; return; }
+    for ( ULONG i = 0; i < ObjectCount; i++ )
+    {
+        D3DXMatrixTranslation( &pWorld[i], (float)(BenchRandom( Seed ) % 400) - 200.0f,
+                                           (float)(BenchRandom( Seed ) % 400) - 200.0f,
+                                           (float)(BenchRandom( Seed ) % 400) - 200.0f );
+
+    } // Next Object
+
+    D3DXMatrixIdentity( &mtxView );
+    D3DXMatrixPerspectiveFovLH( &mtxProjection, D3DXToRadian( 60.0f ), 800.0f / 600.0f, 1.01f, 1000.0f );
+    Stage.SetViewport( 0, 0, 800, 600 );
+    Stage.SetViewProjection( mtxView, mtxProjection );
+
+    // Transform everything
+    Start = BenchTime();
+    for ( ULONG p = 0; p < Passes; p++ )
+    {
+        for ( ULONG i = 0; i < ObjectCount; i++ )
+        {
+            Stage.SetWorld( pWorld[i] );
+            Stage.Transform( Mesh.m_pVertex, pOut, Mesh.m_nVertexCount );
+
+        } // Next Object
+
+    } // Next Pass
+    All = BenchTime() - Start;
+
+    // Test bounds first
+    Start = BenchTime();
+    for ( ULONG p = 0; p < Passes; p++ )
+    {
+        for ( ULONG i = 0; i < ObjectCount; i++ )
+        {
+            ULONG      Planes;
+            CULLRESULT Result;
+
+            Stage.SetWorld( pWorld[i] );
+            Result = Stage.TestBounds( Mesh.m_Bounds, &Planes );
+            if ( p == 0 && Result == CULL_OUTSIDE ) Culled++;
+            if ( p == 0 && (Planes & (FRUSTUM_NEAR | FRUSTUM_FAR)) ) Clipped++;
+            if ( Result != CULL_OUTSIDE ) Stage.Transform( Mesh.m_pVertex, pOut, Mesh.m_nVertexCount );
+
+        } // Next Object
+
+    } // Next Pass
+    Tested = BenchTime() - Start;
+    g_fSink = pOut[0].x;
+
+    // Report
+    sprintf( szName, "no culling (%u objects)", (unsigned int)ObjectCount );
+    BenchReport( "transform", szName, All * 1e9 / ((double)ObjectCount * Passes), "ns/object" );
+    sprintf( szName, "frustum culled (%u objects)", (unsigned int)ObjectCount );
+    BenchReport( "transform", szName, Tested * 1e9 / ((double)ObjectCount * Passes), "ns/object" );
+    sprintf( szName, "culled (%u objects)", (unsigned int)ObjectCount );
+    BenchReport( "transform", szName, 100.0 * Culled / ObjectCount, "% of objects" );
+    sprintf( szName, "near / far clipped (%u objects)", (unsigned int)ObjectCount );
+    BenchReport( "transform", szName, 100.0 * Clipped / ObjectCount, "% of objects" );
+
+    delete []pWorld;
+    delete []pOut;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BenchTransform ()
+// Desc : Transform benchmark suite entry point.
+//-----------------------------------------------------------------------------
+void BenchTransform( bool bQuick )
+{
+    BenchTransformMesh( 100000,  bQuick ? 2 : 50 );
+    BenchTransformMesh( 1000000, bQuick ? 1 : 10 );
+
+    BenchTransformKernels( 100003,  bQuick ? 5 : 200 );
+    BenchTransformKernels( 1000003, bQuick ? 1 : 20 );
+
+    BenchCulling( bQuick ? 1000 : 10000, bQuick ? 2 : 10 );
+}
@@ -0,0 +1,105 @@
+//-----------------------------------------------------------------------------
+// File: CBVH.h
+//
+// Desc: Bounding volume hierarchy over the world space bounds of scene
+//       objects, used for frustum, ray and box queries.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CBVH_H_
+#define _CBVH_H_
+
+//-----------------------------------------------------------------------------
+// CBVH Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CObject.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG BVH_LEAF_SIZE   = 4;            // Items a leaf holds before it is split
+const ULONG BVH_BIN_COUNT   = 16;           // Buckets used to estimate split costs
+const ULONG BVH_MAX_DEPTH   = 64;           // Deepest node (also the query stack size)
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CBVH (Class)
+// Desc : Binary tree of axis aligned boxes, one item (object) per entry of
+//        the bounds array given to Build. Nodes are split using the surface
+//        area heuristic, evaluated over a fixed number of bins, and each
+//        node's items are stored contiguously so that a node found to be
+//        entirely inside a query returns them all without going further.
+//        As objects move their bounds are changed in place, and the tree is
+//        refitted (either for one item, walking up from its leaf, or in one
+//        bottom up pass over every node) rather than rebuilt. Refitting
+//        never changes the tree's shape, so a tree whose objects have moved
+//        a long way should occasionally be rebuilt.
+//-----------------------------------------------------------------------------
+class CBVH
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CBVH();
+	virtual ~CBVH();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Build( const CBounds * pBounds, ULONG Count );
+    void        Release( );
+
+    void        SetBounds( ULONG Item, const CBounds & Bounds );
+    void        UpdateBounds( ULONG Item, const CBounds & Bounds );
+    void        Refit( );
+
+    ULONG       QueryFrustum( const D3DXPLANE * pPlanes, ULONG PlaneCount, ULONG * pResults, ULONG MaxResults ) const;
+    ULONG       QueryBounds( const CBounds & Bounds, ULONG * pResults, ULONG MaxResults ) const;
+    bool        RayCast( const D3DXVECTOR3 & vecOrigin, const D3DXVECTOR3 & vecDir, float fMaxT,
+                         ULONG & Item, float & fHitT ) const;
+
+    ULONG       GetItemCount( ) const { return m_nItemCount; }
+    ULONG       GetNodeCount( ) const { return m_nNodeCount; }
+    ULONG       GetDepth( ) const { return m_nDepth; }
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+    struct BVHNODE
+    {
+        D3DXVECTOR3 vecMin;                 // Bounds of every item beneath
+        D3DXVECTOR3 vecMax;
+        ULONG       Child;                  // First of two children (0 for a leaf)
+        ULONG       Parent;                 // Parent node (root is its own parent)
+        ULONG       First;                  // First entry of m_pItems beneath
+        ULONG       Count;                  // Entries of m_pItems beneath
+    };
+
+    //-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    void        FitNode( ULONG Node );
+    ULONG       Split( ULONG Node );
+    void        AddRange( const BVHNODE & Node, ULONG * pResults, ULONG MaxResults, ULONG & Found ) const;
+
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    BVHNODE    *m_pNodes;               // Node array, root first (2 * items - 1 at most)
+    ULONG       m_nNodeCount;           // Nodes in use
+    ULONG      *m_pItems;               // Item indices, grouped by leaf
+    ULONG      *m_pItemLeaf;            // Leaf holding each item
+    D3DXVECTOR3 *m_pItemMin;            // Bounds of each item
+    D3DXVECTOR3 *m_pItemMax;
+    ULONG       m_nItemCount;           // Number of items
+    ULONG       m_nDepth;               // Deepest node in the tree
+
+};
+
+#endif // _CBVH_H_
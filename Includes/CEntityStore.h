@@ -0,0 +1,189 @@
+//-----------------------------------------------------------------------------
+// File: CEntityStore.h
+//
+// Desc: Archetype based storage of scene entities, each component held in
+//       its own array within fixed size chunks.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CENTITYSTORE_H_
+#define _CENTITYSTORE_H_
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CObject.h"
+#include "CLODChain.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// SSE2 animation kernel is available wherever SSE2 is part of the baseline
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENTITY_SIMD_SSE2
+#endif
+
+const ULONG ENTITY_CHUNK_SIZE     = 256;        // Entities stored in each chunk
+const ULONG ENTITY_MAX_ARCHETYPES = 32;         // One for each combination of components
+const ULONG ENTITY_INVALID        = 0xFFFFFFFF; // No entity (or no chunk)
+const ULONG ENTITY_RENORMALISE_STEPS = 64;      // Animation steps between renormalising orientations
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+// Components an entity may have (its archetype is the combination of them)
+enum ENTITYCOMPONENT
+{
+    COMPONENT_WORLD     = 0x1,                  // World matrix
+    COMPONENT_SPIN      = 0x2,                  // Angular velocity
+    COMPONENT_MESH      = 0x4,                  // Mesh handle (see CEntityStore::AddMesh)
+    COMPONENT_FLAGS     = 0x8,                  // ENTITYFLAGS
+    COMPONENT_POSE      = 0x10,                 // Orientation, position and scale (ENTITYPOSE)
+    COMPONENT_ALL       = 0x1F
+};
+
+// Elements of the pose component, each stored in its own array
+enum ENTITYPOSE
+{
+    POSE_QX             = 0,                    // Orientation quaternion
+    POSE_QY             = 1,
+    POSE_QZ             = 2,
+    POSE_QW             = 3,
+    POSE_X              = 4,                    // Position
+    POSE_Y              = 5,
+    POSE_Z              = 6,
+    POSE_SCALE          = 7,                    // Uniform scale
+    POSE_COUNT          = 8
+};
+
+// Bits of the flags component
+enum ENTITYFLAGS
+{
+    ENTITY_SPINNING     = 0x1,                  // Angular velocity is applied each frame
+    ENTITY_BACKFACECULL = 0x2,                  // Skip polygons facing away (closed meshes only)
+    ENTITY_OCCLUDER     = 0x4                   // Drawn into the occlusion buffer to hide other entities
+};
+
+//-----------------------------------------------------------------------------
+// Name : ENTITYCHUNK (Struct)
+// Desc : A block of entities of one archetype. Each component the archetype
+//        has is an array of ENTITY_CHUNK_SIZE entries, the first Count of
+//        which are in use; the others are NULL.
+//-----------------------------------------------------------------------------
+struct ENTITYCHUNK
+{
+    ULONG       Archetype;                      // Components stored (ENTITYCOMPONENT)
+    ULONG       Count;                          // Entities in use
+    ULONG       Steps;                          // Times the chunk has been animated
+    ULONG      *pEntity;                        // Entity stored in each slot
+    D3DXMATRIX *pWorld;                         // COMPONENT_WORLD
+    D3DXVECTOR3 *pSpin;                         // COMPONENT_SPIN (radians / second, see CEntityStore)
+    ULONG      *pMesh;                          // COMPONENT_MESH
+    ULONG      *pFlags;                         // COMPONENT_FLAGS
+    float      *pPose[POSE_COUNT];              // COMPONENT_POSE (one array per ENTITYPOSE element)
+    BYTE       *pMemory;                        // Single allocation holding every array
+};
+
+//-----------------------------------------------------------------------------
+// Name : ENTITYMESH (Struct)
+// Desc : Mesh (and optional detail chain) an entity's mesh handle refers to.
+//-----------------------------------------------------------------------------
+struct ENTITYMESH
+{
+    CIndexedMesh *pMesh;
+    CLODChain   *pLOD;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CEntityStore (Class)
+// Desc : Stores any number of entities, each a combination of components.
+//        Entities with the same combination (archetype) share chunks, in
+//        which each component is a contiguous array, so that systems
+//        process whole chunks with straight loops over just the components
+//        they need, and chunks make convenient units of work for the job
+//        system. Chunks are kept packed: destroying an entity moves the
+//        last entity of its archetype into the hole. Entities are named by
+//        a handle which stays valid throughout, and which is looked up
+//        through a table (entities created one after another, with no
+//        destruction in between, are numbered and stored in order).
+//        Spinning entities with a pose turn about their spin vector, at its
+//        length in radians per second: the orientation quaternion is
+//        advanced (four entities at a time where SSE2 is available) and
+//        the world matrix composed from it directly, so that it never
+//        drifts from a rotation. Those without a pose have their world
+//        matrix rotated about y, x then z by the vector's components.
+//-----------------------------------------------------------------------------
+class CEntityStore
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CEntityStore();
+	virtual ~CEntityStore();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    ULONG       Create( ULONG Archetype );
+    void        Destroy( ULONG Entity );
+    void        Release( );
+
+    ULONG       AddMesh( CIndexedMesh * pMesh, CLODChain * pLOD );
+    const ENTITYMESH & GetMesh( ULONG Handle ) const { return m_pMeshes[ Handle ]; }
+    ULONG       GetMeshCount( ) const { return m_nMeshCount; }
+
+    D3DXMATRIX *GetWorld( ULONG Entity ) const;
+    D3DXVECTOR3 *GetSpin( ULONG Entity ) const;
+    ULONG      *GetMeshHandle( ULONG Entity ) const;
+    ULONG      *GetFlags( ULONG Entity ) const;
+    void        SetPose( ULONG Entity, const D3DXVECTOR3 & vecPosition, float fScale );
+
+    ULONG       GetEntityCount( ) const { return m_nEntityCount; }
+    ULONG       GetEntityLimit( ) const { return m_nRecordCount; }
+    ULONG       GetChunkCount( ) const { return m_nChunkCount; }
+    const ENTITYCHUNK & GetChunk( ULONG Chunk ) const { return m_pChunks[ Chunk ]; }
+
+    void        AnimateChunk( ULONG Chunk, float fTimeElapsed );
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+    struct ENTITYRECORD
+    {
+        ULONG       Chunk;                      // Chunk holding the entity (ENTITY_INVALID if free)
+        ULONG       Slot;                       // Position within the chunk (next free record if free)
+    };
+
+    //-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    ULONG       AllocateChunk( ULONG Archetype );
+    ULONG       AllocateRecord( );
+    void        CopySlot( ENTITYCHUNK & Dest, ULONG DestSlot, const ENTITYCHUNK & Source, ULONG SourceSlot );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    ENTITYCHUNK *m_pChunks;                     // Every chunk, of every archetype
+    ULONG       m_nChunkCount;
+    ULONG       m_nChunkMax;
+    ULONG       m_pOpenChunk[ENTITY_MAX_ARCHETYPES]; // Last (only part full) chunk of each archetype
+    ENTITYRECORD *m_pRecords;                   // Where each entity is stored
+    ULONG       m_nRecordCount;
+    ULONG       m_nRecordMax;
+    ULONG       m_nFreeRecord;                  // First free record (ENTITY_INVALID if none)
+    ULONG       m_nEntityCount;                 // Entities alive
+    ENTITYMESH *m_pMeshes;                      // Meshes referred to by mesh handles
+    ULONG       m_nMeshCount;
+    ULONG       m_nMeshMax;
+
+};
+
+#endif // _CENTITYSTORE_H_
@@ -0,0 +1,133 @@
+//-----------------------------------------------------------------------------
+// File: CFlightRecorder.h
+//
+// Desc: Always-on record of the most recent frames' timings and counts,
+//       written out around any frame which takes too long (a hitch).
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CFLIGHTRECORDER_H_
+#define _CFLIGHTRECORDER_H_
+
+//-----------------------------------------------------------------------------
+// CFlightRecorder Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG FLIGHT_PRE_FRAMES   = 120;          // Default frames kept from before a hitch
+const ULONG FLIGHT_POST_FRAMES  = 30;           // Default frames recorded after a hitch
+const ULONG FLIGHT_MAX_DUMPS    = 16;           // Dumps written before the recorder stops writing
+const ULONG FLIGHT_PREFIX_LENGTH = 240;         // Longest dump file prefix (including terminator)
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : FLIGHTSTAGE (Enum)
+// Desc : The parts of a frame timed by the recorder, in frame order.
+//-----------------------------------------------------------------------------
+enum FLIGHTSTAGE
+{
+    FLIGHT_ANIMATE      = 0,                    // Animation (and clearing the frame buffer meanwhile)
+    FLIGHT_CULL         = 1,                    // Hierarchy query and culling
+    FLIGHT_OCCLUDE      = 2,                    // Occlusion buffer and tests
+    FLIGHT_TRANSFORM    = 3,                    // Vertex transformation
+    FLIGHT_DRAW         = 4,                    // Submitting polygons
+    FLIGHT_RASTERIZE    = 5,                    // Binning and rasterizing tiles
+    FLIGHT_OVERLAY      = 6,                    // Statistics text
+    FLIGHT_PRESENT      = 7,                    // Presenting the frame buffer
+    FLIGHT_WAIT         = 8,                    // Everything until the next frame begins (timer lock included)
+    FLIGHT_STAGE_COUNT  = 9
+};
+
+//-----------------------------------------------------------------------------
+// Name : FLIGHTRECORD (Struct)
+// Desc : Everything recorded of a single frame.
+//-----------------------------------------------------------------------------
+struct FLIGHTRECORD
+{
+    ULONG           Frame;                      // Frame number
+    float           FrameTime;                  // Frame time measured by the timer (seconds)
+    float           StageTime[FLIGHT_STAGE_COUNT]; // Time spent in each FLIGHTSTAGE (seconds)
+    ULONG           ObjectsDrawn;               // Objects drawn
+    ULONG           ObjectsCulled;              // Objects rejected by their bounds
+    ULONG           PolygonsDrawn;              // Polygons drawn
+    ULONG           TrianglesDrawn;             // Triangles rasterized (solid mode)
+    ULONG           LinesDrawn;                 // Lines rasterized (wireframe mode)
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFlightRecorder (Class)
+// Desc : Keeps a ring of the last PreFrames + 1 + PostFrames frame records,
+//        allocated once by Create. A frame longer than the hitch threshold
+//        is counted and, if dumps were asked for, starts a capture;
+//        PostFrames later the ring holds the frames either side of it,
+//        and is written as a CSV file. Hitches within a
+//        capture are written with it, and the frame spent writing cannot
+//        itself start another.
+// Note : Frames are driven from a single thread: BeginFrame after the timer
+//        ticks, MarkStage at the end of each stage, and counts written into
+//        GetRecord before the next BeginFrame.
+//-----------------------------------------------------------------------------
+class CFlightRecorder
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors for This Class
+    //-------------------------------------------------------------------------
+             CFlightRecorder( );
+    virtual ~CFlightRecorder( );
+
+    //-------------------------------------------------------------------------
+    // Public Functions for This Class
+    //-------------------------------------------------------------------------
+    bool            Create          ( float fHitchTime, ULONG PreFrames, ULONG PostFrames, LPCTSTR FilePrefix );
+    void            Release         ( );
+
+    void            BeginFrame      ( float fLastFrameTime );
+    void            MarkStage       ( FLIGHTSTAGE Stage );
+    FLIGHTRECORD  & GetRecord       ( ) { return m_pRecords[ m_nCurrent ]; }
+
+    bool            IsCreated       ( ) const { return m_pRecords != NULL; }
+    ULONG           GetHitchCount   ( ) const { return m_nHitchCount; }
+    ULONG           GetDumpCount    ( ) const { return m_nDumpCount; }
+
+    static const char * GetStageName( FLIGHTSTAGE Stage );
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Functions for This Class
+    //-------------------------------------------------------------------------
+    bool            WriteDump       ( );
+
+    //-------------------------------------------------------------------------
+    // Private Variables for This Class
+    //-------------------------------------------------------------------------
+    FLIGHTRECORD  * m_pRecords;                 // Ring of frame records
+    ULONG           m_nCapacity;                // Records in the ring
+    ULONG           m_nCount;                   // Records completed (up to m_nCapacity)
+    ULONG           m_nCurrent;                 // Record of the frame in progress
+    ULONG           m_nFrame;                   // Frames begun
+    bool            m_bOpen;                    // A frame is in progress
+    __int64         m_MarkTime;                 // Counter at the last stage boundary
+    float           m_TimeScale;                // Counter ticks to seconds
+
+    float           m_fHitchTime;               // Frame time which triggers a capture
+    ULONG           m_nPostFrames;              // Frames recorded after a hitch
+    ULONG           m_nPending;                 // Frames left to record before dumping (0 = not capturing)
+    ULONG           m_nHitchFrame;              // First hitch frame of the capture
+    bool            m_bSkipNext;                // Next frame cannot trigger (it wrote a dump)
+    ULONG           m_nHitchCount;              // Hitches seen
+    ULONG           m_nDumpCount;               // Dumps written
+    bool            m_bDump;                    // Hitches are written out, not just counted
+    char            m_szPrefix[FLIGHT_PREFIX_LENGTH];       // Dump file names are <prefix><frame>.csv
+};
+
+#endif // _CFLIGHTRECORDER_H_
@@ -0,0 +1,136 @@
+//-----------------------------------------------------------------------------
+// File: CFrameBuffer.h
+//
+// Desc: Frame buffer classes. The engine always renders into a raw 32 bit
+//       pixel array that we own, and the backend decides how (or whether)
+//       that array is presented to the user.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CFRAMEBUFFER_H_
+#define _CFRAMEBUFFER_H_
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG FRAMEBUFFER_ALIGNMENT = 64;    // Byte alignment of pixel memory / rows
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFrameBuffer (Base Class)
+// Desc : Frame buffer interface. Pixels are stored as 0xAARRGGBB in a top down
+//        array of m_nHeight rows, each m_nPitch pixels apart. An optional 32
+//        bit float depth buffer, laid out the same way, can be attached.
+//-----------------------------------------------------------------------------
+class CFrameBuffer
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CFrameBuffer();
+	virtual ~CFrameBuffer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    virtual bool    Create( ULONG Width, ULONG Height ) = 0;
+    virtual void    Release( ) = 0;
+    virtual void    Present( ULONG X, ULONG Y, ULONG Width, ULONG Height ) = 0;
+    virtual void    Clear( ULONG Color );
+    virtual void    PrintText( long X, long Y, LPCTSTR lpszText );
+
+    bool            CreateDepthBuffer( );
+    void            ReleaseDepthBuffer( );
+    void            ClearDepth( float Depth );
+
+    bool            WritePPM( const char * FileName ) const;
+    bool            WriteRaw( const char * FileName ) const;
+    bool            ComparePPM( const char * FileName, ULONG Tolerance, ULONG & Differing ) const;
+
+    ULONG         * GetBits( )   const { return m_pBits; }
+    float         * GetDepthBits( ) const { return m_pDepth; }
+    ULONG           GetWidth( )  const { return m_nWidth; }
+    ULONG           GetHeight( ) const { return m_nHeight; }
+    ULONG           GetPitch( )  const { return m_nPitch; }
+
+protected:
+    //-------------------------------------------------------------------------
+	// Protected Variables for This Class
+	//-------------------------------------------------------------------------
+    ULONG          *m_pBits;                // Pixel memory (top row first)
+    float          *m_pDepth;               // Depth memory, same layout as the pixels (may be NULL)
+    ULONG           m_nWidth;               // Width of the buffer in pixels
+    ULONG           m_nHeight;              // Height of the buffer in pixels
+    ULONG           m_nPitch;               // Distance between rows in pixels
+
+};
+
+//-----------------------------------------------------------------------------
+// Name : CMemoryFrameBuffer (Class)
+// Desc : Headless frame buffer, an aligned block of system memory which is
+//        never presented. Results may be inspected directly or dumped to disk.
+//-----------------------------------------------------------------------------
+class CMemoryFrameBuffer : public CFrameBuffer
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CMemoryFrameBuffer();
+	virtual ~CMemoryFrameBuffer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    virtual bool    Create( ULONG Width, ULONG Height );
+    virtual void    Release( );
+    virtual void    Present( ULONG X, ULONG Y, ULONG Width, ULONG Height );
+
+};
+
+#ifdef _WIN32
+//-----------------------------------------------------------------------------
+// Name : CWin32FrameBuffer (Class)
+// Desc : Frame buffer backed by a top down DIB section, so that the pixels
+//        remain in memory we control but can be blitted to a window.
+//-----------------------------------------------------------------------------
+class CWin32FrameBuffer : public CFrameBuffer
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CWin32FrameBuffer( HWND hWnd );
+	virtual ~CWin32FrameBuffer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    virtual bool    Create( ULONG Width, ULONG Height );
+    virtual void    Release( );
+    virtual void    Present( ULONG X, ULONG Y, ULONG Width, ULONG Height );
+    virtual void    Clear( ULONG Color );
+    virtual void    PrintText( long X, long Y, LPCTSTR lpszText );
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    HWND            m_hWnd;                 // Window we present to
+    HDC             m_hdcFrameBuffer;       // Frame Buffers Device Context
+    HBITMAP         m_hbmFrameBuffer;       // Frame buffers DIB section
+    HBITMAP         m_hbmSelectOut;         // Used for selecting out of the DC
+
+};
+#endif // _WIN32
+
+#endif // _CFRAMEBUFFER_H_
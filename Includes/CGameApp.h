@@ -15,6 +15,64 @@
 #include "Main.h"
 #include "CTimer.h"
 #include "CObject.h"
+#include "CFrameBuffer.h"
+#include "CRasterizer.h"
+#include "CTransformStage.h"
+#include "CTileRenderer.h"
+#include "CJobSystem.h"
+#include "COcclusionBuffer.h"
+#include "CBVH.h"
+#include "CLODChain.h"
+#include "CMeshFile.h"
+#include "CEntityStore.h"
+#include "CProfiler.h"
+#include "CFlightRecorder.h"
+#include "CPerfCounters.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG HEADLESS_FRAME_COUNT = 100;     // Default frames rendered when headless
+const ULONG HEADLESS_WARMUP_COUNT = 1;      // Default frames rendered before those measured
+const ULONG HEADLESS_RUN_COUNT   = 1;       // Default times the measured frames are run
+const ULONG HEADLESS_WIDTH       = 800;     // Default size of the headless frame buffer
+const ULONG HEADLESS_HEIGHT      = 600;
+const ULONG VERIFY_COLOR_TOLERANCE = 8;     // Channel difference ignored when comparing with a reference image
+const float VERIFY_PIXEL_TOLERANCE = 0.001f;// Fraction of pixels which may differ from a reference image
+const float VERIFY_REGRESSION    = 0.1f;    // Slow down from a baseline report which fails a run
+const float VERIFY_MIN_FRAME_TIME = 0.002f; // Baseline median frame time below which speed is not gated (seconds)
+const ULONG MAX_FILENAME_LENGTH  = 260;     // Maximum length of a dump filename
+const ULONG OBJECT_COUNT         = 2;       // Number of objects in the default scene
+const float OBJECT_SPACING       = 10.0f;   // Distance between the objects added to larger scenes
+const ULONG ANIMATE_JOB_GRAIN    = 1;       // Entity chunks animated per job
+const ULONG TRANSFORM_JOB_GRAIN  = 16;      // Objects transformed per job
+const float OBJECT_LOD_SIZE      = 128.0f;  // Projected size (pixels) below which objects are simplified
+const float OBJECT_SPHERE_RADIUS = 2.0f;    // Radius of generated spheres (the cube's half width)
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : FRAMESTATS (Struct)
+// Desc : Visibility statistics gathered while drawing a frame.
+//-----------------------------------------------------------------------------
+struct FRAMESTATS
+{
+    ULONG       ObjectsDrawn;           // Objects at least partly inside the frustum
+    ULONG       ObjectsCulled;          // Objects rejected by their bounds
+    ULONG       ObjectsClipped;         // Drawn objects crossing the near or far plane
+    ULONG       EdgesClipped;           // Edges shortened by the near / far planes
+    ULONG       EdgesRejected;          // Edges entirely beyond the near / far planes
+    ULONG       PolygonsDrawn;          // Polygons of visible objects drawn
+    ULONG       PolygonsRejected;       // Polygons skipped as back facing
+    ULONG       TrianglesDrawn;         // Triangles submitted in solid mode
+    ULONG       VerticesTransformed;    // Vertices of the meshes drawn
+    ULONG       LinesDrawn;             // Lines submitted in wireframe mode
+    ULONG       ObjectsTested;          // Objects tested against the occlusion buffer
+    ULONG       ObjectsOccluded;        // Objects hidden behind occluders
+    ULONG       LevelObjects[LOD_MAX_LEVELS];   // Objects drawn at each detail level
+    ULONG       LevelTriangles[LOD_MAX_LEVELS]; // Triangles (polygons fanned) drawn at each detail level
+};
 
 //-----------------------------------------------------------------------------
 // Main Class Declarations
@@ -35,7 +93,9 @@ public:
 	//-------------------------------------------------------------------------
 	// Public Functions for This Class
 	//-------------------------------------------------------------------------
+#ifdef _WIN32
     LRESULT     DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam );
+#endif
 	bool        InitInstance( HANDLE hInstance, LPCTSTR lpCmdLine, int iCmdShow );
     int         BeginGame( );
 	bool        ShutDown( );
@@ -45,20 +105,53 @@ private:
 	// Private Functions for This Class
 	//-------------------------------------------------------------------------
     bool        BuildObjects( );
-    void        FrameAdvance( );
+    bool        LoadMeshFile( const char * pFileName );
+    bool        FrameAdvance( );
     bool        CreateDisplay( );
+    void        ParseCommandLine( LPCTSTR lpCmdLine );
     void        SetupGameState( );
-    void        AnimateObjects( );
+    bool        AllocateObjectState( ULONG Count );
+    void        ReleaseObjectState( );
+    void        AnimateChunk( ULONG Chunk );
+    void        CullObject( ULONG Object );
+    void        UpdateObjectBounds( ULONG Object );
+    void        QueryVisibleObjects( );
+    void        TransformObject( ULONG Object );
+    float       GetProjectedSize( ULONG Object ) const;
+    const ENTITYMESH &GetObjectSource( ULONG Object ) const;
+    ULONG       GetObjectFlags( ULONG Object ) const;
+    const CIndexedMesh *GetObjectMesh( ULONG Object ) const;
+    bool        IsOccluder( ULONG Object ) const;
+    void        DrawOccluders( );
+    void        DrawObjects( );
+    void        DrawOverlay( );
+    bool        WriteReport( const char * pFileName ) const;
+    void        MarkStage( FLIGHTSTAGE Stage );
+    void        PrintStageCounters( char * pszLine, FLIGHTSTAGE Stage ) const;
+    bool        VerifyImage( ) const;
+    bool        VerifyBaseline( ) const;
     void        PresentFrameBuffer( );
     void        ClearFrameBuffer( ULONG Color );
     bool        BuildFrameBuffer( ULONG Width, ULONG Height );
-    void        DrawPrimitive( CPolygon * pPoly, D3DXMATRIX * pmtxWorld );
-    void        DrawLine( const D3DXVECTOR3 & vtx1, const D3DXVECTOR3 & vtx2, ULONG Color );
+    void        DrawPrimitive( const CIndexedMesh * pMesh, const CScreenVertex * pVertices, ULONG Polygon );
+    void        DrawPrimitiveClipped( const CIndexedMesh * pMesh, const CScreenVertex * pVertices,
+                                      const CClipVertex * pClipVertices, ULONG Polygon );
+    void        DrawPrimitiveSolid( const CIndexedMesh * pMesh, const CScreenVertex * pVertices,
+                                    const CClipVertex * pClipVertices, ULONG Polygon, ULONG Color );
+    ULONG       GetClipPlanes( ULONG Object ) const;
+    void        DrawLine( const CScreenVertex & vtx1, const CScreenVertex & vtx2, ULONG Color );
+    bool        ReserveScreenVertices( ULONG Count );
 
     //-------------------------------------------------------------------------
 	// Private Static Functions For This Class
 	//-------------------------------------------------------------------------
+#ifdef _WIN32
     static LRESULT CALLBACK StaticWndProc(HWND hWnd, UINT Message, WPARAM wParam, LPARAM lParam);
+#endif
+    static void AnimateObjectsJob( void * pContext, ULONG Begin, ULONG End );
+    static void CullObjectsJob( void * pContext, ULONG Begin, ULONG End );
+    static void TransformObjectsJob( void * pContext, ULONG Begin, ULONG End );
+    static bool ReadReportValue( const char * pReport, const char * pKey, double & Value );
 
     //-------------------------------------------------------------------------
 	// Private Variables For This Class
@@ -66,18 +159,74 @@ private:
     D3DXMATRIX  m_mtxView;          // View Matrix
     D3DXMATRIX  m_mtxProjection;    // Projection matrix
 
-    CMesh       m_Mesh;             // Mesh to be rendered
-    CObject     m_pObject[2];       // Objects storing mesh instances
+    CIndexedMesh m_Mesh;            // Mesh to be rendered
+    CLODChain   m_MeshLOD;          // Simplified levels of m_Mesh
+    CMeshFile   m_MeshFile;         // Mapped mesh file m_Mesh is attached to (if loaded)
+    CEntityStore m_Entities;        // Every object in the scene, entity i being object i
+    ULONG       m_nObjectCount;     // Number of objects in the scene
     
     CTimer      m_Timer;            // Game timer
     
+#ifdef _WIN32
     HWND        m_hWnd;             // Main window HWND
-    HDC         m_hdcFrameBuffer;   // Frame Buffers Device Context
-    HBITMAP     m_hbmFrameBuffer;   // Frame buffers Bitmap
-    HBITMAP     m_hbmSelectOut;     // Used for selecting out of the DC
+#endif
+    CFrameBuffer *m_pFrameBuffer;   // Frame buffer backend we render into
+    CTileRenderer m_TileRenderer;   // Bins lines into tiles, then draws them in parallel
+    CJobSystem  m_JobSystem;        // Work stealing scheduler for per frame work
+    ULONG       m_nThreadCount;     // Threads to run jobs on (0 = one per hardware thread)
+    CTransformStage m_Transform;    // Object to screen space vertex transformation
+    CScreenVertex *m_pScreenVertex; // Scratch buffer of the visible objects' transformed vertices
+    CClipVertex *m_pClipVertex;     // Clip space copies, for objects needing clipping
+    ULONG       m_nScreenVertexMax; // Capacity of both scratch buffers
+    ULONG      *m_pVertexStart;     // Each visible object's first vertex in the scratch buffers
+    CULLRESULT *m_pObjectCull;      // Each object's frustum test result this frame
+    ULONG      *m_pObjectPlanes;    // Frustum planes each object straddles
+    D3DXVECTOR3 *m_pObjectEye;      // Camera position in each object's space
+    bool       *m_pObjectBackFace;  // m_pObjectEye is valid, so back faces can be culled this frame
+    SCREENRECT *m_pObjectRect;      // Screen extents of each object's bounds
+    bool       *m_pObjectTestable;  // m_pObjectRect is valid for occlusion testing
+    bool       *m_pObjectOccluded;  // Object is hidden behind occluders this frame
+    COcclusionBuffer m_Occlusion;   // Depth pyramid built from occluders each frame
+    CBVH        m_SceneBVH;         // Hierarchy over every object's world bounds
+    ULONG      *m_pVisibleList;     // Objects the hierarchy finds within the frustum (the only ones
+                                    // whose per-object state below is valid this frame)
+    ULONG       m_nVisibleCount;    // Entries in m_pVisibleList
+    ULONG      *m_pObjectLevel;     // Detail level each object is drawn at this frame
+
+    FRAMESTATS  m_FrameStats;       // Statistics for the last frame drawn
+    FRAMESTATS  m_TotalStats;       // Statistics summed over every frame drawn
+    ULONG       m_nStatsFrames;     // Frames summed into m_TotalStats
 
-    bool        m_bRotation1;       // Object 1 rotation enabled / disabled 
-    bool        m_bRotation2;       // Object 2 rotation enabled / disabled 
+    bool        m_bHeadless;        // Render to memory only, no window
+    float       m_fLockFPS;         // Frame rate to lock the timer to (0 = uncapped)
+    ULONG       m_nFrameLimit;      // Frames to render before exiting (headless)
+    ULONG       m_nWarmupFrames;    // Frames rendered before those measured (headless)
+    ULONG       m_nRunCount;        // Times the measured frames are run (headless)
+    float       m_fBestP50;         // Lowest median frame time of those runs (seconds)
+    char        m_szReportFile[MAX_FILENAME_LENGTH]; // JSON measurements written on exit (headless)
+    ULONG       m_nHeadlessWidth;   // Size of the headless frame buffer
+    ULONG       m_nHeadlessHeight;
+    char        m_szReferenceFile[MAX_FILENAME_LENGTH]; // Image the final frame must match (headless)
+    ULONG       m_nColorTolerance;  // Channel difference ignored when comparing with the reference
+    float       m_fPixelTolerance;  // Fraction of pixels which may differ from the reference
+    char        m_szBaselineFile[MAX_FILENAME_LENGTH]; // Report the run must not be slower than (headless)
+    float       m_fRegression;      // Slow down from the baseline which fails the run
+    bool        m_bUpdate;          // Write the reference and baseline from this run, rather than compare
+    char        m_szDumpFile[MAX_FILENAME_LENGTH]; // Final frame dump (headless)
+    char        m_szMeshFile[MAX_FILENAME_LENGTH]; // Mesh file to draw in place of the cube
+    ULONG       m_nSphereSlices;    // Slices of the sphere to draw in place of the cube (0 = cube)
+    char        m_szTraceFile[MAX_FILENAME_LENGTH]; // Chrome trace written on exit (empty = no profiling)
+    CFlightRecorder m_FlightRecorder; // Recent frames, written out around hitches
+    float       m_fHitchTime;       // Frame time counted as a hitch, by the timer and flight recorder (0 = none)
+    ULONG       m_nHitchPreFrames;  // Frames before a hitch written with it
+    ULONG       m_nHitchPostFrames; // Frames after a hitch written with it
+    char        m_szHitchPrefix[FLIGHT_PREFIX_LENGTH]; // Flight recorder dump file prefix (empty = no dumps)
+    bool        m_bCounters;        // Count hardware events in each stage of the frame
+    CPerfCounters m_Counters;       // Hardware events counted in each FLIGHTSTAGE
+    bool        m_bBackFaceCull;    // Back face culling allowed for objects which request it
+    bool        m_bSolid;           // Draw filled, depth tested polygons rather than wireframe
+    bool        m_bOcclusion;       // Test objects against the occluders before drawing
+    bool        m_bLOD;             // Draw distant objects with their simplified meshes
 
     ULONG       m_nViewX;           // X Position of render viewport
     ULONG       m_nViewY;           // Y Position of render viewport
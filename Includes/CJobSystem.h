@@ -0,0 +1,183 @@
+//-----------------------------------------------------------------------------
+// File: CJobSystem.h
+//
+// Desc: Work stealing job scheduler used to spread per frame engine work
+//       across every available hardware thread.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CJOBSYSTEM_H_
+#define _CJOBSYSTEM_H_
+
+//-----------------------------------------------------------------------------
+// CJobSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG JOB_QUEUE_SIZE  = 4096;         // Jobs each thread's deque can hold (power of 2)
+const ULONG JOB_SPIN_COUNT  = 64;           // Failed steal rounds before a worker sleeps
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+typedef void (*JOBFUNC)( void * pContext, ULONG Begin, ULONG End );
+
+class CJobCounter;
+
+//-----------------------------------------------------------------------------
+// Name : JOB (Struct)
+// Desc : A unit of work, calling pfnJob( pContext, Begin, End ). Jobs with a
+//        non zero Grain are parallel-for ranges, split in half on execution
+//        until no larger than Grain.
+//-----------------------------------------------------------------------------
+struct JOB
+{
+    JOBFUNC         pfnJob;                 // Function to execute
+    void          * pContext;               // User data passed to the function
+    ULONG           Begin;                  // First index of the range
+    ULONG           End;                    // One past the last index of the range
+    ULONG           Grain;                  // Split size (0 = never split)
+    CJobCounter   * pCounter;               // Decremented once the job completes (may be NULL)
+};
+
+//-----------------------------------------------------------------------------
+// Name : JOBSTATS (Struct)
+// Desc : Scheduler statistics, summed over all threads.
+//-----------------------------------------------------------------------------
+struct JOBSTATS
+{
+    ULONG           Executed;               // Jobs executed (including split halves)
+    ULONG           Stolen;                 // Jobs taken from another thread's deque
+    ULONG           StealAttempts;          // Attempts to take from another deque
+    ULONG           Overflowed;             // Jobs run inline because a deque was full
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CJobCounter (Class)
+// Desc : Counts outstanding jobs. Each job submitted against a counter adds
+//        one, and removes it on completion. Jobs may also be submitted to
+//        run only once another counter reaches zero (a dependency); such
+//        jobs are held by that counter until then.
+//-----------------------------------------------------------------------------
+class CJobCounter
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CJobCounter();
+	virtual ~CJobCounter();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        IsDone( ) const { return m_nCount.load( std::memory_order_acquire ) == 0; }
+
+private:
+    friend class CJobSystem;
+
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    std::atomic<long>   m_nCount;           // Outstanding jobs
+    std::mutex          m_Mutex;            // Protects the held job list
+    JOB               * m_pHeld;            // Jobs waiting for this counter to reach zero
+    ULONG               m_nHeldCount;       // Number of held jobs
+    ULONG               m_nHeldMax;         // Capacity of m_pHeld
+
+};
+
+//-----------------------------------------------------------------------------
+// Name : CJobSystem (Class)
+// Desc : Each thread owns a deque of jobs. A thread pushes and pops at the
+//        bottom of its own deque (most recent first, which keeps its data
+//        warm) and, when that is empty, steals from the top of another
+//        thread's deque (oldest first, which for split ranges is the
+//        largest remaining piece). The thread which calls Create is thread
+//        zero, takes part whenever it waits, and together with the workers
+//        is the only thread which may submit jobs.
+//-----------------------------------------------------------------------------
+class CJobSystem
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CJobSystem();
+	virtual ~CJobSystem();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Create( ULONG ThreadCount );
+    void        Release( );
+
+    void        Submit( JOBFUNC pfnJob, void * pContext, ULONG Begin, ULONG End,
+                        CJobCounter * pCounter, CJobCounter * pDependency = NULL );
+    void        ParallelFor( JOBFUNC pfnJob, void * pContext, ULONG Count, ULONG Grain,
+                             CJobCounter * pCounter = NULL, CJobCounter * pDependency = NULL );
+    void        Wait( CJobCounter * pCounter );
+
+    ULONG       GetThreadCount( ) const { return m_nThreadCount; }
+    void        GetStats( JOBSTATS & Stats ) const;
+    void        ResetStats( );
+
+    static ULONG GetHardwareThreads( );
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+    struct alignas(64) WORKER
+    {
+        std::atomic<bool>   bLocked;        // Deque spin lock
+        ULONG               nTop;           // Steal end of the deque
+        ULONG               nBottom;        // Owner end of the deque
+        JOB                 Jobs[ JOB_QUEUE_SIZE ];
+        ULONG               nSeed;          // Victim selection random state
+        std::atomic<ULONG>  nExecuted;      // Statistics
+        std::atomic<ULONG>  nStolen;
+        std::atomic<ULONG>  nStealAttempts;
+        std::atomic<ULONG>  nOverflowed;
+        std::thread         Thread;         // Worker thread (unused for thread zero)
+    };
+
+    //-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    void        WorkerThread( ULONG Index );
+    bool        Push( WORKER & Worker, const JOB & Job );
+    bool        Pop( WORKER & Worker, JOB & Job );
+    bool        Steal( WORKER & Worker, JOB & Job );
+    bool        RunOne( ULONG Index );
+    void        Execute( ULONG Index, JOB Job );
+    void        Dispatch( const JOB & Job, CJobCounter * pDependency );
+    void        Enqueue( const JOB & Job );
+    void        Complete( CJobCounter * pCounter );
+    ULONG       GetThreadIndex( ) const;
+
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    WORKER                 *m_pWorkers;         // One per thread, index zero is the creator
+    ULONG                   m_nThreadCount;     // Threads taking part, including the creator
+    std::atomic<long>       m_nQueued;          // Jobs sitting in any deque
+    std::atomic<long>       m_nSleeping;        // Workers waiting on m_WakeCondition
+    std::atomic<bool>       m_bShutdown;        // Workers should exit
+    std::mutex              m_Mutex;            // Used only to sleep / wake workers
+    std::condition_variable m_WakeCondition;    // Signalled when work is queued
+
+};
+
+#endif // _CJOBSYSTEM_H_
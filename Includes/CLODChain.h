@@ -0,0 +1,89 @@
+//-----------------------------------------------------------------------------
+// File: CLODChain.h
+//
+// Desc: Level of detail chains, a mesh plus progressively simplified copies
+//       generated by quadric error edge collapse.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CLODCHAIN_H_
+#define _CLODCHAIN_H_
+
+//-----------------------------------------------------------------------------
+// CLODChain Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CObject.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG LOD_MAX_LEVELS      = 4;        // Levels in a chain, including the source mesh
+const float LOD_REDUCTION       = 0.5f;     // Fraction of triangles kept by each level
+const float LOD_MIN_REDUCTION   = 0.9f;     // A level keeping more than this of the last is dropped
+const float LOD_BOUNDARY_WEIGHT = 100.0f;   // Quadric weight holding open edges in place
+const float LOD_FLIP_LIMIT      = 0.2f;     // Minimum cosine between a face normal before / after a collapse
+const float LOD_PIXEL_ERROR     = 1.0f;     // Largest simplification error allowed on screen, in pixels
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CLODChain (Class)
+// Desc : Holds a source mesh (level 0, not owned) and up to LOD_MAX_LEVELS - 1
+//        simplified copies, each with roughly LOD_REDUCTION of the triangles
+//        of the level before. Simplified levels are triangle meshes whose
+//        vertices never leave the source mesh's bounding box, so the
+//        source's bounds remain valid for culling every level.
+//        A level is selected from the projected size of an object on screen
+//        (the diameter of its bounding sphere, in pixels), switching to the
+//        first simplified level below the size given to Build and to each
+//        further level every time that size halves. A level whose error
+//        would be more than LOD_PIXEL_ERROR pixels at that size is held back
+//        until the object is small enough for it not to be.
+//-----------------------------------------------------------------------------
+class CLODChain
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CLODChain();
+	virtual ~CLODChain();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Build( const CIndexedMesh * pMesh, ULONG LevelCount, float fSwitchSize );
+    void        Create( const CIndexedMesh * pMesh, float fSwitchSize );
+    CIndexedMesh *AddLevel( float fError );
+    void        Release( );
+
+    ULONG       SelectLevel( float fProjectedSize ) const;
+    const CIndexedMesh *GetLevel( ULONG Level ) const { return (Level == 0) ? m_pSource : &m_pLevels[ Level - 1 ]; }
+    ULONG       GetLevelCount( ) const { return m_nLevelCount; }
+    float       GetLevelError( ULONG Level ) const { return m_fError[ Level ]; }
+
+    static bool Simplify( const CIndexedMesh & Source, CIndexedMesh & Dest, ULONG TargetTriangles, float * pError = NULL );
+    static ULONG CountTriangles( const CIndexedMesh & Mesh );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    void        SetLevelError( ULONG Level, float fError );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    const CIndexedMesh *m_pSource;                      // Level 0 (not owned)
+    CIndexedMesh m_pLevels[LOD_MAX_LEVELS - 1];         // Simplified levels 1 onwards
+    float       m_fSwitchSize[LOD_MAX_LEVELS];          // Projected size below which each level is used
+    float       m_fError[LOD_MAX_LEVELS];               // Error of each level, relative to level 0
+    float       m_fBaseSwitchSize;                      // Projected size at which level 1 is used
+    ULONG       m_nLevelCount;                          // Levels in use (including level 0)
+
+};
+
+#endif // _CLODCHAIN_H_
@@ -0,0 +1,60 @@
+//-----------------------------------------------------------------------------
+// File: CMappedFile.h
+//
+// Desc: Read only memory mapping of a whole file.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CMAPPEDFILE_H_
+#define _CMAPPEDFILE_H_
+
+//-----------------------------------------------------------------------------
+// CMappedFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CMappedFile (Class)
+// Desc : Maps a file into the address space, read only, so that it can be
+//        used directly in memory. Pages are read in by the operating system
+//        as they are first touched (or ahead of time, see Prefetch).
+//-----------------------------------------------------------------------------
+class CMappedFile
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CMappedFile();
+	virtual ~CMappedFile();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Open( const char * pFileName );
+    void        Close( );
+    void        Prefetch( ) const;
+
+    const BYTE *GetData( ) const { return m_pData; }
+    unsigned __int64 GetSize( ) const { return m_nSize; }
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    const BYTE *m_pData;                    // Start of the mapping (NULL if not open)
+    unsigned __int64 m_nSize;               // Bytes mapped
+#ifdef _WIN32
+    HANDLE      m_hFile;                    // Open file
+    HANDLE      m_hMapping;                 // File mapping object
+#else
+    int         m_nFile;                    // Open file descriptor
+#endif
+
+};
+
+#endif // _CMAPPEDFILE_H_
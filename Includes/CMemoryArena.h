@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------------
+// File: CMemoryArena.h
+//
+// Desc: Simple block based linear allocator. Allocations are carved out of
+//       large blocks and only ever released all together.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CMEMORYARENA_H_
+#define _CMEMORYARENA_H_
+
+//-----------------------------------------------------------------------------
+// CMemoryArena Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const size_t ARENA_MIN_BLOCK_SIZE = 64 * 1024;          // Size of the first block
+const size_t ARENA_MAX_BLOCK_SIZE = 64 * 1024 * 1024;   // Growth stops doubling here
+const size_t ARENA_ALIGNMENT      = 16;                 // Default allocation alignment
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CMemoryArena (Class)
+// Desc : Linear allocator. Each new block is double the size of the previous
+//        one (up to ARENA_MAX_BLOCK_SIZE), so that very large numbers of
+//        small allocations cost only a handful of real heap allocations.
+//-----------------------------------------------------------------------------
+class CMemoryArena
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CMemoryArena();
+	virtual ~CMemoryArena();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    void      * Allocate( size_t Size, size_t Alignment = ARENA_ALIGNMENT );
+    bool        Grow( void * pMemory, size_t OldSize, size_t NewSize );
+    bool        Reserve( size_t Size );
+    void        Release( );
+
+    size_t      GetBlockCount( ) const { return m_nBlockCount; }
+    size_t      GetTotalSize( )  const { return m_nTotalSize; }
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+    struct BLOCK
+    {
+        BLOCK     * pPrevious;          // Previously allocated block
+        size_t      Size;               // Usable bytes following this header
+        size_t      Used;               // Bytes handed out so far
+    };
+
+    //-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        AddBlock( size_t MinSize );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    BLOCK      *m_pBlock;               // Current block (head of the list)
+    size_t      m_nBlockCount;          // Number of blocks allocated
+    size_t      m_nTotalSize;           // Total usable bytes in all blocks
+    size_t      m_nNextBlockSize;       // Size of the next block to allocate
+
+};
+
+#endif // _CMEMORYARENA_H_
@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// File: CMeshFile.h
+//
+// Desc: Binary mesh container, memory mapped and used in place so that no
+//       parsing or copying is needed to load it.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CMESHFILE_H_
+#define _CMESHFILE_H_
+
+//-----------------------------------------------------------------------------
+// CMeshFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CObject.h"
+#include "CMappedFile.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG MESHFILE_MAGIC      = 0x464D4947;   // 'GIMF' as stored (little endian)
+const ULONG MESHFILE_VERSION    = 1;            // Bumped on any change to the layout
+const ULONG MESHFILE_ALIGN      = 64;           // Alignment of every block within the file
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : MESHFILEHEADER (Struct)
+// Desc : Start of every mesh file, followed (at TableOffset) by one
+//        MESHFILEENTRY per mesh. All offsets are from the start of the file.
+//-----------------------------------------------------------------------------
+struct MESHFILEHEADER
+{
+    ULONG       Magic;                  // MESHFILE_MAGIC
+    ULONG       Version;                // MESHFILE_VERSION
+    ULONG       MeshCount;              // Entries in the mesh table
+    ULONG       EntrySize;              // sizeof(MESHFILEENTRY) when written
+    unsigned __int64 TableOffset;       // Mesh table
+    unsigned __int64 FileSize;          // Total size, to catch truncated files
+};
+
+//-----------------------------------------------------------------------------
+// Name : MESHFILEENTRY (Struct)
+// Desc : Describes one mesh, whose blocks are laid out exactly as the arrays
+//        of CIndexedMesh so they can be attached directly. Simplified levels
+//        of detail follow the mesh they were generated from, numbered from 1.
+//-----------------------------------------------------------------------------
+struct MESHFILEENTRY
+{
+    ULONG       VertexCount;            // CVertex entries in the vertex block
+    ULONG       IndexCount;             // ULONG entries in the index block
+    ULONG       PolygonCount;           // Polygon start table has one more entry than this
+    ULONG       Level;                  // Level of detail (0 = a new source mesh)
+    float       Error;                  // Simplification error of the level (0 for a source)
+    ULONG       Reserved[3];
+    unsigned __int64 VertexOffset;      // CVertex[ VertexCount ]
+    unsigned __int64 IndexOffset;       // ULONG[ IndexCount ]
+    unsigned __int64 PolygonOffset;     // ULONG[ PolygonCount + 1 ]
+    unsigned __int64 PlaneOffset;       // D3DXPLANE[ PolygonCount ]
+    float       BoundsMin[3];           // CBounds of the vertex array
+    float       BoundsMax[3];
+    float       BoundsCentre[3];
+    float       BoundsRadius;
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CMeshFile (Class)
+// Desc : Read only view of a mesh file. Opening maps the whole file and
+//        checks only the header and the mesh table, so the time taken does
+//        not depend on the amount of geometry; the data itself is paged in
+//        by the operating system as it is first touched. Meshes retrieved
+//        with GetMesh are attached to the mapping, and must be released
+//        before the file is closed.
+//-----------------------------------------------------------------------------
+class CMeshFile
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CMeshFile();
+	virtual ~CMeshFile();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Open( const char * pFileName );
+    void        Close( );
+    bool        Validate( ) const;
+    void        Prefetch( ) const { m_File.Prefetch(); }
+
+    ULONG       GetMeshCount( ) const { return m_pHeader ? m_pHeader->MeshCount : 0; }
+    const MESHFILEENTRY & GetEntry( ULONG Mesh ) const { return m_pEntries[ Mesh ]; }
+    bool        GetMesh( ULONG Mesh, CIndexedMesh & Out ) const;
+    unsigned __int64 GetFileSize( ) const { return m_nFileSize; }
+
+    static bool Write( const char * pFileName, const CIndexedMesh * const * ppMeshes, const ULONG * pLevels,
+                       const float * pErrors, ULONG Count );
+
+private:
+	//-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        CheckLayout( ) const;
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    CMappedFile m_File;                     // Mapping of the whole file
+    const BYTE *m_pData;                    // Start of the mapped file
+    unsigned __int64 m_nFileSize;           // Bytes mapped
+    const MESHFILEHEADER *m_pHeader;        // Header at the start of m_pData
+    const MESHFILEENTRY  *m_pEntries;       // Mesh table
+
+};
+
+#endif // _CMESHFILE_H_
@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------------
+// File: COBJImporter.h
+//
+// Desc: Parallel importer for Wavefront OBJ geometry.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _COBJIMPORTER_H_
+#define _COBJIMPORTER_H_
+
+//-----------------------------------------------------------------------------
+// COBJImporter Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CObject.h"
+#include "CMappedFile.h"
+
+//-----------------------------------------------------------------------------
+// Forward Declarations
+//-----------------------------------------------------------------------------
+class CJobSystem;
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG OBJ_CHUNK_SIZE  = 1048576;      // Bytes of text parsed by each job
+
+//-----------------------------------------------------------------------------
+// Main Structure Definitions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : OBJSTATS (Struct)
+// Desc : Describes the last import.
+//-----------------------------------------------------------------------------
+struct OBJSTATS
+{
+    unsigned __int64 FileSize;              // Bytes of text read
+    ULONG       ChunkCount;                 // Pieces the text was split into
+    ULONG       PositionCount;              // 'v' records read
+    ULONG       VertexCount;                // Vertices left after welding
+    ULONG       PolygonCount;               // Faces read (of three or more corners)
+    ULONG       IndexCount;                 // Face corners read
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : COBJImporter (Class)
+// Desc : Reads the positions ('v') and faces ('f') of an OBJ file; all other
+//        records are skipped. The file is mapped and split into chunks at
+//        line boundaries, each of which is parsed by its own job into
+//        private arrays. Once every chunk's counts are known they are laid
+//        out end to end in the output mesh and a second set of jobs copies
+//        them into place, resolving relative (negative) face indices
+//        against the chunk's starting vertex. Faces keep every corner, so
+//        n-gons arrive intact. Unless welding is disabled, vertices sharing
+//        the exact same position are then merged into one.
+//        Unless flipping is disabled the right handed OBJ data is mirrored
+//        in z and each face reversed, so that it appears as authored in our
+//        left handed, clockwise space.
+//-----------------------------------------------------------------------------
+class COBJImporter
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         COBJImporter();
+	virtual ~COBJImporter();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    void        SetJobSystem( CJobSystem * pJobSystem ) { m_pJobSystem = pJobSystem; }
+    void        SetFlip( bool bFlip ) { m_bFlip = bFlip; }
+    void        SetWeld( bool bWeld ) { m_bWeld = bWeld; }
+
+    bool        Import( const char * pFileName, CIndexedMesh & Mesh );
+    bool        Import( const char * pFileName, CMesh & Mesh );
+    bool        Import( const char * pText, size_t Length, CIndexedMesh & Mesh );
+
+    const OBJSTATS & GetStats( ) const { return m_Stats; }
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+    struct OBJCHUNK
+    {
+        const char *pBegin;                 // Text to parse (whole lines)
+        const char *pEnd;
+        float      *pPositions;             // Positions read (x, y, z)
+        ULONG       nPositionCount;
+        ULONG       nPositionMax;
+        __int64    *pCorners;               // Face corners read (see ParseChunk)
+        ULONG       nCornerCount;
+        ULONG       nCornerMax;
+        ULONG      *pFaceSizes;             // Corners in each face read
+        ULONG       nFaceCount;
+        ULONG       nFaceMax;
+        ULONG       VertexBase;             // Where this chunk lands in the mesh
+        ULONG       IndexBase;
+        ULONG       PolygonBase;
+        bool        bError;                 // Chunk could not be read
+    };
+
+    //-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        SplitChunks( const char * pText, size_t Length );
+    void        ReleaseChunks( );
+    void        ParseChunk( OBJCHUNK & Chunk );
+    void        MergeChunk( OBJCHUNK & Chunk );
+    void        RemapChunk( const OBJCHUNK & Chunk );
+    bool        WeldVertices( );
+    void        RunJobs( void (*pfnJob)( void *, ULONG, ULONG ) );
+
+    static void ParseChunksJob( void * pContext, ULONG Begin, ULONG End );
+    static void MergeChunksJob( void * pContext, ULONG Begin, ULONG End );
+    static void RemapChunksJob( void * pContext, ULONG Begin, ULONG End );
+
+	//-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    CJobSystem *m_pJobSystem;               // Runs the chunk jobs (NULL to run them here)
+    bool        m_bFlip;                    // Mirror into left handed space
+    bool        m_bWeld;                    // Merge vertices with equal positions
+    OBJSTATS    m_Stats;                    // Description of the last import
+    CMappedFile m_File;                     // File being imported
+    OBJCHUNK   *m_pChunks;                  // Pieces of the text being imported
+    ULONG       m_nChunkCount;
+    CIndexedMesh *m_pMesh;                  // Mesh being filled
+    ULONG      *m_pRemap;                   // Welded index of each vertex
+
+};
+
+#endif // _COBJIMPORTER_H_
@@ -13,6 +13,7 @@
 // CObject Specific Includes
 //-----------------------------------------------------------------------------
 #include "Main.h"
+#include "CMemoryArena.h"
 
 //-----------------------------------------------------------------------------
 // Main Class Declarations
@@ -39,9 +40,43 @@ public:
     
 };
 
+//-----------------------------------------------------------------------------
+// Name : CBounds (Class)
+// Desc : Object space bounding volume, stored both as an axis aligned box
+//        and as the sphere which encloses that box.
+//-----------------------------------------------------------------------------
+class CBounds
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+    CBounds() { Reset(); }
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    void        Reset( );
+    void        AddPoint( const CVertex & Point );
+    void        CalculateSphere( );
+    void        Transform( const D3DXMATRIX & mtx, CBounds & Out ) const;
+    bool        IsEmpty( ) const { return m_vecMin.x > m_vecMax.x; }
+
+    //-------------------------------------------------------------------------
+	// Public Variables for This Class
+	//-------------------------------------------------------------------------
+    D3DXVECTOR3 m_vecMin;               // Box minimum extents
+    D3DXVECTOR3 m_vecMax;               // Box maximum extents
+    D3DXVECTOR3 m_vecCentre;            // Sphere centre (centre of the box)
+    float       m_fRadius;              // Sphere radius (half the box diagonal)
+
+};
+
 //-----------------------------------------------------------------------------
 // Name : CPolygon (Class)
 // Desc : Basic polygon class used to store this polygons vertex data.
+// Note : Polygons created by a CMesh allocate their vertices from the mesh's
+//        memory arena, rather than from the heap.
 //-----------------------------------------------------------------------------
 class CPolygon
 {
@@ -50,6 +85,7 @@ public:
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
              CPolygon( USHORT VertexCount );
+             CPolygon( CMemoryArena * pArena );
 	         CPolygon();
 	virtual ~CPolygon();
 
@@ -57,12 +93,15 @@ public:
 	// Public Functions for This Class
 	//-------------------------------------------------------------------------
     long        AddVertex( USHORT Count = 1 );
+    bool        Reserve( USHORT Capacity );
 
     //-------------------------------------------------------------------------
 	// Public Variables for This Class
 	//-------------------------------------------------------------------------
     USHORT      m_nVertexCount;         // Number of vertices stored.
+    USHORT      m_nVertexCapacity;      // Number of vertices allocated.
     CVertex    *m_pVertex;              // Simple vertex array
+    CMemoryArena *m_pArena;             // Arena owning the vertex array (or NULL)
 
 };
 
@@ -84,12 +123,68 @@ public:
 	// Public Functions for This Class
 	//-------------------------------------------------------------------------
     long        AddPolygon( ULONG Count = 1 );
+    bool        Reserve( ULONG PolygonCapacity, ULONG VertexCount = 0 );
+    void        CalculateBounds( );
 
     //-------------------------------------------------------------------------
 	// Public Variables for This Class
 	//-------------------------------------------------------------------------
     ULONG       m_nPolygonCount;        // Number of polygons stored
+    ULONG       m_nPolygonCapacity;     // Number of polygon pointers allocated
     CPolygon  **m_pPolygon;             // Simply polygon array.
+    CMemoryArena m_Arena;               // Storage for polygons and their vertices
+    CBounds     m_Bounds;               // Bounds of every polygon vertex (see CalculateBounds)
+
+};
+
+//-----------------------------------------------------------------------------
+// Name : CIndexedMesh (Class)
+// Desc : Compact render ready mesh. Unique vertices are stored once in a
+//        single array, and polygons reference them through one contiguous
+//        index array. Polygon 'i' uses the indices from m_pPolygonStart[i]
+//        up to (but not including) m_pPolygonStart[i + 1].
+//        The arrays may instead be attached to memory owned elsewhere (such
+//        as a mapped mesh file), in which case the mesh is read only and
+//        Release simply forgets them.
+//-----------------------------------------------------------------------------
+class CIndexedMesh
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CIndexedMesh();
+	virtual ~CIndexedMesh();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Create( ULONG VertexCount, ULONG IndexCount, ULONG PolygonCount );
+    bool        BuildFromMesh( const CMesh & Mesh );
+    bool        BuildSphere( float fRadius, ULONG Slices, ULONG Stacks );
+    void        Attach( ULONG VertexCount, const CVertex * pVertex, ULONG IndexCount, const ULONG * pIndex,
+                        ULONG PolygonCount, const ULONG * pPolygonStart, const D3DXPLANE * pPolygonPlane,
+                        const CBounds & Bounds );
+    void        Release( );
+    void        CalculateBounds( );
+    bool        CalculatePlanes( );
+    void        CalculatePlanes( ULONG FirstPolygon, ULONG PolygonCount );
+
+    ULONG       GetPolygonVertexCount( ULONG Polygon ) const { return m_pPolygonStart[ Polygon + 1 ] - m_pPolygonStart[ Polygon ]; }
+    const ULONG *GetPolygonIndices( ULONG Polygon ) const { return &m_pIndex[ m_pPolygonStart[ Polygon ] ]; }
+
+	//-------------------------------------------------------------------------
+	// Public Variables for This Class
+	//-------------------------------------------------------------------------
+    ULONG       m_nVertexCount;         // Number of unique vertices stored
+    CVertex    *m_pVertex;              // Unique vertex array
+    ULONG       m_nIndexCount;          // Number of indices stored
+    ULONG      *m_pIndex;               // Polygon vertex indices, in polygon order
+    ULONG       m_nPolygonCount;        // Number of polygons stored
+    ULONG      *m_pPolygonStart;        // First index of each polygon (m_nPolygonCount + 1 entries)
+    D3DXPLANE  *m_pPolygonPlane;        // Plane of each polygon, front facing side positive (may be NULL)
+    CBounds     m_Bounds;               // Bounds of the vertex array
+    bool        m_bAttached;            // Arrays belong to someone else (read only)
 
 };
 
@@ -103,14 +198,14 @@ public:
     //-------------------------------------------------------------------------
 	// Constructors & Destructors for This Class.
 	//-------------------------------------------------------------------------
-     CObject( CMesh * pMesh );
+     CObject( CIndexedMesh * pMesh );
 	 CObject();
 
 	//-------------------------------------------------------------------------
 	// Public Variables for This Class
 	//-------------------------------------------------------------------------
     D3DXMATRIX  m_mtxWorld;             // Objects world matrix
-    CMesh      *m_pMesh;                // Mesh we are instancing
+    CIndexedMesh *m_pMesh;              // Mesh we are instancing
 
 };
 
@@ -0,0 +1,77 @@
+//-----------------------------------------------------------------------------
+// File: COcclusionBuffer.h
+//
+// Desc: Low resolution software depth buffer, reduced into a hierarchical
+//       depth pyramid, against which object bounds are tested for occlusion.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _COCCLUSIONBUFFER_H_
+#define _COCCLUSIONBUFFER_H_
+
+//-----------------------------------------------------------------------------
+// COcclusionBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CTransformStage.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG OCCLUSION_SCALE      = 4;      // Screen pixels per occlusion texel (each way)
+const ULONG OCCLUSION_MAX_LEVELS = 16;     // Depth pyramid levels, including the base
+const ULONG OCCLUSION_MAX_VERTICES = 16;   // Largest occluder polygon drawn
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : COcclusionBuffer (Class)
+// Desc : Occluder polygons are rasterized conservatively at 1 / SCALE of the
+//        screen resolution: a texel is only written if the polygon covers it
+//        entirely, and then with the furthest depth the polygon reaches
+//        within it. Each level of the pyramid above the base holds the
+//        furthest depth of the 2x2 texels beneath it. An object is occluded
+//        if its nearest depth lies beyond the furthest depth of every texel
+//        its screen rectangle touches, at whichever level that rectangle
+//        spans no more than a couple of texels.
+//-----------------------------------------------------------------------------
+class COcclusionBuffer
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         COcclusionBuffer();
+	virtual ~COcclusionBuffer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    bool        Create( ULONG Width, ULONG Height );
+    void        Release( );
+
+    void        Clear( );
+    void        DrawTriangle( const CScreenVertex & vtx1, const CScreenVertex & vtx2, const CScreenVertex & vtx3 );
+    void        DrawPolygon( const CScreenVertex * pVertices, const ULONG * pIndices, ULONG Count );
+    void        BuildPyramid( );
+    bool        IsOccluded( const SCREENRECT & Rect ) const;
+
+    ULONG       GetWidth( ) const { return m_nWidth[0]; }
+    ULONG       GetHeight( ) const { return m_nHeight[0]; }
+    ULONG       GetLevelCount( ) const { return m_nLevelCount; }
+    const float *GetLevel( ULONG Level ) const { return m_pLevel[ Level ]; }
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    float      *m_pLevel[ OCCLUSION_MAX_LEVELS ];  // Depth per texel, for each level
+    ULONG       m_nWidth[ OCCLUSION_MAX_LEVELS ];  // Texels across each level
+    ULONG       m_nHeight[ OCCLUSION_MAX_LEVELS ]; // Texels down each level
+    ULONG       m_nLevelCount;          // Levels in use (0 if not created)
+
+};
+
+#endif // _COCCLUSIONBUFFER_H_
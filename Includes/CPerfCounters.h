@@ -0,0 +1,103 @@
+//-----------------------------------------------------------------------------
+// File: CPerfCounters.h
+//
+// Desc: Hardware performance counters (cycles, instructions, cache and
+//       branch misses), counted on every thread which opens them and
+//       attributed to the stages of a frame. Only available on Linux, through
+//       perf_event_open, and only where the kernel exposes the counters.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CPERFCOUNTERS_H_
+#define _CPERFCOUNTERS_H_
+
+//-----------------------------------------------------------------------------
+// CPerfCounters Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG PERF_THREAD_LIMIT   = 64;           // Threads which can open counters
+const ULONG PERF_STAGE_LIMIT    = 16;           // Stages counts can be attributed to
+const ULONG PERF_ERROR_LENGTH   = 128;          // Longest reason counters are unavailable
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : PERFCOUNTER (Enum)
+// Desc : The counters opened on each thread.
+//-----------------------------------------------------------------------------
+enum PERFCOUNTER
+{
+    PERF_CYCLES         = 0,                    // CPU cycles (user mode)
+    PERF_INSTRUCTIONS   = 1,                    // Instructions retired
+    PERF_CACHE_MISSES   = 2,                    // Last level cache misses
+    PERF_BRANCH_MISSES  = 3,                    // Mispredicted branches
+    PERF_COUNTER_COUNT  = 4
+};
+
+//-----------------------------------------------------------------------------
+// Name : PERFSAMPLE (Struct)
+// Desc : A count of each counter, summed over every thread.
+//-----------------------------------------------------------------------------
+struct PERFSAMPLE
+{
+    __int64         Count[PERF_COUNTER_COUNT];  // Events counted (0 for counters not available)
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CPerfCounters (Class)
+// Desc : Each thread opens its own group of counters, which any thread can
+//        then read. Stage attribution reads every thread's counts at the
+//        boundaries marked between stages, so work done by the job system's
+//        workers is counted against the stage the main thread is waiting on
+//        (idle workers spinning for jobs included).
+//        Counters the kernel will not open (in containers and virtual
+//        machines without a PMU, or with perf_event_paranoid too high) are
+//        simply left out; should none open, every call does nothing.
+// Note : Reads take a system call per thread, so marks cost microseconds.
+//-----------------------------------------------------------------------------
+class CPerfCounters
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors for This Class
+    //-------------------------------------------------------------------------
+	         CPerfCounters();
+	virtual ~CPerfCounters();
+
+    //-------------------------------------------------------------------------
+    // Public Static Functions for This Class
+    //-------------------------------------------------------------------------
+    static bool     OpenThread      ( );
+    static void     CloseAll        ( );
+    static bool     IsOpen          ( );
+    static bool     IsCounting      ( PERFCOUNTER Counter );
+    static ULONG    GetThreadCount  ( );
+    static const char * GetError    ( );
+    static const char * GetCounterName( PERFCOUNTER Counter );
+    static void     ReadTotals      ( PERFSAMPLE & Sample );
+
+    //-------------------------------------------------------------------------
+    // Public Functions for This Class
+    //-------------------------------------------------------------------------
+    void            Reset           ( );
+    void            MarkStage       ( ULONG Stage );
+    const PERFSAMPLE & GetStage     ( ULONG Stage ) const { return m_Stage[ Stage ]; }
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Variables for This Class
+    //-------------------------------------------------------------------------
+    PERFSAMPLE      m_Last;                     // Totals read at the last mark
+    PERFSAMPLE      m_Stage[PERF_STAGE_LIMIT];  // Counts attributed to each stage since the reset
+};
+
+#endif // _CPERFCOUNTERS_H_
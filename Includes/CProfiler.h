@@ -0,0 +1,111 @@
+//-----------------------------------------------------------------------------
+// File: CProfiler.h
+//
+// Desc: Scoped profiling zones, recorded per thread while enabled and written
+//       out as a Chrome trace (chrome://tracing, or ui.perfetto.dev).
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CPROFILER_H_
+#define _CPROFILER_H_
+
+//-----------------------------------------------------------------------------
+// CProfiler Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include <atomic>
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const ULONG PROFILER_EVENT_LIMIT   = 65536;     // Most recent zones each thread keeps
+const ULONG PROFILER_THREAD_LIMIT  = 64;        // Threads which can record zones
+const ULONG PROFILER_NAME_LENGTH   = 32;        // Longest thread name (including terminator)
+
+// PROFILE_ZONE( "Name" ) times the rest of the enclosing scope. The name must
+// outlive the profile (a string literal). Defining PROFILER_DISABLED compiles
+// every zone away, otherwise a disabled zone costs a single flag test.
+#define PROFILE_CONCAT_( a, b )     a##b
+#define PROFILE_CONCAT( a, b )      PROFILE_CONCAT_( a, b )
+#ifdef PROFILER_DISABLED
+#define PROFILE_ZONE( Name )
+#else
+#define PROFILE_ZONE( Name )        CProfileZone PROFILE_CONCAT( ProfileZone, __LINE__ )( Name )
+#endif
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : PROFILEEVENT (Struct)
+// Desc : A single completed zone.
+//-----------------------------------------------------------------------------
+struct PROFILEEVENT
+{
+    const char    * pszName;                // Zone name
+    __int64         Begin;                  // Counter on entering the zone
+    __int64         End;                    // Counter on leaving the zone
+    ULONG           Depth;                  // Zones already open on the thread
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CProfiler (Class)
+// Desc : Records zones into a fixed ring owned by each thread, so that
+//        recording takes no locks. A thread is given its ring the first
+//        time it records (or is named). Once a ring is full each zone
+//        overwrites the oldest, which is counted as dropped, so a long run
+//        keeps its latest zones.
+// Note : Reset and WriteTrace read every thread's buffer, so must only be
+//        called while no zones are open on other threads (between frames,
+//        with the job system idle).
+//-----------------------------------------------------------------------------
+class CProfiler
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Functions for This Class
+    //-------------------------------------------------------------------------
+    static void     Enable          ( bool bEnable );
+    static bool     IsEnabled       ( ) { return m_bEnabled.load( std::memory_order_relaxed ); }
+    static void     Reset           ( );
+    static void     SetThreadName   ( const char * pszName );
+    static bool     WriteTrace      ( LPCTSTR FileName );
+    static ULONG    GetEventCount   ( );
+    static ULONG    GetDroppedCount ( );
+
+    static __int64  BeginZone       ( );
+    static void     EndZone         ( const char * pszName, __int64 Begin );
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Variables for This Class
+    //-------------------------------------------------------------------------
+    static std::atomic<bool>    m_bEnabled;         // Zones are being recorded
+};
+
+//-----------------------------------------------------------------------------
+// Name : CProfileZone (Class)
+// Desc : Times its own lifetime, see PROFILE_ZONE.
+//-----------------------------------------------------------------------------
+class CProfileZone
+{
+public:
+    //-------------------------------------------------------------------------
+    // Constructors & Destructors for This Class
+    //-------------------------------------------------------------------------
+    explicit CProfileZone( const char * pszName ) : m_pszName( pszName ), m_Begin( CProfiler::IsEnabled() ? CProfiler::BeginZone() : 0 ) {}
+            ~CProfileZone( ) { if ( m_Begin ) CProfiler::EndZone( m_pszName, m_Begin ); }
+
+private:
+    //-------------------------------------------------------------------------
+    // Private Variables for This Class
+    //-------------------------------------------------------------------------
+    const char    * m_pszName;              // Zone name
+    __int64         m_Begin;                // Counter on entering (0 if not recording)
+};
+
+#endif // _CPROFILER_H_
@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------------
+// File: CRasterizer.h
+//
+// Desc: Software rasterizer, draws primitives directly into the pixel memory
+//       of a frame buffer.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CRASTERIZER_H_
+#define _CRASTERIZER_H_
+
+//-----------------------------------------------------------------------------
+// CRasterizer Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CFrameBuffer.h"
+#include "CTransformStage.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const float RASTER_GUARD_BAND = 16777216.0f; // Float coordinates are clipped to +/- this range
+const float RASTER_TRIANGLE_GUARD = 8192.0f; // Triangles must lie within +/- this range (pixels)
+const long  RASTER_SUBPIXEL_BITS  = 4;      // Fractional bits of snapped triangle vertices
+const long  RASTER_BLOCK_SIZE     = 8;      // Width / height of a triangle coverage block
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CRasterizer (Class)
+// Desc : Integer line rasterizer. Lines are clipped by limiting the range of
+//        Bresenham steps that are walked, so the pixels produced for a line
+//        never depend on the clip rectangle in use.
+//        Filled triangles are rasterized with fixed point edge functions,
+//        8x8 pixel blocks at a time, and depth tested against the target's
+//        depth buffer when it has one. Coverage and depth for each pixel
+//        depend only on the triangle and the (absolutely aligned) block
+//        containing it, so again the clip rectangle alters nothing.
+//-----------------------------------------------------------------------------
+class CRasterizer
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CRasterizer();
+	virtual ~CRasterizer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    void        SetRenderTarget( CFrameBuffer * pFrameBuffer );
+    void        SetClipRect( long Left, long Top, long Right, long Bottom );
+    void        SetColor( ULONG Color ) { m_nColor = Color; }
+    ULONG       GetColor( ) const { return m_nColor; }
+
+    void        DrawLine( long X1, long Y1, long X2, long Y2 );
+    void        DrawLine( float X1, float Y1, float X2, float Y2 );
+    void        DrawTriangle( const CScreenVertex & vtx1, const CScreenVertex & vtx2, const CScreenVertex & vtx3 );
+
+    static bool SnapLine( float X1, float Y1, float X2, float Y2, long & nX1, long & nY1, long & nX2, long & nY2 );
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    ULONG      *m_pBits;                // Render target pixel memory
+    float      *m_pDepth;               // Render target depth memory (may be NULL)
+    ULONG       m_nPitch;               // Render target pitch in pixels
+    long        m_nTargetWidth;         // Render target width
+    long        m_nTargetHeight;        // Render target height
+    long        m_nClipLeft;            // Clip rectangle (inclusive)
+    long        m_nClipTop;             // Clip rectangle (inclusive)
+    long        m_nClipRight;           // Clip rectangle (exclusive)
+    long        m_nClipBottom;          // Clip rectangle (exclusive)
+    ULONG       m_nColor;               // Packed pixel value for drawing
+
+};
+
+#endif // _CRASTERIZER_H_
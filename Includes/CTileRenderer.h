@@ -0,0 +1,123 @@
+//-----------------------------------------------------------------------------
+// File: CTileRenderer.h
+//
+// Desc: Tile binning renderer. Primitives are gathered and sorted into screen
+//       tiles, and the tiles are then rasterized in parallel.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CTILERENDERER_H_
+#define _CTILERENDERER_H_
+
+//-----------------------------------------------------------------------------
+// CTileRenderer Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CFrameBuffer.h"
+#include "CRasterizer.h"
+#include "CJobSystem.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+const long  TILE_SIZE      = 64;           // Width / height of a screen tile in pixels
+const ULONG TILE_JOB_GRAIN = 2;            // Tiles drawn per job
+const ULONG TILE_TRIANGLE  = 0x80000000;   // Bin entry refers to a triangle, not a line
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CTileRenderer (Class)
+// Desc : Front end records each line and bins it into every tile it may
+//        touch. The back end then draws each tile on a single thread, in
+//        submission order, clipped to that tile. Because the rasterizer's
+//        clipping never alters the pixels of a line, the result is identical
+//        to drawing every line serially, whatever the number of threads.
+//        Filled triangles are handled in the same way. Each tile draws its
+//        triangles (in submission order) before its lines.
+//-----------------------------------------------------------------------------
+class CTileRenderer
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CTileRenderer();
+	virtual ~CTileRenderer();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    void        SetRenderTarget( CFrameBuffer * pFrameBuffer );
+    void        SetClipRect( long Left, long Top, long Right, long Bottom );
+    void        SetJobSystem( CJobSystem * pJobSystem ) { m_pJobSystem = pJobSystem; }
+
+    void        BeginFrame( );
+    void        AddLine( float X1, float Y1, float X2, float Y2, ULONG Color );
+    void        AddLine( long X1, long Y1, long X2, long Y2, ULONG Color );
+    void        AddTriangle( const CScreenVertex & vtx1, const CScreenVertex & vtx2, const CScreenVertex & vtx3, ULONG Color );
+    void        EndFrame( );
+    void        Release( );
+
+    ULONG       GetLineCount( ) const { return m_nLineCount; }
+    ULONG       GetTriangleCount( ) const { return m_nTriangleCount; }
+    ULONG       GetBinnedCount( ) const { return m_nBinnedCount; }
+    ULONG       GetTileCount( ) const { return m_nTilesX * m_nTilesY; }
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Structures for This Class
+	//-------------------------------------------------------------------------
+    struct TILELINE
+    {
+        long    X1, Y1, X2, Y2;             // Integer end points
+        ULONG   Color;                      // Packed pixel value
+    };
+
+    struct TILETRIANGLE
+    {
+        CScreenVertex Vertex[3];            // Screen space corners
+        ULONG   Color;                      // Packed pixel value
+    };
+
+    //-------------------------------------------------------------------------
+	// Private Functions for This Class
+	//-------------------------------------------------------------------------
+    void        BinLine( ULONG Line, bool bScatter );
+    void        BinTriangle( ULONG Triangle, bool bScatter );
+    bool        ReserveBins( ULONG Count );
+    void        DrawTile( ULONG Tile );
+
+    static void DrawTilesJob( void * pContext, ULONG Begin, ULONG End );
+
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    CFrameBuffer   *m_pFrameBuffer;         // Target we render into
+    CJobSystem     *m_pJobSystem;           // Scheduler used by the back end (may be NULL)
+    long            m_nClipLeft;            // Clip rectangle (inclusive)
+    long            m_nClipTop;             // Clip rectangle (inclusive)
+    long            m_nClipRight;           // Clip rectangle (exclusive)
+    long            m_nClipBottom;          // Clip rectangle (exclusive)
+    ULONG           m_nTilesX;              // Tile columns covering the target
+    ULONG           m_nTilesY;              // Tile rows covering the target
+
+    TILELINE       *m_pLines;               // Lines recorded this frame
+    ULONG           m_nLineCount;           // Number of lines recorded
+    ULONG           m_nLineMax;             // Capacity of m_pLines
+
+    TILETRIANGLE   *m_pTriangles;           // Triangles recorded this frame
+    ULONG           m_nTriangleCount;       // Number of triangles recorded
+    ULONG           m_nTriangleMax;         // Capacity of m_pTriangles
+
+    ULONG          *m_pTileStart;           // First bin entry per tile (tile count + 1)
+    ULONG          *m_pTileFill;            // Scatter position per tile
+    ULONG          *m_pBins;                // Line / triangle indices, grouped by tile
+    ULONG           m_nBinnedCount;         // Entries in m_pBins
+    ULONG           m_nBinMax;              // Capacity of m_pBins
+
+};
+
+#endif // _CTILERENDERER_H_
@@ -3,7 +3,10 @@
 //
 // Desc: This class handles all timing functionality. This includes counting
 //       the number of frames per second, to scaling vectors and values
-//       relative to the time that has passed since the previous frame.
+//       relative to the time that has passed since the previous frame, and
+//       holding the frame rate to a lock without burning a core to do so.
+//       Every frame time is also kept for statistics on the slowest frames,
+//       which an average frame rate hides.
 //
 // Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
 //-----------------------------------------------------------------------------
@@ -21,6 +24,69 @@
 //-----------------------------------------------------------------------------
 const ULONG MAX_SAMPLE_COUNT = 50; // Maximum frame time sample count
 
+const float TIMER_LOCK_MARGIN   = 0.0005f;  // Time PACING_LOCK leaves to spin after sleeping (seconds)
+const float TIMER_MIN_MARGIN    = 0.0002f;  // Least time PACING_ADAPTIVE leaves to spin (seconds)
+const float TIMER_MAX_MARGIN    = 0.001f;   // Most time PACING_ADAPTIVE leaves to spin (seconds)
+const float TIMER_MARGIN_DECAY  = 0.05f;    // Rate PACING_ADAPTIVE's margin falls back toward recent wake ups
+
+const ULONG TIMER_HISTORY_SIZE  = 1024;     // Recent frame times kept for the rolling window
+const ULONG TIMER_BUCKET_COUNT  = 320;      // Frame time histogram buckets
+const ULONG TIMER_BUCKET_OCTAVE = 16;       // Histogram buckets per doubling of frame time
+const float TIMER_BUCKET_MIN    = 0.00005f; // Upper edge of the first histogram bucket (seconds)
+const float TIMER_HITCH_TIME    = 1.0f / 30.0f; // Default frame time counted as a hitch (seconds, 0 = none)
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : TIMERPACING (Enum)
+// Desc : How Tick waits out the remainder of a locked frame.
+//-----------------------------------------------------------------------------
+enum TIMERPACING
+{
+    PACING_UNCAPPED     = 0,                    // Never wait, ignoring the lock
+    PACING_SPIN         = 1,                    // Poll the counter until the deadline
+    PACING_LOCK         = 2,                    // Sleep, then spin a fixed margin
+    PACING_ADAPTIVE     = 3                     // Sleep, then spin a margin learned from wake ups
+};
+
+//-----------------------------------------------------------------------------
+// Name : TIMERSTATS (Struct)
+// Desc : Pacing statistics, summed over every locked frame since the last
+//        reset. Wake error is how much later than asked a sleep returned,
+//        pacing error how far from the frame deadline Tick returned.
+//-----------------------------------------------------------------------------
+struct TIMERSTATS
+{
+    ULONG           Frames;                     // Locked frames
+    ULONG           LateFrames;                 // Frames already past their deadline on arrival
+    ULONG           Sleeps;                     // Sleeps taken
+    double          SleepTime;                  // Time spent asleep (seconds)
+    double          SpinTime;                   // Time spent polling the counter (seconds)
+    double          WakeError;                  // Summed wake error (seconds)
+    double          WakeErrorMax;               // Worst wake error (seconds)
+    double          PacingError;                // Summed pacing error (seconds)
+    double          PacingErrorMax;             // Worst pacing error (seconds)
+};
+
+//-----------------------------------------------------------------------------
+// Name : TIMERFRAMESTATS (Struct)
+// Desc : Frame time statistics, over every frame since the last reset or
+//        over the rolling window of recent frames. Percentiles are read from
+//        a histogram with TIMER_BUCKET_OCTAVE buckets per doubling, so are
+//        good to within a few percent; the mean and maximum are exact.
+//-----------------------------------------------------------------------------
+struct TIMERFRAMESTATS
+{
+    ULONG           Frames;                     // Frames measured
+    ULONG           Hitches;                    // Frames longer than the hitch threshold
+    float           Mean;                       // Mean frame time (seconds)
+    float           P50;                        // Median frame time (seconds)
+    float           P95;                        // 95th percentile frame time (seconds)
+    float           P99;                        // 99th percentile frame time (seconds)
+    float           Max;                        // Longest frame time (seconds)
+};
+
 //-----------------------------------------------------------------------------
 // Main Class Declarations
 //-----------------------------------------------------------------------------
@@ -29,6 +95,14 @@ const ULONG MAX_SAMPLE_COUNT = 50; // Maximum frame time sample count
 // Desc : Game Timer class, queries performance hardware if available, and 
 //        calculates all the various values required for frame rate based
 //        vector / value scaling.
+//        When the frame rate is locked, the bulk of each frame's remaining
+//        time is slept through and only the last moments spun, the margin
+//        left to spin being fixed or adapted to how late sleeps wake up
+//        (see TIMERPACING).
+//        Each frame time is added to a histogram of all frames, and to a
+//        ring of the most recent from which a rolling window is read.
+//        A fixed step replaces the measured time elapsed, but never the
+//        frame times measured for the statistics.
 //-----------------------------------------------------------------------------
 class CTimer
 {
@@ -45,6 +119,18 @@ public:
 	void	        Tick( float fLockFPS = 0.0f );
     unsigned long   GetFrameRate( LPTSTR lpszString = NULL ) const;
     float           GetTimeElapsed() const;
+    float           GetFrameTime() const;
+    void            SetFixedStep( float fSeconds ) { m_FixedStep = fSeconds; }
+    float           GetFixedStep( ) const { return m_FixedStep; }
+
+    void            SetPacing( TIMERPACING Pacing ) { m_Pacing = Pacing; }
+    TIMERPACING     GetPacing( ) const { return m_Pacing; }
+    const TIMERSTATS & GetStats( ) const { return m_Stats; }
+    void            ResetStats( );
+
+    void            SetHitchThreshold( float fSeconds ) { m_HitchTime = fSeconds; }
+    float           GetHitchThreshold( ) const { return m_HitchTime; }
+    void            GetFrameStats( TIMERFRAMESTATS & Stats, bool bWindow = false ) const;
 
 private:
 	//------------------------------------------------------------
@@ -53,20 +139,41 @@ private:
     bool            m_PerfHardware;             // Has Performance Counter
 	float           m_TimeScale;                // Amount to scale counter
 	float           m_TimeElapsed;              // Time elapsed since previous frame
+    float           m_FixedStep;                // Time reported elapsed every frame (0 = measured)
     __int64         m_CurrentTime;              // Current Performance Counter
     __int64         m_LastTime;                 // Performance Counter last frame
 	__int64         m_PerfFreq;                 // Performance Frequency
 
-    float           m_FrameTime[MAX_SAMPLE_COUNT];
-    ULONG           m_SampleCount;
+    float           m_FrameTime[MAX_SAMPLE_COUNT]; // Ring of recent frame times, averaged for GetTimeElapsed
+    ULONG           m_SampleCount;              // Samples in m_FrameTime
+    ULONG           m_SampleHead;               // Next sample to be replaced
+    double          m_SampleTotal;              // Sum of the samples
 
     unsigned long   m_FrameRate;                // Stores current framerate
 	unsigned long   m_FPSFrameCount;            // Elapsed frames in any given second
 	float           m_FPSTimeElapsed;           // How much time has passed during FPS sample
+
+    TIMERPACING     m_Pacing;                   // How locked frames are waited out
+    float           m_SpinMargin;               // Time left to spin after sleeping (PACING_ADAPTIVE)
+    TIMERSTATS      m_Stats;                    // Pacing statistics
+
+    float           m_HitchTime;                // Frame time counted as a hitch
+    float           m_History[TIMER_HISTORY_SIZE]; // Ring of every recent frame time
+    ULONG           m_HistoryCount;             // Frames in m_History
+    ULONG           m_HistoryHead;              // Next frame to be replaced
+    ULONG           m_WindowBuckets[TIMER_BUCKET_COUNT]; // Histogram of m_History
+    ULONG           m_TotalBuckets[TIMER_BUCKET_COUNT];  // Histogram of every frame
+    ULONG           m_TotalFrames;              // Frames since the statistics were reset
+    ULONG           m_TotalHitches;             // Hitches since the statistics were reset
+    double          m_TotalTime;                // Time since the statistics were reset
+    float           m_TotalMax;                 // Longest frame since the statistics were reset
 	
 	//------------------------------------------------------------
 	// Private Functions For This Class
 	//------------------------------------------------------------
+    __int64         ReadCounter( ) const;
+    float           WaitForFrame( float fTimeElapsed, float fFrameTime );
+    void            RecordFrame( float fTimeElapsed );
 };
 
 #endif // _CTIMER_H_
\ No newline at end of file
@@ -0,0 +1,175 @@
+//-----------------------------------------------------------------------------
+// File: CTransformStage.h
+//
+// Desc: Vertex transformation stage. Takes object space vertices all the way
+//       through to screen space using a single concatenated matrix.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _CTRANSFORMSTAGE_H_
+#define _CTRANSFORMSTAGE_H_
+
+//-----------------------------------------------------------------------------
+// CTransformStage Specific Includes
+//-----------------------------------------------------------------------------
+#include "Main.h"
+#include "CObject.h"
+
+//-----------------------------------------------------------------------------
+// Definitions, Macros & Constants
+//-----------------------------------------------------------------------------
+// SSE2 kernel is available wherever SSE2 is part of the baseline instruction set
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TRANSFORM_SIMD_SSE2
+#endif
+
+// Frustum plane flags, as reported by CTransformStage::TestBounds
+const ULONG FRUSTUM_LEFT    = 0x01;
+const ULONG FRUSTUM_RIGHT   = 0x02;
+const ULONG FRUSTUM_BOTTOM  = 0x04;
+const ULONG FRUSTUM_TOP     = 0x08;
+const ULONG FRUSTUM_NEAR    = 0x10;
+const ULONG FRUSTUM_FAR     = 0x20;
+
+const ULONG TRANSFORM_CLIP_MAX = 9;         // Vertices a triangle can have once clipped
+
+//-----------------------------------------------------------------------------
+// Typedefs, Structures & Enumerators
+//-----------------------------------------------------------------------------
+enum TRANSFORMKERNEL
+{
+    TRANSFORM_SCALAR    = 0,            // Portable C++, one vertex at a time
+    TRANSFORM_SSE2      = 1,            // Four vertices per instruction
+    TRANSFORM_AVX2      = 2,            // Eight vertices per instruction
+    TRANSFORM_KERNEL_COUNT
+};
+
+enum CULLRESULT
+{
+    CULL_OUTSIDE        = 0,            // Entirely outside the frustum
+    CULL_INTERSECT      = 1,            // Crosses one or more frustum planes
+    CULL_INSIDE         = 2             // Entirely inside the frustum
+};
+
+//-----------------------------------------------------------------------------
+// Name : SCREENRECT (Struct)
+// Desc : Screen space extents of a projected bounding box, in pixels, along
+//        with the nearest projected depth of any of its corners.
+//-----------------------------------------------------------------------------
+struct SCREENRECT
+{
+    float       Left;                   // Minimum x
+    float       Top;                    // Minimum y
+    float       Right;                  // Maximum x
+    float       Bottom;                 // Maximum y
+    float       MinZ;                   // Nearest projected depth
+};
+
+//-----------------------------------------------------------------------------
+// Main Class Declarations
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CScreenVertex (Class)
+// Desc : Transformed vertex. x / y are in screen space (pixels), z is the
+//        projected depth and w the clip space w prior to the divide.
+//-----------------------------------------------------------------------------
+class CScreenVertex
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Variables for This Class
+    //-------------------------------------------------------------------------
+    float       x;          // Screen X Position
+    float       y;          // Screen Y Position
+    float       z;          // Projected Depth
+    float       w;          // Clip Space W
+    
+};
+
+//-----------------------------------------------------------------------------
+// Name : CClipVertex (Class)
+// Desc : Clip space vertex, prior to the divide by w. x / y already include
+//        the viewport scale and offset, so dividing through gives pixels.
+//-----------------------------------------------------------------------------
+class CClipVertex
+{
+public:
+    //-------------------------------------------------------------------------
+    // Public Variables for This Class
+    //-------------------------------------------------------------------------
+    float       x;          // Clip Space X (viewport scaled)
+    float       y;          // Clip Space Y (viewport scaled)
+    float       z;          // Clip Space Z
+    float       w;          // Clip Space W
+    
+};
+
+//-----------------------------------------------------------------------------
+// Name : TRANSFORMFUNC (Typedef)
+// Desc : Batch transform kernel. Every kernel evaluates the same sequence of
+//        multiplies / adds (no fused multiply-add) and uses a true divide, so
+//        all kernels produce bit identical results.
+//-----------------------------------------------------------------------------
+typedef void (*TRANSFORMFUNC)( const D3DXMATRIX & mtx, const CVertex * pVertices, CScreenVertex * pOut, ULONG Count );
+
+//-----------------------------------------------------------------------------
+// Transform Kernels (AVX2 kernel lives in its own, separately compiled file)
+//-----------------------------------------------------------------------------
+TRANSFORMFUNC   GetTransformKernelAVX2( );
+
+//-----------------------------------------------------------------------------
+// Name : CTransformStage (Class)
+// Desc : World, view, projection and viewport transforms are concatenated
+//        into one matrix per object, so that each vertex costs a single
+//        vector / matrix multiply and a single divide. Vertices are processed
+//        in batches by the widest kernel the CPU supports.
+//-----------------------------------------------------------------------------
+class CTransformStage
+{
+public:
+    //-------------------------------------------------------------------------
+	// Constructors & Destructors for This Class.
+	//-------------------------------------------------------------------------
+	         CTransformStage();
+	virtual ~CTransformStage();
+
+	//-------------------------------------------------------------------------
+	// Public Functions for This Class
+	//-------------------------------------------------------------------------
+    void        SetViewport( ULONG X, ULONG Y, ULONG Width, ULONG Height );
+    void        SetViewProjection( const D3DXMATRIX & mtxView, const D3DXMATRIX & mtxProjection );
+    void        SetWorld( const D3DXMATRIX & mtxWorld );
+    void        Transform( const CVertex * pVertices, CScreenVertex * pOut, ULONG Count ) const;
+    void        TransformHomogeneous( const CVertex * pVertices, CClipVertex * pOut, ULONG Count ) const;
+    CULLRESULT  TestBounds( const CBounds & Bounds, ULONG * pPlanes = NULL ) const;
+    bool        ProjectBounds( const CBounds & Bounds, SCREENRECT & Rect ) const;
+
+    bool        SetKernel( TRANSFORMKERNEL Kernel );
+    TRANSFORMKERNEL GetKernel( ) const { return m_Kernel; }
+
+    const D3DXMATRIX & GetCombined( ) const { return m_mtxCombined; }
+
+    static bool         IsKernelSupported( TRANSFORMKERNEL Kernel );
+    static TRANSFORMKERNEL GetBestKernel( );
+    static const char * GetKernelName( TRANSFORMKERNEL Kernel );
+    static void         Project( const CClipVertex & In, CScreenVertex & Out );
+    static void         GetFrustumPlanes( const D3DXMATRIX & mtx, D3DXPLANE * pPlanes );
+    static ULONG        GetClipCode( const CClipVertex & Vertex, float fGuardBand );
+    static ULONG        ClipTriangle( const CClipVertex * pIn, CClipVertex * pOut, float fGuardBand );
+
+private:
+    //-------------------------------------------------------------------------
+	// Private Variables for This Class
+	//-------------------------------------------------------------------------
+    D3DXMATRIX  m_mtxViewport;          // Maps clip space x / y to pixels (pre-divide)
+    D3DXMATRIX  m_mtxViewProj;          // View * Projection
+    D3DXMATRIX  m_mtxViewProjView;      // View * Projection * Viewport
+    D3DXMATRIX  m_mtxWorldViewProj;     // World * View * Projection (frustum planes)
+    D3DXMATRIX  m_mtxCombined;          // World * View * Projection * Viewport
+    TRANSFORMKERNEL m_Kernel;           // Kernel selected for Transform
+    TRANSFORMFUNC   m_pfnTransform;     // Kernel entry point
+
+};
+
+#endif // _CTRANSFORMSTAGE_H_
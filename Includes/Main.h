@@ -12,14 +12,44 @@
 //-----------------------------------------------------------------------------
 // Main Application Includes
 //-----------------------------------------------------------------------------
+#ifdef _WIN32
 #include "..\\Res\\resource.h"
 #include <windows.h>
 #include <tchar.h>
+#include <malloc.h>
 #include <D3DX9.h>
+#else
+#include "Platform.h"
+#endif
 
 //-----------------------------------------------------------------------------
 // Miscellaneous Macros
 //-----------------------------------------------------------------------------
 #define RGB2BGR( Color ) (Color & 0xFF000000) | ((Color & 0xFF0000) >> 16) | (Color & 0x00FF00) | ((Color & 0x0000FF) << 16)
 
+//-----------------------------------------------------------------------------
+// Miscellaneous Functions
+//-----------------------------------------------------------------------------
+// Allocates memory aligned to the specified power of two boundary.
+inline void * AlignedAlloc( size_t Size, size_t Alignment )
+{
+#ifdef _WIN32
+    return _aligned_malloc( Size, Alignment );
+#else
+    void * pMemory = NULL;
+    if ( posix_memalign( &pMemory, Alignment, Size ) != 0 ) return NULL;
+    return pMemory;
+#endif
+}
+
+// Releases memory previously allocated with AlignedAlloc.
+inline void AlignedFree( void * pMemory )
+{
+#ifdef _WIN32
+    _aligned_free( pMemory );
+#else
+    free( pMemory );
+#endif
+}
+
 #endif // _MAIN_H_
\ No newline at end of file
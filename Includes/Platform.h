@@ -0,0 +1,329 @@
+//-----------------------------------------------------------------------------
+// File: Platform.h
+//
+// Desc: Minimal stand-ins for the Win32 / D3DX types and functions used by the
+//       engine, allowing it to be built headless on platforms other than
+//       Windows. Only included by Main.h when _WIN32 is not defined.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+#ifndef _PLATFORM_H_
+#define _PLATFORM_H_
+
+//-----------------------------------------------------------------------------
+// Platform Specific Includes
+//-----------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+//-----------------------------------------------------------------------------
+// Win32 Types, Macros & Constants
+//-----------------------------------------------------------------------------
+typedef uint32_t        ULONG;
+typedef int32_t         LONG;
+typedef uint16_t        USHORT;
+typedef uint8_t         UCHAR;
+typedef uint8_t         BYTE;
+typedef unsigned int    UINT;
+typedef int             BOOL;
+typedef char            TCHAR;
+typedef char           *LPTSTR;
+typedef const char     *LPCTSTR;
+typedef void           *HANDLE;
+
+#define __int64         long long
+#define TRUE            1
+#define FALSE           0
+#define _T( x )         x
+
+#define ZeroMemory( Destination, Length ) memset( (Destination), 0, (Length) )
+
+typedef union _LARGE_INTEGER
+{
+    struct { uint32_t LowPart; int32_t HighPart; };
+    long long QuadPart;
+
+} LARGE_INTEGER;
+
+//-----------------------------------------------------------------------------
+// Win32 Function Stand-ins
+//-----------------------------------------------------------------------------
+inline BOOL QueryPerformanceFrequency( LARGE_INTEGER * lpFrequency )
+{
+    // Monotonic clock is reported in nanoseconds
+    lpFrequency->QuadPart = 1000000000LL;
+    return TRUE;
+}
+
+inline BOOL QueryPerformanceCounter( LARGE_INTEGER * lpPerformanceCount )
+{
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    lpPerformanceCount->QuadPart = (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+    return TRUE;
+}
+
+inline ULONG timeGetTime( )
+{
+    timespec ts;
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return (ULONG)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+inline UINT timeBeginPeriod( UINT )
+{
+    // Sleeps are already as fine grained as the kernel allows
+    return 0;
+}
+
+inline UINT timeEndPeriod( UINT )
+{
+    return 0;
+}
+
+inline void Sleep( ULONG dwMilliseconds )
+{
+    timespec ts;
+    ts.tv_sec  = dwMilliseconds / 1000;
+    ts.tv_nsec = (long)(dwMilliseconds % 1000) * 1000000L;
+    nanosleep( &ts, NULL );
+}
+
+inline LPTSTR _itot( int Value, LPTSTR lpszString, int )
+{
+    // Only decimal conversion is required by the engine
+    sprintf( lpszString, "%d", Value );
+    return lpszString;
+}
+
+#define _tcscat     strcat
+#define _tcslen     strlen
+#define _tcsstr     strstr
+#define _stprintf   sprintf
+
+//-----------------------------------------------------------------------------
+// D3DX Math Types, Macros & Constants
+//-----------------------------------------------------------------------------
+#define D3DX_PI                 (3.14159265358979323846f)
+#define D3DXToRadian( degree )  ((degree) * (D3DX_PI / 180.0f))
+#define D3DXToDegree( radian )  ((radian) * (180.0f / D3DX_PI))
+
+//-----------------------------------------------------------------------------
+// Name : D3DXVECTOR3 (Struct)
+// Desc : Three component vector, layout compatible with the D3DX type.
+//-----------------------------------------------------------------------------
+struct D3DXVECTOR3
+{
+    D3DXVECTOR3( ) {}
+    D3DXVECTOR3( float fX, float fY, float fZ ) { x = fX; y = fY; z = fZ; }
+
+    D3DXVECTOR3 operator + ( const D3DXVECTOR3 & v ) const { return D3DXVECTOR3( x + v.x, y + v.y, z + v.z ); }
+    D3DXVECTOR3 operator - ( const D3DXVECTOR3 & v ) const { return D3DXVECTOR3( x - v.x, y - v.y, z - v.z ); }
+    D3DXVECTOR3 operator * ( float f ) const { return D3DXVECTOR3( x * f, y * f, z * f ); }
+    D3DXVECTOR3 operator - ( ) const { return D3DXVECTOR3( -x, -y, -z ); }
+
+    float x, y, z;
+};
+
+//-----------------------------------------------------------------------------
+// Name : D3DXVECTOR4 (Struct)
+// Desc : Four component vector, layout compatible with the D3DX type.
+//-----------------------------------------------------------------------------
+struct D3DXVECTOR4
+{
+    D3DXVECTOR4( ) {}
+    D3DXVECTOR4( float fX, float fY, float fZ, float fW ) { x = fX; y = fY; z = fZ; w = fW; }
+
+    float x, y, z, w;
+};
+
+//-----------------------------------------------------------------------------
+// Name : D3DXPLANE (Struct)
+// Desc : Plane (ax + by + cz + d = 0), layout compatible with the D3DX type.
+//-----------------------------------------------------------------------------
+struct D3DXPLANE
+{
+    D3DXPLANE( ) {}
+    D3DXPLANE( float fA, float fB, float fC, float fD ) { a = fA; b = fB; c = fC; d = fD; }
+
+    float a, b, c, d;
+};
+
+//-----------------------------------------------------------------------------
+// Name : D3DXMATRIX (Struct)
+// Desc : Row major 4x4 matrix, layout compatible with the D3DX type.
+//-----------------------------------------------------------------------------
+struct D3DXMATRIX
+{
+    D3DXMATRIX( ) {}
+    D3DXMATRIX( float f11, float f12, float f13, float f14,
+                float f21, float f22, float f23, float f24,
+                float f31, float f32, float f33, float f34,
+                float f41, float f42, float f43, float f44 )
+    {
+        _11 = f11; _12 = f12; _13 = f13; _14 = f14;
+        _21 = f21; _22 = f22; _23 = f23; _24 = f24;
+        _31 = f31; _32 = f32; _33 = f33; _34 = f34;
+        _41 = f41; _42 = f42; _43 = f43; _44 = f44;
+    }
+
+    float & operator () ( UINT Row, UINT Col )       { return m[Row][Col]; }
+    float   operator () ( UINT Row, UINT Col ) const { return m[Row][Col]; }
+
+    union
+    {
+        struct
+        {
+            float _11, _12, _13, _14;
+            float _21, _22, _23, _24;
+            float _31, _32, _33, _34;
+            float _41, _42, _43, _44;
+        };
+        float m[4][4];
+    };
+};
+
+//-----------------------------------------------------------------------------
+// D3DX Math Function Stand-ins
+//-----------------------------------------------------------------------------
+inline D3DXMATRIX * D3DXMatrixIdentity( D3DXMATRIX * pOut )
+{
+    memset( (void*)pOut, 0, sizeof(D3DXMATRIX) );
+    pOut->_11 = pOut->_22 = pOut->_33 = pOut->_44 = 1.0f;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixMultiply( D3DXMATRIX * pOut, const D3DXMATRIX * pM1, const D3DXMATRIX * pM2 )
+{
+    D3DXMATRIX mtxResult;
+
+    // Calculate into a temporary so that pOut may alias either input
+    for ( int i = 0; i < 4; i++ )
+    {
+        for ( int j = 0; j < 4; j++ )
+        {
+            mtxResult.m[i][j] = pM1->m[i][0] * pM2->m[0][j] + pM1->m[i][1] * pM2->m[1][j] +
+                                pM1->m[i][2] * pM2->m[2][j] + pM1->m[i][3] * pM2->m[3][j];
+
+        } // Next Column
+
+    } // Next Row
+
+    *pOut = mtxResult;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixInverse( D3DXMATRIX * pOut, float * pDeterminant, const D3DXMATRIX * pM )
+{
+    const float (*m)[4] = pM->m;
+    D3DXMATRIX  mtxResult;
+    float       Det;
+
+    // 2x2 sub-determinants of the upper and lower row pairs
+    float s0 = m[0][0] * m[1][1] - m[1][0] * m[0][1], s1 = m[0][0] * m[1][2] - m[1][0] * m[0][2];
+    float s2 = m[0][0] * m[1][3] - m[1][0] * m[0][3], s3 = m[0][1] * m[1][2] - m[1][1] * m[0][2];
+    float s4 = m[0][1] * m[1][3] - m[1][1] * m[0][3], s5 = m[0][2] * m[1][3] - m[1][2] * m[0][3];
+    float c5 = m[2][2] * m[3][3] - m[3][2] * m[2][3], c4 = m[2][1] * m[3][3] - m[3][1] * m[2][3];
+    float c3 = m[2][1] * m[3][2] - m[3][1] * m[2][2], c2 = m[2][0] * m[3][3] - m[3][0] * m[2][3];
+    float c1 = m[2][0] * m[3][2] - m[3][0] * m[2][2], c0 = m[2][0] * m[3][1] - m[3][0] * m[2][1];
+
+    // Singular matrices cannot be inverted
+    Det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    if ( pDeterminant ) *pDeterminant = Det;
+    if ( Det == 0.0f ) return NULL;
+    Det = 1.0f / Det;
+
+    mtxResult.m[0][0] = ( m[1][1] * c5 - m[1][2] * c4 + m[1][3] * c3) * Det;
+    mtxResult.m[0][1] = (-m[0][1] * c5 + m[0][2] * c4 - m[0][3] * c3) * Det;
+    mtxResult.m[0][2] = ( m[3][1] * s5 - m[3][2] * s4 + m[3][3] * s3) * Det;
+    mtxResult.m[0][3] = (-m[2][1] * s5 + m[2][2] * s4 - m[2][3] * s3) * Det;
+    mtxResult.m[1][0] = (-m[1][0] * c5 + m[1][2] * c2 - m[1][3] * c1) * Det;
+    mtxResult.m[1][1] = ( m[0][0] * c5 - m[0][2] * c2 + m[0][3] * c1) * Det;
+    mtxResult.m[1][2] = (-m[3][0] * s5 + m[3][2] * s2 - m[3][3] * s1) * Det;
+    mtxResult.m[1][3] = ( m[2][0] * s5 - m[2][2] * s2 + m[2][3] * s1) * Det;
+    mtxResult.m[2][0] = ( m[1][0] * c4 - m[1][1] * c2 + m[1][3] * c0) * Det;
+    mtxResult.m[2][1] = (-m[0][0] * c4 + m[0][1] * c2 - m[0][3] * c0) * Det;
+    mtxResult.m[2][2] = ( m[3][0] * s4 - m[3][1] * s2 + m[3][3] * s0) * Det;
+    mtxResult.m[2][3] = (-m[2][0] * s4 + m[2][1] * s2 - m[2][3] * s0) * Det;
+    mtxResult.m[3][0] = (-m[1][0] * c3 + m[1][1] * c1 - m[1][2] * c0) * Det;
+    mtxResult.m[3][1] = ( m[0][0] * c3 - m[0][1] * c1 + m[0][2] * c0) * Det;
+    mtxResult.m[3][2] = (-m[3][0] * s3 + m[3][1] * s1 - m[3][2] * s0) * Det;
+    mtxResult.m[3][3] = ( m[2][0] * s3 - m[2][1] * s1 + m[2][2] * s0) * Det;
+
+    // Calculated into a temporary so that pOut may alias pM
+    *pOut = mtxResult;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixTranslation( D3DXMATRIX * pOut, float x, float y, float z )
+{
+    D3DXMatrixIdentity( pOut );
+    pOut->_41 = x; pOut->_42 = y; pOut->_43 = z;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixScaling( D3DXMATRIX * pOut, float sx, float sy, float sz )
+{
+    D3DXMatrixIdentity( pOut );
+    pOut->_11 = sx; pOut->_22 = sy; pOut->_33 = sz;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixRotationX( D3DXMATRIX * pOut, float Angle )
+{
+    float s = sinf( Angle ), c = cosf( Angle );
+    D3DXMatrixIdentity( pOut );
+    pOut->_22 =  c; pOut->_23 = s;
+    pOut->_32 = -s; pOut->_33 = c;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixRotationY( D3DXMATRIX * pOut, float Angle )
+{
+    float s = sinf( Angle ), c = cosf( Angle );
+    D3DXMatrixIdentity( pOut );
+    pOut->_11 = c; pOut->_13 = -s;
+    pOut->_31 = s; pOut->_33 =  c;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixRotationZ( D3DXMATRIX * pOut, float Angle )
+{
+    float s = sinf( Angle ), c = cosf( Angle );
+    D3DXMatrixIdentity( pOut );
+    pOut->_11 =  c; pOut->_12 = s;
+    pOut->_21 = -s; pOut->_22 = c;
+    return pOut;
+}
+
+inline D3DXMATRIX * D3DXMatrixPerspectiveFovLH( D3DXMATRIX * pOut, float fovy, float Aspect, float zn, float zf )
+{
+    float yScale = 1.0f / tanf( fovy / 2.0f );
+    float xScale = yScale / Aspect;
+
+    memset( (void*)pOut, 0, sizeof(D3DXMATRIX) );
+    pOut->_11 = xScale;
+    pOut->_22 = yScale;
+    pOut->_33 = zf / (zf - zn);
+    pOut->_34 = 1.0f;
+    pOut->_43 = -zn * zf / (zf - zn);
+    return pOut;
+}
+
+inline D3DXVECTOR3 * D3DXVec3TransformCoord( D3DXVECTOR3 * pOut, const D3DXVECTOR3 * pV, const D3DXMATRIX * pM )
+{
+    float x = pV->x * pM->_11 + pV->y * pM->_21 + pV->z * pM->_31 + pM->_41;
+    float y = pV->x * pM->_12 + pV->y * pM->_22 + pV->z * pM->_32 + pM->_42;
+    float z = pV->x * pM->_13 + pV->y * pM->_23 + pV->z * pM->_33 + pM->_43;
+    float w = pV->x * pM->_14 + pV->y * pM->_24 + pV->z * pM->_34 + pM->_44;
+
+    pOut->x = x / w; pOut->y = y / w; pOut->z = z / w;
+    return pOut;
+}
+
+#endif // _PLATFORM_H_
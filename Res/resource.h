@@ -7,13 +7,14 @@
 #define ID_EXIT                         40006
 #define ID_ANIM_ROTATION1               40007
 #define ID_ANIM_ROTATION2               40008
+#define ID_RENDER_SOLID                 40009
 
 // Next default values for new objects
 // 
 #ifdef APSTUDIO_INVOKED
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        103
-#define _APS_NEXT_COMMAND_VALUE         40009
+#define _APS_NEXT_COMMAND_VALUE         40010
 #define _APS_NEXT_CONTROL_VALUE         1000
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
@@ -0,0 +1,551 @@
+//-----------------------------------------------------------------------------
+// File: CBVH.cpp
+//
+// Desc: Bounding volume hierarchy over the world space bounds of scene
+//       objects, used for frustum, ray and box queries.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CBVH Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CBVH.h"
+#include <new>
+#include <float.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : HalfArea () (Local)
+// Desc : Half the surface area of a box, as used by the split heuristic.
+//-----------------------------------------------------------------------------
+static inline float HalfArea( const D3DXVECTOR3 & vecMin, const D3DXVECTOR3 & vecMax )
+{
+    float dx = vecMax.x - vecMin.x, dy = vecMax.y - vecMin.y, dz = vecMax.z - vecMin.z;
+    if ( dx < 0.0f || dy < 0.0f || dz < 0.0f ) return 0.0f;
+    return dx * dy + dy * dz + dz * dx;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GrowBox () (Local)
+// Desc : Enlarges the first box to enclose the second.
+//-----------------------------------------------------------------------------
+static inline void GrowBox( D3DXVECTOR3 & vecMin, D3DXVECTOR3 & vecMax, const D3DXVECTOR3 & vecAddMin, const D3DXVECTOR3 & vecAddMax )
+{
+    if ( vecAddMin.x < vecMin.x ) vecMin.x = vecAddMin.x;
+    if ( vecAddMin.y < vecMin.y ) vecMin.y = vecAddMin.y;
+    if ( vecAddMin.z < vecMin.z ) vecMin.z = vecAddMin.z;
+    if ( vecAddMax.x > vecMax.x ) vecMax.x = vecAddMax.x;
+    if ( vecAddMax.y > vecMax.y ) vecMax.y = vecAddMax.y;
+    if ( vecAddMax.z > vecMax.z ) vecMax.z = vecAddMax.z;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ClassifyBox () (Local)
+// Desc : Tests a box against the planes selected by Mask (inside is the
+//        positive side). Returns false if the box is entirely outside any of
+//        them, otherwise clears from Mask each plane it is entirely inside.
+//-----------------------------------------------------------------------------
+static inline bool ClassifyBox( const D3DXVECTOR3 & Min, const D3DXVECTOR3 & Max, const D3DXPLANE * pPlanes,
+                                ULONG PlaneCount, ULONG & Mask )
+{
+    for ( ULONG i = 0; i < PlaneCount; i++ )
+    {
+        const D3DXPLANE & p = pPlanes[i];
+        if ( !(Mask & (1 << i)) ) continue;
+
+        // Corner furthest inside the plane, if that is outside so is the box
+        float fInside = p.a * (p.a > 0.0f ? Max.x : Min.x) + p.b * (p.b > 0.0f ? Max.y : Min.y) +
+                        p.c * (p.c > 0.0f ? Max.z : Min.z) + p.d;
+        if ( fInside < 0.0f ) return false;
+
+        // Corner furthest outside the plane, if that is inside so is the box
+        float fOutside = p.a * (p.a > 0.0f ? Min.x : Max.x) + p.b * (p.b > 0.0f ? Min.y : Max.y) +
+                         p.c * (p.c > 0.0f ? Min.z : Max.z) + p.d;
+        if ( fOutside >= 0.0f ) Mask &= ~(1 << i);
+
+    } // Next Plane
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IntersectRay () (Local)
+// Desc : Slab test of a ray (inverse direction supplied) against a box,
+//        returning the distance at which the ray enters it, or FLT_MAX.
+//-----------------------------------------------------------------------------
+static inline float IntersectRay( const D3DXVECTOR3 & Min, const D3DXVECTOR3 & Max, const D3DXVECTOR3 & vecOrigin,
+                                  const D3DXVECTOR3 & vecInvDir, float fMaxT )
+{
+    float t1 = (Min.x - vecOrigin.x) * vecInvDir.x, t2 = (Max.x - vecOrigin.x) * vecInvDir.x;
+    float tNear = (t1 < t2) ? t1 : t2, tFar = (t1 < t2) ? t2 : t1;
+
+    t1 = (Min.y - vecOrigin.y) * vecInvDir.y; t2 = (Max.y - vecOrigin.y) * vecInvDir.y;
+    if ( t1 > t2 ) std::swap( t1, t2 );
+    if ( t1 > tNear ) tNear = t1;
+    if ( t2 < tFar  ) tFar  = t2;
+
+    t1 = (Min.z - vecOrigin.z) * vecInvDir.z; t2 = (Max.z - vecOrigin.z) * vecInvDir.z;
+    if ( t1 > t2 ) std::swap( t1, t2 );
+    if ( t1 > tNear ) tNear = t1;
+    if ( t2 < tFar  ) tFar  = t2;
+
+    // Starting inside the box counts as entering it immediately
+    if ( tNear < 0.0f ) tNear = 0.0f;
+    if ( !(tNear <= tFar) || tNear > fMaxT ) return FLT_MAX;
+    return tNear;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CBVH () (Constructor)
+// Desc : CBVH Class Constructor
+//-----------------------------------------------------------------------------
+CBVH::CBVH()
+{
+	// Reset / Clear all required values
+    m_pNodes        = NULL;
+    m_nNodeCount    = 0;
+    m_pItems        = NULL;
+    m_pItemLeaf     = NULL;
+    m_pItemMin      = NULL;
+    m_pItemMax      = NULL;
+    m_nItemCount    = 0;
+    m_nDepth        = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CBVH () (Destructor)
+// Desc : CBVH Class Destructor
+//-----------------------------------------------------------------------------
+CBVH::~CBVH()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the tree and its items.
+//-----------------------------------------------------------------------------
+void CBVH::Release( )
+{
+    if ( m_pNodes    ) delete []m_pNodes;
+    if ( m_pItems    ) delete []m_pItems;
+    if ( m_pItemLeaf ) delete []m_pItemLeaf;
+    if ( m_pItemMin  ) delete []m_pItemMin;
+    if ( m_pItemMax  ) delete []m_pItemMax;
+
+    m_pNodes        = NULL;
+    m_nNodeCount    = 0;
+    m_pItems        = NULL;
+    m_pItemLeaf     = NULL;
+    m_pItemMin      = NULL;
+    m_pItemMax      = NULL;
+    m_nItemCount    = 0;
+    m_nDepth        = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Builds the tree over the bounds specified, item 'i' being the
+//        bounds at pBounds[i].
+// Note : Any existing tree is released.
+//-----------------------------------------------------------------------------
+bool CBVH::Build( const CBounds * pBounds, ULONG Count )
+{
+    struct BUILDENTRY { ULONG Node, Depth; } Stack[ BVH_MAX_DEPTH + 1 ];
+    ULONG  StackSize = 0;
+
+    Release();
+    if ( Count == 0 ) return true;
+
+    // Allocate everything up front (a binary tree with one or more items per
+    // leaf never has more than 2n - 1 nodes)
+    m_pNodes    = new (std::nothrow) BVHNODE[ Count * 2 ];
+    m_pItems    = new (std::nothrow) ULONG[ Count ];
+    m_pItemLeaf = new (std::nothrow) ULONG[ Count ];
+    m_pItemMin  = new (std::nothrow) D3DXVECTOR3[ Count ];
+    m_pItemMax  = new (std::nothrow) D3DXVECTOR3[ Count ];
+    if ( !m_pNodes || !m_pItems || !m_pItemLeaf || !m_pItemMin || !m_pItemMax ) { Release(); return false; }
+
+    m_nItemCount = Count;
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        m_pItems[i]   = i;
+        m_pItemMin[i] = pBounds[i].m_vecMin;
+        m_pItemMax[i] = pBounds[i].m_vecMax;
+
+    } // Next Item
+
+    // Root holds everything to begin with
+    m_pNodes[0].Child  = 0;
+    m_pNodes[0].Parent = 0;
+    m_pNodes[0].First  = 0;
+    m_pNodes[0].Count  = Count;
+    m_nNodeCount = 1;
+    Stack[ StackSize ].Node = 0; Stack[ StackSize ].Depth = 0; StackSize++;
+
+    // Split nodes top down until they are small enough (or too deep)
+    while ( StackSize > 0 )
+    {
+        BUILDENTRY Entry = Stack[ --StackSize ];
+        BVHNODE  & Node  = m_pNodes[ Entry.Node ];
+        ULONG      Left  = 0;
+
+        FitNode( Entry.Node );
+        if ( Entry.Depth > m_nDepth ) m_nDepth = Entry.Depth;
+
+        if ( Node.Count > BVH_LEAF_SIZE && Entry.Depth + 1 < BVH_MAX_DEPTH ) Left = Split( Entry.Node );
+        if ( Left == 0 )
+        {
+            // Leaf, remember where each of its items lives
+            for ( ULONG i = 0; i < Node.Count; i++ ) m_pItemLeaf[ m_pItems[ Node.First + i ] ] = Entry.Node;
+            continue;
+
+        } // End if leaf
+
+        // Two children, stored side by side
+        BVHNODE & Child0 = m_pNodes[ m_nNodeCount ];
+        BVHNODE & Child1 = m_pNodes[ m_nNodeCount + 1 ];
+        Child0.Child = 0; Child0.Parent = Entry.Node; Child0.First = Node.First;        Child0.Count = Left;
+        Child1.Child = 0; Child1.Parent = Entry.Node; Child1.First = Node.First + Left; Child1.Count = Node.Count - Left;
+        Node.Child = m_nNodeCount;
+        m_nNodeCount += 2;
+
+        Stack[ StackSize ].Node = Node.Child;     Stack[ StackSize ].Depth = Entry.Depth + 1; StackSize++;
+        Stack[ StackSize ].Node = Node.Child + 1; Stack[ StackSize ].Depth = Entry.Depth + 1; StackSize++;
+
+    } // Next Node
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Split () (Private)
+// Desc : Partitions a node's items in two, choosing (from the bin boundaries
+//        along the axis with the widest spread of item centres) the split
+//        with the lowest surface area cost. Returns the number of items in
+//        the first half, or 0 if the node should remain a leaf.
+//-----------------------------------------------------------------------------
+ULONG CBVH::Split( ULONG NodeIndex )
+{
+    const BVHNODE & Node = m_pNodes[ NodeIndex ];
+    D3DXVECTOR3     BinMin[ BVH_BIN_COUNT ], BinMax[ BVH_BIN_COUNT ];
+    ULONG           BinCount[ BVH_BIN_COUNT ];
+    float           RightArea[ BVH_BIN_COUNT ];
+    ULONG          *pFirst = m_pItems + Node.First, *pLast = pFirst + Node.Count;
+    float           fCentreMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX }, fCentreMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    ULONG           Axis = 0, BestSplit = 0;
+    float           fBestCost = FLT_MAX;
+
+    // Spread of item centres (doubled, which changes nothing but saves a multiply)
+    for ( ULONG * p = pFirst; p < pLast; p++ )
+    {
+        const D3DXVECTOR3 & Min = m_pItemMin[ *p ], & Max = m_pItemMax[ *p ];
+        float c[3] = { Min.x + Max.x, Min.y + Max.y, Min.z + Max.z };
+        for ( ULONG a = 0; a < 3; a++ )
+        {
+            if ( c[a] < fCentreMin[a] ) fCentreMin[a] = c[a];
+            if ( c[a] > fCentreMax[a] ) fCentreMax[a] = c[a];
+
+        } // Next Axis
+
+    } // Next Item
+    if ( fCentreMax[1] - fCentreMin[1] > fCentreMax[Axis] - fCentreMin[Axis] ) Axis = 1;
+    if ( fCentreMax[2] - fCentreMin[2] > fCentreMax[Axis] - fCentreMin[Axis] ) Axis = 2;
+
+    // Every centre in the same place, any split is as good as another
+    float fExtent = fCentreMax[Axis] - fCentreMin[Axis];
+    if ( !(fExtent > 0.0f) ) return Node.Count / 2;
+    float fScale = (float)BVH_BIN_COUNT * 0.99999f / fExtent;
+
+    // Drop each item into a bin
+    for ( ULONG b = 0; b < BVH_BIN_COUNT; b++ )
+    {
+        BinMin[b]   = D3DXVECTOR3(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+        BinMax[b]   = D3DXVECTOR3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+        BinCount[b] = 0;
+
+    } // Next Bin
+    for ( ULONG * p = pFirst; p < pLast; p++ )
+    {
+        const D3DXVECTOR3 & Min = m_pItemMin[ *p ], & Max = m_pItemMax[ *p ];
+        float c = (&Min.x)[Axis] + (&Max.x)[Axis];
+        ULONG b = (ULONG)((c - fCentreMin[Axis]) * fScale);
+        if ( b >= BVH_BIN_COUNT ) b = BVH_BIN_COUNT - 1;
+
+        GrowBox( BinMin[b], BinMax[b], Min, Max );
+        BinCount[b]++;
+
+    } // Next Item
+
+    // Sweep from the right recording areas, then from the left evaluating
+    // the cost of splitting after each bin
+    D3DXVECTOR3 vecMin(  FLT_MAX,  FLT_MAX,  FLT_MAX ), vecMax( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+    for ( ULONG b = BVH_BIN_COUNT - 1; b > 0; b-- )
+    {
+        GrowBox( vecMin, vecMax, BinMin[b], BinMax[b] );
+        RightArea[b] = HalfArea( vecMin, vecMax );
+
+    } // Next Bin
+
+    ULONG LeftCount = 0;
+    vecMin = D3DXVECTOR3(  FLT_MAX,  FLT_MAX,  FLT_MAX ); vecMax = D3DXVECTOR3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+    for ( ULONG b = 0; b + 1 < BVH_BIN_COUNT; b++ )
+    {
+        GrowBox( vecMin, vecMax, BinMin[b], BinMax[b] );
+        LeftCount += BinCount[b];
+        if ( LeftCount == 0 || LeftCount == Node.Count ) continue;
+
+        float fCost = HalfArea( vecMin, vecMax ) * (float)LeftCount + RightArea[b + 1] * (float)(Node.Count - LeftCount);
+        if ( fCost < fBestCost ) { fBestCost = fCost; BestSplit = b; }
+
+    } // Next Split
+    if ( fBestCost == FLT_MAX ) return Node.Count / 2;
+
+    // Partition the items about the chosen bin boundary
+    float fCentreMinAxis = fCentreMin[Axis];
+    ULONG * pMid = std::partition( pFirst, pLast, [&]( ULONG Item )
+    {
+        float c = (&m_pItemMin[ Item ].x)[Axis] + (&m_pItemMax[ Item ].x)[Axis];
+        ULONG b = (ULONG)((c - fCentreMinAxis) * fScale);
+        return ((b < BVH_BIN_COUNT) ? b : BVH_BIN_COUNT - 1) <= BestSplit;
+    } );
+
+    return (ULONG)(pMid - pFirst);
+}
+
+//-----------------------------------------------------------------------------
+// Name : FitNode () (Private)
+// Desc : Recomputes a node's bounds from its children or, for a leaf, from
+//        its items.
+//-----------------------------------------------------------------------------
+void CBVH::FitNode( ULONG NodeIndex )
+{
+    BVHNODE & Node = m_pNodes[ NodeIndex ];
+
+    if ( Node.Child )
+    {
+        const BVHNODE & Child0 = m_pNodes[ Node.Child ], & Child1 = m_pNodes[ Node.Child + 1 ];
+        Node.vecMin = Child0.vecMin;
+        Node.vecMax = Child0.vecMax;
+        GrowBox( Node.vecMin, Node.vecMax, Child1.vecMin, Child1.vecMax );
+
+    } // End if internal
+    else
+    {
+        Node.vecMin = D3DXVECTOR3(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+        Node.vecMax = D3DXVECTOR3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+        for ( ULONG i = 0; i < Node.Count; i++ )
+        {
+            ULONG Item = m_pItems[ Node.First + i ];
+            GrowBox( Node.vecMin, Node.vecMax, m_pItemMin[ Item ], m_pItemMax[ Item ] );
+
+        } // Next Item
+
+    } // End if leaf
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetBounds ()
+// Desc : Changes an item's bounds without touching the tree, ready for a
+//        later call to Refit.
+// Note : Safe to call for different items from several threads at once.
+//-----------------------------------------------------------------------------
+void CBVH::SetBounds( ULONG Item, const CBounds & Bounds )
+{
+    m_pItemMin[ Item ] = Bounds.m_vecMin;
+    m_pItemMax[ Item ] = Bounds.m_vecMax;
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateBounds ()
+// Desc : Changes an item's bounds and refits the tree above it, stopping as
+//        soon as a node's bounds are unaffected.
+//-----------------------------------------------------------------------------
+void CBVH::UpdateBounds( ULONG Item, const CBounds & Bounds )
+{
+    ULONG NodeIndex = m_pItemLeaf[ Item ];
+
+    SetBounds( Item, Bounds );
+    for ( ; ; )
+    {
+        BVHNODE   & Node = m_pNodes[ NodeIndex ];
+        D3DXVECTOR3 vecOldMin = Node.vecMin, vecOldMax = Node.vecMax;
+
+        FitNode( NodeIndex );
+        if ( NodeIndex == 0 ) break;
+        if ( Node.vecMin.x == vecOldMin.x && Node.vecMin.y == vecOldMin.y && Node.vecMin.z == vecOldMin.z &&
+             Node.vecMax.x == vecOldMax.x && Node.vecMax.y == vecOldMax.y && Node.vecMax.z == vecOldMax.z ) break;
+        NodeIndex = Node.Parent;
+
+    } // Next Ancestor
+}
+
+//-----------------------------------------------------------------------------
+// Name : Refit ()
+// Desc : Recomputes every node's bounds after many items have moved.
+// Note : Children are always stored after their parent, so walking the node
+//        array backwards visits every child before its parent.
+//-----------------------------------------------------------------------------
+void CBVH::Refit( )
+{
+    for ( ULONG i = m_nNodeCount; i > 0; i-- ) FitNode( i - 1 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddRange () (Private)
+// Desc : Appends every item beneath the node to the results.
+//-----------------------------------------------------------------------------
+void CBVH::AddRange( const BVHNODE & Node, ULONG * pResults, ULONG MaxResults, ULONG & Found ) const
+{
+    for ( ULONG i = 0; i < Node.Count && Found < MaxResults; i++ ) pResults[ Found++ ] = m_pItems[ Node.First + i ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : QueryFrustum ()
+// Desc : Finds the items whose bounds are not entirely outside any of the
+//        planes specified (inside being the positive side, as produced by
+//        CTransformStage::GetFrustumPlanes). Returns the number of items
+//        written to pResults, which is never more than MaxResults.
+// Note : Planes a node is entirely inside are not tested again beneath it,
+//        and a node inside all of them returns its items without testing.
+//-----------------------------------------------------------------------------
+ULONG CBVH::QueryFrustum( const D3DXPLANE * pPlanes, ULONG PlaneCount, ULONG * pResults, ULONG MaxResults ) const
+{
+    struct QUERYENTRY { ULONG Node, Mask; } Stack[ BVH_MAX_DEPTH + 1 ];
+    ULONG  StackSize = 0, Found = 0;
+
+    if ( !m_nNodeCount || PlaneCount > 32 ) return 0;
+    Stack[ StackSize ].Node = 0;
+    Stack[ StackSize ].Mask = (PlaneCount < 32) ? (1UL << PlaneCount) - 1 : 0xFFFFFFFF;
+    StackSize++;
+
+    while ( StackSize > 0 && Found < MaxResults )
+    {
+        QUERYENTRY      Entry = Stack[ --StackSize ];
+        const BVHNODE & Node  = m_pNodes[ Entry.Node ];
+
+        if ( !ClassifyBox( Node.vecMin, Node.vecMax, pPlanes, PlaneCount, Entry.Mask ) ) continue;
+        if ( Entry.Mask == 0 ) { AddRange( Node, pResults, MaxResults, Found ); continue; }
+
+        if ( Node.Child == 0 )
+        {
+            // Leaf, test its items against whichever planes remain
+            for ( ULONG i = 0; i < Node.Count && Found < MaxResults; i++ )
+            {
+                ULONG Item = m_pItems[ Node.First + i ], Mask = Entry.Mask;
+                if ( ClassifyBox( m_pItemMin[ Item ], m_pItemMax[ Item ], pPlanes, PlaneCount, Mask ) ) pResults[ Found++ ] = Item;
+
+            } // Next Item
+            continue;
+
+        } // End if leaf
+
+        Stack[ StackSize ].Node = Node.Child + 1; Stack[ StackSize ].Mask = Entry.Mask; StackSize++;
+        Stack[ StackSize ].Node = Node.Child;     Stack[ StackSize ].Mask = Entry.Mask; StackSize++;
+
+    } // Next Node
+
+    return Found;
+}
+
+//-----------------------------------------------------------------------------
+// Name : QueryBounds ()
+// Desc : Finds the items whose bounds overlap (or touch) the box specified.
+//        Returns the number written to pResults, at most MaxResults.
+//-----------------------------------------------------------------------------
+ULONG CBVH::QueryBounds( const CBounds & Bounds, ULONG * pResults, ULONG MaxResults ) const
+{
+    const D3DXVECTOR3 & Min = Bounds.m_vecMin, & Max = Bounds.m_vecMax;
+    ULONG Stack[ BVH_MAX_DEPTH + 1 ], StackSize = 0, Found = 0;
+
+    if ( !m_nNodeCount ) return 0;
+    Stack[ StackSize++ ] = 0;
+
+    while ( StackSize > 0 && Found < MaxResults )
+    {
+        const BVHNODE & Node = m_pNodes[ Stack[ --StackSize ] ];
+
+        // Disjoint?
+        if ( Node.vecMin.x > Max.x || Node.vecMax.x < Min.x || Node.vecMin.y > Max.y || Node.vecMax.y < Min.y ||
+             Node.vecMin.z > Max.z || Node.vecMax.z < Min.z ) continue;
+
+        // Entirely contained?
+        if ( Node.vecMin.x >= Min.x && Node.vecMax.x <= Max.x && Node.vecMin.y >= Min.y && Node.vecMax.y <= Max.y &&
+             Node.vecMin.z >= Min.z && Node.vecMax.z <= Max.z ) { AddRange( Node, pResults, MaxResults, Found ); continue; }
+
+        if ( Node.Child == 0 )
+        {
+            for ( ULONG i = 0; i < Node.Count && Found < MaxResults; i++ )
+            {
+                ULONG               Item = m_pItems[ Node.First + i ];
+                const D3DXVECTOR3 & ItemMin = m_pItemMin[ Item ], & ItemMax = m_pItemMax[ Item ];
+                if ( ItemMin.x > Max.x || ItemMax.x < Min.x || ItemMin.y > Max.y || ItemMax.y < Min.y ||
+                     ItemMin.z > Max.z || ItemMax.z < Min.z ) continue;
+                pResults[ Found++ ] = Item;
+
+            } // Next Item
+            continue;
+
+        } // End if leaf
+
+        Stack[ StackSize++ ] = Node.Child + 1;
+        Stack[ StackSize++ ] = Node.Child;
+
+    } // Next Node
+
+    return Found;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RayCast ()
+// Desc : Finds the item whose bounds the ray enters first, no further than
+//        fMaxT along it (vecDir need not be normalised, distances are in
+//        multiples of it). Returns false if nothing is hit.
+// Note : Nearer children are visited first, and nodes entered beyond the
+//        closest hit so far are skipped.
+//-----------------------------------------------------------------------------
+bool CBVH::RayCast( const D3DXVECTOR3 & vecOrigin, const D3DXVECTOR3 & vecDir, float fMaxT, ULONG & Item, float & fHitT ) const
+{
+    ULONG       Stack[ BVH_MAX_DEPTH + 1 ], StackSize = 0;
+    D3DXVECTOR3 vecInvDir( 1.0f / vecDir.x, 1.0f / vecDir.y, 1.0f / vecDir.z );
+    bool        bHit = false;
+
+    if ( !m_nNodeCount ) return false;
+    if ( IntersectRay( m_pNodes[0].vecMin, m_pNodes[0].vecMax, vecOrigin, vecInvDir, fMaxT ) == FLT_MAX ) return false;
+    Stack[ StackSize++ ] = 0;
+    fHitT = fMaxT;
+
+    while ( StackSize > 0 )
+    {
+        const BVHNODE & Node = m_pNodes[ Stack[ --StackSize ] ];
+
+        if ( Node.Child == 0 )
+        {
+            for ( ULONG i = 0; i < Node.Count; i++ )
+            {
+                ULONG n = m_pItems[ Node.First + i ];
+                float t = IntersectRay( m_pItemMin[ n ], m_pItemMax[ n ], vecOrigin, vecInvDir, fHitT );
+                if ( t != FLT_MAX && (!bHit || t < fHitT) ) { fHitT = t; Item = n; bHit = true; }
+
+            } // Next Item
+            continue;
+
+        } // End if leaf
+
+        // Visit whichever child the ray enters first, skipping any it misses
+        float t0 = IntersectRay( m_pNodes[ Node.Child ].vecMin, m_pNodes[ Node.Child ].vecMax, vecOrigin, vecInvDir, fHitT );
+        float t1 = IntersectRay( m_pNodes[ Node.Child + 1 ].vecMin, m_pNodes[ Node.Child + 1 ].vecMax, vecOrigin, vecInvDir, fHitT );
+        ULONG Near = Node.Child, Far = Node.Child + 1;
+        if ( t1 < t0 ) { std::swap( t0, t1 ); std::swap( Near, Far ); }
+        if ( t1 != FLT_MAX ) Stack[ StackSize++ ] = Far;
+        if ( t0 != FLT_MAX ) Stack[ StackSize++ ] = Near;
+
+    } // Next Node
+
+    return bHit;
+}
@@ -0,0 +1,612 @@
+//-----------------------------------------------------------------------------
+// File: CEntityStore.cpp
+//
+// Desc: Archetype based storage of scene entities, each component held in
+//       its own array within fixed size chunks.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CEntityStore Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CEntityStore.h"
+#include <new>
+
+#ifdef ENTITY_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+// Largest squared half angle a step may turn through for the series below
+// to be used (a quarter turn, beyond which sinf / cosf are called)
+static const float POSE_SERIES_LIMIT = 0.6168503f;
+
+// Nested (Horner) coefficients of sin(h) / h and cos(h) in terms of h * h
+static const float g_SincTerms[4] = { 1.0f / 6.0f, 1.0f / 20.0f, 1.0f / 42.0f, 1.0f / 72.0f };
+static const float g_CosTerms[5]  = { 1.0f / 2.0f, 1.0f / 12.0f, 1.0f / 30.0f, 1.0f / 56.0f, 1.0f / 90.0f };
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : GrowArray () (Local)
+// Desc : Doubles the size of one of the store's tables, keeping its contents.
+//-----------------------------------------------------------------------------
+template <class T> static bool GrowArray( T *& pArray, ULONG Count, ULONG & Max )
+{
+    ULONG NewMax = ( Max < 16 ) ? 16 : Max * 2;
+    T   * pNew;
+
+    if ( NewMax <= Max ) return false;
+    if (!( pNew = new (std::nothrow) T[ NewMax ] )) return false;
+    if ( pArray ) { memcpy( pNew, pArray, Count * sizeof(T) ); delete []pArray; }
+    pArray = pNew;
+    Max    = NewMax;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimatePoseScalar () (Local)
+// Desc : Advances the orientation of a range of a chunk's entities by their
+//        spin, and composes their world matrices from their poses. Each
+//        step is the quaternion exp( spin * t / 2 ), evaluated by series
+//        for angles up to a quarter turn. Entities which are not spinning
+//        take an identity step, which leaves them exactly where they are.
+// Note : Evaluated in exactly the same order as the SSE2 kernel, so both
+//        produce the same results.
+//-----------------------------------------------------------------------------
+static void AnimatePoseScalar( const ENTITYCHUNK & Data, ULONG Begin, ULONG End, float fTimeElapsed, bool bRenormalise )
+{
+    float * const * pPose = Data.pPose;
+    float           fHalf = fTimeElapsed * 0.5f;
+
+    for ( ULONG i = Begin; i < End; i++ )
+    {
+        D3DXVECTOR3 vecSpin = Data.pSpin[i];
+        float       h2, fSinc, fCos, fFactor, dx, dy, dz, dw, x, y, z, w;
+
+        if ( Data.pFlags && !(Data.pFlags[i] & ENTITY_SPINNING) ) vecSpin = D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+
+        // Step quaternion
+        h2 = (vecSpin.x * vecSpin.x + vecSpin.y * vecSpin.y + vecSpin.z * vecSpin.z) * (fHalf * fHalf);
+        if ( h2 <= POSE_SERIES_LIMIT )
+        {
+            fSinc = 1.0f - (h2 * g_SincTerms[3]);
+            fSinc = 1.0f - (h2 * g_SincTerms[2]) * fSinc;
+            fSinc = 1.0f - (h2 * g_SincTerms[1]) * fSinc;
+            fSinc = 1.0f - (h2 * g_SincTerms[0]) * fSinc;
+            fCos  = 1.0f - (h2 * g_CosTerms[4]);
+            fCos  = 1.0f - (h2 * g_CosTerms[3]) * fCos;
+            fCos  = 1.0f - (h2 * g_CosTerms[2]) * fCos;
+            fCos  = 1.0f - (h2 * g_CosTerms[1]) * fCos;
+            fCos  = 1.0f - (h2 * g_CosTerms[0]) * fCos;
+
+        } // End if series
+        else
+        {
+            float h = sqrtf( h2 );
+            fSinc = sinf( h ) / h;
+            fCos  = cosf( h );
+
+        } // End if large
+        fFactor = fHalf * fSinc;
+        dx = vecSpin.x * fFactor; dy = vecSpin.y * fFactor; dz = vecSpin.z * fFactor; dw = fCos;
+
+        // Apply it in object space (orientation * step)
+        x = pPose[POSE_QX][i]; y = pPose[POSE_QY][i]; z = pPose[POSE_QZ][i]; w = pPose[POSE_QW][i];
+        float qx = ((w * dx + x * dw) + y * dz) - z * dy;
+        float qy = ((w * dy - x * dz) + y * dw) + z * dx;
+        float qz = ((w * dz + x * dy) - y * dx) + z * dw;
+        float qw = ((w * dw - x * dx) - y * dy) - z * dz;
+
+        // Rounding slowly changes its length, so pull it back now and then
+        if ( bRenormalise )
+        {
+            float fInverse = 1.0f / sqrtf( ((qx * qx + qy * qy) + qz * qz) + qw * qw );
+            qx *= fInverse; qy *= fInverse; qz *= fInverse; qw *= fInverse;
+
+        } // End if renormalising
+        pPose[POSE_QX][i] = qx; pPose[POSE_QY][i] = qy; pPose[POSE_QZ][i] = qz; pPose[POSE_QW][i] = qw;
+
+        // Compose the world matrix, dividing through by the length so that
+        // the rotation is exact whatever it is
+        float k  = 2.0f / (((qx * qx + qy * qy) + qz * qz) + qw * qw), s = pPose[POSE_SCALE][i];
+        float xs = qx * k, ys = qy * k, zs = qz * k;
+        float xx = qx * xs, yy = qy * ys, zz = qz * zs, xy = qx * ys, xz = qx * zs, yz = qy * zs;
+        float wx = qw * xs, wy = qw * ys, wz = qw * zs;
+        D3DXMATRIX & mtxWorld = Data.pWorld[i];
+
+        mtxWorld._11 = (1.0f - (yy + zz)) * s; mtxWorld._12 = (xy + wz) * s; mtxWorld._13 = (xz - wy) * s; mtxWorld._14 = 0.0f;
+        mtxWorld._21 = (xy - wz) * s; mtxWorld._22 = (1.0f - (xx + zz)) * s; mtxWorld._23 = (yz + wx) * s; mtxWorld._24 = 0.0f;
+        mtxWorld._31 = (xz + wy) * s; mtxWorld._32 = (yz - wx) * s; mtxWorld._33 = (1.0f - (xx + yy)) * s; mtxWorld._34 = 0.0f;
+        mtxWorld._41 = pPose[POSE_X][i]; mtxWorld._42 = pPose[POSE_Y][i]; mtxWorld._43 = pPose[POSE_Z][i]; mtxWorld._44 = 1.0f;
+
+    } // Next Entity
+}
+
+#ifdef ENTITY_SIMD_SSE2
+//-----------------------------------------------------------------------------
+// Name : AnimatePoseSSE2 () (Local)
+// Desc : As AnimatePoseScalar, four entities at a time. Groups in which any
+//        entity turns too far in one step for the series are handed to the
+//        scalar kernel, as is any remainder.
+//-----------------------------------------------------------------------------
+static void AnimatePoseSSE2( const ENTITYCHUNK & Data, ULONG Begin, ULONG End, float fTimeElapsed, bool bRenormalise )
+{
+    float * const * pPose = Data.pPose;
+    __m128  Half = _mm_set1_ps( fTimeElapsed * 0.5f ), Limit = _mm_set1_ps( POSE_SERIES_LIMIT );
+    __m128  One  = _mm_set1_ps( 1.0f ), Two = _mm_set1_ps( 2.0f ), Zero = _mm_setzero_ps();
+    __m128i Spinning = _mm_set1_epi32( ENTITY_SPINNING );
+    __m128  Sinc[4], Cos[5];
+    ULONG   i;
+
+    for ( ULONG t = 0; t < 4; t++ ) Sinc[t] = _mm_set1_ps( g_SincTerms[t] );
+    for ( ULONG t = 0; t < 5; t++ ) Cos[t]  = _mm_set1_ps( g_CosTerms[t] );
+
+    for ( i = Begin; i + 4 <= End; i += 4 )
+    {
+        const float * pIn = &Data.pSpin[i].x;
+
+        // Transpose the spin vectors into x, y and z registers
+        __m128 a = _mm_loadu_ps( pIn );
+        __m128 b = _mm_loadu_ps( pIn + 4 );
+        __m128 c = _mm_loadu_ps( pIn + 8 );
+        __m128 t = _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 1, 3, 2 ) );
+        __m128 X = _mm_shuffle_ps( a, t, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+        __m128 Y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), t, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        __m128 Z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ),
+                                   _mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+        // Entities which are not spinning take an identity step
+        if ( Data.pFlags )
+        {
+            __m128i Flags = _mm_loadu_si128( (const __m128i*)&Data.pFlags[i] );
+            __m128  Mask  = _mm_castsi128_ps( _mm_cmpeq_epi32( _mm_and_si128( Flags, Spinning ), Spinning ) );
+            X = _mm_and_ps( X, Mask ); Y = _mm_and_ps( Y, Mask ); Z = _mm_and_ps( Z, Mask );
+
+        } // End if flags
+
+        // Step quaternions
+        __m128 h2 = _mm_mul_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, X ), _mm_mul_ps( Y, Y ) ), _mm_mul_ps( Z, Z ) ), _mm_mul_ps( Half, Half ) );
+        if ( _mm_movemask_ps( _mm_cmpgt_ps( h2, Limit ) ) ) { AnimatePoseScalar( Data, i, i + 4, fTimeElapsed, bRenormalise ); continue; }
+
+        __m128 S = _mm_sub_ps( One, _mm_mul_ps( h2, Sinc[3] ) );
+        S = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Sinc[2] ), S ) );
+        S = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Sinc[1] ), S ) );
+        S = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Sinc[0] ), S ) );
+        __m128 dw = _mm_sub_ps( One, _mm_mul_ps( h2, Cos[4] ) );
+        dw = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Cos[3] ), dw ) );
+        dw = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Cos[2] ), dw ) );
+        dw = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Cos[1] ), dw ) );
+        dw = _mm_sub_ps( One, _mm_mul_ps( _mm_mul_ps( h2, Cos[0] ), dw ) );
+        __m128 Factor = _mm_mul_ps( Half, S );
+        __m128 dx = _mm_mul_ps( X, Factor ), dy = _mm_mul_ps( Y, Factor ), dz = _mm_mul_ps( Z, Factor );
+
+        // Apply them in object space (orientation * step)
+        __m128 x = _mm_loadu_ps( &pPose[POSE_QX][i] ), y = _mm_loadu_ps( &pPose[POSE_QY][i] );
+        __m128 z = _mm_loadu_ps( &pPose[POSE_QZ][i] ), w = _mm_loadu_ps( &pPose[POSE_QW][i] );
+        __m128 qx = _mm_sub_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( w, dx ), _mm_mul_ps( x, dw ) ), _mm_mul_ps( y, dz ) ), _mm_mul_ps( z, dy ) );
+        __m128 qy = _mm_add_ps( _mm_add_ps( _mm_sub_ps( _mm_mul_ps( w, dy ), _mm_mul_ps( x, dz ) ), _mm_mul_ps( y, dw ) ), _mm_mul_ps( z, dx ) );
+        __m128 qz = _mm_add_ps( _mm_sub_ps( _mm_add_ps( _mm_mul_ps( w, dz ), _mm_mul_ps( x, dy ) ), _mm_mul_ps( y, dx ) ), _mm_mul_ps( z, dw ) );
+        __m128 qw = _mm_sub_ps( _mm_sub_ps( _mm_sub_ps( _mm_mul_ps( w, dw ), _mm_mul_ps( x, dx ) ), _mm_mul_ps( y, dy ) ), _mm_mul_ps( z, dz ) );
+        __m128 Norm = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( qx, qx ), _mm_mul_ps( qy, qy ) ), _mm_mul_ps( qz, qz ) ), _mm_mul_ps( qw, qw ) );
+
+        if ( bRenormalise )
+        {
+            __m128 Inverse = _mm_div_ps( One, _mm_sqrt_ps( Norm ) );
+            qx = _mm_mul_ps( qx, Inverse ); qy = _mm_mul_ps( qy, Inverse );
+            qz = _mm_mul_ps( qz, Inverse ); qw = _mm_mul_ps( qw, Inverse );
+            Norm = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( qx, qx ), _mm_mul_ps( qy, qy ) ), _mm_mul_ps( qz, qz ) ), _mm_mul_ps( qw, qw ) );
+
+        } // End if renormalising
+        _mm_storeu_ps( &pPose[POSE_QX][i], qx ); _mm_storeu_ps( &pPose[POSE_QY][i], qy );
+        _mm_storeu_ps( &pPose[POSE_QZ][i], qz ); _mm_storeu_ps( &pPose[POSE_QW][i], qw );
+
+        // Compose the world matrices
+        __m128 k  = _mm_div_ps( Two, Norm ), s = _mm_loadu_ps( &pPose[POSE_SCALE][i] );
+        __m128 xs = _mm_mul_ps( qx, k ), ys = _mm_mul_ps( qy, k ), zs = _mm_mul_ps( qz, k );
+        __m128 xx = _mm_mul_ps( qx, xs ), yy = _mm_mul_ps( qy, ys ), zz = _mm_mul_ps( qz, zs );
+        __m128 xy = _mm_mul_ps( qx, ys ), xz = _mm_mul_ps( qx, zs ), yz = _mm_mul_ps( qy, zs );
+        __m128 wx = _mm_mul_ps( qw, xs ), wy = _mm_mul_ps( qw, ys ), wz = _mm_mul_ps( qw, zs );
+
+        __m128 r0 = _mm_mul_ps( _mm_sub_ps( One, _mm_add_ps( yy, zz ) ), s ), r1 = _mm_mul_ps( _mm_add_ps( xy, wz ), s );
+        __m128 r2 = _mm_mul_ps( _mm_sub_ps( xz, wy ), s ), r3 = Zero;
+        __m128 u0 = _mm_mul_ps( _mm_sub_ps( xy, wz ), s ), u1 = _mm_mul_ps( _mm_sub_ps( One, _mm_add_ps( xx, zz ) ), s );
+        __m128 u2 = _mm_mul_ps( _mm_add_ps( yz, wx ), s ), u3 = Zero;
+        __m128 v0 = _mm_mul_ps( _mm_add_ps( xz, wy ), s ), v1 = _mm_mul_ps( _mm_sub_ps( yz, wx ), s );
+        __m128 v2 = _mm_mul_ps( _mm_sub_ps( One, _mm_add_ps( xx, yy ) ), s ), v3 = Zero;
+        __m128 p0 = _mm_loadu_ps( &pPose[POSE_X][i] ), p1 = _mm_loadu_ps( &pPose[POSE_Y][i] );
+        __m128 p2 = _mm_loadu_ps( &pPose[POSE_Z][i] ), p3 = One;
+
+        // Transpose each row from one register per element to one per entity
+        _MM_TRANSPOSE4_PS( r0, r1, r2, r3 );
+        _MM_TRANSPOSE4_PS( u0, u1, u2, u3 );
+        _MM_TRANSPOSE4_PS( v0, v1, v2, v3 );
+        _MM_TRANSPOSE4_PS( p0, p1, p2, p3 );
+
+        float * pOut = &Data.pWorld[i]._11;
+        _mm_storeu_ps( pOut,      r0 ); _mm_storeu_ps( pOut + 4,  u0 ); _mm_storeu_ps( pOut + 8,  v0 ); _mm_storeu_ps( pOut + 12, p0 );
+        _mm_storeu_ps( pOut + 16, r1 ); _mm_storeu_ps( pOut + 20, u1 ); _mm_storeu_ps( pOut + 24, v1 ); _mm_storeu_ps( pOut + 28, p1 );
+        _mm_storeu_ps( pOut + 32, r2 ); _mm_storeu_ps( pOut + 36, u2 ); _mm_storeu_ps( pOut + 40, v2 ); _mm_storeu_ps( pOut + 44, p2 );
+        _mm_storeu_ps( pOut + 48, r3 ); _mm_storeu_ps( pOut + 52, u3 ); _mm_storeu_ps( pOut + 56, v3 ); _mm_storeu_ps( pOut + 60, p3 );
+
+    } // Next Group
+
+    // Remaining entities
+    AnimatePoseScalar( Data, i, End, fTimeElapsed, bRenormalise );
+}
+#endif // ENTITY_SIMD_SSE2
+
+//-----------------------------------------------------------------------------
+// CEntityStore Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CEntityStore () (Constructor)
+// Desc : CEntityStore Class Constructor
+//-----------------------------------------------------------------------------
+CEntityStore::CEntityStore()
+{
+	// Reset / Clear all required values
+    m_pChunks       = NULL;
+    m_nChunkCount   = 0;
+    m_nChunkMax     = 0;
+    m_pRecords      = NULL;
+    m_nRecordCount  = 0;
+    m_nRecordMax    = 0;
+    m_nFreeRecord   = ENTITY_INVALID;
+    m_nEntityCount  = 0;
+    m_pMeshes       = NULL;
+    m_nMeshCount    = 0;
+    m_nMeshMax      = 0;
+    for ( ULONG i = 0; i < ENTITY_MAX_ARCHETYPES; i++ ) m_pOpenChunk[i] = ENTITY_INVALID;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CEntityStore () (Destructor)
+// Desc : CEntityStore Class Destructor
+//-----------------------------------------------------------------------------
+CEntityStore::~CEntityStore()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Destroys every entity and forgets every mesh.
+//-----------------------------------------------------------------------------
+void CEntityStore::Release( )
+{
+    for ( ULONG i = 0; i < m_nChunkCount; i++ ) delete []m_pChunks[i].pMemory;
+    if ( m_pChunks  ) delete []m_pChunks;
+    if ( m_pRecords ) delete []m_pRecords;
+    if ( m_pMeshes  ) delete []m_pMeshes;
+
+    m_pChunks       = NULL;
+    m_nChunkCount   = 0;
+    m_nChunkMax     = 0;
+    m_pRecords      = NULL;
+    m_nRecordCount  = 0;
+    m_nRecordMax    = 0;
+    m_nFreeRecord   = ENTITY_INVALID;
+    m_nEntityCount  = 0;
+    m_pMeshes       = NULL;
+    m_nMeshCount    = 0;
+    m_nMeshMax      = 0;
+    for ( ULONG i = 0; i < ENTITY_MAX_ARCHETYPES; i++ ) m_pOpenChunk[i] = ENTITY_INVALID;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddMesh ()
+// Desc : Registers a mesh (and optional detail chain) for entities to refer
+//        to, returning its handle (ENTITY_INVALID on failure).
+//-----------------------------------------------------------------------------
+ULONG CEntityStore::AddMesh( CIndexedMesh * pMesh, CLODChain * pLOD )
+{
+    if ( m_nMeshCount == m_nMeshMax && !GrowArray( m_pMeshes, m_nMeshCount, m_nMeshMax ) ) return ENTITY_INVALID;
+
+    m_pMeshes[ m_nMeshCount ].pMesh = pMesh;
+    m_pMeshes[ m_nMeshCount ].pLOD  = pLOD;
+    return m_nMeshCount++;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Creates an entity with the given components (ENTITYCOMPONENT), all
+//        set to defaults: an identity world matrix, no spin, mesh handle 0,
+//        no flags and an identity pose. Returns its handle (ENTITY_INVALID on failure).
+//-----------------------------------------------------------------------------
+ULONG CEntityStore::Create( ULONG Archetype )
+{
+    ULONG Chunk, Entity, Slot;
+
+    Archetype &= COMPONENT_ALL;
+
+    // Room in the archetype's open chunk?
+    Chunk = m_pOpenChunk[ Archetype ];
+    if ( Chunk == ENTITY_INVALID || m_pChunks[ Chunk ].Count == ENTITY_CHUNK_SIZE )
+    {
+        if ( (Chunk = AllocateChunk( Archetype )) == ENTITY_INVALID ) return ENTITY_INVALID;
+        m_pOpenChunk[ Archetype ] = Chunk;
+
+    } // End if full
+    if ( (Entity = AllocateRecord()) == ENTITY_INVALID ) return ENTITY_INVALID;
+
+    // Fill in the next slot
+    ENTITYCHUNK & Data = m_pChunks[ Chunk ];
+    Slot = Data.Count++;
+    Data.pEntity[ Slot ] = Entity;
+    if ( Data.pWorld ) D3DXMatrixIdentity( &Data.pWorld[ Slot ] );
+    if ( Data.pSpin  ) Data.pSpin[ Slot ] = D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+    if ( Data.pMesh  ) Data.pMesh[ Slot ] = 0;
+    if ( Data.pFlags ) Data.pFlags[ Slot ] = 0;
+    if ( Data.pPose[0] )
+    {
+        for ( ULONG i = 0; i < POSE_COUNT; i++ ) Data.pPose[i][ Slot ] = 0.0f;
+        Data.pPose[ POSE_QW ][ Slot ] = 1.0f;
+        Data.pPose[ POSE_SCALE ][ Slot ] = 1.0f;
+
+    } // End if pose
+
+    m_pRecords[ Entity ].Chunk = Chunk;
+    m_pRecords[ Entity ].Slot  = Slot;
+    m_nEntityCount++;
+    return Entity;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Destroy ()
+// Desc : Destroys an entity, moving the last entity of its archetype into
+//        the slot it leaves so that every chunk stays packed.
+//-----------------------------------------------------------------------------
+void CEntityStore::Destroy( ULONG Entity )
+{
+    ULONG Chunk, Slot, Open;
+
+    if ( Entity >= m_nRecordCount || m_pRecords[ Entity ].Chunk == ENTITY_INVALID ) return;
+    Chunk = m_pRecords[ Entity ].Chunk;
+    Slot  = m_pRecords[ Entity ].Slot;
+    Open  = m_pOpenChunk[ m_pChunks[ Chunk ].Archetype ];
+
+    // Fill the hole with the archetype's last entity
+    ENTITYCHUNK & Last = m_pChunks[ Open ];
+    ULONG         LastSlot = Last.Count - 1;
+    if ( Open != Chunk || LastSlot != Slot )
+    {
+        CopySlot( m_pChunks[ Chunk ], Slot, Last, LastSlot );
+        m_pRecords[ m_pChunks[ Chunk ].pEntity[ Slot ] ].Slot  = Slot;
+        m_pRecords[ m_pChunks[ Chunk ].pEntity[ Slot ] ].Chunk = Chunk;
+
+    } // End if moved
+    Last.Count--;
+
+    // Free the record
+    m_pRecords[ Entity ].Chunk = ENTITY_INVALID;
+    m_pRecords[ Entity ].Slot  = m_nFreeRecord;
+    m_nFreeRecord = Entity;
+    m_nEntityCount--;
+
+    // An emptied chunk is released, the last chunk taking its place, and
+    // any full chunk of the archetype becomes the one left open
+    if ( Last.Count == 0 )
+    {
+        ULONG Archetype = Last.Archetype, Moved = m_nChunkCount - 1;
+
+        delete []Last.pMemory;
+        if ( Open != Moved )
+        {
+            ENTITYCHUNK & Dest = m_pChunks[ Open ];
+
+            Dest = m_pChunks[ Moved ];
+            for ( ULONG i = 0; i < Dest.Count; i++ ) m_pRecords[ Dest.pEntity[i] ].Chunk = Open;
+            if ( m_pOpenChunk[ Dest.Archetype ] == Moved ) m_pOpenChunk[ Dest.Archetype ] = Open;
+
+        } // End if moved
+        m_nChunkCount--;
+
+        m_pOpenChunk[ Archetype ] = ENTITY_INVALID;
+        for ( ULONG i = 0; i < m_nChunkCount; i++ )
+        {
+            if ( m_pChunks[i].Archetype == Archetype ) { m_pOpenChunk[ Archetype ] = i; break; }
+
+        } // Next Chunk
+
+    } // End if emptied
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetWorld ()
+// Desc : Returns the entity's world matrix (NULL if it has none).
+//-----------------------------------------------------------------------------
+D3DXMATRIX * CEntityStore::GetWorld( ULONG Entity ) const
+{
+    const ENTITYRECORD & Record = m_pRecords[ Entity ];
+    const ENTITYCHUNK  & Chunk  = m_pChunks[ Record.Chunk ];
+    return Chunk.pWorld ? &Chunk.pWorld[ Record.Slot ] : NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetSpin ()
+// Desc : Returns the entity's angular velocity (NULL if it has none).
+//-----------------------------------------------------------------------------
+D3DXVECTOR3 * CEntityStore::GetSpin( ULONG Entity ) const
+{
+    const ENTITYRECORD & Record = m_pRecords[ Entity ];
+    const ENTITYCHUNK  & Chunk  = m_pChunks[ Record.Chunk ];
+    return Chunk.pSpin ? &Chunk.pSpin[ Record.Slot ] : NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetMeshHandle ()
+// Desc : Returns the entity's mesh handle (NULL if it has none).
+//-----------------------------------------------------------------------------
+ULONG * CEntityStore::GetMeshHandle( ULONG Entity ) const
+{
+    const ENTITYRECORD & Record = m_pRecords[ Entity ];
+    const ENTITYCHUNK  & Chunk  = m_pChunks[ Record.Chunk ];
+    return Chunk.pMesh ? &Chunk.pMesh[ Record.Slot ] : NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFlags ()
+// Desc : Returns the entity's flags (NULL if it has none).
+//-----------------------------------------------------------------------------
+ULONG * CEntityStore::GetFlags( ULONG Entity ) const
+{
+    const ENTITYRECORD & Record = m_pRecords[ Entity ];
+    const ENTITYCHUNK  & Chunk  = m_pChunks[ Record.Chunk ];
+    return Chunk.pFlags ? &Chunk.pFlags[ Record.Slot ] : NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetPose ()
+// Desc : Places a posed entity, unrotated, at the given position and scale
+//        (its world matrix being updated to match).
+//-----------------------------------------------------------------------------
+void CEntityStore::SetPose( ULONG Entity, const D3DXVECTOR3 & vecPosition, float fScale )
+{
+    const ENTITYRECORD & Record = m_pRecords[ Entity ];
+    const ENTITYCHUNK  & Chunk  = m_pChunks[ Record.Chunk ];
+    ULONG                Slot   = Record.Slot;
+
+    if ( !Chunk.pPose[0] ) return;
+    Chunk.pPose[ POSE_QX ][ Slot ] = 0.0f;
+    Chunk.pPose[ POSE_QY ][ Slot ] = 0.0f;
+    Chunk.pPose[ POSE_QZ ][ Slot ] = 0.0f;
+    Chunk.pPose[ POSE_QW ][ Slot ] = 1.0f;
+    Chunk.pPose[ POSE_X ][ Slot ]  = vecPosition.x;
+    Chunk.pPose[ POSE_Y ][ Slot ]  = vecPosition.y;
+    Chunk.pPose[ POSE_Z ][ Slot ]  = vecPosition.z;
+    Chunk.pPose[ POSE_SCALE ][ Slot ] = fScale;
+
+    if ( Chunk.pWorld )
+    {
+        D3DXMATRIX & mtxWorld = Chunk.pWorld[ Slot ];
+        D3DXMatrixScaling( &mtxWorld, fScale, fScale, fScale );
+        mtxWorld._41 = vecPosition.x; mtxWorld._42 = vecPosition.y; mtxWorld._43 = vecPosition.z;
+
+    } // End if world
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateChunk ()
+// Desc : Rotates every spinning entity of the chunk by its angular velocity
+//        over the time elapsed. Posed entities are turned about their spin
+//        vector and have their world matrices rebuilt, the rest are rotated
+//        in place (yaw, then pitch, then roll, in object space).
+// Note : Chunks are independent, so may be animated on different threads.
+//-----------------------------------------------------------------------------
+void CEntityStore::AnimateChunk( ULONG Chunk, float fTimeElapsed )
+{
+    ENTITYCHUNK & Data = m_pChunks[ Chunk ];
+    D3DXMATRIX    mtxYaw, mtxPitch, mtxRoll, mtxRotate;
+
+    if ( !Data.pWorld || !Data.pSpin ) return;
+
+    // Posed entities take the quaternion kernel
+    if ( Data.pPose[0] )
+    {
+        bool bRenormalise = (++Data.Steps % ENTITY_RENORMALISE_STEPS) == 0;
+#ifdef ENTITY_SIMD_SSE2
+        AnimatePoseSSE2( Data, 0, Data.Count, fTimeElapsed, bRenormalise );
+#else
+        AnimatePoseScalar( Data, 0, Data.Count, fTimeElapsed, bRenormalise );
+#endif
+        return;
+
+    } // End if posed
+    for ( ULONG i = 0; i < Data.Count; i++ )
+    {
+        const D3DXVECTOR3 & vecSpin = Data.pSpin[i];
+        if ( Data.pFlags && !(Data.pFlags[i] & ENTITY_SPINNING) ) continue;
+
+        // Build, and concatenate, the rotation matrices
+        D3DXMatrixRotationY( &mtxYaw,   vecSpin.y * fTimeElapsed );
+        D3DXMatrixRotationX( &mtxPitch, vecSpin.x * fTimeElapsed );
+        D3DXMatrixRotationZ( &mtxRoll,  vecSpin.z * fTimeElapsed );
+        D3DXMatrixMultiply( &mtxRotate, &mtxYaw, &mtxPitch );
+        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxRoll );
+
+        // Apply the rotation to the entity's matrix
+        D3DXMatrixMultiply( &Data.pWorld[i], &mtxRotate, &Data.pWorld[i] );
+
+    } // Next Entity
+}
+
+//-----------------------------------------------------------------------------
+// Name : AllocateChunk () (Private)
+// Desc : Adds an empty chunk for the given archetype, carving each of its
+//        component arrays from a single allocation.
+//-----------------------------------------------------------------------------
+ULONG CEntityStore::AllocateChunk( ULONG Archetype )
+{
+    size_t Size = ENTITY_CHUNK_SIZE * sizeof(ULONG);
+    BYTE * pMemory;
+
+    if ( m_nChunkCount == m_nChunkMax && !GrowArray( m_pChunks, m_nChunkCount, m_nChunkMax ) ) return ENTITY_INVALID;
+
+    // Largest components first, keeping the matrices aligned
+    if ( Archetype & COMPONENT_WORLD ) Size += ENTITY_CHUNK_SIZE * sizeof(D3DXMATRIX);
+    if ( Archetype & COMPONENT_SPIN  ) Size += ENTITY_CHUNK_SIZE * sizeof(D3DXVECTOR3);
+    if ( Archetype & COMPONENT_MESH  ) Size += ENTITY_CHUNK_SIZE * sizeof(ULONG);
+    if ( Archetype & COMPONENT_FLAGS ) Size += ENTITY_CHUNK_SIZE * sizeof(ULONG);
+    if ( Archetype & COMPONENT_POSE  ) Size += ENTITY_CHUNK_SIZE * sizeof(float) * POSE_COUNT;
+    if (!( pMemory = new (std::nothrow) BYTE[ Size ] )) return ENTITY_INVALID;
+
+    ENTITYCHUNK & Chunk = m_pChunks[ m_nChunkCount ];
+    ZeroMemory( &Chunk, sizeof(ENTITYCHUNK) );
+    Chunk.Archetype = Archetype;
+    Chunk.pMemory   = pMemory;
+    if ( Archetype & COMPONENT_WORLD ) { Chunk.pWorld = (D3DXMATRIX*)pMemory;  pMemory += ENTITY_CHUNK_SIZE * sizeof(D3DXMATRIX); }
+    if ( Archetype & COMPONENT_SPIN  ) { Chunk.pSpin  = (D3DXVECTOR3*)pMemory; pMemory += ENTITY_CHUNK_SIZE * sizeof(D3DXVECTOR3); }
+    if ( Archetype & COMPONENT_MESH  ) { Chunk.pMesh  = (ULONG*)pMemory;       pMemory += ENTITY_CHUNK_SIZE * sizeof(ULONG); }
+    if ( Archetype & COMPONENT_FLAGS ) { Chunk.pFlags = (ULONG*)pMemory;       pMemory += ENTITY_CHUNK_SIZE * sizeof(ULONG); }
+    if ( Archetype & COMPONENT_POSE  )
+    {
+        for ( ULONG i = 0; i < POSE_COUNT; i++ ) { Chunk.pPose[i] = (float*)pMemory; pMemory += ENTITY_CHUNK_SIZE * sizeof(float); }
+
+    } // End if pose
+    Chunk.pEntity = (ULONG*)pMemory;
+
+    return m_nChunkCount++;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AllocateRecord () (Private)
+// Desc : Finds a free entity handle, reusing destroyed ones first.
+//-----------------------------------------------------------------------------
+ULONG CEntityStore::AllocateRecord( )
+{
+    ULONG Entity = m_nFreeRecord;
+
+    if ( Entity != ENTITY_INVALID )
+    {
+        m_nFreeRecord = m_pRecords[ Entity ].Slot;
+        return Entity;
+
+    } // End if free
+
+    if ( m_nRecordCount == m_nRecordMax && !GrowArray( m_pRecords, m_nRecordCount, m_nRecordMax ) ) return ENTITY_INVALID;
+    return m_nRecordCount++;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CopySlot () (Private)
+// Desc : Copies every component of one slot to another (both chunks being
+//        of the same archetype).
+//-----------------------------------------------------------------------------
+void CEntityStore::CopySlot( ENTITYCHUNK & Dest, ULONG DestSlot, const ENTITYCHUNK & Source, ULONG SourceSlot )
+{
+    Dest.pEntity[ DestSlot ] = Source.pEntity[ SourceSlot ];
+    if ( Dest.pWorld ) Dest.pWorld[ DestSlot ] = Source.pWorld[ SourceSlot ];
+    if ( Dest.pSpin  ) Dest.pSpin[ DestSlot ]  = Source.pSpin[ SourceSlot ];
+    if ( Dest.pMesh  ) Dest.pMesh[ DestSlot ]  = Source.pMesh[ SourceSlot ];
+    if ( Dest.pFlags ) Dest.pFlags[ DestSlot ] = Source.pFlags[ SourceSlot ];
+    if ( Dest.pPose[0] )
+    {
+        for ( ULONG i = 0; i < POSE_COUNT; i++ ) Dest.pPose[i][ DestSlot ] = Source.pPose[i][ SourceSlot ];
+
+    } // End if pose
+}
@@ -0,0 +1,224 @@
+//-----------------------------------------------------------------------------
+// File: CFlightRecorder.cpp
+//
+// Desc: Always-on record of the most recent frames' timings and counts,
+//       written out around any frame which takes too long (a hitch).
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFlightRecorder Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CFlightRecorder.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static const char * g_pszStageNames[ FLIGHT_STAGE_COUNT ] =
+{
+    "animate", "cull", "occlude", "transform", "draw", "rasterize", "overlay", "present", "wait"
+};
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : ReadCounter () (Local)
+// Desc : Returns the current performance counter value.
+//-----------------------------------------------------------------------------
+static inline __int64 ReadCounter( )
+{
+    __int64 Counter;
+    QueryPerformanceCounter( (LARGE_INTEGER*)&Counter );
+    return Counter;
+}
+
+//-----------------------------------------------------------------------------
+// CFlightRecorder Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CFlightRecorder () (Constructor)
+// Desc : CFlightRecorder Class Constructor
+//-----------------------------------------------------------------------------
+CFlightRecorder::CFlightRecorder()
+{
+    // Reset / Clear all required values
+    m_pRecords      = NULL;
+    m_szPrefix[0]   = '\0';
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFlightRecorder () (Destructor)
+// Desc : CFlightRecorder Class Destructor
+//-----------------------------------------------------------------------------
+CFlightRecorder::~CFlightRecorder()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates the ring, after which frames may be recorded without any
+//        further allocation. Frames taking longer than fHitchTime seconds
+//        are counted as hitches, and written out in a dump unless
+//        FilePrefix is NULL.
+//-----------------------------------------------------------------------------
+bool CFlightRecorder::Create( float fHitchTime, ULONG PreFrames, ULONG PostFrames, LPCTSTR FilePrefix )
+{
+    __int64 Frequency;
+
+    Release();
+    if ( !QueryPerformanceFrequency( (LARGE_INTEGER*)&Frequency ) ) return false;
+    if ( FilePrefix && strlen( FilePrefix ) >= FLIGHT_PREFIX_LENGTH ) return false;
+
+    m_nCapacity = PreFrames + 1 + PostFrames;
+    if (!( m_pRecords = new (std::nothrow) FLIGHTRECORD[ m_nCapacity ] )) { m_nCapacity = 0; return false; }
+
+    m_TimeScale   = 1.0f / (float)Frequency;
+    m_fHitchTime  = fHitchTime;
+    m_nPostFrames = PostFrames;
+    m_bDump       = ( FilePrefix != NULL );
+    if ( m_bDump ) strcpy( m_szPrefix, FilePrefix );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the ring, and forgets every frame recorded.
+//-----------------------------------------------------------------------------
+void CFlightRecorder::Release( )
+{
+    if ( m_pRecords ) delete []m_pRecords;
+    m_pRecords      = NULL;
+    m_nCapacity     = 0;
+    m_nCount        = 0;
+    m_nCurrent      = 0;
+    m_nFrame        = 0;
+    m_bOpen         = false;
+    m_MarkTime      = 0;
+    m_TimeScale     = 0.0f;
+    m_fHitchTime    = 0.0f;
+    m_nPostFrames   = 0;
+    m_nPending      = 0;
+    m_nHitchFrame   = 0;
+    m_bSkipNext     = false;
+    m_nHitchCount   = 0;
+    m_nDumpCount    = 0;
+    m_bDump         = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BeginFrame ()
+// Desc : Completes the previous frame, whose length the timer has just
+//        measured, writing a dump if it ends a capture, then starts the next.
+// Note : The first frame is never taken as a hitch, as it pays for warming
+//        every cache and buffer.
+//-----------------------------------------------------------------------------
+void CFlightRecorder::BeginFrame( float fLastFrameTime )
+{
+    __int64 Now = ReadCounter();
+
+    if ( !m_pRecords ) return;
+    if ( m_bOpen )
+    {
+        FLIGHTRECORD & Record = m_pRecords[ m_nCurrent ];
+        bool           bHitch = ( fLastFrameTime > m_fHitchTime && Record.Frame > 0 && !m_bSkipNext );
+
+        Record.StageTime[ FLIGHT_WAIT ] = (Now - m_MarkTime) * m_TimeScale;
+        Record.FrameTime = fLastFrameTime;
+        if ( m_nCount < m_nCapacity ) m_nCount++;
+        m_bSkipNext = false;
+
+        // A hitch starts a capture, unless one is under way already
+        if ( bHitch )
+        {
+            m_nHitchCount++;
+            if ( m_bDump && m_nPending == 0 && m_nDumpCount < FLIGHT_MAX_DUMPS )
+            {
+                m_nPending    = m_nPostFrames + 1;
+                m_nHitchFrame = Record.Frame;
+
+            } // End if not capturing
+
+        } // End if hitch
+
+        // Write out a capture once the frames after it are in
+        if ( m_nPending > 0 && --m_nPending == 0 )
+        {
+            if ( WriteDump() ) m_nDumpCount++;
+            m_bSkipNext = true;
+            Now = ReadCounter();
+
+        } // End if capture complete
+
+        m_nCurrent = (m_nCurrent + 1) % m_nCapacity;
+
+    } // End if frame open
+
+    // Start the next record
+    FLIGHTRECORD & Record = m_pRecords[ m_nCurrent ];
+    ZeroMemory( &Record, sizeof(FLIGHTRECORD) );
+    Record.Frame = m_nFrame++;
+    m_MarkTime   = Now;
+    m_bOpen      = true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MarkStage ()
+// Desc : Ends the given stage of the frame in progress, which began when the
+//        last stage (or the frame) did.
+//-----------------------------------------------------------------------------
+void CFlightRecorder::MarkStage( FLIGHTSTAGE Stage )
+{
+    __int64 Now = ReadCounter();
+
+    if ( !m_bOpen ) return;
+    m_pRecords[ m_nCurrent ].StageTime[ Stage ] += (Now - m_MarkTime) * m_TimeScale;
+    m_MarkTime = Now;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStageName () (Static)
+// Desc : Returns the name a stage is written under.
+//-----------------------------------------------------------------------------
+const char * CFlightRecorder::GetStageName( FLIGHTSTAGE Stage )
+{
+    return g_pszStageNames[ Stage ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteDump () (Private)
+// Desc : Writes every record in the ring, oldest first, to a CSV file named
+//        after the hitch frame. Times are written in milliseconds.
+//-----------------------------------------------------------------------------
+bool CFlightRecorder::WriteDump( )
+{
+    char   szFileName[ FLIGHT_PREFIX_LENGTH + 16 ];
+    ULONG  First = (m_nCurrent + m_nCapacity - (m_nCount - 1)) % m_nCapacity;
+    FILE * pFile;
+
+    sprintf( szFileName, "%s%u.csv", m_szPrefix, (unsigned int)m_nHitchFrame );
+    if (!( pFile = fopen( szFileName, "w" ) )) return false;
+
+    fprintf( pFile, "# hitch at frame %u, over %.3f ms\n", (unsigned int)m_nHitchFrame, m_fHitchTime * 1e3f );
+    fprintf( pFile, "frame,frame_ms,hitch" );
+    for ( ULONG s = 0; s < FLIGHT_STAGE_COUNT; s++ ) fprintf( pFile, ",%s_ms", g_pszStageNames[s] );
+    fprintf( pFile, ",objects_drawn,objects_culled,polygons_drawn,triangles_drawn,lines_drawn\n" );
+
+    for ( ULONG i = 0; i < m_nCount; i++ )
+    {
+        const FLIGHTRECORD & Record = m_pRecords[ (First + i) % m_nCapacity ];
+
+        fprintf( pFile, "%u,%.3f,%d", (unsigned int)Record.Frame, Record.FrameTime * 1e3f,
+                 ( Record.FrameTime > m_fHitchTime ) ? 1 : 0 );
+        for ( ULONG s = 0; s < FLIGHT_STAGE_COUNT; s++ ) fprintf( pFile, ",%.3f", Record.StageTime[s] * 1e3f );
+        fprintf( pFile, ",%u,%u,%u,%u,%u\n", (unsigned int)Record.ObjectsDrawn, (unsigned int)Record.ObjectsCulled,
+                 (unsigned int)Record.PolygonsDrawn, (unsigned int)Record.TrianglesDrawn, (unsigned int)Record.LinesDrawn );
+
+    } // Next Record
+
+    return ( fclose( pFile ) == 0 );
+}
@@ -0,0 +1,458 @@
+//-----------------------------------------------------------------------------
+// File: CFrameBuffer.cpp
+//
+// Desc: Frame buffer classes. The engine always renders into a raw 32 bit
+//       pixel array that we own, and the backend decides how (or whether)
+//       that array is presented to the user.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CFrameBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CFrameBuffer.h"
+#include <new>
+#include <stdlib.h>
+
+//-----------------------------------------------------------------------------
+// Name : CFrameBuffer () (Constructor)
+// Desc : CFrameBuffer Class Constructor
+//-----------------------------------------------------------------------------
+CFrameBuffer::CFrameBuffer()
+{
+	// Reset / Clear all required values
+    m_pBits     = NULL;
+    m_pDepth    = NULL;
+    m_nWidth    = 0;
+    m_nHeight   = 0;
+    m_nPitch    = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CFrameBuffer () (Destructor)
+// Desc : CFrameBuffer Class Destructor
+//-----------------------------------------------------------------------------
+CFrameBuffer::~CFrameBuffer()
+{
+    ReleaseDepthBuffer();
+}
+
+//-----------------------------------------------------------------------------
+// Name : CreateDepthBuffer ()
+// Desc : Allocates a depth buffer matching the current pixel memory, cleared
+//        to the far plane.
+// Note : Re-creating the pixel memory releases the depth buffer, so this
+//        must be called again after each successful Create.
+//-----------------------------------------------------------------------------
+bool CFrameBuffer::CreateDepthBuffer( )
+{
+    // Release any previous buffer
+    ReleaseDepthBuffer();
+    if ( !m_pBits ) return false;
+
+    // Same pitch as the pixels, so one offset addresses both
+    m_pDepth = (float*)AlignedAlloc( (size_t)m_nPitch * m_nHeight * sizeof(float), FRAMEBUFFER_ALIGNMENT );
+    if ( !m_pDepth ) return false;
+
+    ClearDepth( 1.0f );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseDepthBuffer ()
+// Desc : Releases the depth buffer, if any.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::ReleaseDepthBuffer( )
+{
+    if ( m_pDepth ) AlignedFree( m_pDepth );
+    m_pDepth = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ClearDepth ()
+// Desc : Fills the entire depth buffer with the value specified.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::ClearDepth( float Depth )
+{
+    if ( !m_pDepth ) return;
+
+    // Fill each row in turn (pitch may exceed width)
+    for ( ULONG y = 0; y < m_nHeight; y++ )
+    {
+        float * pRow = m_pDepth + y * m_nPitch;
+        for ( ULONG x = 0; x < m_nWidth; x++ ) pRow[x] = Depth;
+
+    } // Next Row
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Fills the entire frame buffer with the colour specified.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::Clear( ULONG Color )
+{
+    if ( !m_pBits ) return;
+
+    // Fill each row in turn (pitch may exceed width)
+    for ( ULONG y = 0; y < m_nHeight; y++ )
+    {
+        ULONG * pRow = m_pBits + y * m_nPitch;
+        for ( ULONG x = 0; x < m_nWidth; x++ ) pRow[x] = Color;
+
+    } // Next Row
+}
+
+//-----------------------------------------------------------------------------
+// Name : PrintText ()
+// Desc : Renders a string of text to the frame buffer. The base frame buffer
+//        has no font support, so this is a no-op unless overriden.
+//-----------------------------------------------------------------------------
+void CFrameBuffer::PrintText( long, long, LPCTSTR )
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : WritePPM ()
+// Desc : Dumps the frame buffer contents to disk as a binary (P6) PPM image.
+//-----------------------------------------------------------------------------
+bool CFrameBuffer::WritePPM( const char * FileName ) const
+{
+    FILE  * pFile = NULL;
+    UCHAR * pRow  = NULL;
+    bool    bResult = true;
+
+    if ( !m_pBits ) return false;
+
+    // Open the file for writing
+    if (!( pFile = fopen( FileName, "wb" ) )) return false;
+
+    // Allocate a single row of packed RGB triplets
+    if (!( pRow = new (std::nothrow) UCHAR[ m_nWidth * 3 ] )) { fclose( pFile ); return false; }
+
+    // Write the header, followed by each row converted to RGB
+    fprintf( pFile, "P6\n%u %u\n255\n", (unsigned int)m_nWidth, (unsigned int)m_nHeight );
+    for ( ULONG y = 0; y < m_nHeight && bResult; y++ )
+    {
+        const ULONG * pSrc = m_pBits + y * m_nPitch;
+        for ( ULONG x = 0; x < m_nWidth; x++ )
+        {
+            pRow[ x * 3 + 0 ] = (UCHAR)((pSrc[x] >> 16) & 0xFF);
+            pRow[ x * 3 + 1 ] = (UCHAR)((pSrc[x] >>  8) & 0xFF);
+            pRow[ x * 3 + 2 ] = (UCHAR)((pSrc[x]      ) & 0xFF);
+
+        } // Next Pixel
+
+        if ( fwrite( pRow, 3, m_nWidth, pFile ) != m_nWidth ) bResult = false;
+
+    } // Next Row
+
+    // Clean up
+    delete []pRow;
+    if ( fclose( pFile ) != 0 ) bResult = false;
+
+    return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteRaw ()
+// Desc : Dumps the raw 32 bit pixel rows (pitch removed) to disk.
+//-----------------------------------------------------------------------------
+bool CFrameBuffer::WriteRaw( const char * FileName ) const
+{
+    FILE * pFile = NULL;
+    bool   bResult = true;
+
+    if ( !m_pBits ) return false;
+
+    // Open the file for writing
+    if (!( pFile = fopen( FileName, "wb" ) )) return false;
+
+    // Write each row in turn
+    for ( ULONG y = 0; y < m_nHeight && bResult; y++ )
+    {
+        if ( fwrite( m_pBits + y * m_nPitch, sizeof(ULONG), m_nWidth, pFile ) != m_nWidth ) bResult = false;
+
+    } // Next Row
+
+    if ( fclose( pFile ) != 0 ) bResult = false;
+    return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ComparePPM ()
+// Desc : Compares the frame buffer contents with a binary (P6) PPM image of
+//        the same size, counting the pixels in which any channel differs by
+//        more than the tolerance given.
+// Note : Returns false if the image cannot be read, or is a different size.
+//-----------------------------------------------------------------------------
+bool CFrameBuffer::ComparePPM( const char * FileName, ULONG Tolerance, ULONG & Differing ) const
+{
+    FILE        * pFile = NULL;
+    UCHAR       * pRow  = NULL;
+    unsigned int  Width, Height, MaxValue;
+    bool          bResult = true;
+
+    Differing = 0;
+    if ( !m_pBits ) return false;
+
+    // Open the file, and check that its header matches our own images
+    if (!( pFile = fopen( FileName, "rb" ) )) return false;
+    if ( fscanf( pFile, "P6 %u %u %u", &Width, &Height, &MaxValue ) != 3 || fgetc( pFile ) == EOF ||
+         Width != m_nWidth || Height != m_nHeight || MaxValue != 255 )
+    {
+        fclose( pFile );
+        return false;
+
+    } // End if unexpected
+
+    // Allocate a single row of packed RGB triplets
+    if (!( pRow = new (std::nothrow) UCHAR[ m_nWidth * 3 ] )) { fclose( pFile ); return false; }
+
+    // Compare each row in turn
+    for ( ULONG y = 0; y < m_nHeight && bResult; y++ )
+    {
+        const ULONG * pSrc = m_pBits + y * m_nPitch;
+        if ( fread( pRow, 3, m_nWidth, pFile ) != m_nWidth ) { bResult = false; break; }
+
+        for ( ULONG x = 0; x < m_nWidth; x++ )
+        {
+            long Red   = (long)((pSrc[x] >> 16) & 0xFF) - pRow[ x * 3 + 0 ];
+            long Green = (long)((pSrc[x] >>  8) & 0xFF) - pRow[ x * 3 + 1 ];
+            long Blue  = (long)((pSrc[x]      ) & 0xFF) - pRow[ x * 3 + 2 ];
+            if ( labs( Red ) > (long)Tolerance || labs( Green ) > (long)Tolerance || labs( Blue ) > (long)Tolerance ) Differing++;
+
+        } // Next Pixel
+
+    } // Next Row
+
+    // Clean up
+    delete []pRow;
+    fclose( pFile );
+
+    return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CMemoryFrameBuffer () (Constructor)
+// Desc : CMemoryFrameBuffer Class Constructor
+//-----------------------------------------------------------------------------
+CMemoryFrameBuffer::CMemoryFrameBuffer()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CMemoryFrameBuffer () (Destructor)
+// Desc : CMemoryFrameBuffer Class Destructor
+//-----------------------------------------------------------------------------
+CMemoryFrameBuffer::~CMemoryFrameBuffer()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates the pixel memory. Each row is padded out so that it begins
+//        on a FRAMEBUFFER_ALIGNMENT boundary.
+// Note : Destroys any existing pixel memory, so can be re-used
+//-----------------------------------------------------------------------------
+bool CMemoryFrameBuffer::Create( ULONG Width, ULONG Height )
+{
+    const ULONG AlignPixels = FRAMEBUFFER_ALIGNMENT / sizeof(ULONG);
+
+    // Release any previous buffer (and its depth buffer)
+    Release();
+    if ( Width == 0 || Height == 0 ) return false;
+
+    // Calculate padded pitch and allocate
+    m_nPitch = (Width + AlignPixels - 1) & ~(AlignPixels - 1);
+    m_pBits  = (ULONG*)AlignedAlloc( (size_t)m_nPitch * Height * sizeof(ULONG), FRAMEBUFFER_ALIGNMENT );
+    if ( !m_pBits ) { m_nPitch = 0; return false; }
+
+    // Store dimensions
+    m_nWidth  = Width;
+    m_nHeight = Height;
+
+    // Start with a known state
+    memset( m_pBits, 0, (size_t)m_nPitch * Height * sizeof(ULONG) );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Releases the pixel memory.
+//-----------------------------------------------------------------------------
+void CMemoryFrameBuffer::Release( )
+{
+    if ( m_pBits ) AlignedFree( m_pBits );
+    ReleaseDepthBuffer();
+
+    // Clear variables
+    m_pBits   = NULL;
+    m_nWidth  = 0;
+    m_nHeight = 0;
+    m_nPitch  = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Present ()
+// Desc : Nothing to present to for a headless buffer.
+//-----------------------------------------------------------------------------
+void CMemoryFrameBuffer::Present( ULONG, ULONG, ULONG, ULONG )
+{
+}
+
+#ifdef _WIN32
+//-----------------------------------------------------------------------------
+// Name : CWin32FrameBuffer () (Constructor)
+// Desc : CWin32FrameBuffer Class Constructor, stores the target window.
+//-----------------------------------------------------------------------------
+CWin32FrameBuffer::CWin32FrameBuffer( HWND hWnd )
+{
+	// Reset / Clear all required values
+    m_hWnd              = hWnd;
+    m_hdcFrameBuffer    = NULL;
+    m_hbmFrameBuffer    = NULL;
+    m_hbmSelectOut      = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CWin32FrameBuffer () (Destructor)
+// Desc : CWin32FrameBuffer Class Destructor
+//-----------------------------------------------------------------------------
+CWin32FrameBuffer::~CWin32FrameBuffer()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Creates the frame buffer memory DC and DIB section ready for use.
+// Note : Destroys the DC / Bitmap when needed, so can be re-used
+//-----------------------------------------------------------------------------
+bool CWin32FrameBuffer::Create( ULONG Width, ULONG Height )
+{
+    BITMAPINFO  bmi;
+    void      * pBits = NULL;
+
+    // Obtain window's HDC.
+    HDC hDC = ::GetDC( m_hWnd );
+
+    // Create Frame Buffers Device Context if not already existant
+    if ( !m_hdcFrameBuffer ) m_hdcFrameBuffer = ::CreateCompatibleDC( hDC );
+
+    // If an old FrameBuffer bitmap has already been generated then delete it
+    if ( m_hbmFrameBuffer )
+    {
+        // Select the frame buffer back out and destroy it
+        ::SelectObject( m_hdcFrameBuffer, m_hbmSelectOut );
+        ::DeleteObject( m_hbmFrameBuffer );
+        m_hbmFrameBuffer = NULL;
+        m_hbmSelectOut   = NULL;
+        m_pBits          = NULL;
+        ReleaseDepthBuffer();
+
+    } // End if
+
+    // Describe a top down 32 bit DIB (32 bit rows require no padding)
+    ZeroMemory( &bmi, sizeof(BITMAPINFO) );
+    bmi.bmiHeader.biSize        = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth       = (LONG)Width;
+    bmi.bmiHeader.biHeight      = -(LONG)Height;
+    bmi.bmiHeader.biPlanes      = 1;
+    bmi.bmiHeader.biBitCount    = 32;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    // Create the frame buffer
+    m_hbmFrameBuffer = ::CreateDIBSection( hDC, &bmi, DIB_RGB_COLORS, &pBits, NULL, 0 );
+
+    // Release windows HDC.
+    ::ReleaseDC( m_hWnd, hDC );
+    if ( !m_hbmFrameBuffer ) return false;
+
+    // Select this bitmap into our Frame Buffer DC
+    m_hbmSelectOut = (HBITMAP)::SelectObject( m_hdcFrameBuffer, m_hbmFrameBuffer );
+
+    // Set up initial DC states
+    ::SetBkMode( m_hdcFrameBuffer, TRANSPARENT );
+
+    // Store the pixel memory details
+    m_pBits   = (ULONG*)pBits;
+    m_nWidth  = Width;
+    m_nHeight = Height;
+    m_nPitch  = Width;
+
+    // Success!!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Destroys the frame buffer and associated DC's
+//-----------------------------------------------------------------------------
+void CWin32FrameBuffer::Release( )
+{
+    if ( m_hdcFrameBuffer && m_hbmFrameBuffer )
+    {
+        ::SelectObject( m_hdcFrameBuffer, m_hbmSelectOut );
+        ::DeleteObject( m_hbmFrameBuffer );
+
+    } // End if
+
+    if ( m_hdcFrameBuffer ) ::DeleteDC( m_hdcFrameBuffer );
+    ReleaseDepthBuffer();
+
+    // Clear all variables
+    m_hdcFrameBuffer    = NULL;
+    m_hbmFrameBuffer    = NULL;
+    m_hbmSelectOut      = NULL;
+    m_pBits             = NULL;
+    m_nWidth            = 0;
+    m_nHeight           = 0;
+    m_nPitch            = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Present ()
+// Desc : Blits the specified area of the frame buffer to the window.
+//-----------------------------------------------------------------------------
+void CWin32FrameBuffer::Present( ULONG X, ULONG Y, ULONG Width, ULONG Height )
+{
+    HDC hDC = NULL;
+
+    // Retrieve the DC of the window
+    hDC = ::GetDC( m_hWnd );
+
+    // Blit the frame buffer to the screen
+    ::BitBlt( hDC, X, Y, Width, Height, m_hdcFrameBuffer, X, Y, SRCCOPY );
+
+    // Clean up
+    ::ReleaseDC( m_hWnd, hDC );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Fills the frame buffer, after waiting for any pending GDI output.
+//-----------------------------------------------------------------------------
+void CWin32FrameBuffer::Clear( ULONG Color )
+{
+    // GDI may still be writing to the DIB section
+    ::GdiFlush();
+
+    // Fill the pixel memory directly
+    CFrameBuffer::Clear( Color );
+}
+
+//-----------------------------------------------------------------------------
+// Name : PrintText ()
+// Desc : Renders a string of text to the frame buffer via GDI.
+//-----------------------------------------------------------------------------
+void CWin32FrameBuffer::PrintText( long X, long Y, LPCTSTR lpszText )
+{
+    TextOut( m_hdcFrameBuffer, X, Y, lpszText, (int)_tcslen( lpszText ) );
+}
+#endif // _WIN32
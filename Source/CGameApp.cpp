@@ -9,7 +9,9 @@
 //-----------------------------------------------------------------------------
 // CGameApp Specific Includes
 //-----------------------------------------------------------------------------
-#include "..\\Includes\\CGameApp.h"
+#include "../Includes/CGameApp.h"
+#include <float.h>
+#include <new>
 
 //-----------------------------------------------------------------------------
 // Name : CGameApp () (Constructor)
@@ -18,10 +20,57 @@
 CGameApp::CGameApp()
 {
 	// Reset / Clear all required values
+#ifdef _WIN32
     m_hWnd              = NULL;
-    m_hdcFrameBuffer    = NULL;
-    m_hbmSelectOut      = NULL;
-    m_hbmFrameBuffer    = NULL;
+#endif
+    m_pFrameBuffer      = NULL;
+    m_pScreenVertex     = NULL;
+    m_pClipVertex       = NULL;
+    m_nScreenVertexMax  = 0;
+    m_nStatsFrames      = 0;
+    m_nObjectCount      = OBJECT_COUNT;
+    m_pVertexStart      = NULL;
+    m_pObjectCull       = NULL;
+    m_pObjectPlanes     = NULL;
+    m_pObjectEye        = NULL;
+    m_pObjectBackFace   = NULL;
+    m_pObjectRect       = NULL;
+    m_pObjectTestable   = NULL;
+    m_pObjectOccluded   = NULL;
+    m_pVisibleList      = NULL;
+    m_pObjectLevel      = NULL;
+    m_nVisibleCount     = 0;
+    m_bBackFaceCull     = true;
+    m_bSolid            = false;
+    m_bOcclusion        = true;
+    m_bLOD              = true;
+    ZeroMemory( &m_FrameStats, sizeof(FRAMESTATS) );
+    ZeroMemory( &m_TotalStats, sizeof(FRAMESTATS) );
+    m_bHeadless         = false;
+    m_fLockFPS          = 60.0f;
+    m_nFrameLimit       = HEADLESS_FRAME_COUNT;
+    m_szDumpFile[0]     = '\0';
+    m_szMeshFile[0]     = '\0';
+    m_szTraceFile[0]    = '\0';
+    m_szReportFile[0]   = '\0';
+    m_nWarmupFrames     = HEADLESS_WARMUP_COUNT;
+    m_nRunCount         = HEADLESS_RUN_COUNT;
+    m_fBestP50          = 0.0f;
+    m_nSphereSlices     = 0;
+    m_bCounters         = false;
+    m_nHeadlessWidth    = HEADLESS_WIDTH;
+    m_nHeadlessHeight   = HEADLESS_HEIGHT;
+    m_szReferenceFile[0] = '\0';
+    m_szBaselineFile[0] = '\0';
+    m_nColorTolerance   = VERIFY_COLOR_TOLERANCE;
+    m_fPixelTolerance   = VERIFY_PIXEL_TOLERANCE;
+    m_fRegression       = VERIFY_REGRESSION;
+    m_bUpdate           = false;
+    m_szHitchPrefix[0]  = '\0';
+    m_fHitchTime        = TIMER_HITCH_TIME;
+    m_nHitchPreFrames   = FLIGHT_PRE_FRAMES;
+    m_nHitchPostFrames  = FLIGHT_POST_FRAMES;
+    m_nThreadCount      = 0;
 }
 
 //-----------------------------------------------------------------------------
@@ -40,12 +89,44 @@ CGameApp::~CGameApp()
 //-----------------------------------------------------------------------------
 bool CGameApp::InitInstance( HANDLE hInstance, LPCTSTR lpCmdLine, int iCmdShow )
 {
+    // Process any command line options
+    ParseCommandLine( lpCmdLine );
+
+    // Profile from the start if a trace was asked for
+    if ( m_szTraceFile[0] )
+    {
+        CProfiler::SetThreadName( "Main" );
+        CProfiler::Enable( true );
+
+    } // End if tracing
+
+    // Count hardware events on this thread (and so on the workers), carrying
+    // on without them where they are not available
+    if ( m_bCounters && !CPerfCounters::OpenThread() )
+        printf( "counters: unavailable (%s)\n", CPerfCounters::GetError() );
+
+    // Start the job system worker threads
+    if ( m_nThreadCount == 0 ) m_nThreadCount = CJobSystem::GetHardwareThreads();
+    if (!m_JobSystem.Create( m_nThreadCount )) { ShutDown(); return false; }
+    m_TileRenderer.SetJobSystem( &m_JobSystem );
+
     // Create the primary display device
     if (!CreateDisplay()) { ShutDown(); return false; }
 
     // Build Objects
     if (!BuildObjects()) { ShutDown(); return false; }
 
+    // Count hitches against the same threshold everywhere, keeping recent
+    // frames ready to write out around any
+    m_Timer.SetHitchThreshold( m_fHitchTime );
+    if ( m_fHitchTime > 0.0f && !m_FlightRecorder.Create( m_fHitchTime, m_nHitchPreFrames, m_nHitchPostFrames,
+                                                          m_szHitchPrefix[0] ? m_szHitchPrefix : NULL ) )
+    {
+        ShutDown();
+        return false;
+
+    } // End if recorder failed
+
     // Set up all required game states
     SetupGameState();
 
@@ -60,10 +141,29 @@ bool CGameApp::InitInstance( HANDLE hInstance, LPCTSTR lpCmdLine, int iCmdShow )
 //-----------------------------------------------------------------------------
 bool CGameApp::CreateDisplay()
 {
-    LPTSTR  WindowTitle  = _T("Software Render");
     USHORT  Width        = 800;
     USHORT  Height       = 600;
-    HDC     hDC          = NULL;
+
+    // Headless rendering targets system memory only
+    if ( m_bHeadless )
+    {
+        Width  = (USHORT)m_nHeadlessWidth;
+        Height = (USHORT)m_nHeadlessHeight;
+
+        // Viewport covers the entire buffer
+        m_nViewX      = 0;
+        m_nViewY      = 0;
+        m_nViewWidth  = Width;
+        m_nViewHeight = Height;
+
+        // Build the frame buffer
+        if (!( m_pFrameBuffer = new (std::nothrow) CMemoryFrameBuffer() )) return false;
+        return BuildFrameBuffer( Width, Height );
+
+    } // End if headless
+
+#ifdef _WIN32
+    LPTSTR  WindowTitle  = _T("Software Render");
     RECT    rc;
     
     // Register the new windows window class.
@@ -96,6 +196,7 @@ bool CGameApp::CreateDisplay()
     m_nViewHeight = rc.bottom - rc.top;
 
     // Build the frame buffer
+    if (!( m_pFrameBuffer = new (std::nothrow) CWin32FrameBuffer( m_hWnd ) )) return false;
     if (!BuildFrameBuffer( Width, Height )) return false;
     
 	// Show the window
@@ -103,6 +204,259 @@ bool CGameApp::CreateDisplay()
 
     // Success!
     return true;
+#else
+    // Only headless rendering is available on this platform
+    return false;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseCommandLine () (Private)
+// Desc : Processes the command line options supported by the engine.
+//        -headless      Render into system memory without creating a window.
+//        -frames <n>    Number of frames to render when headless (0 = forever).
+//        -warmup <n>    Frames rendered before those measured when headless.
+//        -repeat <n>    Times the measured frames are run when headless, the
+//                       report and checks taking the lowest median frame
+//                       time of them (the rest describe the last run).
+//        -timestep <ms> Advance the scene by a fixed step each frame, however
+//                       long frames take, so that runs are reproducible.
+//        -report <file> Write the headless run's measurements as JSON.
+//        -size <w> <h>  Size of the headless frame buffer.
+//        -reference <file>
+//                       Compare the final headless frame with a PPM image,
+//                       failing if it differs or does not exist.
+//        -tolerance <levels> <percent>
+//                       Colour difference ignored, and percentage of pixels
+//                       which may differ beyond it, when comparing.
+//        -baseline <file>
+//                       Compare the run with an earlier -report, failing if
+//                       it is slower or does not exist.
+//        -regression <percent>
+//                       Slow down from the baseline which fails the run.
+//        -update        Write the -reference and -baseline files from this
+//                       run (replacing any there), rather than compare.
+//        -dump <file>   Write the final headless frame (.ppm or .raw).
+//        -threads <n>   Number of job threads (0 = one per hardware thread).
+//        -nobackface    Draw back facing polygons, even of closed objects.
+//        -solid         Draw filled polygons rather than wireframe.
+//        -noocclusion   Draw every object, even when hidden behind occluders.
+//        -nolod         Always draw objects with their full detail mesh.
+//        -mesh <file>   Draw the first mesh of a mesh file in place of the cube.
+//        -sphere <n>    Draw a generated sphere of n slices (and n / 2 stacks)
+//                       in place of the cube.
+//        -objects <n>   Number of objects in the scene (beyond the first two,
+//                       laid out in a grid behind them).
+//        -lockfps <n>   Frame rate to lock to (0 = uncapped), even headless.
+//        -pacing <mode> How locked frames are waited out: uncapped, spin,
+//                       lock or adaptive (see TIMERPACING).
+//        -trace <file>  Profile every frame, writing a Chrome trace on exit.
+//        -hitch <ms>    Frame time counted as a hitch, in the statistics and
+//                       by the flight recorder (0 = neither counts hitches,
+//                       nor is the recorder run).
+//        -hitchdir <dir>
+//                       Write a dump of each hitch to <dir>/hitch_<frame>.csv
+//                       (the directory must exist). Hitches are only
+//                       counted unless this or -hitchfile is given.
+//        -hitchfile <prefix>
+//                       Write a dump of each hitch to <prefix><frame>.csv.
+//        -hitchframes <before> <after>
+//                       Frames either side of a hitch written with it.
+//        -counters      Count cycles, instructions, cache and branch misses
+//                       in each stage of the frame (Linux only, where the
+//                       kernel allows).
+//-----------------------------------------------------------------------------
+void CGameApp::ParseCommandLine( LPCTSTR lpCmdLine )
+{
+    char          szToken[ MAX_FILENAME_LENGTH ];
+    const char  * pCmdLine = lpCmdLine;
+    static const char * pszPacing[] = { "uncapped", "spin", "lock", "adaptive" };
+    unsigned int  nValue, nValue2;
+    float         fValue;
+    int           nRead;
+    bool          bLockFPS = false;
+
+#ifndef _WIN32
+    // There is no window support on this platform
+    m_bHeadless = true;
+#endif
+
+    // Process each whitespace separated token
+    while ( pCmdLine && sscanf( pCmdLine, "%259s%n", szToken, &nRead ) == 1 )
+    {
+        pCmdLine += nRead;
+
+        if ( strcmp( szToken, "-headless" ) == 0 )
+        {
+            m_bHeadless = true;
+
+        } // End if headless
+        else if ( strcmp( szToken, "-frames" ) == 0 && sscanf( pCmdLine, "%u%n", &nValue, &nRead ) == 1 )
+        {
+            m_nFrameLimit = nValue;
+            pCmdLine += nRead;
+
+        } // End if frames
+        else if ( strcmp( szToken, "-warmup" ) == 0 && sscanf( pCmdLine, "%u%n", &nValue, &nRead ) == 1 )
+        {
+            m_nWarmupFrames = nValue;
+            pCmdLine += nRead;
+
+        } // End if warmup
+        else if ( strcmp( szToken, "-repeat" ) == 0 && sscanf( pCmdLine, "%u%n", &nValue, &nRead ) == 1 )
+        {
+            m_nRunCount = ( nValue > 0 ) ? nValue : 1;
+            pCmdLine += nRead;
+
+        } // End if repeat
+        else if ( strcmp( szToken, "-timestep" ) == 0 && sscanf( pCmdLine, "%f%n", &fValue, &nRead ) == 1 )
+        {
+            m_Timer.SetFixedStep( ( fValue > 0.0f ) ? fValue * 0.001f : 0.0f );
+            pCmdLine += nRead;
+
+        } // End if time step
+        else if ( strcmp( szToken, "-report" ) == 0 && sscanf( pCmdLine, "%259s%n", m_szReportFile, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if report
+        else if ( strcmp( szToken, "-size" ) == 0 && sscanf( pCmdLine, "%u %u%n", &nValue, &nValue2, &nRead ) == 2 )
+        {
+            m_nHeadlessWidth  = ( nValue  > 0 && nValue  <= 0xFFFF ) ? nValue  : HEADLESS_WIDTH;
+            m_nHeadlessHeight = ( nValue2 > 0 && nValue2 <= 0xFFFF ) ? nValue2 : HEADLESS_HEIGHT;
+            pCmdLine += nRead;
+
+        } // End if size
+        else if ( strcmp( szToken, "-reference" ) == 0 && sscanf( pCmdLine, "%259s%n", m_szReferenceFile, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if reference
+        else if ( strcmp( szToken, "-tolerance" ) == 0 && sscanf( pCmdLine, "%u %f%n", &nValue, &fValue, &nRead ) == 2 )
+        {
+            m_nColorTolerance = nValue;
+            m_fPixelTolerance = fValue * 0.01f;
+            pCmdLine += nRead;
+
+        } // End if tolerance
+        else if ( strcmp( szToken, "-baseline" ) == 0 && sscanf( pCmdLine, "%259s%n", m_szBaselineFile, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if baseline
+        else if ( strcmp( szToken, "-regression" ) == 0 && sscanf( pCmdLine, "%f%n", &fValue, &nRead ) == 1 )
+        {
+            m_fRegression = fValue * 0.01f;
+            pCmdLine += nRead;
+
+        } // End if regression
+        else if ( strcmp( szToken, "-dump" ) == 0 && sscanf( pCmdLine, "%259s%n", m_szDumpFile, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if dump
+        else if ( strcmp( szToken, "-mesh" ) == 0 && sscanf( pCmdLine, "%259s%n", m_szMeshFile, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if mesh
+        else if ( strcmp( szToken, "-sphere" ) == 0 && sscanf( pCmdLine, "%u%n", &nValue, &nRead ) == 1 )
+        {
+            m_nSphereSlices = ( nValue >= 4 ) ? nValue : 4;
+            pCmdLine += nRead;
+
+        } // End if sphere
+        else if ( strcmp( szToken, "-trace" ) == 0 && sscanf( pCmdLine, "%259s%n", m_szTraceFile, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if trace
+        else if ( strcmp( szToken, "-hitch" ) == 0 && sscanf( pCmdLine, "%f%n", &fValue, &nRead ) == 1 )
+        {
+            m_fHitchTime = fValue * 0.001f;
+            pCmdLine += nRead;
+
+        } // End if hitch
+        else if ( strcmp( szToken, "-hitchframes" ) == 0 && sscanf( pCmdLine, "%u %u%n", &nValue, &nValue2, &nRead ) == 2 )
+        {
+            m_nHitchPreFrames  = nValue;
+            m_nHitchPostFrames = nValue2;
+            pCmdLine += nRead;
+
+        } // End if hitch frames
+        else if ( strcmp( szToken, "-hitchfile" ) == 0 && sscanf( pCmdLine, "%239s%n", m_szHitchPrefix, &nRead ) == 1 )
+        {
+            pCmdLine += nRead;
+
+        } // End if hitch file
+        else if ( strcmp( szToken, "-hitchdir" ) == 0 && sscanf( pCmdLine, "%232s%n", m_szHitchPrefix, &nRead ) == 1 )
+        {
+            strcat( m_szHitchPrefix, "/hitch_" );
+            pCmdLine += nRead;
+
+        } // End if hitch directory
+        else if ( strcmp( szToken, "-threads" ) == 0 && sscanf( pCmdLine, "%u%n", &nValue, &nRead ) == 1 )
+        {
+            m_nThreadCount = nValue;
+            pCmdLine += nRead;
+
+        } // End if threads
+        else if ( strcmp( szToken, "-objects" ) == 0 && sscanf( pCmdLine, "%u%n", &nValue, &nRead ) == 1 )
+        {
+            m_nObjectCount = ( nValue > 0 ) ? nValue : 1;
+            pCmdLine += nRead;
+
+        } // End if objects
+        else if ( strcmp( szToken, "-nobackface" ) == 0 )
+        {
+            m_bBackFaceCull = false;
+
+        } // End if no back face culling
+        else if ( strcmp( szToken, "-solid" ) == 0 )
+        {
+            m_bSolid = true;
+
+        } // End if solid
+        else if ( strcmp( szToken, "-counters" ) == 0 )
+        {
+            m_bCounters = true;
+
+        } // End if counters
+        else if ( strcmp( szToken, "-update" ) == 0 )
+        {
+            m_bUpdate = true;
+
+        } // End if update
+        else if ( strcmp( szToken, "-noocclusion" ) == 0 )
+        {
+            m_bOcclusion = false;
+
+        } // End if no occlusion culling
+        else if ( strcmp( szToken, "-nolod" ) == 0 )
+        {
+            m_bLOD = false;
+
+        } // End if no level of detail
+        else if ( strcmp( szToken, "-lockfps" ) == 0 && sscanf( pCmdLine, "%f%n", &fValue, &nRead ) == 1 )
+        {
+            m_fLockFPS = ( fValue > 0.0f ) ? fValue : 0.0f;
+            bLockFPS   = true;
+            pCmdLine  += nRead;
+
+        } // End if lock frame rate
+        else if ( strcmp( szToken, "-pacing" ) == 0 && sscanf( pCmdLine, "%259s%n", szToken, &nRead ) == 1 )
+        {
+            for ( ULONG i = 0; i < sizeof(pszPacing) / sizeof(pszPacing[0]); i++ )
+                if ( strcmp( szToken, pszPacing[i] ) == 0 ) m_Timer.SetPacing( (TIMERPACING)i );
+            pCmdLine += nRead;
+
+        } // End if pacing
+
+    } // Next Token
+
+    // Headless output is never presented, so never hold back the frame rate
+    // unless asked to
+    if ( m_bHeadless && !bLockFPS ) m_fLockFPS = 0.0f;
 }
 
 //-----------------------------------------------------------------------------
@@ -112,35 +466,20 @@ bool CGameApp::CreateDisplay()
 //-----------------------------------------------------------------------------
 bool CGameApp::BuildFrameBuffer( ULONG Width, ULONG Height )
 {
-    // Obtain window's HDC.
-    HDC hDC = ::GetDC( m_hWnd );
-
-    // Create Frame Buffers Device Context if not already existant
-    if ( !m_hdcFrameBuffer ) m_hdcFrameBuffer = ::CreateCompatibleDC( hDC );
-    
-    // If an old FrameBuffer bitmap has already been generated then delete it
-    if ( m_hbmFrameBuffer ) 
-    {
-        // Select the frame buffer back out and destroy it
-        ::SelectObject( m_hdcFrameBuffer, m_hbmSelectOut );
-        ::DeleteObject( m_hbmFrameBuffer );
-        m_hbmFrameBuffer = NULL;
-        m_hbmSelectOut   = NULL;
-
-    } // End if
+    // Validate
+    if ( !m_pFrameBuffer ) return false;
 
-    // Create the frame buffer
-    m_hbmFrameBuffer = CreateCompatibleBitmap( hDC, Width, Height );    
-    if ( !m_hbmFrameBuffer ) return false;
+    // Allow the backend to (re)create its pixel memory, and a matching depth buffer
+    if ( !m_pFrameBuffer->Create( Width, Height ) ) return false;
+    if ( !m_pFrameBuffer->CreateDepthBuffer() ) return false;
+    if ( !m_Occlusion.Create( Width, Height ) ) return false;
 
-    // Select this bitmap into our Frame Buffer DC
-    m_hbmSelectOut = (HBITMAP)::SelectObject( m_hdcFrameBuffer, m_hbmFrameBuffer );
+    // Point the renderer at the new pixel memory, clipped to the viewport
+    m_TileRenderer.SetRenderTarget( m_pFrameBuffer );
+    m_TileRenderer.SetClipRect( m_nViewX, m_nViewY, m_nViewX + m_nViewWidth, m_nViewY + m_nViewHeight );
 
-    // Release windows HDC.
-    ::ReleaseDC( m_hWnd, hDC );
-
-    // Set up initial DC states
-    ::SetBkMode( m_hdcFrameBuffer, TRANSPARENT );
+    // Vertices must be mapped into the same viewport
+    m_Transform.SetViewport( m_nViewX, m_nViewY, m_nViewWidth, m_nViewHeight );
 
     // Success!!
     return true;
@@ -152,30 +491,8 @@ bool CGameApp::BuildFrameBuffer( ULONG Width, ULONG Height )
 //-----------------------------------------------------------------------------
 void CGameApp::ClearFrameBuffer( ULONG Color )
 {
-
-    LOGBRUSH logBrush;
-    HBRUSH   hBrush = NULL, hOldBrush = NULL;
-    
-    // Set up the rendering brush
-    logBrush.lbStyle = BS_SOLID;
-    
-    // Set up the colour, converted to BGR & stripped of alpha
-    logBrush.lbColor = 0x00FFFFFF & RGB2BGR( Color );
-    
-    // Create the rendering brush
-    hBrush = ::CreateBrushIndirect( &logBrush );
-    if (!hBrush) return;
-
-    // Select into the frame buffer DC
-    hOldBrush = (HBRUSH)::SelectObject( m_hdcFrameBuffer, hBrush );
-
-    // Draw the rectangle
-    Rectangle( m_hdcFrameBuffer, m_nViewX, m_nViewY, m_nViewWidth, m_nViewHeight );
-    
-    // Destroy rendering brush
-    ::SelectObject( m_hdcFrameBuffer, hOldBrush );
-    ::DeleteObject( hBrush );
-
+    // Fill the pixel memory directly
+    m_pFrameBuffer->Clear( Color );
 }
 
 //-----------------------------------------------------------------------------
@@ -184,52 +501,20 @@ void CGameApp::ClearFrameBuffer( ULONG Color )
 //-----------------------------------------------------------------------------
 void CGameApp::PresentFrameBuffer( )
 {    
-    HDC hDC = NULL; 
-
-    // Retrieve the DC of the window
-    hDC = ::GetDC(m_hWnd);
-
-    // Blit the frame buffer to the screen
-    ::BitBlt( hDC, m_nViewX, m_nViewY, m_nViewWidth, m_nViewHeight, m_hdcFrameBuffer,
-              m_nViewX, m_nViewY, SRCCOPY );
-
-    // Clean up
-    ::ReleaseDC( m_hWnd, hDC );
+    PROFILE_ZONE( "PresentFrameBuffer" );
 
+    // Hand the viewport area over to the backend
+    m_pFrameBuffer->Present( m_nViewX, m_nViewY, m_nViewWidth, m_nViewHeight );
 }
 
 //-----------------------------------------------------------------------------
 // Name : DrawLine () (Private)
-// Desc : Simple line drawing using GDI for clarity.
+// Desc : Submits a line segment to the tile renderer, it is drawn into the
+//        frame buffer's pixel memory when the frame's tiles are rasterized.
 //-----------------------------------------------------------------------------
-void CGameApp::DrawLine( const D3DXVECTOR3 & vtx1, const D3DXVECTOR3 & vtx2, ULONG Color )
+void CGameApp::DrawLine( const CScreenVertex & vtx1, const CScreenVertex & vtx2, ULONG Color )
 {
-    LOGPEN logPen;
-    HPEN   hPen = NULL, hOldPen = NULL;
-    
-    // Set up the rendering pen
-    logPen.lopnStyle   = PS_SOLID;
-    logPen.lopnWidth.x = 1;
-    logPen.lopnWidth.y = 1;
-
-    // Set up the colour, converted to BGR & stripped of alpha
-    logPen.lopnColor   = 0x00FFFFFF & RGB2BGR( Color ); 
-    
-    // Create the rendering pen
-    hPen = ::CreatePenIndirect( &logPen );
-    if (!hPen) return;
-
-    // Select into the frame buffer DC
-    hOldPen = (HPEN)::SelectObject( m_hdcFrameBuffer, hPen );
-
-    // Draw the line segment
-    MoveToEx( m_hdcFrameBuffer, (long)vtx1.x, (long)vtx1.y, NULL );
-    LineTo( m_hdcFrameBuffer, (long)vtx2.x, (long)vtx2.y );
-
-    // Destroy rendering pen
-    ::SelectObject( m_hdcFrameBuffer, hOldPen );
-    ::DeleteObject( hPen );
-    
+    m_TileRenderer.AddLine( vtx1.x, vtx1.y, vtx2.x, vtx2.y, Color );
 }
 
 //-----------------------------------------------------------------------------
@@ -248,10 +533,6 @@ void CGameApp::SetupGameState()
 
     // Set up a perspective projection matrix
     D3DXMatrixPerspectiveFovLH( &m_mtxProjection, D3DXToRadian( 60.0f ), fAspect, 1.01f, 1000.0f );
-    
-    // Enable rotation
-    m_bRotation1 = true;
-    m_bRotation2 = true;
 
 }
 
@@ -262,6 +543,119 @@ void CGameApp::SetupGameState()
 //-----------------------------------------------------------------------------
 int CGameApp::BeginGame()
 {
+    // Headless runs simply render the requested number of frames
+    if ( m_bHeadless )
+    {
+        TIMERFRAMESTATS FrameTimes;
+
+        // The first frame's time includes startup, so is never measured
+        for ( ULONG i = 0; i < m_nWarmupFrames; i++ ) if ( !FrameAdvance() ) return 1;
+
+        // Measure each run afresh, keeping the lowest median frame time
+        for ( ULONG Run = 0; Run < m_nRunCount; Run++ )
+        {
+            m_Timer.ResetStats();
+            ZeroMemory( &m_TotalStats, sizeof(FRAMESTATS) );
+            m_nStatsFrames = 0;
+            m_Counters.Reset();
+
+            for ( ULONG i = 0; m_nFrameLimit == 0 || i < m_nFrameLimit; i++ ) if ( !FrameAdvance() ) return 1;
+
+            m_Timer.GetFrameStats( FrameTimes );
+            if ( Run == 0 || FrameTimes.P50 < m_fBestP50 ) m_fBestP50 = FrameTimes.P50;
+
+        } // Next Run
+
+        // Dump the final frame if requested
+        if ( m_szDumpFile[0] )
+        {
+            size_t Length = strlen( m_szDumpFile );
+            bool   bRaw   = (Length > 4 && strcmp( m_szDumpFile + Length - 4, ".raw" ) == 0);
+            if ( !(bRaw ? m_pFrameBuffer->WriteRaw( m_szDumpFile ) : m_pFrameBuffer->WritePPM( m_szDumpFile )) ) return 1;
+
+        } // End if dump
+
+        // Report average visibility statistics
+        if ( m_nStatsFrames > 0 )
+        {
+            double Frames = (double)m_nStatsFrames;
+            printf( "objects drawn %.1f, culled %.1f, clipped %.1f, edges clipped %.1f, rejected %.1f (per frame)\n",
+                    m_TotalStats.ObjectsDrawn / Frames, m_TotalStats.ObjectsCulled / Frames,
+                    m_TotalStats.ObjectsClipped / Frames, m_TotalStats.EdgesClipped / Frames,
+                    m_TotalStats.EdgesRejected / Frames );
+            printf( "polygons drawn %.1f, back facing %.1f, triangles drawn %.1f (per frame)\n",
+                    m_TotalStats.PolygonsDrawn / Frames, m_TotalStats.PolygonsRejected / Frames,
+                    m_TotalStats.TrianglesDrawn / Frames );
+            printf( "occlusion tested %.1f, occluded %.1f (per frame)\n",
+                    m_TotalStats.ObjectsTested / Frames, m_TotalStats.ObjectsOccluded / Frames );
+            for ( ULONG i = 0; i < m_MeshLOD.GetLevelCount(); i++ )
+                printf( "lod %u: objects %.1f, triangles %.1f (per frame)\n", (unsigned int)i,
+                        m_TotalStats.LevelObjects[i] / Frames, m_TotalStats.LevelTriangles[i] / Frames );
+
+        } // End if stats
+
+        // Report how closely locked frames were paced
+        const TIMERSTATS & Pacing = m_Timer.GetStats();
+        if ( Pacing.Frames > 0 )
+        {
+            double Frames = (double)Pacing.Frames;
+            printf( "pacing: late frames %u, sleep %.3f ms, spin %.3f ms, pacing error %.3f ms (max %.3f) (per frame), "
+                    "wake error %.3f ms (max %.3f) (per sleep)\n", (unsigned int)Pacing.LateFrames,
+                    Pacing.SleepTime * 1e3 / Frames, Pacing.SpinTime * 1e3 / Frames,
+                    Pacing.PacingError * 1e3 / Frames, Pacing.PacingErrorMax * 1e3,
+                    Pacing.Sleeps ? Pacing.WakeError * 1e3 / Pacing.Sleeps : 0.0, Pacing.WakeErrorMax * 1e3 );
+
+        } // End if paced
+
+        // Report the frame time distribution
+        if ( FrameTimes.Frames > 0 )
+        {
+            printf( "frame time: mean %.3f ms, p50 %.3f, p95 %.3f, p99 %.3f, max %.3f, hitches %u (over %.1f ms)\n",
+                    FrameTimes.Mean * 1e3, FrameTimes.P50 * 1e3, FrameTimes.P95 * 1e3, FrameTimes.P99 * 1e3,
+                    FrameTimes.Max * 1e3, (unsigned int)FrameTimes.Hitches, m_Timer.GetHitchThreshold() * 1e3 );
+            if ( m_nRunCount > 1 )
+                printf( "frame time: best p50 %.3f ms of %u runs\n", m_fBestP50 * 1e3, (unsigned int)m_nRunCount );
+
+        } // End if frames
+
+        // Report any hitches written out (they are counted above)
+        if ( m_FlightRecorder.GetHitchCount() > 0 && m_szHitchPrefix[0] )
+            printf( "flight recorder: %u dumps written\n", (unsigned int)m_FlightRecorder.GetDumpCount() );
+        else if ( m_FlightRecorder.GetHitchCount() > 0 )
+            printf( "flight recorder: no dumps written (-hitchdir to write hitches out)\n" );
+
+        // Report where the hardware events were counted
+        if ( CPerfCounters::IsOpen() && m_nStatsFrames > 0 )
+        {
+            printf( "counters: counted on %u threads (per frame, misses per vertex drawn)\n", (unsigned int)CPerfCounters::GetThreadCount() );
+            for ( ULONG s = 0; s < FLIGHT_STAGE_COUNT; s++ )
+            {
+                char szLine[ 256 ];
+                PrintStageCounters( szLine, (FLIGHTSTAGE)s );
+                printf( "counters: %s\n", szLine );
+
+            } // Next Stage
+
+        } // End if counting
+
+        // Write the measurements out for comparison with other runs
+        if ( m_szReportFile[0] )
+        {
+            if ( !WriteReport( m_szReportFile ) ) return 1;
+            printf( "report: written to %s\n", m_szReportFile );
+
+        } // End if report
+
+        // Check the run against its references, failing if either differs
+        bool bImage    = VerifyImage();
+        bool bBaseline = VerifyBaseline();
+        if ( !bImage || !bBaseline ) return 1;
+
+        return 0;
+
+    } // End if headless
+
+#ifdef _WIN32
     MSG		msg;
 
     // Start main loop
@@ -277,42 +671,317 @@ int CGameApp::BeginGame()
         else 
         {
 			// Advance Game Frame.
-			FrameAdvance();
+			if ( !FrameAdvance() )
+            {
+                MessageBox( m_hWnd, _T("Out of memory for the frame's transformed vertices."), _T("Fatal Error"), MB_OK | MB_ICONSTOP );
+                return 1;
+
+            } // End if frame failed
 
 		} // End If messages waiting
 	
     } // Until quit message is receieved
+#endif
 
     return 0;
 }
 
+//-----------------------------------------------------------------------------
+// Name : WriteReport () (Private)
+// Desc : Writes the measurements of a headless run as JSON, so that runs
+//        (of the same scene, with a fixed time step) can be compared by
+//        machine. Rates are over the last run's measured frames' total
+//        time.
+// Note : Edges are the lines drawn in wireframe, and the three edges of
+//        each triangle filled in solid mode.
+//-----------------------------------------------------------------------------
+bool CGameApp::WriteReport( const char * pFileName ) const
+{
+    TIMERFRAMESTATS FrameTimes;
+    FILE          * pFile;
+    const char    * pScene = m_szMeshFile[0] ? "mesh" : ( m_nSphereSlices > 0 ) ? "sphere" : "cube";
+
+    // Rates need at least one measured frame
+    m_Timer.GetFrameStats( FrameTimes );
+    if ( FrameTimes.Frames == 0 || m_nStatsFrames == 0 ) return false;
+
+    double Seconds  = (double)FrameTimes.Mean * FrameTimes.Frames;
+    double Frames   = (double)m_nStatsFrames;
+    double Edges    = (double)m_TotalStats.LinesDrawn + 3.0 * (double)m_TotalStats.TrianglesDrawn;
+    double Vertices = (double)m_TotalStats.VerticesTransformed;
+
+    if (!( pFile = fopen( pFileName, "w" ) )) return false;
+
+    // Describe the scene, then what it cost to render
+    fprintf( pFile, "{\n" );
+    fprintf( pFile, "  \"scene\": \"%s\",\n", pScene );
+    fprintf( pFile, "  \"objects\": %u,\n", (unsigned int)m_nObjectCount );
+    fprintf( pFile, "  \"mesh_vertices\": %u,\n", (unsigned int)m_Mesh.m_nVertexCount );
+    fprintf( pFile, "  \"mesh_polygons\": %u,\n", (unsigned int)m_Mesh.m_nPolygonCount );
+    fprintf( pFile, "  \"solid\": %s,\n", m_bSolid ? "true" : "false" );
+    fprintf( pFile, "  \"threads\": %u,\n", (unsigned int)m_JobSystem.GetThreadCount() );
+    fprintf( pFile, "  \"timestep_ms\": %.3f,\n", m_Timer.GetFixedStep() * 1e3 );
+    fprintf( pFile, "  \"warmup_frames\": %u,\n", (unsigned int)m_nWarmupFrames );
+    fprintf( pFile, "  \"frames\": %u,\n", (unsigned int)m_nStatsFrames );
+    fprintf( pFile, "  \"runs\": %u,\n", (unsigned int)m_nRunCount );
+    fprintf( pFile, "  \"seconds\": %.6f,\n", Seconds );
+    fprintf( pFile, "  \"frames_per_second\": %.3f,\n", FrameTimes.Frames / Seconds );
+    fprintf( pFile, "  \"ns_per_vertex\": %.3f,\n", ( Vertices > 0.0 ) ? Seconds * 1e9 / (Vertices * FrameTimes.Frames / Frames) : 0.0 );
+    fprintf( pFile, "  \"edges_per_second\": %.1f,\n", Edges * FrameTimes.Frames / Frames / Seconds );
+    fprintf( pFile, "  \"objects_drawn_per_frame\": %.3f,\n", m_TotalStats.ObjectsDrawn / Frames );
+    fprintf( pFile, "  \"vertices_per_frame\": %.3f,\n", Vertices / Frames );
+    fprintf( pFile, "  \"edges_per_frame\": %.3f,\n", Edges / Frames );
+    fprintf( pFile, "  \"triangles_per_frame\": %.3f,\n", m_TotalStats.TrianglesDrawn / Frames );
+    fprintf( pFile, "  \"frame_ms\": { \"mean\": %.4f, \"p50\": %.4f, \"best_p50\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f },\n",
+             FrameTimes.Mean * 1e3, FrameTimes.P50 * 1e3, m_fBestP50 * 1e3, FrameTimes.P95 * 1e3, FrameTimes.P99 * 1e3, FrameTimes.Max * 1e3 );
+
+    // Hardware events counted in each stage (per frame), where available
+    if ( CPerfCounters::IsOpen() )
+    {
+        fprintf( pFile, "  \"counters\": {\n" );
+        for ( ULONG s = 0; s < FLIGHT_STAGE_COUNT; s++ )
+        {
+            const PERFSAMPLE & Sample = m_Counters.GetStage( s );
+            fprintf( pFile, "    \"%s\": {", CFlightRecorder::GetStageName( (FLIGHTSTAGE)s ) );
+            for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ )
+            {
+                fprintf( pFile, "%s \"%s\": ", c ? "," : "", CPerfCounters::GetCounterName( (PERFCOUNTER)c ) );
+                if ( CPerfCounters::IsCounting( (PERFCOUNTER)c ) ) fprintf( pFile, "%.1f", Sample.Count[c] / Frames );
+                else fprintf( pFile, "null" );
+
+            } // Next Counter
+            fprintf( pFile, " }%s\n", ( s + 1 < FLIGHT_STAGE_COUNT ) ? "," : "" );
+
+        } // Next Stage
+        fprintf( pFile, "  },\n" );
+
+    } // End if counting
+    fprintf( pFile, "  \"hitches\": %u\n", (unsigned int)FrameTimes.Hitches );
+    fprintf( pFile, "}\n" );
+
+    // Success?
+    bool bWritten = ( ferror( pFile ) == 0 );
+    fclose( pFile );
+    return bWritten;
+}
+
+//-----------------------------------------------------------------------------
+// Name : MarkStage () (Private)
+// Desc : Ends a stage of the frame, for both the flight recorder and the
+//        hardware counters.
+//-----------------------------------------------------------------------------
+void CGameApp::MarkStage( FLIGHTSTAGE Stage )
+{
+    m_FlightRecorder.MarkStage( Stage );
+    m_Counters.MarkStage( Stage );
+}
+
+//-----------------------------------------------------------------------------
+// Name : PrintStageCounters () (Private)
+// Desc : Formats the events counted in a stage, averaged over the measured
+//        frames, into a line of at least 256 characters. Counters which are
+//        not available are left out.
+//-----------------------------------------------------------------------------
+void CGameApp::PrintStageCounters( char * pszLine, FLIGHTSTAGE Stage ) const
+{
+    const PERFSAMPLE & Sample = m_Counters.GetStage( Stage );
+    double             Frames   = (double)m_nStatsFrames;
+    double             Vertices = (double)m_TotalStats.VerticesTransformed;
+    const char       * pszSeparator = "";
+    int                Length;
+
+    Length = sprintf( pszLine, "%-9s ", CFlightRecorder::GetStageName( Stage ) );
+    if ( CPerfCounters::IsCounting( PERF_CYCLES ) && CPerfCounters::IsCounting( PERF_INSTRUCTIONS ) && Sample.Count[ PERF_CYCLES ] > 0 )
+        Length += sprintf( pszLine + Length, "ipc %.2f, ", (double)Sample.Count[ PERF_INSTRUCTIONS ] / (double)Sample.Count[ PERF_CYCLES ] );
+
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ )
+    {
+        if ( !CPerfCounters::IsCounting( (PERFCOUNTER)c ) ) continue;
+        Length += sprintf( pszLine + Length, "%s%s %.0f", pszSeparator, CPerfCounters::GetCounterName( (PERFCOUNTER)c ), Sample.Count[c] / Frames );
+        pszSeparator = ", ";
+
+    } // Next Counter
+
+    if ( CPerfCounters::IsCounting( PERF_CACHE_MISSES ) && Vertices > 0.0 )
+        Length += sprintf( pszLine + Length, ", cache_misses/vertex %.4f", Sample.Count[ PERF_CACHE_MISSES ] / Vertices );
+    if ( CPerfCounters::IsCounting( PERF_BRANCH_MISSES ) && Vertices > 0.0 )
+        sprintf( pszLine + Length, ", branch_misses/vertex %.4f", Sample.Count[ PERF_BRANCH_MISSES ] / Vertices );
+}
+
+//-----------------------------------------------------------------------------
+// Name : VerifyImage () (Private)
+// Desc : Compares the final headless frame with the reference image, if one
+//        was given, returning false if too many pixels differ or there is
+//        no reference. With -update the reference is written from this
+//        frame instead, to be checked by eye.
+//-----------------------------------------------------------------------------
+bool CGameApp::VerifyImage( ) const
+{
+    FILE * pFile;
+    ULONG  Differing, Pixels = m_pFrameBuffer->GetWidth() * m_pFrameBuffer->GetHeight();
+
+    if ( !m_szReferenceFile[0] ) return true;
+
+    // Record the reference only when asked to
+    if ( m_bUpdate )
+    {
+        if ( !m_pFrameBuffer->WritePPM( m_szReferenceFile ) ) return false;
+        printf( "verify: reference %s written\n", m_szReferenceFile );
+        return true;
+
+    } // End if updating
+    if (!( pFile = fopen( m_szReferenceFile, "rb" ) ))
+    {
+        printf( "verify: reference %s is missing (-update writes it) - FAILED\n", m_szReferenceFile );
+        return false;
+
+    } // End if no reference
+    fclose( pFile );
+
+    if ( !m_pFrameBuffer->ComparePPM( m_szReferenceFile, m_nColorTolerance, Differing ) )
+    {
+        printf( "verify: reference %s could not be read, or is not %ux%u - FAILED\n", m_szReferenceFile,
+                (unsigned int)m_pFrameBuffer->GetWidth(), (unsigned int)m_pFrameBuffer->GetHeight() );
+        return false;
+
+    } // End if unreadable
+
+    bool bPassed = ( (float)Differing <= m_fPixelTolerance * Pixels );
+    printf( "verify: %u pixels (%.3f%%) differ from %s by more than %u - %s\n", (unsigned int)Differing,
+            Differing * 100.0 / Pixels, m_szReferenceFile, (unsigned int)m_nColorTolerance, bPassed ? "passed" : "FAILED" );
+    return bPassed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : VerifyBaseline () (Private)
+// Desc : Compares the lowest median frame time of the runs with that of the
+//        baseline report, if one was given, returning false if it is slower
+//        by more than the regression allowed or there is no baseline. With
+//        -update the baseline is written from this run instead.
+// Note : The mean (and so the frame rate, which is reported alongside) is
+//        thrown by the odd descheduled frame, and a single run's median by
+//        a busy moment, so only the best median of several runs is gated.
+//        Baselines under VERIFY_MIN_FRAME_TIME swing by more than any
+//        sensible regression between identical runs, so are only reported.
+//-----------------------------------------------------------------------------
+bool CGameApp::VerifyBaseline( ) const
+{
+    TIMERFRAMESTATS FrameTimes;
+    char            szReport[ 4096 ];
+    FILE          * pFile;
+    size_t          Length;
+    double          BaseRate, BaseP50;
+
+    if ( !m_szBaselineFile[0] ) return true;
+
+    // Record the baseline only when asked to
+    if ( m_bUpdate )
+    {
+        if ( !WriteReport( m_szBaselineFile ) ) return false;
+        printf( "verify: baseline %s written\n", m_szBaselineFile );
+        return true;
+
+    } // End if updating
+    if (!( pFile = fopen( m_szBaselineFile, "rb" ) ))
+    {
+        printf( "verify: baseline %s is missing (-update writes it) - FAILED\n", m_szBaselineFile );
+        return false;
+
+    } // End if no baseline
+    Length = fread( szReport, 1, sizeof(szReport) - 1, pFile );
+    szReport[ Length ] = '\0';
+    fclose( pFile );
+
+    // Pull out the measurements we compare
+    if ( !ReadReportValue( szReport, "frames_per_second", BaseRate ) || !ReadReportValue( szReport, "best_p50", BaseP50 ) || BaseRate <= 0.0 )
+    {
+        printf( "verify: baseline %s could not be read - FAILED\n", m_szBaselineFile );
+        return false;
+
+    } // End if unreadable
+
+    m_Timer.GetFrameStats( FrameTimes );
+    if ( FrameTimes.Frames == 0 ) return false;
+    double Rate = FrameTimes.Frames / ((double)FrameTimes.Mean * FrameTimes.Frames), P50 = m_fBestP50 * 1e3;
+
+    bool bGated  = ( BaseP50 >= VERIFY_MIN_FRAME_TIME * 1e3 );
+    bool bPassed = !bGated || ( P50 <= BaseP50 * (1.0 + m_fRegression) );
+    printf( "verify: best p50 of %u runs %.3f ms against %.3f (%+.1f%%, %.0f%% allowed), %.1f frames/s against %.1f - %s\n",
+            (unsigned int)m_nRunCount, P50, BaseP50, (BaseP50 > 0.0) ? (P50 / BaseP50 - 1.0) * 100.0 : 0.0, m_fRegression * 100.0,
+            Rate, BaseRate, !bGated ? "not gated, too short" : bPassed ? "passed" : "FAILED" );
+    return bPassed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadReportValue () (Private, Static)
+// Desc : Reads the number stored against a key in a report written by
+//        WriteReport (the first, should the key appear more than once).
+//-----------------------------------------------------------------------------
+bool CGameApp::ReadReportValue( const char * pReport, const char * pKey, double & Value )
+{
+    char         szKey[ 64 ];
+    const char * pValue;
+
+    sprintf( szKey, "\"%.60s\":", pKey );
+    if (!( pValue = strstr( pReport, szKey ) )) return false;
+    return sscanf( pValue + strlen( szKey ), "%lf", &Value ) == 1;
+}
+
 //-----------------------------------------------------------------------------
 // Name : ShutDown ()
 // Desc : Shuts down the game engine, and frees up all resources.
 //-----------------------------------------------------------------------------
 bool CGameApp::ShutDown()
 {
-    // Destroy the frame buffer and associated DC's
-    if ( m_hdcFrameBuffer && m_hbmFrameBuffer )
+    // Write out the trace, now that no zones are open
+    if ( m_szTraceFile[0] && CProfiler::IsEnabled() )
     {
-        ::SelectObject( m_hdcFrameBuffer, m_hbmSelectOut );
-        ::DeleteObject( m_hbmFrameBuffer );
-        ::DeleteDC( m_hdcFrameBuffer );
-
-    } // End if
-
+        CProfiler::Enable( false );
+        if ( CProfiler::WriteTrace( m_szTraceFile ) )
+            printf( "trace: %u zones written to %s (%u older zones dropped)\n", (unsigned int)CProfiler::GetEventCount(),
+                    m_szTraceFile, (unsigned int)CProfiler::GetDroppedCount() );
+
+    } // End if tracing
+
+    // Destroy the frame buffer backend
+    if ( m_pFrameBuffer ) delete m_pFrameBuffer;
+    m_FlightRecorder.Release();
+
+    // Stop the job threads and release the tile bins
+    m_TileRenderer.Release();
+    m_TileRenderer.SetJobSystem( NULL );
+    m_JobSystem.Release();
+    CPerfCounters::CloseAll();
+
+    // Release the objects, the meshes, then the file any of them may be
+    // attached to
+    m_Entities.Release();
+    ReleaseObjectState();
+    m_MeshLOD.Release();
+    m_Mesh.Release();
+    m_MeshFile.Close();
+
+    // Release transformed vertex storage
+    if ( m_pScreenVertex ) delete []m_pScreenVertex;
+    if ( m_pClipVertex   ) delete []m_pClipVertex;
+    m_pScreenVertex     = NULL;
+    m_pClipVertex       = NULL;
+    m_nScreenVertexMax  = 0;
+
+#ifdef _WIN32
     // Destroy the render window
     if ( m_hWnd ) DestroyWindow( m_hWnd );
+    m_hWnd              = NULL;
+#endif
     
     // Clear all variables
-    m_hWnd              = NULL;
-    m_hbmFrameBuffer    = NULL;
-    m_hdcFrameBuffer    = NULL;
+    m_pFrameBuffer      = NULL;
     
     // Shutdown Success
     return true;
 }
 
+#ifdef _WIN32
 //-----------------------------------------------------------------------------
 // Name : StaticWndProc () (Static Callback)
 // Desc : This is the main messge pump for ALL display devices, it captures
@@ -387,7 +1056,7 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
             D3DXMatrixPerspectiveFovLH( &m_mtxProjection, D3DXToRadian( 60.0f ), fAspect, 1.01f, 1000.0f );
 
             // Rebuild the new frame buffer
-            BuildFrameBuffer( m_nViewWidth, m_nViewHeight );
+            if ( m_pFrameBuffer ) BuildFrameBuffer( m_nViewWidth, m_nViewHeight );
 
 			break;
 
@@ -410,17 +1079,25 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
             switch( LOWORD(wParam) )
             {
                 case ID_ANIM_ROTATION1:
-                    // Disable / enable rotation
-                    m_bRotation1 = !m_bRotation1;
+                    // Disable / enable rotation of the first object
+                    *m_Entities.GetFlags( 0 ) ^= ENTITY_SPINNING;
                     ::CheckMenuItem( ::GetMenu( m_hWnd ), ID_ANIM_ROTATION1, 
-                                     MF_BYCOMMAND | (m_bRotation1) ? MF_CHECKED :  MF_UNCHECKED );
+                                     MF_BYCOMMAND | ((GetObjectFlags( 0 ) & ENTITY_SPINNING) ? MF_CHECKED : MF_UNCHECKED) );
                     break;
 
                 case ID_ANIM_ROTATION2:
-                    // Disable / enable rotation
-                    m_bRotation2 = !m_bRotation2;
+                    // Disable / enable rotation of the second object
+                    if ( m_nObjectCount < 2 ) break;
+                    *m_Entities.GetFlags( 1 ) ^= ENTITY_SPINNING;
                     ::CheckMenuItem( ::GetMenu( m_hWnd ), ID_ANIM_ROTATION2, 
-                                     MF_BYCOMMAND | (m_bRotation2) ? MF_CHECKED :  MF_UNCHECKED );
+                                     MF_BYCOMMAND | ((GetObjectFlags( 1 ) & ENTITY_SPINNING) ? MF_CHECKED : MF_UNCHECKED) );
+                    break;
+
+                case ID_RENDER_SOLID:
+                    // Switch between wireframe and solid rendering
+                    m_bSolid = !m_bSolid;
+                    ::CheckMenuItem( ::GetMenu( m_hWnd ), ID_RENDER_SOLID, 
+                                     MF_BYCOMMAND | ((m_bSolid) ? MF_CHECKED : MF_UNCHECKED) );
                     break;
 
                 case ID_EXIT:
@@ -437,20 +1114,23 @@ LRESULT CGameApp::DisplayWndProc( HWND hWnd, UINT Message, WPARAM wParam, LPARAM
     
     return 0;
 }
+#endif // _WIN32
 
 //-----------------------------------------------------------------------------
 // Name : BuildObjects ()
-// Desc : Build our demonstration cube mesh, and the objects that instance it
+// Desc : Build our demonstration cube mesh (or load a mesh in its place),
+//        and the objects that instance it
 //-----------------------------------------------------------------------------
 bool CGameApp::BuildObjects()
 {
+    CMesh      Mesh;
     CPolygon * pPoly = NULL;
 
     // Add 6 polygons to this mesh.
-    if ( m_Mesh.AddPolygon( 6 ) < 0 ) return false;
+    if ( Mesh.AddPolygon( 6 ) < 0 ) return false;
 
     // Front Face
-    pPoly = m_Mesh.m_pPolygon[0];
+    pPoly = Mesh.m_pPolygon[0];
     if ( pPoly->AddVertex( 4 ) < 0 ) return false;
 
     pPoly->m_pVertex[0] = CVertex( -2,  2, -2 );
@@ -459,7 +1139,7 @@ bool CGameApp::BuildObjects()
     pPoly->m_pVertex[3] = CVertex( -2, -2, -2 );
     
     // Top Face
-    pPoly = m_Mesh.m_pPolygon[1];
+    pPoly = Mesh.m_pPolygon[1];
     if ( pPoly->AddVertex( 4 ) < 0 ) return false;
     
     pPoly->m_pVertex[0] = CVertex( -2,  2,  2 );
@@ -468,7 +1148,7 @@ bool CGameApp::BuildObjects()
     pPoly->m_pVertex[3] = CVertex( -2,  2, -2 );
 
     // Back Face
-    pPoly = m_Mesh.m_pPolygon[2];
+    pPoly = Mesh.m_pPolygon[2];
     if ( pPoly->AddVertex( 4 ) < 0 ) return false;
 
     pPoly->m_pVertex[0] = CVertex( -2, -2,  2 );
@@ -477,7 +1157,7 @@ bool CGameApp::BuildObjects()
     pPoly->m_pVertex[3] = CVertex( -2,  2,  2 ),
 
     // Bottom Face
-    pPoly = m_Mesh.m_pPolygon[3];
+    pPoly = Mesh.m_pPolygon[3];
     if ( pPoly->AddVertex( 4 ) < 0 ) return false;
 
     pPoly->m_pVertex[0] = CVertex( -2, -2, -2 );
@@ -486,7 +1166,7 @@ bool CGameApp::BuildObjects()
     pPoly->m_pVertex[3] = CVertex( -2, -2,  2 );
 
     // Left Face
-    pPoly = m_Mesh.m_pPolygon[4];
+    pPoly = Mesh.m_pPolygon[4];
     if ( pPoly->AddVertex( 4 ) < 0 ) return false;
 
     pPoly->m_pVertex[0] = CVertex( -2,  2,  2 );
@@ -495,7 +1175,7 @@ bool CGameApp::BuildObjects()
     pPoly->m_pVertex[3] = CVertex( -2, -2,  2 );
 
     // Right Face
-    pPoly = m_Mesh.m_pPolygon[5];
+    pPoly = Mesh.m_pPolygon[5];
     if ( pPoly->AddVertex( 4 ) < 0 ) return false;
 
     pPoly->m_pVertex[0] = CVertex(  2,  2, -2 );
@@ -503,156 +1183,955 @@ bool CGameApp::BuildObjects()
     pPoly->m_pVertex[2] = CVertex(  2, -2,  2 );
     pPoly->m_pVertex[3] = CVertex(  2, -2, -2 );
 
-    // Our two objects should reference this mesh
-    m_pObject[ 0 ].m_pMesh = &m_Mesh;
-    m_pObject[ 1 ].m_pMesh = &m_Mesh;
+    // A mesh file replaces the cube, bringing any simplified levels with it
+    bool bLoaded = (m_szMeshFile[0] != '\0');
+    if ( bLoaded )
+    {
+        if ( !LoadMeshFile( m_szMeshFile ) ) return false;
+
+    } // End if mesh file
+    else
+    {
+        // Convert to the compact shared vertex representation for rendering,
+        // or generate a sphere as detailed as asked for in its place
+        if ( m_nSphereSlices > 0 )
+        {
+            if ( !m_Mesh.BuildSphere( OBJECT_SPHERE_RADIUS, m_nSphereSlices, m_nSphereSlices / 2 ) ) return false;
+
+        } // End if sphere
+        else if ( !m_Mesh.BuildFromMesh( Mesh ) ) return false;
+
+        // Generate its simplified levels (the cube has little to give up)
+        if ( !m_MeshLOD.Build( &m_Mesh, LOD_MAX_LEVELS, OBJECT_LOD_SIZE ) ) return false;
+
+    } // End if generated
+
+    // Every object instances this mesh
+    ULONG hMesh = m_Entities.AddMesh( &m_Mesh, &m_MeshLOD );
+    if ( hMesh == ENTITY_INVALID || !AllocateObjectState( m_nObjectCount ) ) return false;
+
+    // Loaded meshes are centred and scaled to the size of the cube
+    D3DXMATRIX  mtxCentre;
+    D3DXVECTOR3 vecCentre( 0.0f, 0.0f, 0.0f );
+    float       fScale = 1.0f;
+    D3DXMatrixIdentity( &mtxCentre );
+    if ( bLoaded && m_Mesh.m_Bounds.m_fRadius > 0.0f )
+    {
+        D3DXMATRIX mtxScale;
+        vecCentre = m_Mesh.m_Bounds.m_vecCentre;
+        fScale    = sqrtf( 12.0f ) / m_Mesh.m_Bounds.m_fRadius;
+
+        D3DXMatrixTranslation( &mtxCentre, -vecCentre.x, -vecCentre.y, -vecCentre.z );
+        D3DXMatrixScaling( &mtxScale, fScale, fScale, fScale );
+        D3DXMatrixMultiply( &mtxCentre, &mtxCentre, &mtxScale );
+
+    } // End if loaded
+
+    // Angular velocities (degrees per second about x, y and z) of the first
+    // two objects, and the positions they are offset slightly to
+    static const D3DXVECTOR3 vecSpin[ OBJECT_COUNT ]     = { D3DXVECTOR3( 50.0f, 75.0f, 25.0f ), D3DXVECTOR3( 50.0f, -25.0f, -75.0f ) };
+    static const D3DXVECTOR3 vecPosition[ OBJECT_COUNT ] = { D3DXVECTOR3( -3.5f, 2.0f, 14.0f ), D3DXVECTOR3( 3.5f, -2.0f, 14.0f ) };
+    ULONG Columns = (ULONG)ceilf( sqrtf( (float)m_nObjectCount ) ), Seed = 1;
+
+    for ( ULONG i = 0; i < m_nObjectCount; i++ )
+    {
+        D3DXVECTOR3 vecRate, vecOrigin;
+        D3DXMATRIX  mtxTranslate;
+        ULONG       Flags = 0, Entity;
+
+        // Any further objects form a grid below and behind the first two,
+        // spinning at random, except for every fourth which stays still
+        if ( i < OBJECT_COUNT )
+        {
+            vecRate   = vecSpin[i];
+            vecOrigin = vecPosition[i];
+
+        } // End if original
+        else
+        {
+            ULONG Extra = i - OBJECT_COUNT;
+            float fRate[3];
+            for ( ULONG a = 0; a < 3; a++ )
+            {
+                Seed = Seed * 1664525 + 1013904223;
+                fRate[a] = (float)(Seed >> 24) - 128.0f;
+
+            } // Next Axis
+            vecRate = ( Extra % 4 == 3 ) ? D3DXVECTOR3( 0.0f, 0.0f, 0.0f ) : D3DXVECTOR3( fRate[0], fRate[1], fRate[2] );
+            vecOrigin = D3DXVECTOR3( ((float)(Extra % Columns) - (float)(Columns - 1) * 0.5f) * OBJECT_SPACING,
+                                     -8.0f, 24.0f + (float)(Extra / Columns) * OBJECT_SPACING );
+
+        } // End if extra
+
+        // Still objects are stored without a spin component (or a pose to
+        // turn), so animation never visits them
+        bool bSpin = ( vecRate.x != 0.0f || vecRate.y != 0.0f || vecRate.z != 0.0f );
+        Entity = m_Entities.Create( COMPONENT_WORLD | COMPONENT_MESH | COMPONENT_FLAGS | (bSpin ? COMPONENT_SPIN | COMPONENT_POSE : 0) );
+        if ( Entity != i ) return false;
+
+        // The cube (or sphere) is closed, so its back faces are always hidden
+        // (nothing is known about loaded meshes). The first cube hides whatever passes
+        // behind it.
+        if ( !bLoaded ) Flags |= ENTITY_BACKFACECULL;
+        if ( i == 0   ) Flags |= ENTITY_OCCLUDER;
+        if ( bSpin    ) Flags |= ENTITY_SPINNING;
+        *m_Entities.GetFlags( Entity )      = Flags;
+        *m_Entities.GetMeshHandle( Entity ) = hMesh;
+        if ( bSpin ) *m_Entities.GetSpin( Entity ) = vecRate * (D3DX_PI / 180.0f);
+
+        // Spinning objects turn about the mesh origin, which centring moves
+        if ( bSpin )
+        {
+            m_Entities.SetPose( Entity, vecOrigin - vecCentre * fScale, fScale );
+
+        } // End if spinning
+        else
+        {
+            D3DXMatrixTranslation( &mtxTranslate, vecOrigin.x, vecOrigin.y, vecOrigin.z );
+            D3DXMatrixMultiply( m_Entities.GetWorld( Entity ), &mtxCentre, &mtxTranslate );
+
+        } // End if still
+
+    } // Next Object
 
-    // Set both objects matrices so that they are offset slightly
-    D3DXMatrixTranslation( &m_pObject[ 0 ].m_mtxWorld, -3.5f,  2.0f, 14.0f );
-    D3DXMatrixTranslation( &m_pObject[ 1 ].m_mtxWorld,  3.5f, -2.0f, 14.0f );
+    // Index the objects' world bounds, refitted as they move
+    CBounds * pBounds = new (std::nothrow) CBounds[ m_nObjectCount ];
+    if ( !pBounds ) return false;
+    for ( ULONG i = 0; i < m_nObjectCount; i++ ) GetObjectSource( i ).pMesh->m_Bounds.Transform( *m_Entities.GetWorld( i ), pBounds[i] );
+    bool bBuilt = m_SceneBVH.Build( pBounds, m_nObjectCount );
+    delete []pBounds;
     
+    // Success?
+    return bBuilt;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AllocateObjectState () (Private)
+// Desc : Allocates the per frame state kept for each object.
+//-----------------------------------------------------------------------------
+bool CGameApp::AllocateObjectState( ULONG Count )
+{
+    ReleaseObjectState();
+    m_pVertexStart    = new (std::nothrow) ULONG[ Count ];
+    m_pObjectCull     = new (std::nothrow) CULLRESULT[ Count ];
+    m_pObjectPlanes   = new (std::nothrow) ULONG[ Count ];
+    m_pObjectEye      = new (std::nothrow) D3DXVECTOR3[ Count ];
+    m_pObjectBackFace = new (std::nothrow) bool[ Count ];
+    m_pObjectRect     = new (std::nothrow) SCREENRECT[ Count ];
+    m_pObjectTestable = new (std::nothrow) bool[ Count ];
+    m_pObjectOccluded = new (std::nothrow) bool[ Count ];
+    m_pVisibleList    = new (std::nothrow) ULONG[ Count ];
+    m_pObjectLevel    = new (std::nothrow) ULONG[ Count ];
+
+    return m_pVertexStart && m_pObjectCull && m_pObjectPlanes && m_pObjectEye && m_pObjectBackFace && m_pObjectRect &&
+           m_pObjectTestable && m_pObjectOccluded && m_pVisibleList && m_pObjectLevel;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseObjectState () (Private)
+// Desc : Frees the per frame object state.
+//-----------------------------------------------------------------------------
+void CGameApp::ReleaseObjectState( )
+{
+    if ( m_pVertexStart    ) delete []m_pVertexStart;
+    if ( m_pObjectCull     ) delete []m_pObjectCull;
+    if ( m_pObjectPlanes   ) delete []m_pObjectPlanes;
+    if ( m_pObjectEye      ) delete []m_pObjectEye;
+    if ( m_pObjectBackFace ) delete []m_pObjectBackFace;
+    if ( m_pObjectRect     ) delete []m_pObjectRect;
+    if ( m_pObjectTestable ) delete []m_pObjectTestable;
+    if ( m_pObjectOccluded ) delete []m_pObjectOccluded;
+    if ( m_pVisibleList    ) delete []m_pVisibleList;
+    if ( m_pObjectLevel    ) delete []m_pObjectLevel;
+
+    m_pVertexStart    = NULL;
+    m_pObjectCull     = NULL;
+    m_pObjectPlanes   = NULL;
+    m_pObjectEye      = NULL;
+    m_pObjectBackFace = NULL;
+    m_pObjectRect     = NULL;
+    m_pObjectTestable = NULL;
+    m_pObjectOccluded = NULL;
+    m_pVisibleList    = NULL;
+    m_pObjectLevel    = NULL;
+    m_nVisibleCount   = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : LoadMeshFile () (Private)
+// Desc : Maps a mesh file and attaches m_Mesh to its first mesh, and the
+//        detail chain to any simplified levels stored after it. Nothing is
+//        copied or parsed, the geometry is paged in as it is first drawn.
+//-----------------------------------------------------------------------------
+bool CGameApp::LoadMeshFile( const char * pFileName )
+{
+    if ( !m_MeshFile.Open( pFileName ) || !m_MeshFile.GetMesh( 0, m_Mesh ) ) return false;
+
+    m_MeshLOD.Create( &m_Mesh, OBJECT_LOD_SIZE );
+    for ( ULONG i = 1; i < m_MeshFile.GetMeshCount() && m_MeshFile.GetEntry( i ).Level == i; i++ )
+    {
+        CIndexedMesh * pLevel = m_MeshLOD.AddLevel( m_MeshFile.GetEntry( i ).Error );
+        if ( !pLevel || !m_MeshFile.GetMesh( i, *pLevel ) ) break;
+
+    } // Next Level
+
     // Success!
     return true;
 }
 
 //-----------------------------------------------------------------------------
 // Name : FrameAdvance () (Private)
-// Desc : Called to signal that we are now rendering the next frame.
+// Desc : Called to signal that we are now rendering the next frame. Returns
+//        false (having reported why) if the frame could not be drawn.
 //-----------------------------------------------------------------------------
-void CGameApp::FrameAdvance()
+bool CGameApp::FrameAdvance()
 {
-    CMesh      *pMesh = NULL;
-    TCHAR       lpszFPS[30];
+    ULONG       nVertexCount = 0;
+    CJobCounter Animated, Culled, Transformed;
 
-    // Advance the timer
-    m_Timer.Tick( 60.0f );
-    
-    // Animate the two objects
-    AnimateObjects();
+    // Advance the timer (waiting out a locked frame)
+    {
+        PROFILE_ZONE( "Tick" );
+        m_Timer.Tick( m_fLockFPS );
+
+    } // End Tick zone
+    PROFILE_ZONE( "FrameAdvance" );
+    m_FlightRecorder.BeginFrame( m_Timer.GetFrameTime() );
+    m_Counters.MarkStage( FLIGHT_WAIT );
+
+    // Cache the view / projection matrices for this frame
+    m_Transform.SetViewProjection( m_mtxView, m_mtxProjection );
 
-    // Clear the frame buffer ready for drawing
-    ClearFrameBuffer( 0x00FFFFFF );
+    // Animate every object, clearing the frame buffer ready for drawing
+    // while that runs
+    m_JobSystem.ParallelFor( AnimateObjectsJob, this, m_Entities.GetChunkCount(), ANIMATE_JOB_GRAIN, &Animated );
+    {
+        PROFILE_ZONE( "ClearFrameBuffer" );
+        ClearFrameBuffer( 0x00FFFFFF );
+        if ( m_bSolid ) m_pFrameBuffer->ClearDepth( 1.0f );
+
+    } // End ClearFrameBuffer zone
+    m_TileRenderer.BeginFrame();
+    ZeroMemory( &m_FrameStats, sizeof(FRAMESTATS) );
+
+    // Find the objects within the frustum, then cull them more exactly
+    // (transforming occluders straight away)
+    m_JobSystem.Wait( &Animated );
+    MarkStage( FLIGHT_ANIMATE );
+    {
+        PROFILE_ZONE( "QueryVisibleObjects" );
+        QueryVisibleObjects();
+
+    } // End QueryVisibleObjects zone
+
+    // Lay out the transformed vertices of just those objects end to end
+    for ( ULONG i = 0; i < m_nVisibleCount; i++ )
+    {
+        m_pVertexStart[ m_pVisibleList[i] ] = nVertexCount;
+        nVertexCount += GetObjectSource( m_pVisibleList[i] ).pMesh->m_nVertexCount;
+
+    } // Next Visible Object
+    if ( !ReserveScreenVertices( nVertexCount ) )
+    {
+        fprintf( stderr, "Out of memory for %u transformed vertices.\n", (unsigned int)nVertexCount );
+        return false;
+
+    } // End if no room
+    m_JobSystem.ParallelFor( CullObjectsJob, this, m_nVisibleCount, TRANSFORM_JOB_GRAIN, &Culled );
+
+    // Build the occlusion buffer, and test every other object against it
+    m_JobSystem.Wait( &Culled );
+    MarkStage( FLIGHT_CULL );
+    {
+        PROFILE_ZONE( "DrawOccluders" );
+        DrawOccluders();
+
+    } // End DrawOccluders zone
+    MarkStage( FLIGHT_OCCLUDE );
+
+    // Transform whatever remains visible, joining (helping out) before drawing
+    m_JobSystem.ParallelFor( TransformObjectsJob, this, m_nVisibleCount, TRANSFORM_JOB_GRAIN, &Transformed );
+    {
+        PROFILE_ZONE( "WaitTransformed" );
+        m_JobSystem.Wait( &Transformed );
+
+    } // End WaitTransformed zone
+    MarkStage( FLIGHT_TRANSFORM );
+
+    // Draw every object still visible
+    DrawObjects();
+    MarkStage( FLIGHT_DRAW );
+
+    // Rasterize every tile touched this frame
+    {
+        PROFILE_ZONE( "RasterizeTiles" );
+        m_TileRenderer.EndFrame();
+
+    } // End RasterizeTiles zone
+    m_FrameStats.LinesDrawn = m_TileRenderer.GetLineCount();
+    MarkStage( FLIGHT_RASTERIZE );
+
+    // Accumulate statistics
+    m_TotalStats.ObjectsDrawn   += m_FrameStats.ObjectsDrawn;
+    m_TotalStats.ObjectsCulled  += m_FrameStats.ObjectsCulled;
+    m_TotalStats.ObjectsClipped += m_FrameStats.ObjectsClipped;
+    m_TotalStats.EdgesClipped   += m_FrameStats.EdgesClipped;
+    m_TotalStats.EdgesRejected  += m_FrameStats.EdgesRejected;
+    m_TotalStats.PolygonsDrawn  += m_FrameStats.PolygonsDrawn;
+    m_TotalStats.PolygonsRejected += m_FrameStats.PolygonsRejected;
+    m_TotalStats.TrianglesDrawn += m_FrameStats.TrianglesDrawn;
+    m_TotalStats.VerticesTransformed += m_FrameStats.VerticesTransformed;
+    m_TotalStats.LinesDrawn     += m_FrameStats.LinesDrawn;
+    m_TotalStats.ObjectsTested  += m_FrameStats.ObjectsTested;
+    m_TotalStats.ObjectsOccluded += m_FrameStats.ObjectsOccluded;
+    for ( ULONG i = 0; i < LOD_MAX_LEVELS; i++ )
+    {
+        m_TotalStats.LevelObjects[i]   += m_FrameStats.LevelObjects[i];
+        m_TotalStats.LevelTriangles[i] += m_FrameStats.LevelTriangles[i];
+
+    } // Next Level
+    m_nStatsFrames++;
+
+    // Keep the counts with the frame's timings
+    if ( m_FlightRecorder.IsCreated() )
+    {
+        FLIGHTRECORD & Record  = m_FlightRecorder.GetRecord();
+        Record.ObjectsDrawn    = m_FrameStats.ObjectsDrawn;
+        Record.ObjectsCulled   = m_FrameStats.ObjectsCulled;
+        Record.PolygonsDrawn   = m_FrameStats.PolygonsDrawn;
+        Record.TrianglesDrawn  = m_TileRenderer.GetTriangleCount();
+        Record.LinesDrawn      = m_FrameStats.LinesDrawn;
+
+    } // End if recording
+
+    // Display Frame Rate and visibility
+    DrawOverlay();
+    MarkStage( FLIGHT_OVERLAY );
     
-    // Loop through each object
-    for ( ULONG i = 0; i < 2; i++ )
+    // Present the buffer
+    PresentFrameBuffer();
+    MarkStage( FLIGHT_PRESENT );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawOverlay () (Private)
+// Desc : Prints the frame rate, frame times and last frame's statistics over
+//        the frame.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawOverlay( )
+{
+    TCHAR       lpszFPS[30], lpszStats[80];
+    TIMERFRAMESTATS FrameTimes;
+
+    PROFILE_ZONE( "DrawOverlay" );
+
+    // Frame Rate and visibility
+    m_Timer.GetFrameRate( lpszFPS );
+    m_pFrameBuffer->PrintText( 5, 5, lpszFPS );
+    _stprintf( lpszStats, _T("Objects: %u drawn, %u culled, %u clipped"), (unsigned int)m_FrameStats.ObjectsDrawn,
+               (unsigned int)m_FrameStats.ObjectsCulled, (unsigned int)m_FrameStats.ObjectsClipped );
+    m_pFrameBuffer->PrintText( 5, 25, lpszStats );
+    _stprintf( lpszStats, _T("Polygons: %u drawn, %u back facing, %u triangles"), (unsigned int)m_FrameStats.PolygonsDrawn,
+               (unsigned int)m_FrameStats.PolygonsRejected, (unsigned int)m_FrameStats.TrianglesDrawn );
+    m_pFrameBuffer->PrintText( 5, 45, lpszStats );
+    _stprintf( lpszStats, _T("Occlusion: %u tested, %u occluded"), (unsigned int)m_FrameStats.ObjectsTested,
+               (unsigned int)m_FrameStats.ObjectsOccluded );
+    m_pFrameBuffer->PrintText( 5, 65, lpszStats );
+    _stprintf( lpszStats, _T("LOD triangles: %u / %u / %u / %u"), (unsigned int)m_FrameStats.LevelTriangles[0],
+               (unsigned int)m_FrameStats.LevelTriangles[1], (unsigned int)m_FrameStats.LevelTriangles[2],
+               (unsigned int)m_FrameStats.LevelTriangles[3] );
+    m_pFrameBuffer->PrintText( 5, 85, lpszStats );
+
+    // Display the slowest of the recent frames, which the rate hides
+    m_Timer.GetFrameStats( FrameTimes, true );
+    _stprintf( lpszStats, _T("Frame ms: %.1f median, %.1f p99, %.1f max, %u hitches"), FrameTimes.P50 * 1000.0f,
+               FrameTimes.P99 * 1000.0f, FrameTimes.Max * 1000.0f, (unsigned int)FrameTimes.Hitches );
+    m_pFrameBuffer->PrintText( 5, 105, lpszStats );
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawPrimitive () (Private)
+// Desc : This function renders an individual polygon of the mesh specified.
+// Note : The mesh vertices must already have been transformed, pVertices
+//        being the first of them.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawPrimitive( const CIndexedMesh * pMesh, const CScreenVertex * pVertices, ULONG Polygon )
+{
+    const ULONG * pIndex = pMesh->GetPolygonIndices( Polygon );
+    ULONG         nCount = pMesh->GetPolygonVertexCount( Polygon );
+
+    // Validate
+    if ( nCount < 2 ) return;
+
+    // Draw each edge, closing back round to the first vertex
+    for ( ULONG v = 0; v < nCount; v++ ) 
+    {
+        DrawLine( pVertices[ pIndex[ v ] ], pVertices[ pIndex[ (v + 1) % nCount ] ], 0 );
+
+    } // Next Vertex
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawPrimitiveClipped () (Private)
+// Desc : Renders an individual polygon of an object which crosses the near
+//        or far plane. Each edge is clipped against those two planes in
+//        homogeneous space before the divide, so vertices behind the eye
+//        never reach the rasterizer.
+// Note : The side planes are left to the rasterizer, whose clipping never
+//        alters the pixels of a line. Edges needing no clipping use the
+//        transformed vertices directly, so they match DrawPrimitive exactly.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawPrimitiveClipped( const CIndexedMesh * pMesh, const CScreenVertex * pVertices,
+                                     const CClipVertex * pClipVertices, ULONG Polygon )
+{
+    const ULONG * pIndex = pMesh->GetPolygonIndices( Polygon );
+    ULONG         nCount = pMesh->GetPolygonVertexCount( Polygon );
+
+    // Validate
+    if ( nCount < 2 ) return;
+
+    for ( ULONG v = 0; v < nCount; v++ ) 
+    {
+        ULONG               i1 = pIndex[ v ], i2 = pIndex[ (v + 1) % nCount ];
+        const CClipVertex & c1 = pClipVertices[ i1 ], & c2 = pClipVertices[ i2 ];
+        CClipVertex         Clip;
+        CScreenVertex       vtx1, vtx2;
+        float               t1 = 0.0f, t2 = 1.0f;
+
+        // Signed distances from the near (z = 0) and far (z = w) planes
+        float Near1 = c1.z, Near2 = c2.z;
+        float Far1  = c1.w - c1.z, Far2 = c2.w - c2.z;
+
+        // Trivially accept, or reject if both ends are beyond the same plane
+        if ( Near1 >= 0.0f && Near2 >= 0.0f && Far1 >= 0.0f && Far2 >= 0.0f )
+        {
+            DrawLine( pVertices[ i1 ], pVertices[ i2 ], 0 );
+            continue;
+
+        } // End if inside
+        if ( (Near1 < 0.0f && Near2 < 0.0f) || (Far1 < 0.0f && Far2 < 0.0f) ) { m_FrameStats.EdgesRejected++; continue; }
+
+        // Shorten the parametric range to the part in front of each plane
+        if ( Near1 < 0.0f || Near2 < 0.0f )
+        {
+            float t = Near1 / (Near1 - Near2);
+            if ( Near1 < 0.0f ) { if ( t > t1 ) t1 = t; } else { if ( t < t2 ) t2 = t; }
+
+        } // End if near
+        if ( Far1 < 0.0f || Far2 < 0.0f )
+        {
+            float t = Far1 / (Far1 - Far2);
+            if ( Far1 < 0.0f ) { if ( t > t1 ) t1 = t; } else { if ( t < t2 ) t2 = t; }
+
+        } // End if far
+        if ( t1 > t2 ) { m_FrameStats.EdgesRejected++; continue; }
+
+        // Build and project the new end points (unclipped ends are reused)
+        if ( t1 > 0.0f )
+        {
+            Clip.x = c1.x + (c2.x - c1.x) * t1; Clip.y = c1.y + (c2.y - c1.y) * t1;
+            Clip.z = c1.z + (c2.z - c1.z) * t1; Clip.w = c1.w + (c2.w - c1.w) * t1;
+            CTransformStage::Project( Clip, vtx1 );
+        }
+        else vtx1 = pVertices[ i1 ];
+
+        if ( t2 < 1.0f )
+        {
+            Clip.x = c1.x + (c2.x - c1.x) * t2; Clip.y = c1.y + (c2.y - c1.y) * t2;
+            Clip.z = c1.z + (c2.z - c1.z) * t2; Clip.w = c1.w + (c2.w - c1.w) * t2;
+            CTransformStage::Project( Clip, vtx2 );
+        }
+        else vtx2 = pVertices[ i2 ];
+
+        DrawLine( vtx1, vtx2, 0 );
+        m_FrameStats.EdgesClipped++;
+
+    } // Next Vertex
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawPrimitiveSolid () (Private)
+// Desc : Renders an individual polygon of the mesh as filled triangles, fanned
+//        out from its first vertex.
+// Note : If pClipVertices is supplied, triangles crossing the near / far
+//        planes, or extending beyond the rasterizer's guard band, are
+//        clipped in homogeneous space first.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawPrimitiveSolid( const CIndexedMesh * pMesh, const CScreenVertex * pVertices,
+                                   const CClipVertex * pClipVertices, ULONG Polygon, ULONG Color )
+{
+    const ULONG * pIndex = pMesh->GetPolygonIndices( Polygon );
+    ULONG         nCount = pMesh->GetPolygonVertexCount( Polygon );
+
+    // Leave a little room for rounding within the rasterizer's range
+    const float   fGuard = RASTER_TRIANGLE_GUARD - 64.0f;
+
+    // Validate
+    if ( nCount < 3 ) return;
+
+    for ( ULONG v = 1; v + 1 < nCount; v++ ) 
     {
-        // Store mesh for easy access
-        pMesh = m_pObject[i].m_pMesh;
+        ULONG         i0 = pIndex[ 0 ], i1 = pIndex[ v ], i2 = pIndex[ v + 1 ];
+        CClipVertex   In[3], Out[ TRANSFORM_CLIP_MAX ];
+        CScreenVertex Fan[ TRANSFORM_CLIP_MAX ];
+        ULONG         Code0, Code1, Code2, nOut;
+
+        // Triangles needing no clipping use the transformed vertices directly
+        if ( !pClipVertices )
+        {
+            m_TileRenderer.AddTriangle( pVertices[ i0 ], pVertices[ i1 ], pVertices[ i2 ], Color );
+            m_FrameStats.TrianglesDrawn++;
+            continue;
+
+        } // End if no clipping
+
+        In[0] = pClipVertices[ i0 ]; In[1] = pClipVertices[ i1 ]; In[2] = pClipVertices[ i2 ];
+        Code0 = CTransformStage::GetClipCode( In[0], fGuard );
+        Code1 = CTransformStage::GetClipCode( In[1], fGuard );
+        Code2 = CTransformStage::GetClipCode( In[2], fGuard );
+        if ( (Code0 | Code1 | Code2) == 0 )
+        {
+            m_TileRenderer.AddTriangle( pVertices[ i0 ], pVertices[ i1 ], pVertices[ i2 ], Color );
+            m_FrameStats.TrianglesDrawn++;
+            continue;
+
+        } // End if inside
+        if ( Code0 & Code1 & Code2 ) continue;
+
+        // Clip, then fan out the resulting convex polygon
+        nOut = CTransformStage::ClipTriangle( In, Out, fGuard );
+        for ( ULONG c = 0; c < nOut; c++ ) CTransformStage::Project( Out[c], Fan[c] );
+        for ( ULONG c = 1; c + 1 < nOut; c++ )
+        {
+            m_TileRenderer.AddTriangle( Fan[0], Fan[c], Fan[c + 1], Color );
+            m_FrameStats.TrianglesDrawn++;
+
+        } // Next Triangle
+
+    } // Next Triangle
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetClipPlanes () (Private)
+// Desc : Returns the frustum planes the object straddles which require
+//        clipping in the current render mode. Wireframe edges are only
+//        clipped at the near and far planes, the rasterizer handling the
+//        rest. Filled triangles may also need cutting back to the guard band.
+//-----------------------------------------------------------------------------
+ULONG CGameApp::GetClipPlanes( ULONG Object ) const
+{
+    if ( m_bSolid ) return m_pObjectPlanes[ Object ];
+    return m_pObjectPlanes[ Object ] & (FRUSTUM_NEAR | FRUSTUM_FAR);
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReserveScreenVertices () (Private)
+// Desc : Ensures the transformed vertex scratch buffers can hold at least the
+//        number of vertices specified, growing them geometrically if not.
+//-----------------------------------------------------------------------------
+bool CGameApp::ReserveScreenVertices( ULONG Count )
+{
+    ULONG nNewMax;
+
+    // Already large enough?
+    if ( Count <= m_nScreenVertexMax ) return true;
+
+    // Grow to at least double the current size
+    nNewMax = (m_nScreenVertexMax > 0) ? m_nScreenVertexMax * 2 : 64;
+    if ( nNewMax < Count ) nNewMax = Count;
+
+    // Contents are transient, so there is nothing to copy
+    if ( m_pScreenVertex ) delete []m_pScreenVertex;
+    if ( m_pClipVertex   ) delete []m_pClipVertex;
+    m_nScreenVertexMax = 0;
+    m_pClipVertex      = NULL;
+    if (!( m_pScreenVertex = new (std::nothrow) CScreenVertex[ nNewMax ] )) return false;
+    if (!( m_pClipVertex   = new (std::nothrow) CClipVertex[ nNewMax ] )) return false;
+    m_nScreenVertexMax = nNewMax;
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateChunk () (Private)
+// Desc : Spins the objects of one entity chunk by their angular velocities,
+//        then updates the world bounds of those which moved.
+// Note : Called from the job system, possibly for several chunks at once.
+//-----------------------------------------------------------------------------
+void CGameApp::AnimateChunk( ULONG Chunk )
+{
+    const ENTITYCHUNK & Data = m_Entities.GetChunk( Chunk );
+
+    // Objects without a spin component never move
+    if ( !Data.pSpin ) return;
+    m_Entities.AnimateChunk( Chunk, m_Timer.GetTimeElapsed() );
+
+    // Keep the scene hierarchy up to date with the objects' new positions
+    for ( ULONG i = 0; i < Data.Count; i++ )
+    {
+        if ( Data.pFlags[i] & ENTITY_SPINNING ) UpdateObjectBounds( Data.pEntity[i] );
+
+    } // Next Entity
+}
+
+//-----------------------------------------------------------------------------
+// Name : UpdateObjectBounds () (Private)
+// Desc : Stores the object's current world space bounds in the scene
+//        hierarchy, ready for the next refit.
+//-----------------------------------------------------------------------------
+void CGameApp::UpdateObjectBounds( ULONG Object )
+{
+    CBounds Bounds;
+
+    GetObjectSource( Object ).pMesh->m_Bounds.Transform( *m_Entities.GetWorld( Object ), Bounds );
+    m_SceneBVH.SetBounds( Object, Bounds );
+}
+
+//-----------------------------------------------------------------------------
+// Name : QueryVisibleObjects () (Private)
+// Desc : Refits the scene hierarchy to this frame's object positions, then
+//        collects the objects whose world bounds reach into the frustum.
+//        Every later pass of the frame works through this list alone, so
+//        nothing else is looked at, and no per-object state is kept for it.
+//-----------------------------------------------------------------------------
+void CGameApp::QueryVisibleObjects( )
+{
+    D3DXMATRIX mtxViewProj;
+    D3DXPLANE  Planes[6];
+
+    // World space frustum planes
+    D3DXMatrixMultiply( &mtxViewProj, &m_mtxView, &m_mtxProjection );
+    CTransformStage::GetFrustumPlanes( mtxViewProj, Planes );
+
+    m_SceneBVH.Refit();
+    m_nVisibleCount = m_SceneBVH.QueryFrustum( Planes, 6, m_pVisibleList, m_nObjectCount );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CullObject () (Private)
+// Desc : Tests a single object found by the hierarchy against the view
+//        frustum, starting its state for the frame afresh. Visible occluders
+//        are transformed straight away, ready to be drawn into the occlusion
+//        buffer, while other objects just record their screen extents.
+// Note : Called from the job system, so works on its own copy of the
+//        transform stage rather than altering the shared one.
+//-----------------------------------------------------------------------------
+void CGameApp::CullObject( ULONG Object )
+{
+    const ENTITYMESH   & Source = GetObjectSource( Object );
+    const CIndexedMesh * pMesh = Source.pMesh;
+    CTransformStage      Stage = m_Transform;
+
+    // Nothing is known of the object yet this frame
+    m_pObjectOccluded[ Object ] = false;
+    m_pObjectTestable[ Object ] = false;
+    m_pObjectLevel[ Object ]    = 0;
+
+    // Concatenate the object's world matrix, once for all its polygons
+    Stage.SetWorld( *m_Entities.GetWorld( Object ) );
+
+    // Nothing more to do if the object is entirely off screen
+    m_pObjectCull[ Object ] = Stage.TestBounds( pMesh->m_Bounds, &m_pObjectPlanes[ Object ] );
+    if ( m_pObjectCull[ Object ] == CULL_OUTSIDE ) return;
+
+    // Pick the detail level from the object's size on screen. Occluders keep
+    // their full mesh, as a simplified one need not lie within the original
+    if ( m_bLOD && Source.pLOD && !IsOccluder( Object ) )
+        m_pObjectLevel[ Object ] = Source.pLOD->SelectLevel( GetProjectedSize( Object ) );
+
+    // Occluders are needed before anything else can be tested
+    if ( IsOccluder( Object ) )
+        TransformObject( Object );
+    else if ( m_bOcclusion )
+        m_pObjectTestable[ Object ] = Stage.ProjectBounds( pMesh->m_Bounds, m_pObjectRect[ Object ] );
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsOccluder () (Private)
+// Desc : Returns true if the object is drawn into the occlusion buffer this
+//        frame (and so is transformed as soon as it has been culled).
+//-----------------------------------------------------------------------------
+bool CGameApp::IsOccluder( ULONG Object ) const
+{
+    return m_bOcclusion && (GetObjectFlags( Object ) & ENTITY_OCCLUDER);
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawObjects () (Private)
+// Desc : Draws every polygon of each object left visible by culling, each
+//        at the detail level it was given. Objects the hierarchy did not
+//        find are counted as culled.
+//-----------------------------------------------------------------------------
+void CGameApp::DrawObjects( )
+{
+    const CIndexedMesh *pMesh = NULL;
+
+    // Fill colours used in solid mode, cycled through per polygon
+    static const ULONG PolygonColors[6] = { 0x00C04040, 0x0040C040, 0x004040C0,
+                                            0x00C0C040, 0x00C040C0, 0x0040C0C0 };
+
+    PROFILE_ZONE( "DrawObjects" );
+
+    // Loop through each object found within the frustum
+    m_FrameStats.ObjectsCulled += m_nObjectCount - m_nVisibleCount;
+    for ( ULONG v = 0; v < m_nVisibleCount; v++ )
+    {
+        ULONG i = m_pVisibleList[v];
+
+        // Skip objects which are entirely off screen, or hidden
+        if ( m_pObjectCull[i] == CULL_OUTSIDE ) { m_FrameStats.ObjectsCulled++; continue; }
+        if ( m_pObjectOccluded[i] ) continue;
+        m_FrameStats.ObjectsDrawn++;
+
+        // Store mesh (at the level selected while culling) for easy access
+        pMesh = GetObjectMesh( i );
+        m_FrameStats.VerticesTransformed += pMesh->m_nVertexCount;
+        ULONG nLevel = m_pObjectLevel[i];
+        m_FrameStats.LevelObjects[ nLevel ]++;
+
+        // Objects crossing the near or far plane have their edges clipped
+        bool bClip = (GetClipPlanes( i ) != 0);
+        bool bCull = m_bBackFaceCull && m_pObjectBackFace[i] && pMesh->m_pPolygonPlane;
+        if ( m_pObjectPlanes[i] & (FRUSTUM_NEAR | FRUSTUM_FAR) ) m_FrameStats.ObjectsClipped++;
 
         // Loop through each polygon
         for ( ULONG f = 0; f < pMesh->m_nPolygonCount; f++ )
         {
+            // Skip polygons whose back is towards the camera
+            if ( bCull )
+            {
+                const D3DXPLANE   & Plane = pMesh->m_pPolygonPlane[f];
+                const D3DXVECTOR3 & vecEye = m_pObjectEye[i];
+                if ( Plane.a * vecEye.x + Plane.b * vecEye.y + Plane.c * vecEye.z + Plane.d < 0.0f )
+                {
+                    m_FrameStats.PolygonsRejected++;
+                    continue;
+
+                } // End if back facing
+
+            } // End if culling
+            m_FrameStats.PolygonsDrawn++;
+            if ( pMesh->GetPolygonVertexCount( f ) >= 3 ) m_FrameStats.LevelTriangles[ nLevel ] += pMesh->GetPolygonVertexCount( f ) - 2;
+
             // Render the primitive
-            DrawPrimitive( pMesh->m_pPolygon[f], &m_pObject[i].m_mtxWorld );
+            if ( m_bSolid )
+                DrawPrimitiveSolid( pMesh, m_pScreenVertex + m_pVertexStart[i], (bClip) ? m_pClipVertex + m_pVertexStart[i] : NULL,
+                                    f, PolygonColors[ f % 6 ] );
+            else if ( bClip )
+                DrawPrimitiveClipped( pMesh, m_pScreenVertex + m_pVertexStart[i], m_pClipVertex + m_pVertexStart[i], f );
+            else
+                DrawPrimitive( pMesh, m_pScreenVertex + m_pVertexStart[i], f );
     
         } // Next Polygon
     
     } // Next Object
-
-    // Display Frame Rate
-    m_Timer.GetFrameRate( lpszFPS );
-    TextOut( m_hdcFrameBuffer, 5, 5, lpszFPS, (int)strlen( lpszFPS ) ); 
-    
-    // Present the buffer
-    PresentFrameBuffer();
-
 }
 
 //-----------------------------------------------------------------------------
-// Name : DrawPrimitive () (Private)
-// Desc : This function renders an individual polygon.
+// Name : DrawOccluders () (Private)
+// Desc : Rasterizes every visible occluder into the occlusion buffer, builds
+//        its depth pyramid, then marks each other object hidden behind them.
+// Note : Occluders crossing the near plane are left out, as their screen
+//        space vertices are not valid.
 //-----------------------------------------------------------------------------
-void CGameApp::DrawPrimitive( CPolygon * pPoly, D3DXMATRIX * pmtxWorld )
+void CGameApp::DrawOccluders( )
 {
-    D3DXVECTOR3 vtxPrevious, vtxCurrent;
+    if ( !m_bOcclusion ) return;
 
-    // Loop round each vertex transforming as we go
-    for ( USHORT v = 0; v < pPoly->m_nVertexCount + 1; v++ ) 
+    // Draw the occluders' front faces
+    m_Occlusion.Clear();
+    for ( ULONG v = 0; v < m_nVisibleCount; v++ )
     {
-        // Store the current vertex
-        vtxCurrent = (D3DXVECTOR3&)pPoly->m_pVertex[ v % pPoly->m_nVertexCount ];
+        ULONG i = m_pVisibleList[v];
 
-        // Multiply the vertex position by the World / object matrix
-        D3DXVec3TransformCoord( &vtxCurrent, &vtxCurrent, pmtxWorld );
+        // Only visible occluders were transformed this frame
+        if ( !IsOccluder( i ) || m_pObjectCull[i] == CULL_OUTSIDE ) continue;
+        if ( m_pObjectPlanes[i] & FRUSTUM_NEAR ) continue;
 
-        // Multiply by View matrix
-        D3DXVec3TransformCoord( &vtxCurrent, &vtxCurrent, &m_mtxView );
+        const CIndexedMesh  * pMesh = GetObjectSource( i ).pMesh;
+        const CScreenVertex * pVertices = m_pScreenVertex + m_pVertexStart[i];
+        bool                  bCull = m_pObjectBackFace[i] && pMesh->m_pPolygonPlane;
 
-        // Multiply by Projection matrix
-        D3DXVec3TransformCoord( &vtxCurrent, &vtxCurrent, &m_mtxProjection );
+        for ( ULONG f = 0; f < pMesh->m_nPolygonCount; f++ )
+        {
+            // Back faces lie behind the front ones, so add nothing
+            if ( bCull )
+            {
+                const D3DXPLANE   & Plane = pMesh->m_pPolygonPlane[f];
+                const D3DXVECTOR3 & vecEye = m_pObjectEye[i];
+                if ( Plane.a * vecEye.x + Plane.b * vecEye.y + Plane.c * vecEye.z + Plane.d < 0.0f ) continue;
 
-        // Convert to screen space coordinates
-        vtxCurrent.x =   vtxCurrent.x * m_nViewWidth  / 2 + m_nViewX + m_nViewWidth  / 2;
-        vtxCurrent.y =  -vtxCurrent.y * m_nViewHeight / 2 + m_nViewY + m_nViewHeight / 2;
+            } // End if culling
 
-        // If this is the first vertex, continue. This is the first point of our first line.
-        if ( v == 0 ) { vtxPrevious = vtxCurrent; continue; }
+            m_Occlusion.DrawPolygon( pVertices, pMesh->GetPolygonIndices( f ), pMesh->GetPolygonVertexCount( f ) );
 
-        // Draw the line
-        DrawLine( vtxPrevious, vtxCurrent, 0 );
+        } // Next Polygon
 
-        // Store this as new line's first point
-        vtxPrevious = vtxCurrent; 
+    } // Next Object
+    m_Occlusion.BuildPyramid();
 
-    } // Next Vertex
+    // Test everything else
+    for ( ULONG v = 0; v < m_nVisibleCount; v++ )
+    {
+        ULONG i = m_pVisibleList[v];
+        if ( !m_pObjectTestable[i] || m_pObjectCull[i] == CULL_OUTSIDE ) continue;
+
+        m_FrameStats.ObjectsTested++;
+        m_pObjectOccluded[i] = m_Occlusion.IsOccluded( m_pObjectRect[i] );
+        if ( m_pObjectOccluded[i] ) m_FrameStats.ObjectsOccluded++;
+
+    } // Next Object
 }
 
 //-----------------------------------------------------------------------------
-// Name : AnimateObjects () (Private)
-// Desc : Animates the objects we currently have loaded.
+// Name : TransformObject () (Private)
+// Desc : Transforms a visible object's mesh into its area of the screen
+//        vertex buffer (and clip space buffer, if it may need clipping).
+// Note : Called from the job system, so works on its own copy of the
+//        transform stage rather than altering the shared one.
 //-----------------------------------------------------------------------------
-void CGameApp::AnimateObjects()
+void CGameApp::TransformObject( ULONG Object )
 {
-    // Note : Expanded for the purposes of this example only.
-    D3DXMATRIX mtxYaw, mtxPitch, mtxRoll, mtxRotate;
-    float RotationYaw, RotationPitch, RotationRoll;
+    const CIndexedMesh * pMesh = GetObjectMesh( Object );
+    CTransformStage      Stage = m_Transform;
+    ULONG                Start = m_pVertexStart[ Object ];
+
+    // Concatenate the object's world matrix, once for all its polygons
+    Stage.SetWorld( *m_Entities.GetWorld( Object ) );
+
+    // Transform each of the mesh's shared vertices exactly once
+    Stage.Transform( pMesh->m_pVertex, m_pScreenVertex + Start, pMesh->m_nVertexCount );
+
+    // Objects which may need clipping are also kept in clip space
+    if ( GetClipPlanes( Object ) )
+        Stage.TransformHomogeneous( pMesh->m_pVertex, m_pClipVertex + Start, pMesh->m_nVertexCount );
+
+    // Back face culling compares polygon planes with the camera position in
+    // object space, the translation of the inverse world * view matrix. A
+    // world matrix with no inverse simply draws every face this frame (the
+    // entity's flags are shared with the other jobs, so are left alone).
+    m_pObjectBackFace[ Object ] = false;
+    if ( GetObjectFlags( Object ) & ENTITY_BACKFACECULL )
+    {
+        D3DXMATRIX mtxWorldView;
+        D3DXMatrixMultiply( &mtxWorldView, m_Entities.GetWorld( Object ), &m_mtxView );
+        if ( D3DXMatrixInverse( &mtxWorldView, NULL, &mtxWorldView ) )
+        {
+            m_pObjectEye[ Object ]      = D3DXVECTOR3( mtxWorldView._41, mtxWorldView._42, mtxWorldView._43 );
+            m_pObjectBackFace[ Object ] = true;
+
+        } // End if invertible
+
+    } // End if culling
+}
 
-    // Rotate Object 1 by small amount
-    if ( m_bRotation1 )
+//-----------------------------------------------------------------------------
+// Name : GetProjectedSize () (Private)
+// Desc : Returns the height in pixels the object's bounding sphere covers on
+//        screen, from its view space depth and the vertical scale of the
+//        projection matrix (FLT_MAX if the camera is within the sphere).
+//-----------------------------------------------------------------------------
+float CGameApp::GetProjectedSize( ULONG Object ) const
+{
+    const CBounds    & Bounds = GetObjectSource( Object ).pMesh->m_Bounds;
+    const D3DXMATRIX & mtxWorld = *m_Entities.GetWorld( Object );
+    D3DXMATRIX         mtxWorldView;
+    D3DXVECTOR3        vecCentre;
+    float              fScale = 0.0f, fRadius;
+
+    // Sphere centre in view space
+    D3DXMatrixMultiply( &mtxWorldView, &mtxWorld, &m_mtxView );
+    D3DXVec3TransformCoord( &vecCentre, &Bounds.m_vecCentre, &mtxWorldView );
+
+    // Largest scale the world matrix applies to any axis
+    for ( ULONG i = 0; i < 3; i++ )
     {
-        // Calculate rotation values for object 0
-        RotationYaw   = D3DXToRadian( 75.0f * m_Timer.GetTimeElapsed() );
-        RotationPitch = D3DXToRadian( 50.0f * m_Timer.GetTimeElapsed() );
-        RotationRoll  = D3DXToRadian( 25.0f * m_Timer.GetTimeElapsed() );
+        float fAxis = mtxWorld.m[i][0] * mtxWorld.m[i][0] + mtxWorld.m[i][1] * mtxWorld.m[i][1] + mtxWorld.m[i][2] * mtxWorld.m[i][2];
+        if ( fAxis > fScale ) fScale = fAxis;
 
-        // Build rotation matrices 
-        D3DXMatrixIdentity( &mtxRotate );
-        D3DXMatrixRotationY( &mtxYaw, RotationYaw);
-        D3DXMatrixRotationX( &mtxPitch,RotationPitch);
-        D3DXMatrixRotationZ( &mtxRoll, RotationRoll);
-        
-        // Concatenate the rotation matrices
-        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxYaw );
-        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxPitch );
-        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxRoll );
-            
-        // Apply the rotation to our object's matrix
-        D3DXMatrixMultiply( &m_pObject[ 0 ].m_mtxWorld, &mtxRotate, &m_pObject[ 0 ].m_mtxWorld );
+    } // Next Axis
+    fRadius = Bounds.m_fRadius * sqrtf( fScale );
+
+    if ( vecCentre.z <= fRadius ) return FLT_MAX;
+    return fRadius * m_mtxProjection._22 * (float)m_nViewHeight / vecCentre.z;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetObjectMesh () (Private)
+// Desc : Returns the mesh the object is drawn with this frame, the level of
+//        its detail chain selected while culling.
+//-----------------------------------------------------------------------------
+const CIndexedMesh * CGameApp::GetObjectMesh( ULONG Object ) const
+{
+    const ENTITYMESH & Source = GetObjectSource( Object );
+    return ( Source.pLOD && m_pObjectLevel[ Object ] > 0 ) ? Source.pLOD->GetLevel( m_pObjectLevel[ Object ] ) : Source.pMesh;
+}
 
-    } // End if Rotation Enabled
+//-----------------------------------------------------------------------------
+// Name : GetObjectSource () (Private)
+// Desc : Returns the full detail mesh, and detail chain, the object's mesh
+//        handle refers to.
+//-----------------------------------------------------------------------------
+const ENTITYMESH & CGameApp::GetObjectSource( ULONG Object ) const
+{
+    return m_Entities.GetMesh( *m_Entities.GetMeshHandle( Object ) );
+}
 
-    // Rotate Object 2 by small amount
-    if ( m_bRotation2 )
+//-----------------------------------------------------------------------------
+// Name : GetObjectFlags () (Private)
+// Desc : Returns the object's flags (ENTITYFLAGS).
+//-----------------------------------------------------------------------------
+ULONG CGameApp::GetObjectFlags( ULONG Object ) const
+{
+    return *m_Entities.GetFlags( Object );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AnimateObjectsJob () (Private, Static)
+// Desc : Job system entry point, animates a range of entity chunks.
+//-----------------------------------------------------------------------------
+void CGameApp::AnimateObjectsJob( void * pContext, ULONG Begin, ULONG End )
+{
+    PROFILE_ZONE( "AnimateObjects" );
+    for ( ULONG i = Begin; i < End; i++ ) ((CGameApp*)pContext)->AnimateChunk( i );
+}
+
+//-----------------------------------------------------------------------------
+// Name : TransformObjectsJob () (Private, Static)
+// Desc : Job system entry point, transforms a range of the objects found
+//        within the frustum.
+//-----------------------------------------------------------------------------
+void CGameApp::TransformObjectsJob( void * pContext, ULONG Begin, ULONG End )
+{
+    CGameApp * pApp = (CGameApp*)pContext;
+
+    PROFILE_ZONE( "TransformObjects" );
+    for ( ULONG v = Begin; v < End; v++ )
     {
-        // Calculate rotation values for object 1
-        RotationYaw   = D3DXToRadian( -25.0f * m_Timer.GetTimeElapsed() );
-        RotationPitch = D3DXToRadian(  50.0f * m_Timer.GetTimeElapsed() );
-        RotationRoll  = D3DXToRadian( -75.0f * m_Timer.GetTimeElapsed() );
+        ULONG i = pApp->m_pVisibleList[v];
 
-        // Build rotation matrices 
-        D3DXMatrixIdentity( &mtxRotate );
-        D3DXMatrixRotationY( &mtxYaw, RotationYaw);
-        D3DXMatrixRotationX( &mtxPitch,RotationPitch);
-        D3DXMatrixRotationZ( &mtxRoll, RotationRoll);
-        
-        // Concatenate the rotation matrices
-        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxYaw );
-        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxPitch );
-        D3DXMatrixMultiply( &mtxRotate, &mtxRotate, &mtxRoll );
-            
-        // Apply the rotation to our object's matrix
-        D3DXMatrixMultiply( &m_pObject[ 1 ].m_mtxWorld, &mtxRotate, &m_pObject[ 1 ].m_mtxWorld );
+        // Occluders were transformed while culling
+        if ( pApp->m_pObjectCull[i] == CULL_OUTSIDE || pApp->m_pObjectOccluded[i] ) continue;
+        if ( pApp->IsOccluder( i ) ) continue;
+        pApp->TransformObject( i );
+
+    } // Next Object
+}
+
+//-----------------------------------------------------------------------------
+// Name : CullObjectsJob () (Private, Static)
+// Desc : Job system entry point, culls a range of objects.
+//-----------------------------------------------------------------------------
+void CGameApp::CullObjectsJob( void * pContext, ULONG Begin, ULONG End )
+{
+    CGameApp * pApp = (CGameApp*)pContext;
 
-    } // End if rotation enabled
+    PROFILE_ZONE( "CullObjects" );
 
+    // Ranges index the list of objects found within the frustum
+    for ( ULONG i = Begin; i < End; i++ ) pApp->CullObject( pApp->m_pVisibleList[i] );
 }
\ No newline at end of file
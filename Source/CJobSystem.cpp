@@ -0,0 +1,568 @@
+//-----------------------------------------------------------------------------
+// File: CJobSystem.cpp
+//
+// Desc: Work stealing job scheduler used to spread per frame engine work
+//       across every available hardware thread.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CJobSystem Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CJobSystem.h"
+#include "../Includes/CProfiler.h"
+#include "../Includes/CPerfCounters.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static thread_local const CJobSystem * t_pJobSystem  = NULL;   // System owning this thread
+static thread_local ULONG              t_nThreadIndex = 0;      // Index within that system
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+// Statistics are only written by their owning thread, so need no locked add.
+static inline void CountStat( std::atomic<ULONG> & Stat )
+{
+    Stat.store( Stat.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CJobCounter () (Constructor)
+// Desc : CJobCounter Class Constructor
+//-----------------------------------------------------------------------------
+CJobCounter::CJobCounter()
+{
+	// Reset / Clear all required values
+    m_nCount        = 0;
+    m_pHeld         = NULL;
+    m_nHeldCount    = 0;
+    m_nHeldMax      = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CJobCounter () (Destructor)
+// Desc : CJobCounter Class Destructor
+//-----------------------------------------------------------------------------
+CJobCounter::~CJobCounter()
+{
+    if ( m_pHeld ) delete []m_pHeld;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CJobSystem () (Constructor)
+// Desc : CJobSystem Class Constructor
+//-----------------------------------------------------------------------------
+CJobSystem::CJobSystem()
+{
+	// Reset / Clear all required values
+    m_pWorkers      = NULL;
+    m_nThreadCount  = 0;
+    m_nQueued       = 0;
+    m_nSleeping     = 0;
+    m_bShutdown     = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CJobSystem () (Destructor)
+// Desc : CJobSystem Class Destructor
+//-----------------------------------------------------------------------------
+CJobSystem::~CJobSystem()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Creates the per thread deques and starts ThreadCount - 1 workers,
+//        the calling thread being thread zero.
+//-----------------------------------------------------------------------------
+bool CJobSystem::Create( ULONG ThreadCount )
+{
+    // Release any previous workers
+    Release();
+    if ( ThreadCount < 1 ) ThreadCount = 1;
+
+    // Allocate the per thread state
+    if (!( m_pWorkers = new (std::nothrow) WORKER[ ThreadCount ] )) return false;
+    for ( ULONG i = 0; i < ThreadCount; i++ )
+    {
+        m_pWorkers[i].bLocked        = false;
+        m_pWorkers[i].nTop           = 0;
+        m_pWorkers[i].nBottom        = 0;
+        m_pWorkers[i].nSeed          = 0x9E3779B9 * (i + 1);
+        m_pWorkers[i].nExecuted      = 0;
+        m_pWorkers[i].nStolen        = 0;
+        m_pWorkers[i].nStealAttempts = 0;
+        m_pWorkers[i].nOverflowed    = 0;
+
+    } // Next Thread
+
+    // The creating thread is thread zero
+    m_nThreadCount  = ThreadCount;
+    m_bShutdown     = false;
+    t_pJobSystem    = this;
+    t_nThreadIndex  = 0;
+
+    // Start the workers
+    for ( ULONG i = 1; i < ThreadCount; i++ )
+    {
+        m_pWorkers[i].Thread = std::thread( &CJobSystem::WorkerThread, this, i );
+
+    } // Next Worker
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Stops and joins all worker threads.
+// Note : All submitted work must have been waited for.
+//-----------------------------------------------------------------------------
+void CJobSystem::Release( )
+{
+    if ( !m_pWorkers ) return;
+
+    // Signal shutdown
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_bShutdown = true;
+    }
+    m_WakeCondition.notify_all();
+
+    // Wait for each worker to exit
+    for ( ULONG i = 1; i < m_nThreadCount; i++ )
+    {
+        if ( m_pWorkers[i].Thread.joinable() ) m_pWorkers[i].Thread.join();
+
+    } // Next Worker
+
+    if ( t_pJobSystem == this ) t_pJobSystem = NULL;
+    delete []m_pWorkers;
+    m_pWorkers     = NULL;
+    m_nThreadCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Submit ()
+// Desc : Queues pfnJob( pContext, Begin, End ) for execution. pCounter (if
+//        any) is incremented now and decremented when the job completes. If
+//        pDependency is specified the job is not queued until that counter
+//        has reached zero.
+//-----------------------------------------------------------------------------
+void CJobSystem::Submit( JOBFUNC pfnJob, void * pContext, ULONG Begin, ULONG End,
+                         CJobCounter * pCounter, CJobCounter * pDependency )
+{
+    JOB Job = { pfnJob, pContext, Begin, End, 0, pCounter };
+
+    if ( pCounter ) pCounter->m_nCount.fetch_add( 1 );
+    Dispatch( Job, pDependency );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParallelFor ()
+// Desc : Calls pfnJob over [0, Count) in ranges of at most Grain indices. If
+//        pCounter is NULL the call waits for completion, otherwise it
+//        returns immediately and the caller waits on the counter.
+// Note : The range is queued as a single job which is split in half as it
+//        executes, so idle threads steal large pieces and the cost of
+//        spawning is only paid where there is parallelism to exploit.
+//-----------------------------------------------------------------------------
+void CJobSystem::ParallelFor( JOBFUNC pfnJob, void * pContext, ULONG Count, ULONG Grain,
+                              CJobCounter * pCounter, CJobCounter * pDependency )
+{
+    CJobCounter   Local;
+    CJobCounter * pWaitCounter = (pCounter) ? pCounter : &Local;
+    JOB           Job = { pfnJob, pContext, 0, Count, (Grain > 0) ? Grain : 1, pWaitCounter };
+
+    if ( Count == 0 ) return;
+    pWaitCounter->m_nCount.fetch_add( 1 );
+    Dispatch( Job, pDependency );
+
+    // Blocking form?
+    if ( !pCounter ) Wait( &Local );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Wait ()
+// Desc : Returns once the counter reaches zero, executing other jobs (from
+//        this thread's deque first, then by stealing) in the meantime.
+// Note : The counter may safely be destroyed once Wait returns.
+//-----------------------------------------------------------------------------
+void CJobSystem::Wait( CJobCounter * pCounter )
+{
+    ULONG Index = GetThreadIndex();
+
+    while ( !pCounter->IsDone() )
+    {
+        if ( !RunOne( Index ) ) std::this_thread::yield();
+
+    } // Next Attempt
+
+    // The thread which completed the counter may still be releasing its held
+    // jobs, it no longer holds the lock once it has finished with the counter
+    std::lock_guard<std::mutex> Lock( pCounter->m_Mutex );
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetStats ()
+// Desc : Retrieves the scheduler statistics, summed over all threads.
+//-----------------------------------------------------------------------------
+void CJobSystem::GetStats( JOBSTATS & Stats ) const
+{
+    memset( &Stats, 0, sizeof(JOBSTATS) );
+    for ( ULONG i = 0; i < m_nThreadCount; i++ )
+    {
+        Stats.Executed      += m_pWorkers[i].nExecuted.load( std::memory_order_relaxed );
+        Stats.Stolen        += m_pWorkers[i].nStolen.load( std::memory_order_relaxed );
+        Stats.StealAttempts += m_pWorkers[i].nStealAttempts.load( std::memory_order_relaxed );
+        Stats.Overflowed    += m_pWorkers[i].nOverflowed.load( std::memory_order_relaxed );
+
+    } // Next Thread
+}
+
+//-----------------------------------------------------------------------------
+// Name : ResetStats ()
+// Desc : Zeroes the scheduler statistics.
+//-----------------------------------------------------------------------------
+void CJobSystem::ResetStats( )
+{
+    for ( ULONG i = 0; i < m_nThreadCount; i++ )
+    {
+        m_pWorkers[i].nExecuted      = 0;
+        m_pWorkers[i].nStolen        = 0;
+        m_pWorkers[i].nStealAttempts = 0;
+        m_pWorkers[i].nOverflowed    = 0;
+
+    } // Next Thread
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetHardwareThreads () (Static)
+// Desc : Returns the number of hardware threads available (at least 1).
+//-----------------------------------------------------------------------------
+ULONG CJobSystem::GetHardwareThreads( )
+{
+    ULONG Count = (ULONG)std::thread::hardware_concurrency();
+    return (Count > 0) ? Count : 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WorkerThread () (Private)
+// Desc : Worker thread main loop. Runs jobs while any can be found, spins
+//        briefly when there are none, and then sleeps until more are queued.
+//-----------------------------------------------------------------------------
+void CJobSystem::WorkerThread( ULONG Index )
+{
+    ULONG Idle = 0;
+    char  szName[ PROFILER_NAME_LENGTH ];
+
+    t_pJobSystem   = this;
+    t_nThreadIndex = Index;
+
+    // Label the thread in profiles (only once one is being taken)
+    if ( CProfiler::IsEnabled() )
+    {
+        sprintf( szName, "Worker %u", (unsigned int)Index );
+        CProfiler::SetThreadName( szName );
+
+    } // End if profiling
+
+    // Count the thread's events too, if the main thread's are being counted
+    // (a thread which cannot is left out)
+    if ( CPerfCounters::IsOpen() ) CPerfCounters::OpenThread();
+
+    while ( !m_bShutdown.load( std::memory_order_relaxed ) )
+    {
+        // Run anything we can find
+        if ( RunOne( Index ) ) { Idle = 0; continue; }
+        if ( ++Idle < JOB_SPIN_COUNT ) { std::this_thread::yield(); continue; }
+
+        // Sleep until work arrives (m_nSleeping is raised before the check
+        // so that a submitter either sees us sleeping or we see its job)
+        std::unique_lock<std::mutex> Lock( m_Mutex );
+        m_nSleeping.fetch_add( 1 );
+        m_WakeCondition.wait( Lock, [this] { return m_bShutdown.load() || m_nQueued.load() > 0; } );
+        m_nSleeping.fetch_sub( 1 );
+        Idle = 0;
+
+    } // Next Job
+}
+
+//-----------------------------------------------------------------------------
+// Name : Push () (Private)
+// Desc : Adds a job to the owner end of the deque. Returns false if full.
+//-----------------------------------------------------------------------------
+bool CJobSystem::Push( WORKER & Worker, const JOB & Job )
+{
+    bool bPushed = false;
+
+    while ( Worker.bLocked.exchange( true, std::memory_order_acquire ) ) {}
+    if ( Worker.nBottom - Worker.nTop < JOB_QUEUE_SIZE )
+    {
+        Worker.Jobs[ Worker.nBottom & (JOB_QUEUE_SIZE - 1) ] = Job;
+        Worker.nBottom++;
+        bPushed = true;
+
+    } // End if room
+    Worker.bLocked.store( false, std::memory_order_release );
+
+    return bPushed;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Pop () (Private)
+// Desc : Removes the most recently pushed job from the owner end.
+//-----------------------------------------------------------------------------
+bool CJobSystem::Pop( WORKER & Worker, JOB & Job )
+{
+    bool bPopped = false;
+
+    while ( Worker.bLocked.exchange( true, std::memory_order_acquire ) ) {}
+    if ( Worker.nBottom != Worker.nTop )
+    {
+        Worker.nBottom--;
+        Job = Worker.Jobs[ Worker.nBottom & (JOB_QUEUE_SIZE - 1) ];
+        bPopped = true;
+
+    } // End if not empty
+    Worker.bLocked.store( false, std::memory_order_release );
+
+    return bPopped;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Steal () (Private)
+// Desc : Removes the oldest job from the steal end. Gives up rather than
+//        waiting if another thread holds the deque.
+//-----------------------------------------------------------------------------
+bool CJobSystem::Steal( WORKER & Worker, JOB & Job )
+{
+    bool bStolen = false;
+
+    if ( Worker.bLocked.exchange( true, std::memory_order_acquire ) ) return false;
+    if ( Worker.nBottom != Worker.nTop )
+    {
+        Job = Worker.Jobs[ Worker.nTop & (JOB_QUEUE_SIZE - 1) ];
+        Worker.nTop++;
+        bStolen = true;
+
+    } // End if not empty
+    Worker.bLocked.store( false, std::memory_order_release );
+
+    return bStolen;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunOne () (Private)
+// Desc : Finds and executes a single job, from our own deque if possible or
+//        else from a randomly chosen victim. Returns false if none found.
+//-----------------------------------------------------------------------------
+bool CJobSystem::RunOne( ULONG Index )
+{
+    JOB      Job;
+
+    if ( !m_pWorkers ) return false;
+    WORKER & Self = m_pWorkers[ Index ];
+
+    // Our own work first
+    if ( Pop( Self, Job ) )
+    {
+        m_nQueued.fetch_sub( 1 );
+        Execute( Index, Job );
+        return true;
+
+    } // End if popped
+
+    // Nothing queued anywhere?
+    if ( m_nThreadCount < 2 || m_nQueued.load( std::memory_order_relaxed ) <= 0 ) return false;
+
+    // Try each other thread, starting from a random victim
+    Self.nSeed ^= Self.nSeed << 13; Self.nSeed ^= Self.nSeed >> 17; Self.nSeed ^= Self.nSeed << 5;
+    ULONG Start = Self.nSeed % m_nThreadCount;
+    for ( ULONG i = 0; i < m_nThreadCount; i++ )
+    {
+        ULONG Victim = (Start + i) % m_nThreadCount;
+        if ( Victim == Index ) continue;
+
+        CountStat( Self.nStealAttempts );
+        if ( Steal( m_pWorkers[ Victim ], Job ) )
+        {
+            CountStat( Self.nStolen );
+            m_nQueued.fetch_sub( 1 );
+            Execute( Index, Job );
+            return true;
+
+        } // End if stolen
+
+    } // Next Victim
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Execute () (Private)
+// Desc : Runs a job. Ranges larger than their grain are first split, the
+//        upper half of each split being pushed so that it can be stolen.
+//-----------------------------------------------------------------------------
+void CJobSystem::Execute( ULONG Index, JOB Job )
+{
+    // Split the range down to the grain size
+    while ( Job.Grain > 0 && Job.End - Job.Begin > Job.Grain )
+    {
+        JOB   Half = Job;
+        ULONG Mid  = Job.Begin + (Job.End - Job.Begin) / 2;
+
+        Half.Begin = Mid;
+        Job.End    = Mid;
+        if ( Half.pCounter ) Half.pCounter->m_nCount.fetch_add( 1 );
+        m_nQueued.fetch_add( 1 );
+        if ( !Push( m_pWorkers[ Index ], Half ) )
+        {
+            // Deque is full, so just run it here
+            m_nQueued.fetch_sub( 1 );
+            CountStat( m_pWorkers[ Index ].nOverflowed );
+            Execute( Index, Half );
+
+        } // End if full
+        else if ( m_nSleeping.load() > 0 )
+        {
+            std::lock_guard<std::mutex> Lock( m_Mutex );
+            m_WakeCondition.notify_one();
+
+        } // End if wake
+
+    } // Next Split
+
+    // Do the work
+    Job.pfnJob( Job.pContext, Job.Begin, Job.End );
+    CountStat( m_pWorkers[ Index ].nExecuted );
+
+    // Signal completion
+    if ( Job.pCounter ) Complete( Job.pCounter );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Dispatch () (Private)
+// Desc : Queues a job, or holds it on its dependency if that is outstanding.
+//-----------------------------------------------------------------------------
+void CJobSystem::Dispatch( const JOB & Job, CJobCounter * pDependency )
+{
+    if ( pDependency )
+    {
+        std::lock_guard<std::mutex> Lock( pDependency->m_Mutex );
+        if ( pDependency->m_nCount.load() != 0 )
+        {
+            // Grow the held list if required
+            if ( pDependency->m_nHeldCount == pDependency->m_nHeldMax )
+            {
+                ULONG nNewMax  = (pDependency->m_nHeldMax > 0) ? pDependency->m_nHeldMax * 2 : 8;
+                JOB * pNewHeld = new JOB[ nNewMax ];
+                if ( pDependency->m_pHeld )
+                {
+                    memcpy( pNewHeld, pDependency->m_pHeld, pDependency->m_nHeldCount * sizeof(JOB) );
+                    delete []pDependency->m_pHeld;
+
+                } // End if existing
+                pDependency->m_pHeld    = pNewHeld;
+                pDependency->m_nHeldMax = nNewMax;
+
+            } // End if full
+
+            // Released by Complete when the dependency reaches zero
+            pDependency->m_pHeld[ pDependency->m_nHeldCount++ ] = Job;
+            return;
+
+        } // End if outstanding
+
+    } // End if dependency
+
+    Enqueue( Job );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Enqueue () (Private)
+// Desc : Places a job on the calling thread's deque and wakes a worker.
+//-----------------------------------------------------------------------------
+void CJobSystem::Enqueue( const JOB & Job )
+{
+    ULONG Index = GetThreadIndex();
+
+    // No threads at all, run it directly
+    if ( !m_pWorkers )
+    {
+        Job.pfnJob( Job.pContext, Job.Begin, Job.End );
+        if ( Job.pCounter ) Complete( Job.pCounter );
+        return;
+
+    } // End if no system
+
+    // Run inline if the deque is full
+    m_nQueued.fetch_add( 1 );
+    if ( !Push( m_pWorkers[ Index ], Job ) )
+    {
+        m_nQueued.fetch_sub( 1 );
+        CountStat( m_pWorkers[ Index ].nOverflowed );
+        Execute( Index, Job );
+        return;
+
+    } // End if full
+
+    // Wake a sleeping worker to take it
+    if ( m_nSleeping.load() > 0 )
+    {
+        std::lock_guard<std::mutex> Lock( m_Mutex );
+        m_WakeCondition.notify_one();
+
+    } // End if sleeping
+}
+
+//-----------------------------------------------------------------------------
+// Name : Complete () (Private)
+// Desc : Decrements a counter, releasing any jobs held on it when it reaches
+//        zero.
+//-----------------------------------------------------------------------------
+void CJobSystem::Complete( CJobCounter * pCounter )
+{
+    JOB   * pHeld = NULL;
+    ULONG   nHeld = 0;
+    long    nCount = pCounter->m_nCount.load();
+
+    // Not the last job? (the common case, needs no lock)
+    while ( nCount > 1 )
+    {
+        if ( pCounter->m_nCount.compare_exchange_weak( nCount, nCount - 1 ) ) return;
+
+    } // Next Attempt
+
+    // The final decrement is made under the lock, so that Wait cannot return
+    // (and the counter be destroyed) until we are done with it, and so that
+    // no job can be held on the counter after its list has been taken
+    {
+        std::lock_guard<std::mutex> Lock( pCounter->m_Mutex );
+        if ( pCounter->m_nCount.fetch_sub( 1 ) != 1 || pCounter->m_nHeldCount == 0 ) return;
+        pHeld = pCounter->m_pHeld;
+        nHeld = pCounter->m_nHeldCount;
+        pCounter->m_pHeld      = NULL;
+        pCounter->m_nHeldCount = 0;
+        pCounter->m_nHeldMax   = 0;
+    }
+
+    // Queue them
+    for ( ULONG i = 0; i < nHeld; i++ ) Enqueue( pHeld[i] );
+    delete []pHeld;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetThreadIndex () (Private)
+// Desc : Index of the calling thread within this system (zero for any
+//        thread which is not one of ours).
+//-----------------------------------------------------------------------------
+ULONG CJobSystem::GetThreadIndex( ) const
+{
+    return (t_pJobSystem == this) ? t_nThreadIndex : 0;
+}
@@ -0,0 +1,781 @@
+//-----------------------------------------------------------------------------
+// File: CLODChain.cpp
+//
+// Desc: Level of detail chains, a mesh plus progressively simplified copies
+//       generated by quadric error edge collapse.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CLODChain Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CLODChain.h"
+#include <new>
+#include <math.h>
+#include <float.h>
+#include <algorithm>
+
+//-----------------------------------------------------------------------------
+// Module Local Structures
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : QUADRIC (Local Struct)
+// Desc : Symmetric 4x4 error quadric, upper triangle only, in the order
+//        aa ab ac ad bb bc bd cc cd dd.
+//-----------------------------------------------------------------------------
+struct QUADRIC
+{
+    double      q[10];
+};
+
+//-----------------------------------------------------------------------------
+// Name : COLLAPSE (Local Struct)
+// Desc : Candidate edge collapse held in the priority heap. The vertex
+//        versions are those at the time the candidate was evaluated, so a
+//        candidate is stale if either vertex has since changed.
+//-----------------------------------------------------------------------------
+struct COLLAPSE
+{
+    double      Cost;                   // Quadric error of the new position
+    double      Position[3];            // Position the pair collapses to
+    ULONG       Keep;                   // Vertex that survives
+    ULONG       Remove;                 // Vertex merged into Keep
+    ULONG       KeepVersion;
+    ULONG       RemoveVersion;
+};
+
+//-----------------------------------------------------------------------------
+// Name : EDGEREF (Local Struct)
+// Desc : Edge of a triangle, used to find unique and open edges by sorting.
+//-----------------------------------------------------------------------------
+struct EDGEREF
+{
+    ULONG       V1, V2;                 // Lowest then highest vertex index
+    ULONG       Triangle;               // Triangle the edge belongs to
+
+    bool operator < ( const EDGEREF & Other ) const
+    {
+        return (V1 != Other.V1) ? (V1 < Other.V1) : (V2 < Other.V2);
+    }
+};
+
+//-----------------------------------------------------------------------------
+// Name : SIMPLIFYSTATE (Local Struct)
+// Desc : Working arrays shared by the simplification helpers. Each vertex
+//        keeps a singly linked list of the triangle corners that reference it
+//        so that merging two vertices is a splice of two lists.
+//-----------------------------------------------------------------------------
+struct SIMPLIFYSTATE
+{
+    ULONG       VertexCount;
+    ULONG       TriangleCount;
+    ULONG       AliveCount;             // Triangles not yet collapsed away
+    double     *pPosition;              // xyz of each vertex
+    QUADRIC    *pQuadric;               // Accumulated quadric of each vertex
+    ULONG      *pVersion;               // Bumped every time a vertex changes
+    bool       *pVertexAlive;
+    ULONG      *pCornerHead;            // First corner referencing each vertex
+    ULONG      *pCornerNext;            // Next corner referencing the same vertex
+    ULONG      *pTriangle;              // Three vertex indices per triangle
+    bool       *pTriangleAlive;
+    double      vecMin[3];              // Source bounds, collapses are clamped to these
+    double      vecMax[3];
+
+    COLLAPSE   *pHeap;                  // Binary min heap of candidates
+    ULONG       HeapCount;
+    ULONG       HeapMax;
+};
+
+const ULONG LOD_NO_CORNER = 0xFFFFFFFF;
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : AddPlaneQuadric () (Local)
+// Desc : Adds the weighted squared distance quadric of a plane to Q.
+//-----------------------------------------------------------------------------
+static void AddPlaneQuadric( QUADRIC & Q, double a, double b, double c, double d, double w )
+{
+    Q.q[0] += w * a * a; Q.q[1] += w * a * b; Q.q[2] += w * a * c; Q.q[3] += w * a * d;
+    Q.q[4] += w * b * b; Q.q[5] += w * b * c; Q.q[6] += w * b * d;
+    Q.q[7] += w * c * c; Q.q[8] += w * c * d;
+    Q.q[9] += w * d * d;
+}
+
+//-----------------------------------------------------------------------------
+// Name : EvaluateQuadric () (Local)
+// Desc : Returns the error v^T Q v of a position.
+//-----------------------------------------------------------------------------
+static double EvaluateQuadric( const QUADRIC & Q, const double * v )
+{
+    const double *q = Q.q, x = v[0], y = v[1], z = v[2];
+    return q[0]*x*x + 2.0*q[1]*x*y + 2.0*q[2]*x*z + 2.0*q[3]*x +
+           q[4]*y*y + 2.0*q[5]*y*z + 2.0*q[6]*y +
+           q[7]*z*z + 2.0*q[8]*z + q[9];
+}
+
+//-----------------------------------------------------------------------------
+// Name : SolveQuadric () (Local)
+// Desc : Finds the position of least error of a quadric, returning false if
+//        the 3x3 system is too close to singular to trust (flat or linear
+//        neighbourhoods, where any point along the plane / line is as good).
+//-----------------------------------------------------------------------------
+static bool SolveQuadric( const QUADRIC & Q, double * v )
+{
+    const double *q = Q.q;
+    double c00 = q[4]*q[7] - q[5]*q[5], c01 = q[5]*q[2] - q[1]*q[7], c02 = q[1]*q[5] - q[4]*q[2];
+    double fDet = q[0]*c00 + q[1]*c01 + q[2]*c02, fTrace = q[0] + q[4] + q[7];
+
+    if ( fTrace <= 0.0 || fabs( fDet ) < 1e-6 * fTrace * fTrace * fTrace ) return false;
+
+    double c11 = q[0]*q[7] - q[2]*q[2], c12 = q[1]*q[2] - q[0]*q[5], c22 = q[0]*q[4] - q[1]*q[1];
+    double fInv = -1.0 / fDet;
+    v[0] = fInv * (c00 * q[3] + c01 * q[6] + c02 * q[8]);
+    v[1] = fInv * (c01 * q[3] + c11 * q[6] + c12 * q[8]);
+    v[2] = fInv * (c02 * q[3] + c12 * q[6] + c22 * q[8]);
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : TriangleNormal () (Local)
+// Desc : Unnormalised normal of a triangle (twice its area in length).
+//-----------------------------------------------------------------------------
+static inline void TriangleNormal( const double * p0, const double * p1, const double * p2, double * n )
+{
+    double e1[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+    double e2[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+    n[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    n[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    n[2] = e1[0] * e2[1] - e1[1] * e2[0];
+}
+
+//-----------------------------------------------------------------------------
+// Name : HeapPush () (Local)
+// Desc : Adds a candidate to the heap, growing it as required.
+//-----------------------------------------------------------------------------
+static bool HeapPush( SIMPLIFYSTATE & s, const COLLAPSE & Collapse )
+{
+    if ( s.HeapCount == s.HeapMax )
+    {
+        ULONG      nNewMax = (s.HeapMax > 0) ? s.HeapMax * 2 : 1024;
+        COLLAPSE * pNew    = new (std::nothrow) COLLAPSE[ nNewMax ];
+        if ( !pNew ) return false;
+        for ( ULONG i = 0; i < s.HeapCount; i++ ) pNew[i] = s.pHeap[i];
+        if ( s.pHeap ) delete []s.pHeap;
+        s.pHeap   = pNew;
+        s.HeapMax = nNewMax;
+
+    } // End if full
+
+    // Sift up
+    ULONG i = s.HeapCount++;
+    while ( i > 0 )
+    {
+        ULONG Parent = (i - 1) / 2;
+        if ( s.pHeap[ Parent ].Cost <= Collapse.Cost ) break;
+        s.pHeap[i] = s.pHeap[ Parent ];
+        i = Parent;
+
+    } // Next Level
+    s.pHeap[i] = Collapse;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : HeapPop () (Local)
+// Desc : Removes the cheapest candidate from a non empty heap.
+//-----------------------------------------------------------------------------
+static COLLAPSE HeapPop( SIMPLIFYSTATE & s )
+{
+    COLLAPSE Top = s.pHeap[0], Last = s.pHeap[ --s.HeapCount ];
+    ULONG    i = 0;
+
+    // Sift the last entry down from the root
+    for ( ;; )
+    {
+        ULONG Child = i * 2 + 1;
+        if ( Child >= s.HeapCount ) break;
+        if ( Child + 1 < s.HeapCount && s.pHeap[ Child + 1 ].Cost < s.pHeap[ Child ].Cost ) Child++;
+        if ( Last.Cost <= s.pHeap[ Child ].Cost ) break;
+        s.pHeap[i] = s.pHeap[ Child ];
+        i = Child;
+
+    } // Next Level
+    if ( s.HeapCount > 0 ) s.pHeap[i] = Last;
+    return Top;
+}
+
+//-----------------------------------------------------------------------------
+// Name : PushCollapse () (Local)
+// Desc : Evaluates the collapse of an edge and queues it. The new position is
+//        the quadric's optimum when it can be solved for, otherwise the best
+//        of the two end points and the midpoint, then clamped to the source
+//        bounds. The surviving vertex is whichever is closest to that.
+//-----------------------------------------------------------------------------
+static bool PushCollapse( SIMPLIFYSTATE & s, ULONG V1, ULONG V2 )
+{
+    COLLAPSE Collapse;
+    QUADRIC  Q;
+    const double *p1 = &s.pPosition[ V1 * 3 ], *p2 = &s.pPosition[ V2 * 3 ];
+
+    for ( ULONG i = 0; i < 10; i++ ) Q.q[i] = s.pQuadric[ V1 ].q[i] + s.pQuadric[ V2 ].q[i];
+
+    if ( SolveQuadric( Q, Collapse.Position ) )
+    {
+        for ( ULONG i = 0; i < 3; i++ )
+        {
+            if ( Collapse.Position[i] < s.vecMin[i] ) Collapse.Position[i] = s.vecMin[i];
+            if ( Collapse.Position[i] > s.vecMax[i] ) Collapse.Position[i] = s.vecMax[i];
+
+        } // Next Axis
+        Collapse.Cost = EvaluateQuadric( Q, Collapse.Position );
+    
+    } // End if solved
+    else
+    {
+        double Mid[3] = { (p1[0] + p2[0]) * 0.5, (p1[1] + p2[1]) * 0.5, (p1[2] + p2[2]) * 0.5 };
+        double f1 = EvaluateQuadric( Q, p1 ), f2 = EvaluateQuadric( Q, p2 ), fMid = EvaluateQuadric( Q, Mid );
+        const double *pBest = p1;
+
+        Collapse.Cost = f1;
+        if ( f2 < Collapse.Cost ) { Collapse.Cost = f2; pBest = p2; }
+        if ( fMid < Collapse.Cost ) { Collapse.Cost = fMid; pBest = Mid; }
+        for ( ULONG i = 0; i < 3; i++ ) Collapse.Position[i] = pBest[i];
+
+    } // End if singular
+
+    // Rounding can leave a tiny negative error
+    if ( Collapse.Cost < 0.0 ) Collapse.Cost = 0.0;
+
+    // Keep the vertex closest to the new position
+    double d1 = 0.0, d2 = 0.0;
+    for ( ULONG i = 0; i < 3; i++ )
+    {
+        d1 += (Collapse.Position[i] - p1[i]) * (Collapse.Position[i] - p1[i]);
+        d2 += (Collapse.Position[i] - p2[i]) * (Collapse.Position[i] - p2[i]);
+
+    } // Next Axis
+    Collapse.Keep          = (d1 <= d2) ? V1 : V2;
+    Collapse.Remove        = (d1 <= d2) ? V2 : V1;
+    Collapse.KeepVersion   = s.pVersion[ Collapse.Keep ];
+    Collapse.RemoveVersion = s.pVersion[ Collapse.Remove ];
+    return HeapPush( s, Collapse );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CollapseFlips () (Local)
+// Desc : Returns true if moving Vertex to Position would turn any of its
+//        triangles (other than those shared with Other, which disappear)
+//        over or crush them to nothing.
+//-----------------------------------------------------------------------------
+static bool CollapseFlips( const SIMPLIFYSTATE & s, ULONG Vertex, ULONG Other, const double * Position )
+{
+    for ( ULONG c = s.pCornerHead[ Vertex ]; c != LOD_NO_CORNER; c = s.pCornerNext[c] )
+    {
+        ULONG Triangle = c / 3;
+        const ULONG * pTri = &s.pTriangle[ Triangle * 3 ];
+        if ( !s.pTriangleAlive[ Triangle ] ) continue;
+        if ( pTri[0] == Other || pTri[1] == Other || pTri[2] == Other ) continue;
+
+        const double *p[3], *q[3];
+        for ( ULONG k = 0; k < 3; k++ )
+        {
+            p[k] = &s.pPosition[ pTri[k] * 3 ];
+            q[k] = (pTri[k] == Vertex) ? Position : p[k];
+
+        } // Next Corner
+
+        double nOld[3], nNew[3];
+        TriangleNormal( p[0], p[1], p[2], nOld );
+        TriangleNormal( q[0], q[1], q[2], nNew );
+        double fDot    = nOld[0] * nNew[0] + nOld[1] * nNew[1] + nOld[2] * nNew[2];
+        double fLength = sqrt( (nOld[0] * nOld[0] + nOld[1] * nOld[1] + nOld[2] * nOld[2]) *
+                               (nNew[0] * nNew[0] + nNew[1] * nNew[1] + nNew[2] * nNew[2]) );
+        if ( fLength <= 0.0 || fDot < LOD_FLIP_LIMIT * fLength ) return true;
+
+    } // Next Corner
+
+    return false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseState () (Local)
+// Desc : Frees the working arrays.
+//-----------------------------------------------------------------------------
+static void ReleaseState( SIMPLIFYSTATE & s )
+{
+    if ( s.pPosition      ) delete []s.pPosition;
+    if ( s.pQuadric       ) delete []s.pQuadric;
+    if ( s.pVersion       ) delete []s.pVersion;
+    if ( s.pVertexAlive   ) delete []s.pVertexAlive;
+    if ( s.pCornerHead    ) delete []s.pCornerHead;
+    if ( s.pCornerNext    ) delete []s.pCornerNext;
+    if ( s.pTriangle      ) delete []s.pTriangle;
+    if ( s.pTriangleAlive ) delete []s.pTriangleAlive;
+    if ( s.pHeap          ) delete []s.pHeap;
+    ZeroMemory( &s, sizeof(SIMPLIFYSTATE) );
+}
+
+//-----------------------------------------------------------------------------
+// Name : InitialiseState () (Local)
+// Desc : Allocates the working arrays, fans the source polygons into
+//        triangles, builds the vertex quadrics (including the open edge
+//        constraints) and queues every unique edge for collapse.
+//-----------------------------------------------------------------------------
+static bool InitialiseState( SIMPLIFYSTATE & s, const CIndexedMesh & Source )
+{
+    EDGEREF * pEdges;
+    ULONG     nEdgeCount = 0;
+    bool      bResult    = true;
+
+    s.VertexCount   = Source.m_nVertexCount;
+    s.TriangleCount = CLODChain::CountTriangles( Source );
+    s.AliveCount    = 0;
+
+    // Allocate the working arrays
+    s.pPosition      = new (std::nothrow) double[ s.VertexCount * 3 ];
+    s.pQuadric       = new (std::nothrow) QUADRIC[ s.VertexCount ];
+    s.pVersion       = new (std::nothrow) ULONG[ s.VertexCount ];
+    s.pVertexAlive   = new (std::nothrow) bool[ s.VertexCount ];
+    s.pCornerHead    = new (std::nothrow) ULONG[ s.VertexCount ];
+    s.pCornerNext    = new (std::nothrow) ULONG[ s.TriangleCount * 3 ];
+    s.pTriangle      = new (std::nothrow) ULONG[ s.TriangleCount * 3 ];
+    s.pTriangleAlive = new (std::nothrow) bool[ s.TriangleCount ];
+    if ( !s.pPosition || !s.pQuadric || !s.pVersion || !s.pVertexAlive || !s.pCornerHead ||
+         !s.pCornerNext || !s.pTriangle || !s.pTriangleAlive ) return false;
+
+    // Vertices
+    for ( ULONG i = 0; i < 3; i++ ) { s.vecMin[i] = DBL_MAX; s.vecMax[i] = -DBL_MAX; }
+    for ( ULONG i = 0; i < s.VertexCount; i++ )
+    {
+        const CVertex & v = Source.m_pVertex[i];
+        double * p = &s.pPosition[ i * 3 ];
+        p[0] = v.x; p[1] = v.y; p[2] = v.z;
+        for ( ULONG k = 0; k < 3; k++ )
+        {
+            if ( p[k] < s.vecMin[k] ) s.vecMin[k] = p[k];
+            if ( p[k] > s.vecMax[k] ) s.vecMax[k] = p[k];
+
+        } // Next Axis
+        ZeroMemory( &s.pQuadric[i], sizeof(QUADRIC) );
+        s.pVersion[i]     = 0;
+        s.pVertexAlive[i] = true;
+        s.pCornerHead[i]  = LOD_NO_CORNER;
+
+    } // Next Vertex
+
+    // Fan each polygon into triangles and accumulate their plane quadrics
+    for ( ULONG i = 0, t = 0; i < Source.m_nPolygonCount; i++ )
+    {
+        const ULONG * pIndex = Source.GetPolygonIndices( i );
+        ULONG         nCount = Source.GetPolygonVertexCount( i );
+
+        for ( ULONG j = 2; j < nCount; j++, t++ )
+        {
+            ULONG * pTri = &s.pTriangle[ t * 3 ];
+            double  n[3], fLength;
+            pTri[0] = pIndex[0]; pTri[1] = pIndex[j - 1]; pTri[2] = pIndex[j];
+
+            TriangleNormal( &s.pPosition[ pTri[0] * 3 ], &s.pPosition[ pTri[1] * 3 ], &s.pPosition[ pTri[2] * 3 ], n );
+            fLength = sqrt( n[0] * n[0] + n[1] * n[1] + n[2] * n[2] );
+            s.pTriangleAlive[t] = (fLength > 0.0);
+            if ( !s.pTriangleAlive[t] ) continue;
+            s.AliveCount++;
+
+            n[0] /= fLength; n[1] /= fLength; n[2] /= fLength;
+            const double * p0 = &s.pPosition[ pTri[0] * 3 ];
+            double d = -(n[0] * p0[0] + n[1] * p0[1] + n[2] * p0[2]);
+            for ( ULONG k = 0; k < 3; k++ )
+            {
+                AddPlaneQuadric( s.pQuadric[ pTri[k] ], n[0], n[1], n[2], d, 1.0 );
+
+                // Link the corner into its vertex's list
+                s.pCornerNext[ t * 3 + k ] = s.pCornerHead[ pTri[k] ];
+                s.pCornerHead[ pTri[k] ]   = t * 3 + k;
+
+            } // Next Corner
+
+        } // Next Triangle
+
+    } // Next Polygon
+
+    // Gather the edges of every live triangle
+    if (!( pEdges = new (std::nothrow) EDGEREF[ s.AliveCount * 3 ] )) return false;
+    for ( ULONG t = 0; t < s.TriangleCount; t++ )
+    {
+        if ( !s.pTriangleAlive[t] ) continue;
+        for ( ULONG k = 0; k < 3; k++ )
+        {
+            ULONG a = s.pTriangle[ t * 3 + k ], b = s.pTriangle[ t * 3 + (k + 1) % 3 ];
+            EDGEREF & Edge = pEdges[ nEdgeCount++ ];
+            Edge.V1 = (a < b) ? a : b; Edge.V2 = (a < b) ? b : a; Edge.Triangle = t;
+
+        } // Next Edge
+
+    } // Next Triangle
+    std::sort( pEdges, pEdges + nEdgeCount );
+
+    // Constrain open edges and queue each unique edge once
+    for ( ULONG i = 0; i < nEdgeCount && bResult; )
+    {
+        ULONG j = i + 1;
+        while ( j < nEdgeCount && pEdges[j].V1 == pEdges[i].V1 && pEdges[j].V2 == pEdges[i].V2 ) j++;
+
+        if ( j - i == 1 )
+        {
+            // Plane through the edge, perpendicular to its one triangle
+            const ULONG  * pTri = &s.pTriangle[ pEdges[i].Triangle * 3 ];
+            const double * pa = &s.pPosition[ pEdges[i].V1 * 3 ], * pb = &s.pPosition[ pEdges[i].V2 * 3 ];
+            double n[3], e[3] = { pb[0] - pa[0], pb[1] - pa[1], pb[2] - pa[2] }, p[3], fLength;
+
+            TriangleNormal( &s.pPosition[ pTri[0] * 3 ], &s.pPosition[ pTri[1] * 3 ], &s.pPosition[ pTri[2] * 3 ], n );
+            p[0] = e[1] * n[2] - e[2] * n[1];
+            p[1] = e[2] * n[0] - e[0] * n[2];
+            p[2] = e[0] * n[1] - e[1] * n[0];
+            fLength = sqrt( p[0] * p[0] + p[1] * p[1] + p[2] * p[2] );
+            if ( fLength > 0.0 )
+            {
+                p[0] /= fLength; p[1] /= fLength; p[2] /= fLength;
+                double d = -(p[0] * pa[0] + p[1] * pa[1] + p[2] * pa[2]);
+                AddPlaneQuadric( s.pQuadric[ pEdges[i].V1 ], p[0], p[1], p[2], d, LOD_BOUNDARY_WEIGHT );
+                AddPlaneQuadric( s.pQuadric[ pEdges[i].V2 ], p[0], p[1], p[2], d, LOD_BOUNDARY_WEIGHT );
+
+            } // End if valid
+
+        } // End if open edge
+        i = j;
+
+    } // Next Edge Run
+
+    // Quadrics are complete, so the costs can now be evaluated
+    for ( ULONG i = 0; i < nEdgeCount && bResult; i++ )
+    {
+        if ( i > 0 && pEdges[i].V1 == pEdges[i - 1].V1 && pEdges[i].V2 == pEdges[i - 1].V2 ) continue;
+        bResult = PushCollapse( s, pEdges[i].V1, pEdges[i].V2 );
+
+    } // Next Edge
+
+    delete []pEdges;
+    return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CollapseEdges () (Local)
+// Desc : Collapses the cheapest queued edges until no more than Target
+//        triangles remain or the queue runs dry, returning the largest
+//        error accepted through fMaxCost.
+//-----------------------------------------------------------------------------
+static bool CollapseEdges( SIMPLIFYSTATE & s, ULONG Target, double & fMaxCost )
+{
+    fMaxCost = 0.0;
+    while ( s.AliveCount > Target && s.HeapCount > 0 )
+    {
+        COLLAPSE Collapse = HeapPop( s );
+        ULONG    Keep = Collapse.Keep, Remove = Collapse.Remove;
+
+        // Stale?
+        if ( !s.pVertexAlive[ Keep ] || !s.pVertexAlive[ Remove ] ) continue;
+        if ( s.pVersion[ Keep ] != Collapse.KeepVersion || s.pVersion[ Remove ] != Collapse.RemoveVersion ) continue;
+
+        // Skip collapses that fold the surface over, a later change around
+        // either vertex will queue the edge again
+        if ( CollapseFlips( s, Keep, Remove, Collapse.Position ) ) continue;
+        if ( CollapseFlips( s, Remove, Keep, Collapse.Position ) ) continue;
+
+        // Merge Remove into Keep
+        for ( ULONG k = 0; k < 3; k++ ) s.pPosition[ Keep * 3 + k ] = Collapse.Position[k];
+        for ( ULONG k = 0; k < 10; k++ ) s.pQuadric[ Keep ].q[k] += s.pQuadric[ Remove ].q[k];
+        s.pVertexAlive[ Remove ] = false;
+        s.pVersion[ Keep ]++;
+        if ( Collapse.Cost > fMaxCost ) fMaxCost = Collapse.Cost;
+
+        ULONG Tail = LOD_NO_CORNER;
+        for ( ULONG c = s.pCornerHead[ Remove ]; c != LOD_NO_CORNER; c = s.pCornerNext[c] )
+        {
+            s.pTriangle[c] = Keep;
+            Tail = c;
+
+        } // Next Corner
+        if ( Tail != LOD_NO_CORNER )
+        {
+            s.pCornerNext[ Tail ] = s.pCornerHead[ Keep ];
+            s.pCornerHead[ Keep ] = s.pCornerHead[ Remove ];
+
+        } // End if any corners
+        s.pCornerHead[ Remove ] = LOD_NO_CORNER;
+
+        // Kill triangles that now repeat a vertex, dropping dead corners from
+        // the list as we go
+        ULONG Prev = LOD_NO_CORNER;
+        for ( ULONG c = s.pCornerHead[ Keep ]; c != LOD_NO_CORNER; c = s.pCornerNext[c] )
+        {
+            ULONG   Triangle = c / 3;
+            ULONG * pTri     = &s.pTriangle[ Triangle * 3 ];
+
+            if ( s.pTriangleAlive[ Triangle ] && (pTri[0] == pTri[1] || pTri[1] == pTri[2] || pTri[2] == pTri[0]) )
+            {
+                s.pTriangleAlive[ Triangle ] = false;
+                s.AliveCount--;
+
+            } // End if degenerate
+
+            if ( !s.pTriangleAlive[ Triangle ] )
+            {
+                if ( Prev == LOD_NO_CORNER ) s.pCornerHead[ Keep ] = s.pCornerNext[c];
+                else s.pCornerNext[ Prev ] = s.pCornerNext[c];
+                continue;
+
+            } // End if dead
+            Prev = c;
+
+        } // Next Corner
+
+        // Requeue the edges around the survivor
+        for ( ULONG c = s.pCornerHead[ Keep ]; c != LOD_NO_CORNER; c = s.pCornerNext[c] )
+        {
+            const ULONG * pTri = &s.pTriangle[ (c / 3) * 3 ];
+            for ( ULONG k = 0; k < 3; k++ )
+            {
+                if ( pTri[k] != Keep && !PushCollapse( s, Keep, pTri[k] ) ) return false;
+
+            } // Next Corner
+
+        } // Next Corner
+
+    } // Next Collapse
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteMesh () (Local)
+// Desc : Compacts the surviving vertices and triangles into a new mesh, one
+//        triangle per polygon.
+//-----------------------------------------------------------------------------
+static bool WriteMesh( const SIMPLIFYSTATE & s, CIndexedMesh & Dest )
+{
+    ULONG * pRemap, nOutVertices = 0;
+
+    if (!( pRemap = new (std::nothrow) ULONG[ s.VertexCount ] )) return false;
+    for ( ULONG i = 0; i < s.VertexCount; i++ ) pRemap[i] = LOD_NO_CORNER;
+    for ( ULONG t = 0; t < s.TriangleCount; t++ )
+    {
+        if ( !s.pTriangleAlive[t] ) continue;
+        for ( ULONG k = 0; k < 3; k++ )
+        {
+            ULONG v = s.pTriangle[ t * 3 + k ];
+            if ( pRemap[v] == LOD_NO_CORNER ) pRemap[v] = nOutVertices++;
+
+        } // Next Corner
+
+    } // Next Triangle
+
+    if ( !Dest.Create( nOutVertices, s.AliveCount * 3, s.AliveCount ) ) { delete []pRemap; return false; }
+    for ( ULONG i = 0; i < s.VertexCount; i++ )
+    {
+        if ( pRemap[i] == LOD_NO_CORNER ) continue;
+        const double * p = &s.pPosition[ i * 3 ];
+        Dest.m_pVertex[ pRemap[i] ] = CVertex( (float)p[0], (float)p[1], (float)p[2] );
+
+    } // Next Vertex
+    for ( ULONG t = 0, n = 0; t < s.TriangleCount; t++ )
+    {
+        if ( !s.pTriangleAlive[t] ) continue;
+        for ( ULONG k = 0; k < 3; k++ ) Dest.m_pIndex[ n * 3 + k ] = pRemap[ s.pTriangle[ t * 3 + k ] ];
+        Dest.m_pPolygonStart[ n ] = n * 3;
+        n++;
+
+    } // Next Triangle
+    delete []pRemap;
+
+    Dest.CalculateBounds();
+    return Dest.CalculatePlanes();
+}
+
+//-----------------------------------------------------------------------------
+// CLODChain Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CLODChain () (Constructor)
+// Desc : CLODChain Class Constructor
+//-----------------------------------------------------------------------------
+CLODChain::CLODChain()
+{
+	// Reset / Clear all required values
+    m_pSource         = NULL;
+    m_nLevelCount     = 0;
+    m_fBaseSwitchSize = 0.0f;
+    for ( ULONG i = 0; i < LOD_MAX_LEVELS; i++ ) { m_fSwitchSize[i] = 0.0f; m_fError[i] = 0.0f; }
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CLODChain () (Destructor)
+// Desc : CLODChain Class Destructor
+//-----------------------------------------------------------------------------
+CLODChain::~CLODChain()
+{
+	// Release any memory
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees the simplified levels.
+//-----------------------------------------------------------------------------
+void CLODChain::Release( )
+{
+    for ( ULONG i = 0; i < LOD_MAX_LEVELS - 1; i++ ) m_pLevels[i].Release();
+    m_pSource     = NULL;
+    m_nLevelCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Build ()
+// Desc : Generates up to LevelCount levels (including the source) from the
+//        mesh, each from the one before. Generation stops early once a level
+//        fails to remove a useful number of triangles, so very simple meshes
+//        may end up with only the source level.
+// Note : The source mesh must outlive the chain.
+//-----------------------------------------------------------------------------
+bool CLODChain::Build( const CIndexedMesh * pMesh, ULONG LevelCount, float fSwitchSize )
+{
+    if ( !pMesh ) return false;
+    if ( LevelCount > LOD_MAX_LEVELS ) LevelCount = LOD_MAX_LEVELS;
+    if ( LevelCount < 1 ) LevelCount = 1;
+
+    Create( pMesh, fSwitchSize );
+    for ( ULONG i = 1; i < LevelCount; i++ )
+    {
+        const CIndexedMesh * pPrev = GetLevel( i - 1 );
+        ULONG nPrevCount = CountTriangles( *pPrev );
+        ULONG nTarget    = (ULONG)(nPrevCount * LOD_REDUCTION);
+        float fError;
+
+        if ( !Simplify( *pPrev, m_pLevels[ i - 1 ], nTarget, &fError ) ) return false;
+
+        // Not worth keeping?
+        if ( CountTriangles( m_pLevels[ i - 1 ] ) > nPrevCount * LOD_MIN_REDUCTION )
+        {
+            m_pLevels[ i - 1 ].Release();
+            break;
+        
+        } // End if too little removed
+
+        // Errors accumulate from level to level
+        SetLevelError( i, m_fError[ i - 1 ] + fError );
+        m_nLevelCount++;
+
+    } // Next Level
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Starts a chain holding only the source mesh, for levels generated
+//        elsewhere (such as those stored in a mesh file) to be added to.
+// Note : The source mesh must outlive the chain.
+//-----------------------------------------------------------------------------
+void CLODChain::Create( const CIndexedMesh * pMesh, float fSwitchSize )
+{
+    Release();
+
+    m_pSource         = pMesh;
+    m_nLevelCount     = 1;
+    m_fBaseSwitchSize = fSwitchSize;
+    m_fSwitchSize[0]  = FLT_MAX;
+    m_fError[0]       = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddLevel ()
+// Desc : Appends a level with the given error (relative to level 0),
+//        returning the mesh for the caller to fill or attach, or NULL if the
+//        chain is full.
+//-----------------------------------------------------------------------------
+CIndexedMesh * CLODChain::AddLevel( float fError )
+{
+    if ( !m_pSource || m_nLevelCount >= LOD_MAX_LEVELS ) return NULL;
+
+    SetLevelError( m_nLevelCount, fError );
+    return &m_pLevels[ m_nLevelCount++ - 1 ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetLevelError () (Private)
+// Desc : Stores a level's error and derives its switch size, half that of the
+//        level before, then shrunk until the error covers at most
+//        LOD_PIXEL_ERROR pixels of the object's projected diameter.
+//-----------------------------------------------------------------------------
+void CLODChain::SetLevelError( ULONG Level, float fError )
+{
+    m_fError[ Level ]      = fError;
+    m_fSwitchSize[ Level ] = (Level == 1) ? m_fBaseSwitchSize : m_fSwitchSize[ Level - 1 ] * 0.5f;
+
+    if ( fError > 0.0f )
+    {
+        float fLimit = LOD_PIXEL_ERROR * m_pSource->m_Bounds.m_fRadius * 2.0f / fError;
+        if ( m_fSwitchSize[ Level ] > fLimit ) m_fSwitchSize[ Level ] = fLimit;
+
+    } // End if any error
+}
+
+//-----------------------------------------------------------------------------
+// Name : SelectLevel ()
+// Desc : Returns the coarsest level whose switch size the projected size
+//        (bounding sphere diameter in pixels) has fallen below.
+//-----------------------------------------------------------------------------
+ULONG CLODChain::SelectLevel( float fProjectedSize ) const
+{
+    ULONG Level = 0;
+    while ( Level + 1 < m_nLevelCount && fProjectedSize < m_fSwitchSize[ Level + 1 ] ) Level++;
+    return Level;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CountTriangles () (Static)
+// Desc : Number of triangles the polygons of a mesh fan into.
+//-----------------------------------------------------------------------------
+ULONG CLODChain::CountTriangles( const CIndexedMesh & Mesh )
+{
+    ULONG nCount = 0;
+    for ( ULONG i = 0; i < Mesh.m_nPolygonCount; i++ )
+    {
+        ULONG nVertices = Mesh.GetPolygonVertexCount( i );
+        if ( nVertices >= 3 ) nCount += nVertices - 2;
+
+    } // Next Polygon
+    return nCount;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Simplify () (Static)
+// Desc : Builds a triangle mesh from Source with at most TargetTriangles
+//        triangles (if it can get that far) by repeatedly collapsing the
+//        edge whose new position has the least quadric error (Garland &
+//        Heckbert). Each vertex starts with the summed squared distance
+//        quadrics of its triangles' planes, plus heavily weighted planes
+//        through any open edges so that borders keep their shape.
+//        Collapses that would flip or crush a triangle are skipped.
+//        Optionally returns the square root of the largest error accepted,
+//        a rough measure of distance from the source surface.
+//-----------------------------------------------------------------------------
+bool CLODChain::Simplify( const CIndexedMesh & Source, CIndexedMesh & Dest, ULONG TargetTriangles, float * pError )
+{
+    SIMPLIFYSTATE s;
+    double        fMaxCost = 0.0;
+    bool          bResult;
+
+    ZeroMemory( &s, sizeof(SIMPLIFYSTATE) );
+    Dest.Release();
+
+    bResult = InitialiseState( s, Source ) && CollapseEdges( s, TargetTriangles, fMaxCost ) && WriteMesh( s, Dest );
+    ReleaseState( s );
+
+    if ( !bResult ) { Dest.Release(); return false; }
+    if ( pError ) *pError = (float)sqrt( fMaxCost );
+    return true;
+}
@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------------
+// File: CMappedFile.cpp
+//
+// Desc: Read only memory mapping of a whole file.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CMappedFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CMappedFile.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Name : CMappedFile () (Constructor)
+// Desc : CMappedFile Class Constructor
+//-----------------------------------------------------------------------------
+CMappedFile::CMappedFile()
+{
+	// Reset / Clear all required values
+    m_pData     = NULL;
+    m_nSize     = 0;
+#ifdef _WIN32
+    m_hFile     = INVALID_HANDLE_VALUE;
+    m_hMapping  = NULL;
+#else
+    m_nFile     = -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CMappedFile () (Destructor)
+// Desc : CMappedFile Class Destructor
+//-----------------------------------------------------------------------------
+CMappedFile::~CMappedFile()
+{
+	// Unmap the file
+    Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open ()
+// Desc : Maps the whole of a (non empty) file, read only.
+//-----------------------------------------------------------------------------
+bool CMappedFile::Open( const char * pFileName )
+{
+    Close();
+
+#ifdef _WIN32
+    LARGE_INTEGER Size;
+
+    m_hFile = CreateFileA( pFileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL );
+    if ( m_hFile == INVALID_HANDLE_VALUE ) return false;
+    if ( !GetFileSizeEx( m_hFile, &Size ) || Size.QuadPart <= 0 ) { Close(); return false; }
+    m_nSize = (unsigned __int64)Size.QuadPart;
+
+    if (!( m_hMapping = CreateFileMapping( m_hFile, NULL, PAGE_READONLY, 0, 0, NULL ) )) { Close(); return false; }
+    if (!( m_pData = (const BYTE*)MapViewOfFile( m_hMapping, FILE_MAP_READ, 0, 0, 0 ) )) { Close(); return false; }
+#else
+    struct stat Info;
+    void      * pMapping;
+
+    if ( (m_nFile = open( pFileName, O_RDONLY )) < 0 ) return false;
+    if ( fstat( m_nFile, &Info ) != 0 || Info.st_size <= 0 ) { Close(); return false; }
+    m_nSize = (unsigned __int64)Info.st_size;
+
+    pMapping = mmap( NULL, (size_t)m_nSize, PROT_READ, MAP_PRIVATE, m_nFile, 0 );
+    if ( pMapping == MAP_FAILED ) { Close(); return false; }
+    m_pData = (const BYTE*)pMapping;
+#endif
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+// Desc : Unmaps the file. Nothing may use the mapped memory afterwards.
+//-----------------------------------------------------------------------------
+void CMappedFile::Close( )
+{
+#ifdef _WIN32
+    if ( m_pData ) UnmapViewOfFile( m_pData );
+    if ( m_hMapping ) CloseHandle( m_hMapping );
+    if ( m_hFile != INVALID_HANDLE_VALUE ) CloseHandle( m_hFile );
+    m_hFile     = INVALID_HANDLE_VALUE;
+    m_hMapping  = NULL;
+#else
+    if ( m_pData ) munmap( (void*)m_pData, (size_t)m_nSize );
+    if ( m_nFile >= 0 ) close( m_nFile );
+    m_nFile     = -1;
+#endif
+
+    m_pData     = NULL;
+    m_nSize     = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Prefetch ()
+// Desc : Hints to the operating system that the whole file will shortly be
+//        read, so that it can be paged in ahead of use (in larger, sequential
+//        reads) rather than a page at a time as it is first touched.
+//-----------------------------------------------------------------------------
+void CMappedFile::Prefetch( ) const
+{
+    if ( !m_pData ) return;
+
+#ifndef _WIN32
+    madvise( (void*)m_pData, (size_t)m_nSize, MADV_WILLNEED );
+#endif
+}
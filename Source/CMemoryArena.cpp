@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// File: CMemoryArena.cpp
+//
+// Desc: Simple block based linear allocator. Allocations are carved out of
+//       large blocks and only ever released all together.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CMemoryArena Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CMemoryArena.h"
+
+//-----------------------------------------------------------------------------
+// Name : CMemoryArena () (Constructor)
+// Desc : CMemoryArena Class Constructor
+//-----------------------------------------------------------------------------
+CMemoryArena::CMemoryArena()
+{
+	// Reset / Clear all required values
+    m_pBlock         = NULL;
+    m_nBlockCount    = 0;
+    m_nTotalSize     = 0;
+    m_nNextBlockSize = ARENA_MIN_BLOCK_SIZE;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CMemoryArena () (Destructor)
+// Desc : CMemoryArena Class Destructor
+//-----------------------------------------------------------------------------
+CMemoryArena::~CMemoryArena()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees every block, invalidating all previous allocations.
+//-----------------------------------------------------------------------------
+void CMemoryArena::Release( )
+{
+    while ( m_pBlock )
+    {
+        BLOCK * pPrevious = m_pBlock->pPrevious;
+        free( m_pBlock );
+        m_pBlock = pPrevious;
+
+    } // Next Block
+
+    // Clear variables
+    m_nBlockCount    = 0;
+    m_nTotalSize     = 0;
+    m_nNextBlockSize = ARENA_MIN_BLOCK_SIZE;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddBlock () (Private)
+// Desc : Allocates a new current block with at least MinSize usable bytes.
+//-----------------------------------------------------------------------------
+bool CMemoryArena::AddBlock( size_t MinSize )
+{
+    size_t  Size   = m_nNextBlockSize;
+    BLOCK * pBlock = NULL;
+
+    // Large requests get a block of their own size
+    if ( Size < MinSize ) Size = MinSize;
+
+    // Allocate block and header together
+    if (!( pBlock = (BLOCK*)malloc( sizeof(BLOCK) + Size ) )) return false;
+    pBlock->pPrevious = m_pBlock;
+    pBlock->Size      = Size;
+    pBlock->Used      = 0;
+    m_pBlock          = pBlock;
+
+    // Track sizes, doubling up to the limit
+    m_nBlockCount++;
+    m_nTotalSize += Size;
+    if ( m_nNextBlockSize < ARENA_MAX_BLOCK_SIZE ) m_nNextBlockSize *= 2;
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Allocate ()
+// Desc : Returns Size bytes aligned to the (power of two) alignment specified,
+//        or NULL on failure.
+//-----------------------------------------------------------------------------
+void * CMemoryArena::Allocate( size_t Size, size_t Alignment )
+{
+    for ( int Attempt = 0; Attempt < 2; Attempt++ )
+    {
+        if ( m_pBlock )
+        {
+            UCHAR * pBase   = (UCHAR*)(m_pBlock + 1);
+            size_t  Address = ((size_t)(pBase + m_pBlock->Used) + Alignment - 1) & ~(Alignment - 1);
+            size_t  Offset  = Address - (size_t)pBase;
+
+            // Fits within the current block?
+            if ( Offset + Size <= m_pBlock->Size )
+            {
+                m_pBlock->Used = Offset + Size;
+                return pBase + Offset;
+
+            } // End if fits
+
+        } // End if block available
+
+        // Start a new block, with room for worst case alignment padding
+        if ( Attempt == 0 && !AddBlock( Size + Alignment ) ) return NULL;
+
+    } // Next Attempt
+
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Grow ()
+// Desc : Attempts to extend the most recent allocation in place.
+// Note : Returns false (leaving the allocation untouched) if pMemory was not
+//        the last allocation, or the current block has no room.
+//-----------------------------------------------------------------------------
+bool CMemoryArena::Grow( void * pMemory, size_t OldSize, size_t NewSize )
+{
+    UCHAR * pBase;
+
+    if ( !m_pBlock || !pMemory ) return false;
+    pBase = (UCHAR*)(m_pBlock + 1);
+
+    // Must be the final allocation in the current block
+    if ( (UCHAR*)pMemory + OldSize != pBase + m_pBlock->Used ) return false;
+    if ( (size_t)((UCHAR*)pMemory - pBase) + NewSize > m_pBlock->Size ) return false;
+
+    m_pBlock->Used = (size_t)((UCHAR*)pMemory - pBase) + NewSize;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reserve ()
+// Desc : Ensures that at least Size bytes can be allocated without requiring
+//        a further block.
+//-----------------------------------------------------------------------------
+bool CMemoryArena::Reserve( size_t Size )
+{
+    if ( m_pBlock && m_pBlock->Size - m_pBlock->Used >= Size + ARENA_ALIGNMENT ) return true;
+    return AddBlock( Size + ARENA_ALIGNMENT );
+}
@@ -0,0 +1,275 @@
+//-----------------------------------------------------------------------------
+// File: CMeshFile.cpp
+//
+// Desc: Binary mesh container, memory mapped and used in place so that no
+//       parsing or copying is needed to load it.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CMeshFile Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CMeshFile.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : AlignOffset () (Local)
+// Desc : Rounds a file offset up to the block alignment.
+//-----------------------------------------------------------------------------
+static inline unsigned __int64 AlignOffset( unsigned __int64 Offset )
+{
+    return (Offset + MESHFILE_ALIGN - 1) & ~(unsigned __int64)(MESHFILE_ALIGN - 1);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckBlock () (Local)
+// Desc : Returns true if a block is aligned and lies entirely within the file.
+//-----------------------------------------------------------------------------
+static inline bool CheckBlock( unsigned __int64 Offset, unsigned __int64 Size, unsigned __int64 FileSize )
+{
+    if ( Offset % MESHFILE_ALIGN ) return false;
+    return Offset <= FileSize && Size <= FileSize - Offset;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WritePadding () (Local)
+// Desc : Writes zeros up to the next aligned offset.
+//-----------------------------------------------------------------------------
+static bool WritePadding( FILE * pFile, unsigned __int64 & Offset )
+{
+    static const BYTE Zero[ MESHFILE_ALIGN ] = { 0 };
+    size_t Count = (size_t)(AlignOffset( Offset ) - Offset);
+
+    Offset += Count;
+    return Count == 0 || fwrite( Zero, 1, Count, pFile ) == Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteBlock () (Local)
+// Desc : Writes a block of data, followed by padding to the next alignment.
+//-----------------------------------------------------------------------------
+static bool WriteBlock( FILE * pFile, const void * pData, size_t Size, unsigned __int64 & Offset )
+{
+    if ( Size && fwrite( pData, 1, Size, pFile ) != Size ) return false;
+    Offset += Size;
+    return WritePadding( pFile, Offset );
+}
+
+//-----------------------------------------------------------------------------
+// CMeshFile Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CMeshFile () (Constructor)
+// Desc : CMeshFile Class Constructor
+//-----------------------------------------------------------------------------
+CMeshFile::CMeshFile()
+{
+	// Reset / Clear all required values
+    m_pData     = NULL;
+    m_nFileSize = 0;
+    m_pHeader   = NULL;
+    m_pEntries  = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CMeshFile () (Destructor)
+// Desc : CMeshFile Class Destructor
+//-----------------------------------------------------------------------------
+CMeshFile::~CMeshFile()
+{
+	// Unmap the file
+    Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Open ()
+// Desc : Maps a mesh file into memory (read only), then checks that its
+//        header and mesh table describe blocks which lie within it.
+//-----------------------------------------------------------------------------
+bool CMeshFile::Open( const char * pFileName )
+{
+    Close();
+
+    if ( !m_File.Open( pFileName ) ) return false;
+    m_pData     = m_File.GetData();
+    m_nFileSize = m_File.GetSize();
+    if ( m_nFileSize < sizeof(MESHFILEHEADER) ) { Close(); return false; }
+
+    m_pHeader  = (const MESHFILEHEADER*)m_pData;
+    m_pEntries = (const MESHFILEENTRY*)(m_pData + m_pHeader->TableOffset);
+    if ( !CheckLayout() ) { Close(); return false; }
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Close ()
+// Desc : Unmaps the file. Meshes attached to it must already be released.
+//-----------------------------------------------------------------------------
+void CMeshFile::Close( )
+{
+    m_File.Close();
+    m_pData     = NULL;
+    m_nFileSize = 0;
+    m_pHeader   = NULL;
+    m_pEntries  = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CheckLayout () (Private)
+// Desc : Checks the header, and that every block of every mesh lies (aligned)
+//        within the file. None of the geometry itself is touched.
+//-----------------------------------------------------------------------------
+bool CMeshFile::CheckLayout( ) const
+{
+    const MESHFILEHEADER & Header = *m_pHeader;
+
+    if ( Header.Magic != MESHFILE_MAGIC || Header.Version != MESHFILE_VERSION ) return false;
+    if ( Header.EntrySize != sizeof(MESHFILEENTRY) || Header.FileSize != m_nFileSize ) return false;
+    if ( !CheckBlock( Header.TableOffset, (unsigned __int64)Header.MeshCount * sizeof(MESHFILEENTRY), m_nFileSize ) ) return false;
+
+    for ( ULONG i = 0; i < Header.MeshCount; i++ )
+    {
+        const MESHFILEENTRY & Entry = m_pEntries[i];
+
+        if ( !CheckBlock( Entry.VertexOffset, (unsigned __int64)Entry.VertexCount * sizeof(CVertex), m_nFileSize ) ) return false;
+        if ( !CheckBlock( Entry.IndexOffset, (unsigned __int64)Entry.IndexCount * sizeof(ULONG), m_nFileSize ) ) return false;
+        if ( !CheckBlock( Entry.PolygonOffset, ((unsigned __int64)Entry.PolygonCount + 1) * sizeof(ULONG), m_nFileSize ) ) return false;
+        if ( !CheckBlock( Entry.PlaneOffset, (unsigned __int64)Entry.PolygonCount * sizeof(D3DXPLANE), m_nFileSize ) ) return false;
+        if ( Entry.Level > 0 && (i == 0 || Entry.Level != m_pEntries[ i - 1 ].Level + 1) ) return false;
+
+    } // Next Mesh
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Validate ()
+// Desc : Checks the contents of every mesh: that each polygon table runs in
+//        order from zero to the index count, and that every index refers to
+//        a vertex. Touches the whole file, so is intended for tools and for
+//        files from untrusted sources rather than for every load.
+//-----------------------------------------------------------------------------
+bool CMeshFile::Validate( ) const
+{
+    if ( !m_pHeader ) return false;
+
+    for ( ULONG i = 0; i < m_pHeader->MeshCount; i++ )
+    {
+        const MESHFILEENTRY & Entry  = m_pEntries[i];
+        const ULONG         * pStart = (const ULONG*)(m_pData + Entry.PolygonOffset);
+        const ULONG         * pIndex = (const ULONG*)(m_pData + Entry.IndexOffset);
+
+        if ( pStart[0] != 0 || pStart[ Entry.PolygonCount ] != Entry.IndexCount ) return false;
+        for ( ULONG p = 0; p < Entry.PolygonCount; p++ ) if ( pStart[ p + 1 ] < pStart[p] ) return false;
+        for ( ULONG n = 0; n < Entry.IndexCount; n++ ) if ( pIndex[n] >= Entry.VertexCount ) return false;
+
+    } // Next Mesh
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetMesh ()
+// Desc : Attaches a mesh to the file's blocks, without copying anything.
+//-----------------------------------------------------------------------------
+bool CMeshFile::GetMesh( ULONG Mesh, CIndexedMesh & Out ) const
+{
+    CBounds Bounds;
+
+    if ( !m_pHeader || Mesh >= m_pHeader->MeshCount ) return false;
+    const MESHFILEENTRY & Entry = m_pEntries[ Mesh ];
+
+    Bounds.m_vecMin    = D3DXVECTOR3( Entry.BoundsMin[0], Entry.BoundsMin[1], Entry.BoundsMin[2] );
+    Bounds.m_vecMax    = D3DXVECTOR3( Entry.BoundsMax[0], Entry.BoundsMax[1], Entry.BoundsMax[2] );
+    Bounds.m_vecCentre = D3DXVECTOR3( Entry.BoundsCentre[0], Entry.BoundsCentre[1], Entry.BoundsCentre[2] );
+    Bounds.m_fRadius   = Entry.BoundsRadius;
+
+    Out.Attach( Entry.VertexCount, (const CVertex*)(m_pData + Entry.VertexOffset),
+                Entry.IndexCount, (const ULONG*)(m_pData + Entry.IndexOffset),
+                Entry.PolygonCount, (const ULONG*)(m_pData + Entry.PolygonOffset),
+                (const D3DXPLANE*)(m_pData + Entry.PlaneOffset), Bounds );
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Write () (Static)
+// Desc : Writes meshes out as a mesh file. Each mesh must have its bounds
+//        and planes calculated. pLevels and pErrors give each mesh's level
+//        of detail and simplification error, and may be NULL if every mesh
+//        is a source mesh.
+//-----------------------------------------------------------------------------
+bool CMeshFile::Write( const char * pFileName, const CIndexedMesh * const * ppMeshes, const ULONG * pLevels,
+                       const float * pErrors, ULONG Count )
+{
+    MESHFILEHEADER    Header;
+    MESHFILEENTRY   * pEntries;
+    unsigned __int64  Offset;
+    FILE            * pFile;
+    bool              bResult = true;
+
+    if (!( pEntries = new (std::nothrow) MESHFILEENTRY[ Count ] )) return false;
+    ZeroMemory( &Header, sizeof(MESHFILEHEADER) );
+    ZeroMemory( pEntries, Count * sizeof(MESHFILEENTRY) );
+
+    // Lay out the header, the mesh table, then each mesh's blocks in turn
+    Offset = AlignOffset( sizeof(MESHFILEHEADER) );
+    Header.Magic       = MESHFILE_MAGIC;
+    Header.Version     = MESHFILE_VERSION;
+    Header.MeshCount   = Count;
+    Header.EntrySize   = sizeof(MESHFILEENTRY);
+    Header.TableOffset = Offset;
+    Offset = AlignOffset( Offset + Count * sizeof(MESHFILEENTRY) );
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const CIndexedMesh & Mesh  = *ppMeshes[i];
+        MESHFILEENTRY      & Entry = pEntries[i];
+
+        if ( !Mesh.m_pPolygonPlane && Mesh.m_nPolygonCount ) { delete []pEntries; return false; }
+
+        Entry.VertexCount   = Mesh.m_nVertexCount;
+        Entry.IndexCount    = Mesh.m_nIndexCount;
+        Entry.PolygonCount  = Mesh.m_nPolygonCount;
+        Entry.Level         = pLevels ? pLevels[i] : 0;
+        Entry.Error         = pErrors ? pErrors[i] : 0.0f;
+        Entry.VertexOffset  = Offset; Offset = AlignOffset( Offset + Mesh.m_nVertexCount * sizeof(CVertex) );
+        Entry.IndexOffset   = Offset; Offset = AlignOffset( Offset + Mesh.m_nIndexCount * sizeof(ULONG) );
+        Entry.PolygonOffset = Offset; Offset = AlignOffset( Offset + (Mesh.m_nPolygonCount + 1) * sizeof(ULONG) );
+        Entry.PlaneOffset   = Offset; Offset = AlignOffset( Offset + Mesh.m_nPolygonCount * sizeof(D3DXPLANE) );
+
+        const CBounds & Bounds = Mesh.m_Bounds;
+        Entry.BoundsMin[0]    = Bounds.m_vecMin.x;    Entry.BoundsMin[1]    = Bounds.m_vecMin.y;    Entry.BoundsMin[2]    = Bounds.m_vecMin.z;
+        Entry.BoundsMax[0]    = Bounds.m_vecMax.x;    Entry.BoundsMax[1]    = Bounds.m_vecMax.y;    Entry.BoundsMax[2]    = Bounds.m_vecMax.z;
+        Entry.BoundsCentre[0] = Bounds.m_vecCentre.x; Entry.BoundsCentre[1] = Bounds.m_vecCentre.y; Entry.BoundsCentre[2] = Bounds.m_vecCentre.z;
+        Entry.BoundsRadius    = Bounds.m_fRadius;
+
+    } // Next Mesh
+    Header.FileSize = Offset;
+
+    // Write everything out in the same order
+    if (!( pFile = fopen( pFileName, "wb" ) )) { delete []pEntries; return false; }
+    Offset  = 0;
+    bResult = WriteBlock( pFile, &Header, sizeof(MESHFILEHEADER), Offset ) &&
+              WriteBlock( pFile, pEntries, Count * sizeof(MESHFILEENTRY), Offset );
+
+    for ( ULONG i = 0; i < Count && bResult; i++ )
+    {
+        const CIndexedMesh & Mesh = *ppMeshes[i];
+
+        bResult = WriteBlock( pFile, Mesh.m_pVertex, Mesh.m_nVertexCount * sizeof(CVertex), Offset ) &&
+                  WriteBlock( pFile, Mesh.m_pIndex, Mesh.m_nIndexCount * sizeof(ULONG), Offset ) &&
+                  WriteBlock( pFile, Mesh.m_pPolygonStart, (Mesh.m_nPolygonCount + 1) * sizeof(ULONG), Offset ) &&
+                  WriteBlock( pFile, Mesh.m_pPolygonPlane, Mesh.m_nPolygonCount * sizeof(D3DXPLANE), Offset );
+
+    } // Next Mesh
+
+    if ( fclose( pFile ) != 0 ) bResult = false;
+    delete []pEntries;
+    return bResult;
+}
@@ -0,0 +1,596 @@
+//-----------------------------------------------------------------------------
+// File: COBJImporter.cpp
+//
+// Desc: Parallel importer for Wavefront OBJ geometry.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// COBJImporter Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/COBJImporter.h"
+#include "../Includes/CJobSystem.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const __int64 OBJ_RELATIVE   = (__int64)1 << 40;    // Offset marking relative face corners
+static const ULONG   OBJ_MAX_TOKEN  = 64;                   // Longest number handed to strtod
+
+// Exactly representable powers of ten, for the fast path of ParseFloat
+static const double  g_Powers[]     = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                        1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                        1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : IsSpace () (Local)
+// Desc : Is this character blank space within a line?
+//-----------------------------------------------------------------------------
+static inline bool IsSpace( char c )
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+//-----------------------------------------------------------------------------
+// Name : GrowArray () (Local)
+// Desc : Doubles the size of a chunk array, keeping its contents.
+//-----------------------------------------------------------------------------
+template <class T> static bool GrowArray( T *& pArray, ULONG Count, ULONG & Max )
+{
+    ULONG NewMax = ( Max < 256 ) ? 256 : Max * 2;
+    T   * pNew;
+
+    if ( NewMax <= Max ) return false;
+    if (!( pNew = new (std::nothrow) T[ NewMax ] )) return false;
+    if ( pArray ) { memcpy( pNew, pArray, Count * sizeof(T) ); delete []pArray; }
+    pArray = pNew;
+    Max    = NewMax;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseFloat () (Local)
+// Desc : Reads a decimal number, stopping at pEnd. Numbers of up to 18
+//        significant digits with small exponents (almost everything found
+//        in practice) are assembled directly from an integer mantissa and
+//        a single exact power of ten, which rounds correctly; anything else
+//        is handed to strtod.
+//-----------------------------------------------------------------------------
+static bool ParseFloat( const char *& pText, const char * pEnd, float & Value )
+{
+    const char       * p = pText, * pToken;
+    unsigned __int64   Mantissa = 0;
+    int                Exponent = 0;
+    bool               bNegative = false, bDigits = false;
+
+    while ( p < pEnd && IsSpace( *p ) ) p++;
+    pToken = p;
+
+    // Sign, whole and fractional digits
+    if ( p < pEnd && (*p == '-' || *p == '+') ) bNegative = ( *p++ == '-' );
+    for ( ; p < pEnd && *p >= '0' && *p <= '9'; p++, bDigits = true )
+    {
+        if ( Mantissa < 100000000000000000ULL ) Mantissa = Mantissa * 10 + (*p - '0'); else Exponent++;
+
+    } // Next Digit
+    if ( p < pEnd && *p == '.' )
+    {
+        for ( p++; p < pEnd && *p >= '0' && *p <= '9'; p++, bDigits = true )
+        {
+            if ( Mantissa < 100000000000000000ULL ) { Mantissa = Mantissa * 10 + (*p - '0'); Exponent--; }
+
+        } // Next Digit
+
+    } // End if fraction
+
+    // Exponent
+    if ( bDigits && p < pEnd && (*p == 'e' || *p == 'E') )
+    {
+        const char * pExponent = p + 1;
+        bool         bExpNegative = false;
+        int          Power = 0;
+
+        if ( pExponent < pEnd && (*pExponent == '-' || *pExponent == '+') ) bExpNegative = ( *pExponent++ == '-' );
+        if ( pExponent < pEnd && *pExponent >= '0' && *pExponent <= '9' )
+        {
+            for ( p = pExponent; p < pEnd && *p >= '0' && *p <= '9'; p++ ) if ( Power < 10000 ) Power = Power * 10 + (*p - '0');
+            Exponent += bExpNegative ? -Power : Power;
+
+        } // End if digits
+        else bDigits = false;
+
+    } // End if exponent
+
+    // Fast path
+    if ( bDigits && (p == pEnd || IsSpace( *p ) || *p == '\n') &&
+         Mantissa <= ((unsigned __int64)1 << 53) && Exponent >= -22 && Exponent <= 22 )
+    {
+        double fValue = (double)Mantissa;
+        fValue = ( Exponent < 0 ) ? fValue / g_Powers[ -Exponent ] : fValue * g_Powers[ Exponent ];
+        Value  = (float)( bNegative ? -fValue : fValue );
+        pText  = p;
+        return true;
+
+    } // End if fast
+
+    // Anything unusual (long mantissa, large exponent, nan, inf, hex)
+    {
+        char   szToken[ OBJ_MAX_TOKEN ];
+        char * pTokenEnd;
+        ULONG  Length = 0;
+
+        for ( p = pToken; p < pEnd && !IsSpace( *p ) && *p != '\n' && Length < OBJ_MAX_TOKEN - 1; p++ ) szToken[ Length++ ] = *p;
+        szToken[ Length ] = '\0';
+        Value = (float)strtod( szToken, &pTokenEnd );
+        if ( pTokenEnd == szToken ) return false;
+        pText = pToken + (pTokenEnd - szToken);
+        return true;
+
+    } // End slow path
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseCorner () (Local)
+// Desc : Reads the position index of one face corner ("v", "v/t", "v//n" or
+//        "v/t/n"), skipping any texture and normal indices.
+//-----------------------------------------------------------------------------
+static bool ParseCorner( const char *& pText, const char * pEnd, __int64 & Index )
+{
+    const char * p = pText;
+    bool         bNegative = false;
+    __int64      Value = 0;
+
+    if ( p < pEnd && (*p == '-' || *p == '+') ) bNegative = ( *p++ == '-' );
+    if ( p >= pEnd || *p < '0' || *p > '9' ) return false;
+    for ( ; p < pEnd && *p >= '0' && *p <= '9'; p++ )
+    {
+        Value = Value * 10 + (*p - '0');
+        if ( Value >= OBJ_RELATIVE ) return false;
+
+    } // Next Digit
+
+    // Skip any texture / normal indices
+    while ( p < pEnd && !IsSpace( *p ) && *p != '\n' ) p++;
+    pText = p;
+    Index = bNegative ? -Value : Value;
+    return Value != 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : HashPosition () (Local)
+// Desc : Hashes the bit pattern of a position, for welding.
+//-----------------------------------------------------------------------------
+static inline ULONG HashPosition( const ULONG Bits[3] )
+{
+    ULONG Hash = Bits[0] * 0x8DA6B343UL ^ Bits[1] * 0xD8163841UL ^ Bits[2] * 0xCB1AB31FUL;
+    return Hash ^ (Hash >> 16);
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPositionBits () (Local)
+// Desc : Retrieves the bit pattern of a position, with negative zeros made
+//        positive so that they weld with their positive counterparts.
+//-----------------------------------------------------------------------------
+static inline void GetPositionBits( const CVertex & Vertex, ULONG Bits[3] )
+{
+    float Position[3] = { Vertex.x + 0.0f, Vertex.y + 0.0f, Vertex.z + 0.0f };
+    memcpy( Bits, Position, sizeof(Position) );
+}
+
+//-----------------------------------------------------------------------------
+// COBJImporter Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : COBJImporter () (Constructor)
+// Desc : COBJImporter Class Constructor
+//-----------------------------------------------------------------------------
+COBJImporter::COBJImporter()
+{
+	// Reset / Clear all required values
+    m_pJobSystem  = NULL;
+    m_bFlip       = true;
+    m_bWeld       = true;
+    m_pChunks     = NULL;
+    m_nChunkCount = 0;
+    m_pMesh       = NULL;
+    m_pRemap      = NULL;
+    ZeroMemory( &m_Stats, sizeof(OBJSTATS) );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~COBJImporter () (Destructor)
+// Desc : COBJImporter Class Destructor
+//-----------------------------------------------------------------------------
+COBJImporter::~COBJImporter()
+{
+    ReleaseChunks();
+    m_File.Close();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Import ()
+// Desc : Maps an OBJ file and imports it (see the in memory Import).
+//-----------------------------------------------------------------------------
+bool COBJImporter::Import( const char * pFileName, CIndexedMesh & Mesh )
+{
+    bool bResult;
+
+    if ( !m_File.Open( pFileName ) ) return false;
+    if ( m_File.GetSize() > (unsigned __int64)((size_t)-1) ) { m_File.Close(); return false; }
+
+    // Every byte is about to be read, so start reading them now
+    m_File.Prefetch();
+    bResult = Import( (const char*)m_File.GetData(), (size_t)m_File.GetSize(), Mesh );
+    m_File.Close();
+    return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Import ()
+// Desc : Imports an OBJ file into a polygon mesh, which should be empty.
+//-----------------------------------------------------------------------------
+bool COBJImporter::Import( const char * pFileName, CMesh & Mesh )
+{
+    CIndexedMesh Indexed;
+    long         First;
+
+    if ( !Import( pFileName, Indexed ) ) return false;
+
+    // Copy out each polygon's vertices
+    if ( !Mesh.Reserve( Indexed.m_nPolygonCount, Indexed.m_nIndexCount ) ) return false;
+    if ( (First = Mesh.AddPolygon( Indexed.m_nPolygonCount )) < 0 ) return false;
+    for ( ULONG i = 0; i < Indexed.m_nPolygonCount; i++ )
+    {
+        CPolygon    * pPoly  = Mesh.m_pPolygon[ First + i ];
+        const ULONG * pIndex = Indexed.GetPolygonIndices( i );
+        ULONG         nCount = Indexed.GetPolygonVertexCount( i );
+
+        if ( nCount > 0xFFFF || pPoly->AddVertex( (USHORT)nCount ) < 0 ) return false;
+        for ( ULONG v = 0; v < nCount; v++ ) pPoly->m_pVertex[v] = Indexed.m_pVertex[ pIndex[v] ];
+
+    } // Next Polygon
+
+    Mesh.CalculateBounds();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Import ()
+// Desc : Imports OBJ text held in memory into an indexed mesh, complete
+//        with bounds and polygon planes.
+//-----------------------------------------------------------------------------
+bool COBJImporter::Import( const char * pText, size_t Length, CIndexedMesh & Mesh )
+{
+    unsigned __int64 nVertices = 0, nIndices = 0, nPolygons = 0;
+    bool             bResult = true;
+
+    ZeroMemory( &m_Stats, sizeof(OBJSTATS) );
+    Mesh.Release();
+    if ( !SplitChunks( pText, Length ) ) return false;
+    m_Stats.FileSize   = Length;
+    m_Stats.ChunkCount = m_nChunkCount;
+
+    // Parse every chunk into its own arrays
+    RunJobs( ParseChunksJob );
+
+    // Lay the chunks out end to end
+    for ( ULONG i = 0; i < m_nChunkCount; i++ )
+    {
+        OBJCHUNK & Chunk = m_pChunks[i];
+        if ( Chunk.bError ) bResult = false;
+
+        Chunk.VertexBase  = (ULONG)nVertices;
+        Chunk.IndexBase   = (ULONG)nIndices;
+        Chunk.PolygonBase = (ULONG)nPolygons;
+        nVertices += Chunk.nPositionCount;
+        nIndices  += Chunk.nCornerCount;
+        nPolygons += Chunk.nFaceCount;
+
+    } // Next Chunk
+    if ( nVertices >= 0xFFFFFFFF || nIndices >= 0xFFFFFFFF || nPolygons >= 0xFFFFFFFF ) bResult = false;
+
+    // Copy them into the mesh, and weld it if asked to
+    if ( bResult ) bResult = Mesh.Create( (ULONG)nVertices, (ULONG)nIndices, (ULONG)nPolygons );
+    if ( bResult ) bResult = (Mesh.m_pPolygonPlane = new (std::nothrow) D3DXPLANE[ (ULONG)nPolygons ]) != NULL;
+    if ( bResult )
+    {
+        m_pMesh = &Mesh;
+        RunJobs( MergeChunksJob );
+        for ( ULONG i = 0; i < m_nChunkCount; i++ ) if ( m_pChunks[i].bError ) bResult = false;
+
+    } // End if created
+    if ( bResult && m_bWeld ) bResult = WeldVertices();
+
+    // Finally remap the indices to the welded vertices and build the planes
+    if ( bResult )
+    {
+        RunJobs( RemapChunksJob );
+        Mesh.CalculateBounds();
+
+        m_Stats.PositionCount = (ULONG)nVertices;
+        m_Stats.VertexCount   = Mesh.m_nVertexCount;
+        m_Stats.PolygonCount  = Mesh.m_nPolygonCount;
+        m_Stats.IndexCount    = Mesh.m_nIndexCount;
+
+    } // End if merged
+    else Mesh.Release();
+
+    if ( m_pRemap ) delete []m_pRemap;
+    m_pRemap = NULL;
+    m_pMesh  = NULL;
+    ReleaseChunks();
+    return bResult;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SplitChunks () (Private)
+// Desc : Divides the text into chunks of roughly OBJ_CHUNK_SIZE bytes, each
+//        ending just after a line feed (or at the end of the text).
+//-----------------------------------------------------------------------------
+bool COBJImporter::SplitChunks( const char * pText, size_t Length )
+{
+    size_t Count = Length / OBJ_CHUNK_SIZE + 1;
+    size_t Offset = 0;
+
+    ReleaseChunks();
+    if ( Count > 0xFFFFFFFF ) return false;
+    if (!( m_pChunks = new (std::nothrow) OBJCHUNK[ Count ] )) return false;
+    ZeroMemory( m_pChunks, Count * sizeof(OBJCHUNK) );
+
+    for ( m_nChunkCount = 0; Offset < Length || m_nChunkCount == 0; m_nChunkCount++ )
+    {
+        OBJCHUNK & Chunk = m_pChunks[ m_nChunkCount ];
+        size_t     End   = Offset + OBJ_CHUNK_SIZE;
+
+        // Run on to the end of the line
+        if ( End >= Length ) End = Length;
+        else
+        {
+            const char * pFeed = (const char*)memchr( pText + End, '\n', Length - End );
+            End = pFeed ? (size_t)(pFeed - pText) + 1 : Length;
+
+        } // End if split
+
+        Chunk.pBegin = pText + Offset;
+        Chunk.pEnd   = pText + End;
+        Offset       = End;
+
+    } // Next Chunk
+
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReleaseChunks () (Private)
+// Desc : Frees the chunks and everything they hold.
+//-----------------------------------------------------------------------------
+void COBJImporter::ReleaseChunks( )
+{
+    for ( ULONG i = 0; i < m_nChunkCount; i++ )
+    {
+        if ( m_pChunks[i].pPositions ) delete []m_pChunks[i].pPositions;
+        if ( m_pChunks[i].pCorners   ) delete []m_pChunks[i].pCorners;
+        if ( m_pChunks[i].pFaceSizes ) delete []m_pChunks[i].pFaceSizes;
+
+    } // Next Chunk
+    if ( m_pChunks ) delete []m_pChunks;
+
+    m_pChunks     = NULL;
+    m_nChunkCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RunJobs () (Private)
+// Desc : Runs a job once for every chunk, on the job system if there is
+//        one, otherwise here and now.
+//-----------------------------------------------------------------------------
+void COBJImporter::RunJobs( void (*pfnJob)( void *, ULONG, ULONG ) )
+{
+    if ( m_pJobSystem ) m_pJobSystem->ParallelFor( pfnJob, this, m_nChunkCount, 1 );
+    else pfnJob( this, 0, m_nChunkCount );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseChunk () (Private)
+// Desc : Reads the positions and faces of one chunk. Positive face indices
+//        are absolute and stored less one. Negative ones are relative to the
+//        last vertex read, which we only know within this chunk, so they
+//        are stored as the chunk local vertex less OBJ_RELATIVE and fixed
+//        up by MergeChunk once the chunk's first vertex is known.
+//-----------------------------------------------------------------------------
+void COBJImporter::ParseChunk( OBJCHUNK & Chunk )
+{
+    const char * p = Chunk.pBegin, * pEnd = Chunk.pEnd;
+
+    while ( p < pEnd && !Chunk.bError )
+    {
+        const char * pLine = p;
+        const char * pFeed = (const char*)memchr( p, '\n', pEnd - p );
+        if ( !pFeed ) pFeed = pEnd;
+
+        // Skip leading space, then decide what kind of record this is
+        while ( pLine < pFeed && IsSpace( *pLine ) ) pLine++;
+        p = pFeed + 1;
+        if ( pFeed - pLine < 2 || !IsSpace( pLine[1] ) ) continue;
+
+        if ( pLine[0] == 'v' )
+        {
+            float * pPosition;
+
+            if ( Chunk.nPositionCount * 3 + 3 > Chunk.nPositionMax &&
+                 !GrowArray( Chunk.pPositions, Chunk.nPositionCount * 3, Chunk.nPositionMax ) ) { Chunk.bError = true; break; }
+
+            pPosition = &Chunk.pPositions[ Chunk.nPositionCount * 3 ];
+            pLine += 2;
+            if ( !ParseFloat( pLine, pFeed, pPosition[0] ) || !ParseFloat( pLine, pFeed, pPosition[1] ) ||
+                 !ParseFloat( pLine, pFeed, pPosition[2] ) ) { Chunk.bError = true; break; }
+            if ( m_bFlip ) pPosition[2] = -pPosition[2];
+            Chunk.nPositionCount++;
+
+        } // End if position
+        else if ( pLine[0] == 'f' )
+        {
+            ULONG   nFirst = Chunk.nCornerCount;
+            __int64 Index;
+
+            for ( pLine += 2; ; )
+            {
+                while ( pLine < pFeed && IsSpace( *pLine ) ) pLine++;
+                if ( pLine >= pFeed || *pLine == '#' ) break;
+                if ( !ParseCorner( pLine, pFeed, Index ) ) { Chunk.bError = true; break; }
+
+                if ( Chunk.nCornerCount == Chunk.nCornerMax &&
+                     !GrowArray( Chunk.pCorners, Chunk.nCornerCount, Chunk.nCornerMax ) ) { Chunk.bError = true; break; }
+                Chunk.pCorners[ Chunk.nCornerCount++ ] = ( Index > 0 ) ? Index - 1 : (__int64)Chunk.nPositionCount + Index - OBJ_RELATIVE;
+
+            } // Next Corner
+            if ( Chunk.bError ) break;
+
+            // Points and lines are not polygons
+            if ( Chunk.nCornerCount - nFirst < 3 ) { Chunk.nCornerCount = nFirst; continue; }
+
+            if ( Chunk.nFaceCount == Chunk.nFaceMax &&
+                 !GrowArray( Chunk.pFaceSizes, Chunk.nFaceCount, Chunk.nFaceMax ) ) { Chunk.bError = true; break; }
+            Chunk.pFaceSizes[ Chunk.nFaceCount++ ] = Chunk.nCornerCount - nFirst;
+
+        } // End if face
+
+    } // Next Line
+}
+
+//-----------------------------------------------------------------------------
+// Name : MergeChunk () (Private)
+// Desc : Copies one parsed chunk into its place in the mesh, resolving its
+//        face corners to vertex indices and reversing faces if flipping.
+//-----------------------------------------------------------------------------
+void COBJImporter::MergeChunk( OBJCHUNK & Chunk )
+{
+    CVertex * pVertex = &m_pMesh->m_pVertex[ Chunk.VertexBase ];
+    ULONG   * pIndex  = &m_pMesh->m_pIndex[ Chunk.IndexBase ];
+    ULONG   * pStart  = &m_pMesh->m_pPolygonStart[ Chunk.PolygonBase ];
+    __int64   nVertexCount = m_pMesh->m_nVertexCount;
+    ULONG     Corner = 0;
+
+    for ( ULONG i = 0; i < Chunk.nPositionCount; i++ )
+    {
+        const float * pPosition = &Chunk.pPositions[ i * 3 ];
+        pVertex[i] = CVertex( pPosition[0], pPosition[1], pPosition[2] );
+
+    } // Next Position
+
+    for ( ULONG i = 0; i < Chunk.nFaceCount; i++ )
+    {
+        ULONG nCount = Chunk.pFaceSizes[i];
+
+        pStart[i] = Chunk.IndexBase + Corner;
+        for ( ULONG v = 0; v < nCount; v++ )
+        {
+            __int64 Index = Chunk.pCorners[ Corner + (m_bFlip ? nCount - 1 - v : v) ];
+            if ( Index < 0 ) Index += OBJ_RELATIVE + Chunk.VertexBase;
+            if ( Index < 0 || Index >= nVertexCount ) { Chunk.bError = true; return; }
+            pIndex[ Corner + v ] = (ULONG)Index;
+
+        } // Next Corner
+        Corner += nCount;
+
+    } // Next Face
+}
+
+//-----------------------------------------------------------------------------
+// Name : WeldVertices () (Private)
+// Desc : Merges vertices with identical positions, compacting the vertex
+//        array in place and recording where each vertex went in m_pRemap.
+//        This is a single pass over an open addressed hash table, and runs
+//        on this thread only.
+//-----------------------------------------------------------------------------
+bool COBJImporter::WeldVertices( )
+{
+    ULONG   nCount = m_pMesh->m_nVertexCount, nUnique = 0, nSize = 16;
+    ULONG * pTable;
+
+    // Table is at most half full
+    while ( nSize < nCount * 2 && nSize < 0x80000000 ) nSize *= 2;
+    if (!( m_pRemap = new (std::nothrow) ULONG[ nCount ] )) return false;
+    if (!( pTable = new (std::nothrow) ULONG[ nSize ] )) return false;
+    memset( pTable, 0xFF, nSize * sizeof(ULONG) );
+
+    for ( ULONG i = 0; i < nCount; i++ )
+    {
+        CVertex Vertex = m_pMesh->m_pVertex[i];
+        ULONG   Bits[3], Other[3], Slot;
+
+        GetPositionBits( Vertex, Bits );
+        for ( Slot = HashPosition( Bits ) & (nSize - 1); pTable[ Slot ] != 0xFFFFFFFF; Slot = (Slot + 1) & (nSize - 1) )
+        {
+            GetPositionBits( m_pMesh->m_pVertex[ pTable[ Slot ] ], Other );
+            if ( memcmp( Bits, Other, sizeof(Bits) ) == 0 ) break;
+
+        } // Next Slot
+
+        // First time this position has been seen?
+        if ( pTable[ Slot ] == 0xFFFFFFFF )
+        {
+            m_pMesh->m_pVertex[ nUnique ] = Vertex;
+            pTable[ Slot ] = nUnique++;
+
+        } // End if new
+        m_pRemap[i] = pTable[ Slot ];
+
+    } // Next Vertex
+
+    delete []pTable;
+    m_pMesh->m_nVertexCount = nUnique;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemapChunk () (Private)
+// Desc : Points one chunk's faces at the welded vertices (if welding), and
+//        calculates their planes.
+//-----------------------------------------------------------------------------
+void COBJImporter::RemapChunk( const OBJCHUNK & Chunk )
+{
+    if ( m_pRemap )
+    {
+        ULONG * pIndex = &m_pMesh->m_pIndex[ Chunk.IndexBase ];
+        for ( ULONG i = 0; i < Chunk.nCornerCount; i++ ) pIndex[i] = m_pRemap[ pIndex[i] ];
+
+    } // End if welded
+
+    m_pMesh->CalculatePlanes( Chunk.PolygonBase, Chunk.nFaceCount );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ParseChunksJob () (Private, Static)
+// Desc : Job system entry point, parses a range of chunks.
+//-----------------------------------------------------------------------------
+void COBJImporter::ParseChunksJob( void * pContext, ULONG Begin, ULONG End )
+{
+    COBJImporter * pImporter = (COBJImporter*)pContext;
+    for ( ULONG i = Begin; i < End; i++ ) pImporter->ParseChunk( pImporter->m_pChunks[i] );
+}
+
+//-----------------------------------------------------------------------------
+// Name : MergeChunksJob () (Private, Static)
+// Desc : Job system entry point, merges a range of chunks into the mesh.
+//-----------------------------------------------------------------------------
+void COBJImporter::MergeChunksJob( void * pContext, ULONG Begin, ULONG End )
+{
+    COBJImporter * pImporter = (COBJImporter*)pContext;
+    for ( ULONG i = Begin; i < End; i++ ) pImporter->MergeChunk( pImporter->m_pChunks[i] );
+}
+
+//-----------------------------------------------------------------------------
+// Name : RemapChunksJob () (Private, Static)
+// Desc : Job system entry point, remaps a range of chunks' faces.
+//-----------------------------------------------------------------------------
+void COBJImporter::RemapChunksJob( void * pContext, ULONG Begin, ULONG End )
+{
+    COBJImporter * pImporter = (COBJImporter*)pContext;
+    for ( ULONG i = Begin; i < End; i++ ) pImporter->RemapChunk( pImporter->m_pChunks[i] );
+}
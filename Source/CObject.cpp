@@ -9,7 +9,10 @@
 //-----------------------------------------------------------------------------
 // CObject Specific Includes
 //-----------------------------------------------------------------------------
-#include "..\\Includes\\CObject.h"
+#include "../Includes/CObject.h"
+#include <new>
+#include <float.h>
+#include <math.h>
 
 //-----------------------------------------------------------------------------
 // Name : CObject () (Constructor)
@@ -18,7 +21,7 @@
 CObject::CObject()
 {
 	// Reset / Clear all required values
-    m_pMesh = NULL;
+    m_pMesh         = NULL;
     D3DXMatrixIdentity( &m_mtxWorld );
 }
 
@@ -26,7 +29,7 @@ CObject::CObject()
 // Name : CObject () (Alternate Constructor)
 // Desc : CObject Class Constructor, sets the internal mesh object
 //-----------------------------------------------------------------------------
-CObject::CObject( CMesh * pMesh )
+CObject::CObject( CIndexedMesh * pMesh )
 {
 	// Reset / Clear all required values
     D3DXMatrixIdentity( &m_mtxWorld );
@@ -42,8 +45,9 @@ CObject::CObject( CMesh * pMesh )
 CMesh::CMesh()
 {
 	// Reset / Clear all required values
-    m_nPolygonCount = 0;
-    m_pPolygon      = NULL;
+    m_nPolygonCount     = 0;
+    m_nPolygonCapacity  = 0;
+    m_pPolygon          = NULL;
 
 }
 
@@ -54,8 +58,9 @@ CMesh::CMesh()
 CMesh::CMesh( ULONG Count )
 {
 	// Reset / Clear all required values
-    m_nPolygonCount = 0;
-    m_pPolygon      = NULL;
+    m_nPolygonCount     = 0;
+    m_nPolygonCapacity  = 0;
+    m_pPolygon          = NULL;
 
     // Add Polygons
     AddPolygon( Count );
@@ -70,10 +75,11 @@ CMesh::~CMesh()
 	// Release our mesh components
     if ( m_pPolygon ) 
     {
-        // Delete all individual polygons in the array.
+        // Destroy all individual polygons in the array (their memory
+        // belongs to the arena, which is released along with the mesh).
         for ( ULONG i = 0; i < m_nPolygonCount; i++ )
         {
-            if ( m_pPolygon[i] ) delete m_pPolygon[i];
+            if ( m_pPolygon[i] ) m_pPolygon[i]->~CPolygon();
         
         } // Next Polygon
 
@@ -83,45 +89,78 @@ CMesh::~CMesh()
     } // End if
 
     // Clear variables
-    m_pPolygon      = NULL;
-    m_nPolygonCount = 0;
+    m_pPolygon          = NULL;
+    m_nPolygonCount     = 0;
+    m_nPolygonCapacity  = 0;
 }
 
 //-----------------------------------------------------------------------------
-// Name : AddPolygon()
-// Desc : Adds a polygon, or multiple polygons, to this mesh.
-// Note : Returns the index for the first polygon added, or -1 on failure.
+// Name : Reserve()
+// Desc : Pre-allocates room for a total of PolygonCapacity polygons, plus
+//        VertexCount vertices to be shared out amongst the new polygons, so
+//        that a mesh of known size can be built without further allocation.
 //-----------------------------------------------------------------------------
-long CMesh::AddPolygon( ULONG Count )
+bool CMesh::Reserve( ULONG PolygonCapacity, ULONG VertexCount )
 {
+    size_t ArenaSize;
 
-    CPolygon ** pPolyBuffer = NULL;
+    // Grow the polygon pointer array if required
+    if ( PolygonCapacity > m_nPolygonCapacity )
+    {
+        CPolygon ** pPolyBuffer = NULL;
     
-    // Allocate new resized array
-    if (!( pPolyBuffer = new CPolygon*[ m_nPolygonCount + Count ] )) return -1;
+        // Allocate new resized array
+        if (!( pPolyBuffer = new CPolygon*[ PolygonCapacity ] )) return false;
 
-    // Clear out slack pointers
-    ZeroMemory( &pPolyBuffer[ m_nPolygonCount ], Count * sizeof( CPolygon* ) );
+        // Existing Data?
+        if ( m_pPolygon )
+        {
+            // Copy old data into new buffer
+            memcpy( pPolyBuffer, m_pPolygon, m_nPolygonCount * sizeof( CPolygon* ) );
 
-    // Existing Data?
-    if ( m_pPolygon )
-    {
-        // Copy old data into new buffer
-        memcpy( pPolyBuffer, m_pPolygon, m_nPolygonCount * sizeof( CPolygon* ) );
+            // Release old buffer
+            delete []m_pPolygon;
 
-        // Release old buffer
-        delete []m_pPolygon;
+        } // End if
 
-    } // End if
-    
-    // Store pointer for new buffer
-    m_pPolygon = pPolyBuffer;
+        // Store pointer for new buffer
+        m_pPolygon          = pPolyBuffer;
+        m_nPolygonCapacity  = PolygonCapacity;
+
+    } // End if grow
+
+    // Make room in the arena for the new polygons and vertices
+    ArenaSize = (size_t)(m_nPolygonCapacity - m_nPolygonCount) * (sizeof(CPolygon) + alignof(CPolygon)) +
+                (size_t)VertexCount * sizeof(CVertex);
+    return m_Arena.Reserve( ArenaSize );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddPolygon()
+// Desc : Adds a polygon, or multiple polygons, to this mesh.
+// Note : Returns the index for the first polygon added, or -1 on failure.
+//        The polygon array grows geometrically, and the polygons themselves
+//        are allocated from the mesh's arena.
+//-----------------------------------------------------------------------------
+long CMesh::AddPolygon( ULONG Count )
+{
+    // Grow the polygon array if required
+    if ( m_nPolygonCount + Count > m_nPolygonCapacity )
+    {
+        ULONG nNewCapacity = m_nPolygonCapacity * 2;
+        if ( nNewCapacity < m_nPolygonCount + Count ) nNewCapacity = m_nPolygonCount + Count;
+        if ( !Reserve( nNewCapacity ) ) return -1;
 
-    // Allocate new polygon pointers
+    } // End if grow
+
+    // Allocate new polygons
     for ( UINT i = 0; i < Count; i++ )
     {
+        void * pMemory = NULL;
+
         // Allocate new poly
-        if (!( m_pPolygon[ m_nPolygonCount ] = new CPolygon() )) return -1;
+        if (!( pMemory = m_Arena.Allocate( sizeof(CPolygon), alignof(CPolygon) ) )) return -1;
+        m_pPolygon[ m_nPolygonCount ] = new ( pMemory ) CPolygon( &m_Arena );
 
         // Increase overall poly count
         m_nPolygonCount++;
@@ -132,6 +171,23 @@ long CMesh::AddPolygon( ULONG Count )
     return m_nPolygonCount - Count;
 }
 
+//-----------------------------------------------------------------------------
+// Name : CalculateBounds()
+// Desc : Recomputes the bounding box / sphere from every polygon vertex.
+// Note : Not maintained automatically, call again after editing vertices.
+//-----------------------------------------------------------------------------
+void CMesh::CalculateBounds( )
+{
+    m_Bounds.Reset();
+    for ( ULONG i = 0; i < m_nPolygonCount; i++ )
+    {
+        const CPolygon * pPoly = m_pPolygon[i];
+        for ( ULONG v = 0; v < pPoly->m_nVertexCount; v++ ) m_Bounds.AddPoint( pPoly->m_pVertex[v] );
+
+    } // Next Polygon
+    m_Bounds.CalculateSphere();
+}
+
 //-----------------------------------------------------------------------------
 // Name : CPolygon () (Constructor)
 // Desc : CPolygon Class Constructor
@@ -139,8 +195,10 @@ long CMesh::AddPolygon( ULONG Count )
 CPolygon::CPolygon()
 {
 	// Reset / Clear all required values
-    m_nVertexCount  = 0;
-    m_pVertex       = NULL;
+    m_nVertexCount      = 0;
+    m_nVertexCapacity   = 0;
+    m_pVertex           = NULL;
+    m_pArena            = NULL;
 
 }
 
@@ -151,38 +209,76 @@ CPolygon::CPolygon()
 CPolygon::CPolygon( USHORT Count )
 {
 	// Reset / Clear all required values
-    m_nVertexCount  = 0;
-    m_pVertex       = NULL;
+    m_nVertexCount      = 0;
+    m_nVertexCapacity   = 0;
+    m_pVertex           = NULL;
+    m_pArena            = NULL;
 
     // Add vertices
     AddVertex( Count );
 }
 
+//-----------------------------------------------------------------------------
+// Name : CPolygon () (Alternate Constructor)
+// Desc : CPolygon Class Constructor, vertices will be allocated from the
+//        arena specified.
+//-----------------------------------------------------------------------------
+CPolygon::CPolygon( CMemoryArena * pArena )
+{
+	// Reset / Clear all required values
+    m_nVertexCount      = 0;
+    m_nVertexCapacity   = 0;
+    m_pVertex           = NULL;
+    m_pArena            = pArena;
+}
+
 //-----------------------------------------------------------------------------
 // Name : ~CPolygon () (Destructor)
 // Desc : CPolygon Class Destructor
 //-----------------------------------------------------------------------------
 CPolygon::~CPolygon()
 {
-	// Release our vertices
-    if ( m_pVertex ) delete []m_pVertex;
+	// Release our vertices (arena memory is released by its owner)
+    if ( m_pVertex && !m_pArena ) delete []m_pVertex;
     
     // Clear variables
-    m_pVertex       = NULL;
-    m_nVertexCount  = 0;
+    m_pVertex           = NULL;
+    m_nVertexCount      = 0;
+    m_nVertexCapacity   = 0;
 }
 
 //-----------------------------------------------------------------------------
-// Name : AddVertex()
-// Desc : Adds a vertex, or multiple vertices, to this polygon.
-// Note : Returns the index for the first vertex added, or -1 on failure.
+// Name : Reserve()
+// Desc : Ensures that room for at least Capacity vertices is allocated.
 //-----------------------------------------------------------------------------
-long CPolygon::AddVertex( USHORT Count )
+bool CPolygon::Reserve( USHORT Capacity )
 {
     CVertex * pVertexBuffer = NULL;
-    
-    // Allocate new resized array
-    if (!( pVertexBuffer = new CVertex[ m_nVertexCount + Count ] )) return -1;
+
+    // Already large enough?
+    if ( Capacity <= m_nVertexCapacity ) return true;
+
+    if ( m_pArena )
+    {
+        // Extend in place if we were the last arena allocation
+        if ( m_pVertex && m_pArena->Grow( m_pVertex, m_nVertexCapacity * sizeof(CVertex), Capacity * sizeof(CVertex) ) )
+        {
+            m_nVertexCapacity = Capacity;
+            return true;
+
+        } // End if grown in place
+
+        // Allocate new resized array (the old one is simply abandoned)
+        pVertexBuffer = (CVertex*)m_pArena->Allocate( Capacity * sizeof(CVertex), alignof(CVertex) );
+
+    } // End if arena
+    else
+    {
+        // Allocate new resized array
+        pVertexBuffer = new CVertex[ Capacity ];
+
+    } // End if heap
+    if ( !pVertexBuffer ) return false;
 
     // Existing Data?
     if ( m_pVertex )
@@ -191,14 +287,463 @@ long CPolygon::AddVertex( USHORT Count )
         memcpy( pVertexBuffer, m_pVertex, m_nVertexCount * sizeof(CVertex) );
 
         // Release old buffer
-        delete []m_pVertex;
+        if ( !m_pArena ) delete []m_pVertex;
 
     } // End if
 
     // Store pointer for new buffer
-    m_pVertex = pVertexBuffer;
-    m_nVertexCount += Count;
+    m_pVertex         = pVertexBuffer;
+    m_nVertexCapacity = Capacity;
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddVertex()
+// Desc : Adds a vertex, or multiple vertices, to this polygon.
+// Note : Returns the index for the first vertex added, or -1 on failure.
+//        Storage grows geometrically, new vertices are set to the origin.
+//-----------------------------------------------------------------------------
+long CPolygon::AddVertex( USHORT Count )
+{
+    ULONG nRequired = (ULONG)m_nVertexCount + Count;
+
+    // Would exceed the maximum vertex count?
+    if ( nRequired > 0xFFFF ) return -1;
+
+    // Grow the vertex array if required
+    if ( nRequired > m_nVertexCapacity )
+    {
+        ULONG nNewCapacity = (ULONG)m_nVertexCapacity * 2;
+        if ( nNewCapacity < nRequired ) nNewCapacity = nRequired;
+        if ( nNewCapacity > 0xFFFF ) nNewCapacity = 0xFFFF;
+        if ( !Reserve( (USHORT)nNewCapacity ) ) return -1;
+
+    } // End if grow
+
+    // Initialise the new vertices
+    for ( ULONG i = m_nVertexCount; i < nRequired; i++ ) m_pVertex[i] = CVertex();
+    m_nVertexCount = (USHORT)nRequired;
 
     // Return first vertex
     return m_nVertexCount - Count;
-}
\ No newline at end of file
+}
+
+//-----------------------------------------------------------------------------
+// Name : CIndexedMesh () (Constructor)
+// Desc : CIndexedMesh Class Constructor
+//-----------------------------------------------------------------------------
+CIndexedMesh::CIndexedMesh()
+{
+	// Reset / Clear all required values
+    m_nVertexCount  = 0;
+    m_pVertex       = NULL;
+    m_nIndexCount   = 0;
+    m_pIndex        = NULL;
+    m_nPolygonCount = 0;
+    m_pPolygonStart = NULL;
+    m_pPolygonPlane = NULL;
+    m_bAttached     = false;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CIndexedMesh () (Destructor)
+// Desc : CIndexedMesh Class Destructor
+//-----------------------------------------------------------------------------
+CIndexedMesh::~CIndexedMesh()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Releases all mesh storage.
+//-----------------------------------------------------------------------------
+void CIndexedMesh::Release( )
+{
+    // Attached arrays are not ours to free
+    if ( !m_bAttached )
+    {
+        if ( m_pVertex       ) delete []m_pVertex;
+        if ( m_pIndex        ) delete []m_pIndex;
+        if ( m_pPolygonStart ) delete []m_pPolygonStart;
+        if ( m_pPolygonPlane ) delete []m_pPolygonPlane;
+
+    } // End if owned
+
+    // Clear variables
+    m_nVertexCount  = 0;
+    m_pVertex       = NULL;
+    m_nIndexCount   = 0;
+    m_pIndex        = NULL;
+    m_nPolygonCount = 0;
+    m_pPolygonStart = NULL;
+    m_pPolygonPlane = NULL;
+    m_bAttached     = false;
+    m_Bounds.Reset();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Attach ()
+// Desc : Points the mesh at arrays held elsewhere, using them in place
+//        rather than copying them. The memory must stay valid (and
+//        unchanged) until the mesh is released, and the mesh may not be
+//        altered in the meantime.
+//-----------------------------------------------------------------------------
+void CIndexedMesh::Attach( ULONG VertexCount, const CVertex * pVertex, ULONG IndexCount, const ULONG * pIndex,
+                           ULONG PolygonCount, const ULONG * pPolygonStart, const D3DXPLANE * pPolygonPlane,
+                           const CBounds & Bounds )
+{
+    // Release any previous data
+    Release();
+
+    // Arrays are only ever read while attached
+    m_nVertexCount  = VertexCount;
+    m_pVertex       = const_cast<CVertex*>( pVertex );
+    m_nIndexCount   = IndexCount;
+    m_pIndex        = const_cast<ULONG*>( pIndex );
+    m_nPolygonCount = PolygonCount;
+    m_pPolygonStart = const_cast<ULONG*>( pPolygonStart );
+    m_pPolygonPlane = const_cast<D3DXPLANE*>( pPolygonPlane );
+    m_Bounds        = Bounds;
+    m_bAttached     = true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CalculatePlanes ()
+// Desc : Computes and caches the plane of every polygon, used to determine
+//        which side of each polygon the camera lies on when back face
+//        culling. Polygons are clockwise when seen from the front (as with
+//        Direct3D), so plane normals point out of the front face.
+// Note : Uses Newell's method, so that polygons with more than three
+//        vertices, or which are slightly non planar, are handled sensibly.
+//        BuildFromMesh does this automatically.
+//-----------------------------------------------------------------------------
+bool CIndexedMesh::CalculatePlanes( )
+{
+    // Attached meshes are read only
+    if ( m_bAttached ) return false;
+
+    // (Re)allocate the plane table
+    if ( m_pPolygonPlane ) delete []m_pPolygonPlane;
+    if (!( m_pPolygonPlane = new (std::nothrow) D3DXPLANE[ m_nPolygonCount ] )) return false;
+    CalculatePlanes( 0, m_nPolygonCount );
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CalculatePlanes ()
+// Desc : Fills in the planes of a range of polygons, into a plane table
+//        which must already have been allocated. Ranges which do not
+//        overlap may be calculated at the same time on different threads.
+//-----------------------------------------------------------------------------
+void CIndexedMesh::CalculatePlanes( ULONG FirstPolygon, ULONG PolygonCount )
+{
+    for ( ULONG i = FirstPolygon; i < FirstPolygon + PolygonCount; i++ )
+    {
+        const ULONG * pIndex = GetPolygonIndices( i );
+        ULONG         nCount = GetPolygonVertexCount( i );
+        D3DXVECTOR3   vecNormal( 0.0f, 0.0f, 0.0f ), vecCentre( 0.0f, 0.0f, 0.0f );
+        float         fLength;
+
+        // Sum the edge contributions to the normal, and the centre
+        for ( ULONG v = 0; v < nCount; v++ )
+        {
+            const CVertex & v1 = m_pVertex[ pIndex[ v ] ];
+            const CVertex & v2 = m_pVertex[ pIndex[ (v + 1) % nCount ] ];
+
+            vecNormal.x += (v1.y - v2.y) * (v1.z + v2.z);
+            vecNormal.y += (v1.z - v2.z) * (v1.x + v2.x);
+            vecNormal.z += (v1.x - v2.x) * (v1.y + v2.y);
+            vecCentre.x += v1.x; vecCentre.y += v1.y; vecCentre.z += v1.z;
+
+        } // Next Vertex
+
+        // Degenerate polygons get a zero plane, which is never culled
+        fLength = sqrtf( vecNormal.x * vecNormal.x + vecNormal.y * vecNormal.y + vecNormal.z * vecNormal.z );
+        if ( fLength <= 0.0f || nCount < 3 ) { m_pPolygonPlane[i] = D3DXPLANE( 0.0f, 0.0f, 0.0f, 0.0f ); continue; }
+
+        vecNormal = vecNormal * (1.0f / fLength);
+        vecCentre = vecCentre * (1.0f / (float)nCount);
+        m_pPolygonPlane[i] = D3DXPLANE( vecNormal.x, vecNormal.y, vecNormal.z,
+                                        -(vecNormal.x * vecCentre.x + vecNormal.y * vecCentre.y + vecNormal.z * vecCentre.z) );
+
+    } // Next Polygon
+}
+
+//-----------------------------------------------------------------------------
+// Name : CalculateBounds ()
+// Desc : Recomputes the bounding box / sphere from the vertex array.
+// Note : BuildFromMesh does this automatically, meshes filled in by hand
+//        after Create must call this once their vertices are in place.
+//-----------------------------------------------------------------------------
+void CIndexedMesh::CalculateBounds( )
+{
+    m_Bounds.Reset();
+    for ( ULONG i = 0; i < m_nVertexCount; i++ ) m_Bounds.AddPoint( m_pVertex[i] );
+    m_Bounds.CalculateSphere();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates storage for the specified number of elements, ready to be
+//        filled in by the caller. The polygon table terminator is set to the
+//        index count.
+// Note : Any existing data is released.
+//-----------------------------------------------------------------------------
+bool CIndexedMesh::Create( ULONG VertexCount, ULONG IndexCount, ULONG PolygonCount )
+{
+    // Release any previous data
+    Release();
+
+    // Allocate the three arrays
+    if (!( m_pVertex       = new CVertex[ VertexCount ] )) { Release(); return false; }
+    if (!( m_pIndex        = new ULONG[ IndexCount ] )) { Release(); return false; }
+    if (!( m_pPolygonStart = new ULONG[ PolygonCount + 1 ] )) { Release(); return false; }
+
+    // Store counts
+    m_nVertexCount  = VertexCount;
+    m_nIndexCount   = IndexCount;
+    m_nPolygonCount = PolygonCount;
+    m_pPolygonStart[ 0 ]            = 0;
+    m_pPolygonStart[ PolygonCount ] = IndexCount;
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildFromMesh ()
+// Desc : Builds the indexed representation of a CMesh, welding together any
+//        vertices which share an identical position.
+// Note : Any existing data is released.
+//-----------------------------------------------------------------------------
+bool CIndexedMesh::BuildFromMesh( const CMesh & Mesh )
+{
+    ULONG   IndexCount = 0, VertexCount = 0, TableSize = 1, i, j;
+    ULONG * pHashTable = NULL;
+
+    // Count the total number of polygon vertices
+    for ( i = 0; i < Mesh.m_nPolygonCount; i++ ) IndexCount += Mesh.m_pPolygon[i]->m_nVertexCount;
+
+    // Worst case, every vertex is unique
+    if ( !Create( IndexCount, IndexCount, Mesh.m_nPolygonCount ) ) return false;
+
+    // Build an open addressed hash table, at most half full, mapping
+    // positions to unique vertex indices (0xFFFFFFFF marks empty slots)
+    while ( TableSize < IndexCount * 2 ) TableSize <<= 1;
+    if (!( pHashTable = new ULONG[ TableSize ] )) { Release(); return false; }
+    memset( pHashTable, 0xFF, TableSize * sizeof(ULONG) );
+
+    // Walk each polygon, adding its vertices
+    for ( i = 0, IndexCount = 0; i < Mesh.m_nPolygonCount; i++ )
+    {
+        const CPolygon * pPoly = Mesh.m_pPolygon[i];
+
+        m_pPolygonStart[ i ] = IndexCount;
+        for ( j = 0; j < pPoly->m_nVertexCount; j++ )
+        {
+            const CVertex & Vertex = pPoly->m_pVertex[j];
+            ULONG Bits[3], Hash;
+
+            // Hash the exact bit pattern of the position (the final mix
+            // matters, as grid aligned positions share most of their bits)
+            memcpy( Bits, &Vertex, sizeof(Bits) );
+            Hash  = ((Bits[0] * 0x9E3779B1u) ^ Bits[1]) * 0x85EBCA77u ^ Bits[2];
+            Hash ^= Hash >> 16; Hash *= 0x85EBCA6Bu;
+            Hash ^= Hash >> 13; Hash *= 0xC2B2AE35u;
+            Hash ^= Hash >> 16;
+
+            // Probe until we find either this position or an empty slot
+            for ( Hash &= TableSize - 1; pHashTable[ Hash ] != 0xFFFFFFFF; Hash = (Hash + 1) & (TableSize - 1) )
+            {
+                if ( memcmp( &m_pVertex[ pHashTable[ Hash ] ], &Vertex, sizeof(CVertex) ) == 0 ) break;
+
+            } // Next Slot
+
+            // New unique vertex?
+            if ( pHashTable[ Hash ] == 0xFFFFFFFF )
+            {
+                m_pVertex[ VertexCount ] = Vertex;
+                pHashTable[ Hash ] = VertexCount++;
+
+            } // End if new vertex
+
+            m_pIndex[ IndexCount++ ] = pHashTable[ Hash ];
+
+        } // Next Vertex
+
+    } // Next Polygon
+
+    // Clean up
+    delete []pHashTable;
+
+    // Shrink the vertex array down to the welded vertices
+    if ( VertexCount < m_nVertexCount )
+    {
+        CVertex * pVertexBuffer = NULL;
+        if (!( pVertexBuffer = new CVertex[ VertexCount ] )) { Release(); return false; }
+        memcpy( pVertexBuffer, m_pVertex, VertexCount * sizeof(CVertex) );
+        delete []m_pVertex;
+        m_pVertex = pVertexBuffer;
+
+    } // End if
+    m_nVertexCount = VertexCount;
+
+    // Bound the welded vertices, and cache each polygon's plane
+    CalculateBounds();
+    if ( !CalculatePlanes() ) { Release(); return false; }
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildSphere ()
+// Desc : Builds a closed latitude / longitude sphere of quads, with a fan of
+//        triangles round each pole, wound as the cube in
+//        CGameApp::BuildObjects.
+// Note : Any existing data is released.
+//-----------------------------------------------------------------------------
+bool CIndexedMesh::BuildSphere( float fRadius, ULONG Slices, ULONG Stacks )
+{
+    // Validate
+    if ( Slices < 3 || Stacks < 2 ) return false;
+
+    ULONG nVertices = Slices * (Stacks - 1) + 2, nPolygons = Slices * Stacks;
+    ULONG nIndices  = Slices * 3 * 2 + Slices * (Stacks - 2) * 4;
+    ULONG nTop = nVertices - 2, nBottom = nVertices - 1, nPoly = 0, nIndex = 0;
+
+    if ( !Create( nVertices, nIndices, nPolygons ) ) return false;
+
+    // Rings from the top down, then the two poles
+    for ( ULONG j = 1; j < Stacks; j++ )
+    {
+        float fPhi = D3DX_PI * (float)j / (float)Stacks;
+        for ( ULONG i = 0; i < Slices; i++ )
+        {
+            float fTheta = 2.0f * D3DX_PI * (float)i / (float)Slices;
+            m_pVertex[ (j - 1) * Slices + i ] = CVertex( fRadius * sinf( fPhi ) * cosf( fTheta ), fRadius * cosf( fPhi ),
+                                                         fRadius * sinf( fPhi ) * sinf( fTheta ) );
+
+        } // Next Slice
+
+    } // Next Stack
+    m_pVertex[ nTop ]    = CVertex( 0.0f,  fRadius, 0.0f );
+    m_pVertex[ nBottom ] = CVertex( 0.0f, -fRadius, 0.0f );
+
+    for ( ULONG j = 0; j < Stacks; j++ )
+    {
+        for ( ULONG i = 0; i < Slices; i++ )
+        {
+            ULONG i2 = (i + 1) % Slices;
+            m_pPolygonStart[ nPoly++ ] = nIndex;
+
+            if ( j == 0 )
+            {
+                m_pIndex[ nIndex++ ] = nTop;
+                m_pIndex[ nIndex++ ] = i2;
+                m_pIndex[ nIndex++ ] = i;
+
+            } // End if top cap
+            else if ( j == Stacks - 1 )
+            {
+                ULONG Ring = (j - 1) * Slices;
+                m_pIndex[ nIndex++ ] = nBottom;
+                m_pIndex[ nIndex++ ] = Ring + i;
+                m_pIndex[ nIndex++ ] = Ring + i2;
+
+            } // End if bottom cap
+            else
+            {
+                ULONG Ring = (j - 1) * Slices;
+                m_pIndex[ nIndex++ ] = Ring + i;
+                m_pIndex[ nIndex++ ] = Ring + i2;
+                m_pIndex[ nIndex++ ] = Ring + Slices + i2;
+                m_pIndex[ nIndex++ ] = Ring + Slices + i;
+
+            } // End if band
+
+        } // Next Slice
+
+    } // Next Stack
+
+    // Bound the sphere, and cache each polygon's plane
+    CalculateBounds();
+    if ( !CalculatePlanes() ) { Release(); return false; }
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Empties the bounds, ready for points to be added.
+//-----------------------------------------------------------------------------
+void CBounds::Reset( )
+{
+    m_vecMin    = D3DXVECTOR3(  FLT_MAX,  FLT_MAX,  FLT_MAX );
+    m_vecMax    = D3DXVECTOR3( -FLT_MAX, -FLT_MAX, -FLT_MAX );
+    m_vecCentre = D3DXVECTOR3( 0.0f, 0.0f, 0.0f );
+    m_fRadius   = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddPoint ()
+// Desc : Grows the box to include the point specified.
+// Note : The sphere is not updated until CalculateSphere is called.
+//-----------------------------------------------------------------------------
+void CBounds::AddPoint( const CVertex & Point )
+{
+    if ( Point.x < m_vecMin.x ) m_vecMin.x = Point.x;
+    if ( Point.y < m_vecMin.y ) m_vecMin.y = Point.y;
+    if ( Point.z < m_vecMin.z ) m_vecMin.z = Point.z;
+    if ( Point.x > m_vecMax.x ) m_vecMax.x = Point.x;
+    if ( Point.y > m_vecMax.y ) m_vecMax.y = Point.y;
+    if ( Point.z > m_vecMax.z ) m_vecMax.z = Point.z;
+}
+
+//-----------------------------------------------------------------------------
+// Name : CalculateSphere ()
+// Desc : Derives the bounding sphere from the box.
+//-----------------------------------------------------------------------------
+void CBounds::CalculateSphere( )
+{
+    // Empty bounds have no sphere
+    if ( IsEmpty() ) { m_vecCentre = D3DXVECTOR3( 0.0f, 0.0f, 0.0f ); m_fRadius = 0.0f; return; }
+
+    D3DXVECTOR3 vecHalf = (m_vecMax - m_vecMin) * 0.5f;
+    m_vecCentre = m_vecMin + vecHalf;
+    m_fRadius   = sqrtf( vecHalf.x * vecHalf.x + vecHalf.y * vecHalf.y + vecHalf.z * vecHalf.z );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Transform ()
+// Desc : Builds the axis aligned box enclosing this box once transformed by
+//        the (affine) matrix specified, such as an object's world matrix.
+// Note : Rather than transforming all eight corners, the centre is
+//        transformed and the half extents are scaled by the absolute values
+//        of the matrix, which gives exactly the same box.
+//-----------------------------------------------------------------------------
+void CBounds::Transform( const D3DXMATRIX & mtx, CBounds & Out ) const
+{
+    // Empty bounds stay empty
+    if ( IsEmpty() ) { Out.Reset(); return; }
+
+    D3DXVECTOR3 c = (m_vecMax + m_vecMin) * 0.5f;
+    D3DXVECTOR3 h = (m_vecMax - m_vecMin) * 0.5f;
+
+    D3DXVECTOR3 vecCentre( c.x * mtx._11 + c.y * mtx._21 + c.z * mtx._31 + mtx._41,
+                           c.x * mtx._12 + c.y * mtx._22 + c.z * mtx._32 + mtx._42,
+                           c.x * mtx._13 + c.y * mtx._23 + c.z * mtx._33 + mtx._43 );
+    D3DXVECTOR3 vecHalf( h.x * fabsf( mtx._11 ) + h.y * fabsf( mtx._21 ) + h.z * fabsf( mtx._31 ),
+                         h.x * fabsf( mtx._12 ) + h.y * fabsf( mtx._22 ) + h.z * fabsf( mtx._32 ),
+                         h.x * fabsf( mtx._13 ) + h.y * fabsf( mtx._23 ) + h.z * fabsf( mtx._33 ) );
+
+    Out.m_vecMin = vecCentre - vecHalf;
+    Out.m_vecMax = vecCentre + vecHalf;
+    Out.CalculateSphere();
+}
@@ -0,0 +1,318 @@
+//-----------------------------------------------------------------------------
+// File: COcclusionBuffer.cpp
+//
+// Desc: Low resolution software depth buffer, reduced into a hierarchical
+//       depth pyramid, against which object bounds are tested for occlusion.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// COcclusionBuffer Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/COcclusionBuffer.h"
+#include <new>
+#include <math.h>
+
+//-----------------------------------------------------------------------------
+// Name : COcclusionBuffer () (Constructor)
+// Desc : COcclusionBuffer Class Constructor
+//-----------------------------------------------------------------------------
+COcclusionBuffer::COcclusionBuffer()
+{
+	// Reset / Clear all required values
+    for ( ULONG i = 0; i < OCCLUSION_MAX_LEVELS; i++ )
+    {
+        m_pLevel[i]  = NULL;
+        m_nWidth[i]  = 0;
+        m_nHeight[i] = 0;
+
+    } // Next Level
+    m_nLevelCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~COcclusionBuffer () (Destructor)
+// Desc : COcclusionBuffer Class Destructor
+//-----------------------------------------------------------------------------
+COcclusionBuffer::~COcclusionBuffer()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Create ()
+// Desc : Allocates the pyramid for a render target of the specified size
+//        (in screen pixels), down to a single texel.
+//-----------------------------------------------------------------------------
+bool COcclusionBuffer::Create( ULONG Width, ULONG Height )
+{
+    ULONG w = (Width + OCCLUSION_SCALE - 1) / OCCLUSION_SCALE;
+    ULONG h = (Height + OCCLUSION_SCALE - 1) / OCCLUSION_SCALE;
+
+    Release();
+    if ( w == 0 || h == 0 ) return false;
+
+    for ( m_nLevelCount = 0; m_nLevelCount < OCCLUSION_MAX_LEVELS; )
+    {
+        // Allocate this level
+        m_pLevel[ m_nLevelCount ] = new (std::nothrow) float[ w * h ];
+        if ( !m_pLevel[ m_nLevelCount ] ) { Release(); return false; }
+        m_nWidth[ m_nLevelCount ]  = w;
+        m_nHeight[ m_nLevelCount ] = h;
+        m_nLevelCount++;
+
+        // Halve (rounding up) until a single texel remains
+        if ( w == 1 && h == 1 ) break;
+        w = (w + 1) / 2;
+        h = (h + 1) / 2;
+
+    } // Next Level
+
+    Clear();
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees every level of the pyramid.
+//-----------------------------------------------------------------------------
+void COcclusionBuffer::Release( )
+{
+    for ( ULONG i = 0; i < OCCLUSION_MAX_LEVELS; i++ )
+    {
+        if ( m_pLevel[i] ) delete []m_pLevel[i];
+        m_pLevel[i]  = NULL;
+        m_nWidth[i]  = 0;
+        m_nHeight[i] = 0;
+
+    } // Next Level
+    m_nLevelCount = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : Clear ()
+// Desc : Resets the base level to the far plane, ready for a new frame.
+//-----------------------------------------------------------------------------
+void COcclusionBuffer::Clear( )
+{
+    if ( !m_nLevelCount ) return;
+
+    float * pDepth = m_pLevel[0];
+    for ( ULONG i = 0, Count = m_nWidth[0] * m_nHeight[0]; i < Count; i++ ) pDepth[i] = 1.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawTriangle ()
+// Desc : Rasterizes a single occluder triangle (screen space).
+//-----------------------------------------------------------------------------
+void COcclusionBuffer::DrawTriangle( const CScreenVertex & vtx1, const CScreenVertex & vtx2, const CScreenVertex & vtx3 )
+{
+    CScreenVertex Vertices[3] = { vtx1, vtx2, vtx3 };
+    ULONG         Indices[3]  = { 0, 1, 2 };
+
+    DrawPolygon( Vertices, Indices, 3 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawPolygon ()
+// Desc : Rasterizes a convex occluder polygon (screen space vertices, picked
+//        out by pIndices) into the base level.
+// Note : Texels are only written when all four of their corners are inside
+//        every edge, and then with the furthest depth any of the polygon's
+//        fan triangles reach within the texel (never beyond its furthest
+//        vertex), so the buffer never claims more occlusion than the polygon
+//        really provides. Polygons must be drawn whole rather than as
+//        separate triangles, or texels along the shared edges are lost.
+//-----------------------------------------------------------------------------
+void COcclusionBuffer::DrawPolygon( const CScreenVertex * pVertices, const ULONG * pIndices, ULONG Count )
+{
+    const float fScale = 1.0f / (float)OCCLUSION_SCALE;
+    float       x[ OCCLUSION_MAX_VERTICES ], y[ OCCLUSION_MAX_VERTICES ];
+    float       A[ OCCLUSION_MAX_VERTICES ], B[ OCCLUSION_MAX_VERTICES ], C[ OCCLUSION_MAX_VERTICES ], E[ OCCLUSION_MAX_VERTICES ];
+    float       zOrigin[ OCCLUSION_MAX_VERTICES ], dzdx[ OCCLUSION_MAX_VERTICES ], dzdy[ OCCLUSION_MAX_VERTICES ];
+    float       fArea = 0.0f, zFar = 0.0f;
+    ULONG       nPlanes = 0;
+
+    // Validate (polygons too large to hold are simply not used as occluders)
+    if ( !m_nLevelCount || Count < 3 || Count > OCCLUSION_MAX_VERTICES ) return;
+
+    // Occlusion buffer space positions, and the polygon's winding
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const CScreenVertex & v = pVertices[ pIndices[i] ];
+        x[i] = v.x * fScale;
+        y[i] = v.y * fScale;
+        if ( i == 0 || v.z > zFar ) zFar = v.z;
+
+    } // Next Vertex
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        ULONG j = (i + 1 < Count) ? i + 1 : 0;
+        fArea += x[i] * y[j] - x[j] * y[i];
+
+    } // Next Edge
+
+    // Reject degenerate polygons (and anything which is not a number)
+    if ( !(fabsf( fArea ) > 1e-6f) ) return;
+    float fSign = (fArea > 0.0f) ? 1.0f : -1.0f;
+
+    // Edge functions, oriented so that the inside is positive, along with
+    // the distance from a texel's centre to its worst corner
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        ULONG j = (i + 1 < Count) ? i + 1 : 0;
+        A[i] = (y[i] - y[j]) * fSign;
+        B[i] = (x[j] - x[i]) * fSign;
+        C[i] = -(A[i] * x[i] + B[i] * y[i]);
+        E[i] = 0.5f * (fabsf( A[i] ) + fabsf( B[i] ));
+
+    } // Next Edge
+
+    // Depth plane of each fan triangle, already biased to the texel's
+    // furthest corner (z = zOrigin + dzdx * x + dzdy * y)
+    for ( ULONG i = 1; i + 1 < Count; i++ )
+    {
+        float ex1 = x[i] - x[0], ey1 = y[i] - y[0], ex2 = x[i + 1] - x[0], ey2 = y[i + 1] - y[0];
+        float fTriArea = ex1 * ey2 - ex2 * ey1;
+        if ( !(fabsf( fTriArea ) > 1e-6f) ) continue;
+
+        float z0  = pVertices[ pIndices[0] ].z;
+        float dz1 = pVertices[ pIndices[i] ].z - z0, dz2 = pVertices[ pIndices[i + 1] ].z - z0;
+        dzdx[ nPlanes ]    = (dz1 * ey2 - dz2 * ey1) / fTriArea;
+        dzdy[ nPlanes ]    = (dz2 * ex1 - dz1 * ex2) / fTriArea;
+        zOrigin[ nPlanes ] = z0 - dzdx[ nPlanes ] * x[0] - dzdy[ nPlanes ] * y[0] +
+                             0.5f * (fabsf( dzdx[ nPlanes ] ) + fabsf( dzdy[ nPlanes ] ));
+        nPlanes++;
+
+    } // Next Triangle
+    if ( !nPlanes ) return;
+
+    // Bounding box of the texels, clamped to the buffer
+    float fMinX = x[0], fMaxX = x[0], fMinY = y[0], fMaxY = y[0];
+    for ( ULONG i = 1; i < Count; i++ )
+    {
+        if ( x[i] < fMinX ) fMinX = x[i];
+        if ( x[i] > fMaxX ) fMaxX = x[i];
+        if ( y[i] < fMinY ) fMinY = y[i];
+        if ( y[i] > fMaxY ) fMaxY = y[i];
+
+    } // Next Vertex
+    if ( !(fMaxX >= 0.0f && fMaxY >= 0.0f && fMinX < (float)m_nWidth[0] && fMinY < (float)m_nHeight[0]) ) return;
+
+    long nMinX = (fMinX > 0.0f) ? (long)fMinX : 0;
+    long nMinY = (fMinY > 0.0f) ? (long)fMinY : 0;
+    long nMaxX = (fMaxX < (float)m_nWidth[0])  ? (long)fMaxX : (long)m_nWidth[0] - 1;
+    long nMaxY = (fMaxY < (float)m_nHeight[0]) ? (long)fMaxY : (long)m_nHeight[0] - 1;
+
+    for ( long ty = nMinY; ty <= nMaxY; ty++ )
+    {
+        float * pRow = m_pLevel[0] + ty * m_nWidth[0];
+        float   cy   = (float)ty + 0.5f;
+
+        for ( long tx = nMinX; tx <= nMaxX; tx++ )
+        {
+            float cx = (float)tx + 0.5f;
+            ULONG i;
+
+            // Whole texel inside every edge?
+            for ( i = 0; i < Count; i++ ) if ( A[i] * cx + B[i] * cy + C[i] < E[i] ) break;
+            if ( i < Count ) continue;
+
+            // Furthest depth within the texel, keeping the nearest occluder
+            float z = zOrigin[0] + dzdx[0] * cx + dzdy[0] * cy;
+            for ( i = 1; i < nPlanes; i++ )
+            {
+                float zPlane = zOrigin[i] + dzdx[i] * cx + dzdy[i] * cy;
+                if ( zPlane > z ) z = zPlane;
+
+            } // Next Plane
+            if ( z > zFar ) z = zFar;
+            if ( z < pRow[tx] ) pRow[tx] = z;
+
+        } // Next Texel
+
+    } // Next Row
+}
+
+//-----------------------------------------------------------------------------
+// Name : BuildPyramid ()
+// Desc : Reduces each level into the next, keeping the furthest depth of
+//        every 2x2 group (edge texels of odd sized levels stand alone).
+//-----------------------------------------------------------------------------
+void COcclusionBuffer::BuildPyramid( )
+{
+    for ( ULONG Level = 1; Level < m_nLevelCount; Level++ )
+    {
+        const float * pSrc = m_pLevel[ Level - 1 ];
+        float       * pDst = m_pLevel[ Level ];
+        ULONG         SrcWidth = m_nWidth[ Level - 1 ], SrcHeight = m_nHeight[ Level - 1 ];
+
+        for ( ULONG y = 0; y < m_nHeight[ Level ]; y++ )
+        {
+            const float * pRow0 = pSrc + (y * 2) * SrcWidth;
+            const float * pRow1 = (y * 2 + 1 < SrcHeight) ? pRow0 + SrcWidth : pRow0;
+
+            for ( ULONG x = 0; x < m_nWidth[ Level ]; x++ )
+            {
+                ULONG x0 = x * 2, x1 = (x * 2 + 1 < SrcWidth) ? x * 2 + 1 : x * 2;
+                float z  = pRow0[ x0 ];
+                if ( pRow0[ x1 ] > z ) z = pRow0[ x1 ];
+                if ( pRow1[ x0 ] > z ) z = pRow1[ x0 ];
+                if ( pRow1[ x1 ] > z ) z = pRow1[ x1 ];
+                pDst[ y * m_nWidth[ Level ] + x ] = z;
+
+            } // Next Texel
+
+        } // Next Row
+
+    } // Next Level
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsOccluded ()
+// Desc : Returns true if everything within the screen rectangle lies beyond
+//        the occluders already drawn (BuildPyramid must have been called).
+//-----------------------------------------------------------------------------
+bool COcclusionBuffer::IsOccluded( const SCREENRECT & Rect ) const
+{
+    const float fScale = 1.0f / (float)OCCLUSION_SCALE;
+    long        nMaxX  = (long)m_nWidth[0] - 1, nMaxY = (long)m_nHeight[0] - 1;
+    ULONG       Level  = 0;
+
+    if ( !m_nLevelCount ) return false;
+
+    // Base level texels touched, clamped to the buffer (anything beyond is
+    // off screen, and so hidden in any case)
+    float fLeft = Rect.Left * fScale, fTop = Rect.Top * fScale;
+    float fRight = Rect.Right * fScale, fBottom = Rect.Bottom * fScale;
+    if ( !(fRight >= 0.0f && fBottom >= 0.0f) ) return false;
+    if ( !(fLeft <= (float)nMaxX + 1.0f && fTop <= (float)nMaxY + 1.0f) ) return false;
+
+    long x0 = (fLeft > 0.0f) ? (long)fLeft : 0;
+    long y0 = (fTop > 0.0f) ? (long)fTop : 0;
+    long x1 = (fRight < (float)nMaxX) ? (long)fRight : nMaxX;
+    long y1 = (fBottom < (float)nMaxY) ? (long)fBottom : nMaxY;
+
+    // Climb until the rectangle spans at most two texels each way
+    while ( Level + 1 < m_nLevelCount && ((x1 - x0) > 1 || (y1 - y0) > 1) )
+    {
+        x0 >>= 1; y0 >>= 1; x1 >>= 1; y1 >>= 1;
+        Level++;
+
+    } // Next Level
+
+    // Occluded only if nearer than nothing in any of them
+    const float * pDepth = m_pLevel[ Level ];
+    for ( long y = y0; y <= y1; y++ )
+    {
+        for ( long x = x0; x <= x1; x++ )
+        {
+            if ( Rect.MinZ <= pDepth[ y * m_nWidth[ Level ] + x ] ) return false;
+
+        } // Next Texel
+
+    } // Next Row
+
+    return true;
+}
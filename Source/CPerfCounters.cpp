@@ -0,0 +1,293 @@
+//-----------------------------------------------------------------------------
+// File: CPerfCounters.cpp
+//
+// Desc: Hardware performance counters (cycles, instructions, cache and
+//       branch misses), counted on every thread which opens them and
+//       attributed to the stages of a frame. Only available on Linux, through
+//       perf_event_open, and only where the kernel exposes the counters.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CPerfCounters Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CPerfCounters.h"
+#include <atomic>
+#include <mutex>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdint.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Structures
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : PERFTHREAD (Local Struct)
+// Desc : The group of counters opened by a single thread. The group is read
+//        through its leader, values arriving in the order they were opened.
+//-----------------------------------------------------------------------------
+struct PERFTHREAD
+{
+    int             Handle[PERF_COUNTER_COUNT]; // Counter file descriptors (-1 if not opened)
+    int             Leader;                     // Descriptor the group is read through
+    long            Slot[PERF_COUNTER_COUNT];   // Position of each counter's value in a read (-1 if not opened)
+    ULONG           Values;                     // Counters in the group
+};
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static PERFTHREAD           g_Threads[ PERF_THREAD_LIMIT ];
+static std::atomic<ULONG>   g_nThreads( 0 );                    // Threads with counters open
+static bool                 g_bCounting[ PERF_COUNTER_COUNT ];  // Counters the first thread opened
+static std::mutex           g_Mutex;                            // Guards the thread table
+static char                 g_szError[ PERF_ERROR_LENGTH ] = "not opened";
+
+static const char * g_pszCounterNames[ PERF_COUNTER_COUNT ] =
+{
+    "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+#ifdef __linux__
+//-----------------------------------------------------------------------------
+// Name : OpenCounter () (Local)
+// Desc : Opens a counter of the calling thread's user mode events, joining
+//        the group led by Leader (or leading a new group if that is -1).
+//        Returns the descriptor, or -1 with errno set.
+//-----------------------------------------------------------------------------
+static int OpenCounter( PERFCOUNTER Counter, int Leader )
+{
+    static const uint64_t Config[ PERF_COUNTER_COUNT ] =
+    {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    struct perf_event_attr Attr;
+
+    ZeroMemory( &Attr, sizeof(Attr) );
+    Attr.size           = sizeof(Attr);
+    Attr.type           = PERF_TYPE_HARDWARE;
+    Attr.config         = Config[ Counter ];
+    Attr.read_format    = PERF_FORMAT_GROUP;
+    Attr.exclude_kernel = 1;
+    Attr.exclude_hv     = 1;
+
+    return (int)syscall( __NR_perf_event_open, &Attr, 0, -1, Leader, PERF_FLAG_FD_CLOEXEC );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CloseThread () (Local)
+// Desc : Closes every counter a thread opened.
+//-----------------------------------------------------------------------------
+static void CloseThread( PERFTHREAD & Thread )
+{
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ )
+    {
+        if ( Thread.Handle[c] >= 0 ) close( Thread.Handle[c] );
+        Thread.Handle[c] = -1;
+
+    } // Next Counter
+}
+#endif // __linux__
+
+//-----------------------------------------------------------------------------
+// CPerfCounters Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : CPerfCounters () (Constructor)
+// Desc : CPerfCounters Class Constructor
+//-----------------------------------------------------------------------------
+CPerfCounters::CPerfCounters()
+{
+    ZeroMemory( &m_Last, sizeof(m_Last) );
+    ZeroMemory( m_Stage, sizeof(m_Stage) );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CPerfCounters () (Destructor)
+// Desc : CPerfCounters Class Destructor
+//-----------------------------------------------------------------------------
+CPerfCounters::~CPerfCounters()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : OpenThread () (Static)
+// Desc : Opens the calling thread's counters. The first thread opens what it
+//        can, and later threads must open the same counters to be counted.
+//        Returns false (see GetError) if the thread will not be counted.
+//-----------------------------------------------------------------------------
+bool CPerfCounters::OpenThread( )
+{
+#ifdef __linux__
+    std::lock_guard<std::mutex> Lock( g_Mutex );
+    ULONG      Index  = g_nThreads.load();
+    bool       bFirst = ( Index == 0 );
+    PERFTHREAD Thread;
+    int        Error  = 0;
+
+    if ( Index == PERF_THREAD_LIMIT ) { strcpy( g_szError, "too many threads" ); return false; }
+
+    Thread.Leader = -1;
+    Thread.Values = 0;
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ )
+    {
+        Thread.Handle[c] = -1;
+        Thread.Slot[c]   = -1;
+        if ( !bFirst && !g_bCounting[c] ) continue;
+
+        // A counter the first thread has must be had by every thread, so
+        // that their counts can be summed
+        if ( (Thread.Handle[c] = OpenCounter( (PERFCOUNTER)c, Thread.Leader )) < 0 )
+        {
+            Error = errno;
+            if ( bFirst ) continue;
+            CloseThread( Thread );
+            snprintf( g_szError, PERF_ERROR_LENGTH, "%s: %s", g_pszCounterNames[c], strerror( Error ) );
+            return false;
+
+        } // End if not opened
+
+        if ( Thread.Leader < 0 ) Thread.Leader = Thread.Handle[c];
+        Thread.Slot[c] = (long)Thread.Values++;
+
+    } // Next Counter
+
+    // Nothing at all may be available (no PMU, or not permitted)
+    if ( Thread.Values == 0 )
+    {
+        snprintf( g_szError, PERF_ERROR_LENGTH, "perf_event_open: %s", strerror( Error ) );
+        return false;
+
+    } // End if none
+
+    if ( bFirst ) for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ ) g_bCounting[c] = ( Thread.Slot[c] >= 0 );
+    g_Threads[ Index ] = Thread;
+    g_nThreads.store( Index + 1 );
+    return true;
+#else
+    strcpy( g_szError, "not supported on this platform" );
+    return false;
+#endif // __linux__
+}
+
+//-----------------------------------------------------------------------------
+// Name : CloseAll () (Static)
+// Desc : Closes every thread's counters.
+//-----------------------------------------------------------------------------
+void CPerfCounters::CloseAll( )
+{
+    std::lock_guard<std::mutex> Lock( g_Mutex );
+
+#ifdef __linux__
+    for ( ULONG i = 0; i < g_nThreads.load(); i++ ) CloseThread( g_Threads[i] );
+#endif
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ ) g_bCounting[c] = false;
+    g_nThreads.store( 0 );
+    strcpy( g_szError, "not opened" );
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsOpen () (Static)
+// Desc : Returns true once any thread has opened counters.
+//-----------------------------------------------------------------------------
+bool CPerfCounters::IsOpen( )
+{
+    return g_nThreads.load( std::memory_order_relaxed ) > 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsCounting () (Static)
+// Desc : Returns true if the counter was opened (and so is summed).
+//-----------------------------------------------------------------------------
+bool CPerfCounters::IsCounting( PERFCOUNTER Counter )
+{
+    return IsOpen() && g_bCounting[ Counter ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetThreadCount () (Static)
+// Desc : Returns the number of threads being counted.
+//-----------------------------------------------------------------------------
+ULONG CPerfCounters::GetThreadCount( )
+{
+    return g_nThreads.load();
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetError () (Static)
+// Desc : Returns why the last thread to try could not open its counters.
+//-----------------------------------------------------------------------------
+const char * CPerfCounters::GetError( )
+{
+    return g_szError;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetCounterName () (Static)
+// Desc : Returns the name a counter is reported under.
+//-----------------------------------------------------------------------------
+const char * CPerfCounters::GetCounterName( PERFCOUNTER Counter )
+{
+    return g_pszCounterNames[ Counter ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadTotals () (Static)
+// Desc : Reads every counter, summed over every thread counted.
+//-----------------------------------------------------------------------------
+void CPerfCounters::ReadTotals( PERFSAMPLE & Sample )
+{
+    ZeroMemory( &Sample, sizeof(PERFSAMPLE) );
+    if ( !IsOpen() ) return;
+
+#ifdef __linux__
+    std::lock_guard<std::mutex> Lock( g_Mutex );
+    uint64_t Values[ 1 + PERF_COUNTER_COUNT ];
+
+    for ( ULONG i = 0; i < g_nThreads.load(); i++ )
+    {
+        const PERFTHREAD & Thread = g_Threads[i];
+
+        // A group reads as its size, then each counter in turn
+        if ( read( Thread.Leader, Values, sizeof(Values) ) < (ssize_t)((1 + Thread.Values) * sizeof(uint64_t)) ) continue;
+        for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ )
+            if ( Thread.Slot[c] >= 0 ) Sample.Count[c] += (__int64)Values[ 1 + Thread.Slot[c] ];
+
+    } // Next Thread
+#endif // __linux__
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset ()
+// Desc : Discards the counts attributed to each stage, counting afresh from
+//        here.
+//-----------------------------------------------------------------------------
+void CPerfCounters::Reset( )
+{
+    ZeroMemory( m_Stage, sizeof(m_Stage) );
+    ReadTotals( m_Last );
+}
+
+//-----------------------------------------------------------------------------
+// Name : MarkStage ()
+// Desc : Attributes everything counted since the last mark to the stage
+//        given.
+//-----------------------------------------------------------------------------
+void CPerfCounters::MarkStage( ULONG Stage )
+{
+    PERFSAMPLE Now;
+
+    if ( !IsOpen() || Stage >= PERF_STAGE_LIMIT ) return;
+
+    ReadTotals( Now );
+    for ( ULONG c = 0; c < PERF_COUNTER_COUNT; c++ ) m_Stage[ Stage ].Count[c] += Now.Count[c] - m_Last.Count[c];
+    m_Last = Now;
+}
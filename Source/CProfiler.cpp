@@ -0,0 +1,242 @@
+//-----------------------------------------------------------------------------
+// File: CProfiler.cpp
+//
+// Desc: Scoped profiling zones, recorded per thread while enabled and written
+//       out as a Chrome trace (chrome://tracing, or ui.perfetto.dev).
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CProfiler Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CProfiler.h"
+#include <mutex>
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Structures
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : PROFILETHREAD (Local Struct)
+// Desc : A recording thread's ring, written only by that thread.
+//-----------------------------------------------------------------------------
+struct PROFILETHREAD
+{
+    PROFILEEVENT  * pEvents;                        // PROFILER_EVENT_LIMIT completed zones
+    ULONG           Count;                          // Zones held
+    ULONG           Next;                           // Slot the next zone is written to
+    ULONG           Dropped;                        // Zones overwritten by newer ones
+    ULONG           Depth;                          // Zones currently open
+    char            szName[ PROFILER_NAME_LENGTH ]; // Name shown in the trace
+};
+
+//-----------------------------------------------------------------------------
+// Name : PROFILETHREADS (Local Struct)
+// Desc : Every thread's buffer, released when the program exits.
+//-----------------------------------------------------------------------------
+struct PROFILETHREADS
+{
+    PROFILETHREAD       Thread[ PROFILER_THREAD_LIMIT ];
+    std::atomic<ULONG>  nCount;                     // Buffers handed out
+    std::atomic<ULONG>  nUnrecorded;                // Zones on threads beyond the limit
+    std::mutex          Mutex;                      // Guards handing out buffers
+
+     PROFILETHREADS( ) : nCount( 0 ), nUnrecorded( 0 ) { ZeroMemory( Thread, sizeof(Thread) ); }
+    ~PROFILETHREADS( ) { for ( ULONG i = 0; i < PROFILER_THREAD_LIMIT; i++ ) delete []Thread[i].pEvents; }
+};
+
+//-----------------------------------------------------------------------------
+// Module Local Variables
+//-----------------------------------------------------------------------------
+static PROFILETHREADS                   g_Threads;
+static thread_local PROFILETHREAD     * t_pThread = NULL;  // This thread's buffer
+
+//-----------------------------------------------------------------------------
+// Static Member Definitions
+//-----------------------------------------------------------------------------
+std::atomic<bool> CProfiler::m_bEnabled( false );
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : GetThread () (Local)
+// Desc : Returns the calling thread's buffer, handing one out on first use
+//        (NULL if every buffer is taken, or out of memory).
+//-----------------------------------------------------------------------------
+static PROFILETHREAD * GetThread( )
+{
+    if ( t_pThread ) return t_pThread;
+
+    std::lock_guard<std::mutex> Lock( g_Threads.Mutex );
+    ULONG Index = g_Threads.nCount.load();
+    if ( Index == PROFILER_THREAD_LIMIT ) return NULL;
+
+    PROFILETHREAD & Thread = g_Threads.Thread[ Index ];
+    if (!( Thread.pEvents = new (std::nothrow) PROFILEEVENT[ PROFILER_EVENT_LIMIT ] )) return NULL;
+    sprintf( Thread.szName, "Thread %u", (unsigned int)Index );
+    g_Threads.nCount.store( Index + 1 );
+    return t_pThread = &Thread;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadCounter () (Local)
+// Desc : Returns the current performance counter value.
+//-----------------------------------------------------------------------------
+static inline __int64 ReadCounter( )
+{
+    __int64 Counter;
+    QueryPerformanceCounter( (LARGE_INTEGER*)&Counter );
+    return Counter;
+}
+
+//-----------------------------------------------------------------------------
+// CProfiler Member Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : Enable () (Static)
+// Desc : Starts or stops recording zones. Zones already open when recording
+//        starts are not recorded.
+//-----------------------------------------------------------------------------
+void CProfiler::Enable( bool bEnable )
+{
+    m_bEnabled.store( bEnable, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Reset () (Static)
+// Desc : Discards every zone recorded so far.
+//-----------------------------------------------------------------------------
+void CProfiler::Reset( )
+{
+    ULONG Count = g_Threads.nCount.load();
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        g_Threads.Thread[i].Count   = 0;
+        g_Threads.Thread[i].Next    = 0;
+        g_Threads.Thread[i].Dropped = 0;
+
+    } // Next Thread
+    g_Threads.nUnrecorded.store( 0 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetThreadName () (Static)
+// Desc : Names the calling thread in the trace.
+//-----------------------------------------------------------------------------
+void CProfiler::SetThreadName( const char * pszName )
+{
+    PROFILETHREAD * pThread = GetThread();
+    if ( !pThread ) return;
+
+    strncpy( pThread->szName, pszName, PROFILER_NAME_LENGTH - 1 );
+    pThread->szName[ PROFILER_NAME_LENGTH - 1 ] = '\0';
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetEventCount () (Static)
+// Desc : Returns the number of zones held on every thread.
+//-----------------------------------------------------------------------------
+ULONG CProfiler::GetEventCount( )
+{
+    ULONG Count = g_Threads.nCount.load(), Events = 0;
+    for ( ULONG i = 0; i < Count; i++ ) Events += g_Threads.Thread[i].Count;
+    return Events;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetDroppedCount () (Static)
+// Desc : Returns the number of zones lost, overwritten by newer ones or on
+//        threads which could not be given a ring.
+//-----------------------------------------------------------------------------
+ULONG CProfiler::GetDroppedCount( )
+{
+    ULONG Count = g_Threads.nCount.load(), Dropped = g_Threads.nUnrecorded.load();
+    for ( ULONG i = 0; i < Count; i++ ) Dropped += g_Threads.Thread[i].Dropped;
+    return Dropped;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BeginZone () (Static)
+// Desc : Opens a zone on the calling thread, returning the counter value to
+//        pass to EndZone.
+//-----------------------------------------------------------------------------
+__int64 CProfiler::BeginZone( )
+{
+    PROFILETHREAD * pThread = GetThread();
+    if ( pThread ) pThread->Depth++;
+    return ReadCounter();
+}
+
+//-----------------------------------------------------------------------------
+// Name : EndZone () (Static)
+// Desc : Closes the zone opened by the matching BeginZone, recording it
+//        over the oldest if the ring is full.
+//-----------------------------------------------------------------------------
+void CProfiler::EndZone( const char * pszName, __int64 Begin )
+{
+    __int64         End     = ReadCounter();
+    PROFILETHREAD * pThread = t_pThread;
+
+    if ( !pThread ) { g_Threads.nUnrecorded.fetch_add( 1, std::memory_order_relaxed ); return; }
+    pThread->Depth--;
+
+    PROFILEEVENT & Event = pThread->pEvents[ pThread->Next ];
+    if ( ++pThread->Next == PROFILER_EVENT_LIMIT ) pThread->Next = 0;
+    if ( pThread->Count < PROFILER_EVENT_LIMIT ) pThread->Count++; else pThread->Dropped++;
+    Event.pszName = pszName;
+    Event.Begin   = Begin;
+    Event.End     = End;
+    Event.Depth   = pThread->Depth;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WriteTrace () (Static)
+// Desc : Writes every zone held to a Chrome trace event (JSON) file, one
+//        complete event per zone, oldest first on each thread, with times
+//        in microseconds from the earliest.
+//-----------------------------------------------------------------------------
+bool CProfiler::WriteTrace( LPCTSTR FileName )
+{
+    ULONG   Count = g_Threads.nCount.load(), Written = 0;
+    __int64 Frequency, Origin = 0;
+    bool    bOrigin = false;
+    FILE  * pFile;
+
+    QueryPerformanceFrequency( (LARGE_INTEGER*)&Frequency );
+    if (!( pFile = fopen( FileName, "w" ) )) return false;
+
+    // Times are written relative to the earliest zone
+    for ( ULONG t = 0; t < Count; t++ )
+    {
+        const PROFILETHREAD & Thread = g_Threads.Thread[t];
+        for ( ULONG i = 0; i < Thread.Count; i++ )
+            if ( !bOrigin || Thread.pEvents[i].Begin < Origin ) { Origin = Thread.pEvents[i].Begin; bOrigin = true; }
+
+    } // Next Thread
+
+    fprintf( pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+    for ( ULONG t = 0; t < Count; t++ )
+    {
+        const PROFILETHREAD & Thread = g_Threads.Thread[t];
+        ULONG First = ( Thread.Count < PROFILER_EVENT_LIMIT ) ? 0 : Thread.Next;
+
+        // Name the thread, then list its zones
+        fprintf( pFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+                 Written++ ? ",\n" : "", (unsigned int)t, Thread.szName );
+        for ( ULONG i = 0; i < Thread.Count; i++ )
+        {
+            const PROFILEEVENT & Event = Thread.pEvents[ (First + i) % PROFILER_EVENT_LIMIT ];
+            fprintf( pFile, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                     Event.pszName, (unsigned int)t, (double)(Event.Begin - Origin) * 1e6 / (double)Frequency,
+                     (double)(Event.End - Event.Begin) * 1e6 / (double)Frequency );
+
+        } // Next Event
+
+    } // Next Thread
+    fprintf( pFile, "\n]}\n" );
+
+    return ( fclose( pFile ) == 0 );
+}
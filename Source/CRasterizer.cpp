@@ -0,0 +1,482 @@
+//-----------------------------------------------------------------------------
+// File: CRasterizer.cpp
+//
+// Desc: Software rasterizer, draws primitives directly into the pixel memory
+//       of a frame buffer.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CRasterizer Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CRasterizer.h"
+
+#ifdef TRANSFORM_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+// Integer division rounding towards positive infinity (Divisor must be > 0).
+static inline long long CeilDiv( long long Value, long long Divisor )
+{
+    return (Value >= 0) ? (Value + Divisor - 1) / Divisor : -((-Value) / Divisor);
+}
+
+// Integer division rounding towards negative infinity (Divisor must be > 0).
+static inline long long FloorDiv( long long Value, long long Divisor )
+{
+    return -CeilDiv( -Value, Divisor );
+}
+
+// Narrows an edge function value to 32 bits. Only values far larger than any
+// step within a block are clamped, and those keep their sign across the block.
+static inline int ClampEdge( long long Value )
+{
+    const long long Limit = 1 << 30;
+    return (int)((Value > Limit) ? Limit : (Value < -Limit) ? -Limit : Value);
+}
+
+//-----------------------------------------------------------------------------
+// Name : CRasterizer () (Constructor)
+// Desc : CRasterizer Class Constructor
+//-----------------------------------------------------------------------------
+CRasterizer::CRasterizer()
+{
+	// Reset / Clear all required values
+    m_pBits         = NULL;
+    m_pDepth        = NULL;
+    m_nPitch        = 0;
+    m_nTargetWidth  = 0;
+    m_nTargetHeight = 0;
+    m_nClipLeft     = 0;
+    m_nClipTop      = 0;
+    m_nClipRight    = 0;
+    m_nClipBottom   = 0;
+    m_nColor        = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CRasterizer () (Destructor)
+// Desc : CRasterizer Class Destructor
+//-----------------------------------------------------------------------------
+CRasterizer::~CRasterizer()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetRenderTarget ()
+// Desc : Selects the frame buffer to draw into, and resets the clip rectangle
+//        to cover the whole buffer.
+// Note : Must be called again whenever the frame buffer is re-created.
+//-----------------------------------------------------------------------------
+void CRasterizer::SetRenderTarget( CFrameBuffer * pFrameBuffer )
+{
+    // Store target details
+    m_pBits         = (pFrameBuffer) ? pFrameBuffer->GetBits() : NULL;
+    m_pDepth        = (pFrameBuffer) ? pFrameBuffer->GetDepthBits() : NULL;
+    m_nPitch        = (pFrameBuffer) ? pFrameBuffer->GetPitch() : 0;
+    m_nTargetWidth  = (pFrameBuffer) ? (long)pFrameBuffer->GetWidth() : 0;
+    m_nTargetHeight = (pFrameBuffer) ? (long)pFrameBuffer->GetHeight() : 0;
+
+    // Clip to the entire buffer
+    m_nClipLeft     = 0;
+    m_nClipTop      = 0;
+    m_nClipRight    = m_nTargetWidth;
+    m_nClipBottom   = m_nTargetHeight;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetClipRect ()
+// Desc : Restricts drawing to the specified rectangle (right / bottom edges
+//        exclusive), limited to the bounds of the render target.
+//-----------------------------------------------------------------------------
+void CRasterizer::SetClipRect( long Left, long Top, long Right, long Bottom )
+{
+    m_nClipLeft     = (Left   > 0) ? Left : 0;
+    m_nClipTop      = (Top    > 0) ? Top  : 0;
+    m_nClipRight    = (Right  < m_nTargetWidth)  ? Right  : m_nTargetWidth;
+    m_nClipBottom   = (Bottom < m_nTargetHeight) ? Bottom : m_nTargetHeight;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawLine ()
+// Desc : Bresenham line drawing directly into the render target. As with the
+//        GDI LineTo function, the final pixel of the line is not drawn.
+// Note : The line is walked as N = max(|dx|,|dy|) steps along the major axis,
+//        the minor axis offset at step i being floor((2*i*dMin + dMaj) /
+//        (2*dMaj)). Clipping simply narrows the range of steps walked.
+//-----------------------------------------------------------------------------
+void CRasterizer::DrawLine( long X1, long Y1, long X2, long Y2 )
+{
+    long      dx = X2 - X1, dy = Y2 - Y1;
+    long      adx = (dx < 0) ? -dx : dx, ady = (dy < 0) ? -dy : dy;
+    long      Maj0, Min0, MajLo, MajHi, MinLo, MinHi, sMaj, sMin;
+    long long dMaj, dMin, Steps, iStart, iEnd, oLo, oHi, Num, Remain;
+    long      MajStep, MinStep, x, y;
+
+    // Validate
+    if ( !m_pBits || m_nClipLeft >= m_nClipRight || m_nClipTop >= m_nClipBottom ) return;
+
+    // Arrange the line in terms of its major & minor axes
+    if ( adx >= ady )
+    {
+        Maj0  = X1;          Min0  = Y1;
+        sMaj  = (dx < 0) ? -1 : 1;
+        sMin  = (dy < 0) ? -1 : 1;
+        dMaj  = adx;         dMin  = ady;
+        MajLo = m_nClipLeft; MajHi = m_nClipRight;
+        MinLo = m_nClipTop;  MinHi = m_nClipBottom;
+        MajStep = sMaj;      MinStep = sMin * (long)m_nPitch;
+
+    } // End if X Major
+    else
+    {
+        Maj0  = Y1;          Min0  = X1;
+        sMaj  = (dy < 0) ? -1 : 1;
+        sMin  = (dx < 0) ? -1 : 1;
+        dMaj  = ady;         dMin  = adx;
+        MajLo = m_nClipTop;  MajHi = m_nClipBottom;
+        MinLo = m_nClipLeft; MinHi = m_nClipRight;
+        MajStep = sMaj * (long)m_nPitch; MinStep = sMin;
+
+    } // End if Y Major
+
+    // Nothing to draw for a zero length line
+    Steps = dMaj;
+    if ( Steps == 0 ) return;
+
+    // Range of steps whose major coordinate lies within the clip rectangle
+    if ( sMaj > 0 ) { iStart = MajLo - Maj0;     iEnd = MajHi - Maj0; }
+    else            { iStart = Maj0 - MajHi + 1; iEnd = Maj0 - MajLo + 1; }
+    if ( iStart < 0 ) iStart = 0;
+    if ( iEnd > Steps ) iEnd = Steps;
+
+    // Range of minor axis offsets which lie within the clip rectangle
+    if ( sMin > 0 ) { oLo = MinLo - Min0;     oHi = MinHi - Min0; }
+    else            { oLo = Min0 - MinHi + 1; oHi = Min0 - MinLo + 1; }
+
+    // Convert that into a range of steps
+    if ( dMin == 0 )
+    {
+        if ( oLo > 0 || oHi <= 0 ) return;
+
+    } // End if axis aligned
+    else
+    {
+        long long iFirst = CeilDiv( (2 * oLo - 1) * dMaj, 2 * dMin );
+        long long iLast  = CeilDiv( (2 * oHi - 1) * dMaj, 2 * dMin );
+        if ( iFirst > iStart ) iStart = iFirst;
+        if ( iLast  < iEnd   ) iEnd   = iLast;
+
+    } // End if sloped
+
+    // Entirely clipped ?
+    if ( iStart >= iEnd ) return;
+
+    // Calculate the Bresenham state at the first visible step
+    Num    = 2 * iStart * dMin + dMaj;
+    Remain = Num % (2 * dMaj);
+    if ( adx >= ady )
+    {
+        x = X1 + sMaj * (long)iStart;
+        y = Y1 + sMin * (long)(Num / (2 * dMaj));
+    }
+    else
+    {
+        y = Y1 + sMaj * (long)iStart;
+        x = X1 + sMin * (long)(Num / (2 * dMaj));
+
+    } // End if
+
+    // Walk the visible steps
+    ULONG * pPixel = m_pBits + (long)y * (long)m_nPitch + x;
+    ULONG   Color  = m_nColor;
+    for ( long long i = iStart; i < iEnd; i++ )
+    {
+        *pPixel = Color;
+        pPixel += MajStep;
+        Remain += 2 * dMin;
+        if ( Remain >= 2 * dMaj ) { Remain -= 2 * dMaj; pPixel += MinStep; }
+
+    } // Next Step
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawLine ()
+// Desc : Draws a line specified in floating point screen coordinates, which
+//        are truncated to integer pixel positions.
+//-----------------------------------------------------------------------------
+void CRasterizer::DrawLine( float X1, float Y1, float X2, float Y2 )
+{
+    long nX1, nY1, nX2, nY2;
+
+    // Draw the integer line
+    if ( SnapLine( X1, Y1, X2, Y2, nX1, nY1, nX2, nY2 ) ) DrawLine( nX1, nY1, nX2, nY2 );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SnapLine () (Static)
+// Desc : Converts a line in floating point screen coordinates to the integer
+//        end points which DrawLine will walk. Returns false if the line
+//        cannot be drawn.
+// Note : Coordinates beyond RASTER_GUARD_BAND (i.e. poorly projected points)
+//        are first clipped back to that range so that the integer setup
+//        cannot overflow.
+//-----------------------------------------------------------------------------
+bool CRasterizer::SnapLine( float X1, float Y1, float X2, float Y2, long & nX1, long & nY1, long & nX2, long & nY2 )
+{
+    const float G = RASTER_GUARD_BAND;
+
+    // Reject invalid coordinates (NaN fails every comparison)
+    if ( !(X1 == X1 && Y1 == Y1 && X2 == X2 && Y2 == Y2) ) return false;
+
+    // Clip to the guard band if required (Liang-Barsky)
+    if ( fabsf( X1 ) > G || fabsf( Y1 ) > G || fabsf( X2 ) > G || fabsf( Y2 ) > G )
+    {
+        float dx = X2 - X1, dy = Y2 - Y1, t0 = 0.0f, t1 = 1.0f;
+        float p[4] = { -dx, dx, -dy, dy };
+        float q[4] = { X1 + G, G - X1, Y1 + G, G - Y1 };
+
+        for ( int k = 0; k < 4; k++ )
+        {
+            if ( p[k] == 0.0f ) { if ( q[k] < 0.0f ) return false; continue; }
+            float r = q[k] / p[k];
+            if ( p[k] < 0.0f ) { if ( r > t1 ) return false; if ( r > t0 ) t0 = r; }
+            else               { if ( r < t0 ) return false; if ( r < t1 ) t1 = r; }
+
+        } // Next Boundary
+
+        // Calculate new end points
+        X2 = X1 + dx * t1; Y2 = Y1 + dy * t1;
+        X1 = X1 + dx * t0; Y1 = Y1 + dy * t0;
+
+    } // End if outside guard band
+
+    // Truncate to pixel positions
+    nX1 = (long)X1; nY1 = (long)Y1;
+    nX2 = (long)X2; nY2 = (long)Y2;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawTriangle ()
+// Desc : Fills a triangle in the current colour, depth testing (less than)
+//        and writing depth if the render target has a depth buffer. Either
+//        winding is accepted, culling is the caller's responsibility.
+// Note : Vertices are snapped to RASTER_SUBPIXEL_BITS of fraction and pixel
+//        centres sampled at (x + 0.5, y + 0.5). Pixels exactly on an edge
+//        belong to the triangle only if that edge is a top or left edge, so
+//        triangles sharing an edge never draw the same pixel twice.
+//        The bounding box is walked in RASTER_BLOCK_SIZE blocks. Blocks
+//        outside any edge are skipped, blocks inside all three need no
+//        per pixel edge tests, and the remainder test four pixels at once.
+//        Vertices must lie within RASTER_TRIANGLE_GUARD, anything further
+//        out should already have been clipped (see CTransformStage).
+//-----------------------------------------------------------------------------
+void CRasterizer::DrawTriangle( const CScreenVertex & vtx1, const CScreenVertex & vtx2, const CScreenVertex & vtx3 )
+{
+    const CScreenVertex * v[3] = { &vtx1, &vtx2, &vtx3 };
+    const long  One = 1 << RASTER_SUBPIXEL_BITS, Half = One / 2, Block = RASTER_BLOCK_SIZE;
+    long        X[3], Y[3], Left, Top, Right, Bottom;
+    long long   A[3], B[3], C[3], Area;
+    float       dzdx = 0.0f, dzdy = 0.0f, zOrigin = 0.0f;
+
+    // Validate
+    if ( !m_pBits || m_nClipLeft >= m_nClipRight || m_nClipTop >= m_nClipBottom ) return;
+
+    // Snap to fixed point (NaN fails the guard band test)
+    for ( int i = 0; i < 3; i++ )
+    {
+        if ( !(fabsf( v[i]->x ) <= RASTER_TRIANGLE_GUARD && fabsf( v[i]->y ) <= RASTER_TRIANGLE_GUARD) ) return;
+        X[i] = (long)floorf( v[i]->x * (float)One + 0.5f );
+        Y[i] = (long)floorf( v[i]->y * (float)One + 0.5f );
+
+    } // Next Vertex
+
+    // Twice the signed area, reordered so that it is positive
+    Area = (long long)(X[1] - X[0]) * (Y[2] - Y[0]) - (long long)(X[2] - X[0]) * (Y[1] - Y[0]);
+    if ( Area == 0 ) return;
+    if ( Area < 0 )
+    {
+        long t;
+        const CScreenVertex * p = v[1]; v[1] = v[2]; v[2] = p;
+        t = X[1]; X[1] = X[2]; X[2] = t;
+        t = Y[1]; Y[1] = Y[2]; Y[2] = t;
+        Area = -Area;
+
+    } // End if reversed
+
+    // Edge functions, positive inside, E = A * x + B * y + C
+    for ( int i = 0; i < 3; i++ )
+    {
+        int j = (i + 1) % 3;
+        A[i] = Y[i] - Y[j];
+        B[i] = X[j] - X[i];
+        C[i] = -(A[i] * X[i] + B[i] * Y[i]);
+
+        // Fill rule, pixels on edges other than top / left edges are excluded
+        if ( !(A[i] > 0 || (A[i] == 0 && B[i] > 0)) ) C[i] -= 1;
+
+    } // Next Edge
+
+    // Pixels whose centres fall within the bounding box, limited to the clip rectangle
+    Left   = (long)CeilDiv( ((X[0] < X[1]) ? ((X[0] < X[2]) ? X[0] : X[2]) : ((X[1] < X[2]) ? X[1] : X[2])) - Half, One );
+    Right  = (long)FloorDiv( ((X[0] > X[1]) ? ((X[0] > X[2]) ? X[0] : X[2]) : ((X[1] > X[2]) ? X[1] : X[2])) - Half, One );
+    Top    = (long)CeilDiv( ((Y[0] < Y[1]) ? ((Y[0] < Y[2]) ? Y[0] : Y[2]) : ((Y[1] < Y[2]) ? Y[1] : Y[2])) - Half, One );
+    Bottom = (long)FloorDiv( ((Y[0] > Y[1]) ? ((Y[0] > Y[2]) ? Y[0] : Y[2]) : ((Y[1] > Y[2]) ? Y[1] : Y[2])) - Half, One );
+    if ( Left   < m_nClipLeft )       Left   = m_nClipLeft;
+    if ( Top    < m_nClipTop )        Top    = m_nClipTop;
+    if ( Right  > m_nClipRight - 1 )  Right  = m_nClipRight - 1;
+    if ( Bottom > m_nClipBottom - 1 ) Bottom = m_nClipBottom - 1;
+    if ( Left > Right || Top > Bottom ) return;
+
+    // Depth plane, z = zOrigin + x * dzdx + y * dzdy at pixel (x, y)
+    if ( m_pDepth )
+    {
+        float x0 = (float)X[0] / One, y0 = (float)Y[0] / One;
+        float x1 = (float)X[1] / One - x0, y1 = (float)Y[1] / One - y0;
+        float x2 = (float)X[2] / One - x0, y2 = (float)Y[2] / One - y0;
+        float z1 = v[1]->z - v[0]->z, z2 = v[2]->z - v[0]->z;
+        float fArea = (float)((double)Area / (double)(One * One));
+
+        dzdx    = (z1 * y2 - z2 * y1) / fArea;
+        dzdy    = (z2 * x1 - z1 * x2) / fArea;
+        zOrigin = v[0]->z + (0.5f - x0) * dzdx + (0.5f - y0) * dzdy;
+
+    } // End if depth
+
+    // Walk the blocks overlapping the bounding box
+    for ( long by = Top - (Top % Block); by <= Bottom; by += Block )
+    {
+        long y0 = (by > Top) ? by : Top, y1 = (by + Block - 1 < Bottom) ? by + Block - 1 : Bottom;
+
+        for ( long bx = Left - (Left % Block); bx <= Right; bx += Block )
+        {
+            long      x0 = (bx > Left) ? bx : Left, x1 = (bx + Block - 1 < Right) ? bx + Block - 1 : Right;
+            long long E[3];
+            bool      bOutside = false, bInside = true;
+
+            // Edge values at the block's first pixel centre, and their range over the block
+            for ( int i = 0; i < 3; i++ )
+            {
+                long long StepX = A[i] * One * (Block - 1), StepY = B[i] * One * (Block - 1);
+
+                E[i] = A[i] * ((long long)bx * One + Half) + B[i] * ((long long)by * One + Half) + C[i];
+                if ( E[i] + ((StepX > 0) ? StepX : 0) + ((StepY > 0) ? StepY : 0) < 0 ) { bOutside = true; break; }
+                if ( E[i] + ((StepX < 0) ? StepX : 0) + ((StepY < 0) ? StepY : 0) < 0 ) bInside = false;
+
+            } // Next Edge
+            if ( bOutside ) continue;
+
+#ifdef TRANSFORM_SIMD_SSE2
+            // Whole rows of the block are processed four pixels at a time
+            if ( x0 == bx && x1 == bx + Block - 1 )
+            {
+                __m128i Color  = _mm_set1_epi32( (int)m_nColor );
+                __m128  fLanes = _mm_set_ps( 3.0f, 2.0f, 1.0f, 0.0f );
+                __m128  dzx    = _mm_set1_ps( dzdx );
+                __m128i Step[3], Step4[3];
+
+                // Per lane edge offsets, and the step to the next four pixels
+                for ( int i = 0; i < 3; i++ )
+                {
+                    int s = (int)(A[i] * One);
+                    Step[i]  = _mm_set_epi32( 3 * s, 2 * s, s, 0 );
+                    Step4[i] = _mm_set1_epi32( 4 * s );
+
+                } // Next Edge
+
+                for ( long y = y0; y <= y1; y++ )
+                {
+                    ULONG * pPixel = m_pBits + y * (long)m_nPitch + bx;
+                    float * pDepth = (m_pDepth) ? m_pDepth + y * (long)m_nPitch + bx : NULL;
+                    __m128  zRow   = _mm_set1_ps( zOrigin + (float)bx * dzdx + (float)y * dzdy );
+                    __m128i e[3];
+
+                    // Edge values for the first four pixels of the row
+                    for ( int i = 0; i < 3 && !bInside; i++ )
+                        e[i] = _mm_add_epi32( _mm_set1_epi32( ClampEdge( E[i] + (y - by) * B[i] * One ) ), Step[i] );
+
+                    for ( long h = 0; h < Block; h += 4 )
+                    {
+                        __m128i Mask = _mm_set1_epi32( -1 );
+
+                        // Covered where every edge value is non negative
+                        if ( !bInside )
+                        {
+                            Mask = _mm_andnot_si128( _mm_srai_epi32( _mm_or_si128( _mm_or_si128( e[0], e[1] ), e[2] ), 31 ), Mask );
+                            e[0] = _mm_add_epi32( e[0], Step4[0] );
+                            e[1] = _mm_add_epi32( e[1], Step4[1] );
+                            e[2] = _mm_add_epi32( e[2], Step4[2] );
+
+                        } // End if partial block
+
+                        // Depth test and write (same arithmetic as the per pixel path)
+                        if ( pDepth && _mm_movemask_epi8( Mask ) )
+                        {
+                            __m128 z   = _mm_add_ps( zRow, _mm_mul_ps( _mm_add_ps( fLanes, _mm_set1_ps( (float)h ) ), dzx ) );
+                            __m128 Old = _mm_loadu_ps( pDepth + h );
+                            Mask = _mm_and_si128( Mask, _mm_castps_si128( _mm_cmplt_ps( z, Old ) ) );
+                            _mm_storeu_ps( pDepth + h, _mm_or_ps( _mm_and_ps( _mm_castsi128_ps( Mask ), z ),
+                                                                  _mm_andnot_ps( _mm_castsi128_ps( Mask ), Old ) ) );
+
+                        } // End if depth
+
+                        // Colour write
+                        if ( _mm_movemask_epi8( Mask ) )
+                        {
+                            __m128i Old = _mm_loadu_si128( (__m128i*)(pPixel + h) );
+                            _mm_storeu_si128( (__m128i*)(pPixel + h), _mm_or_si128( _mm_and_si128( Mask, Color ),
+                                                                                    _mm_andnot_si128( Mask, Old ) ) );
+
+                        } // End if any covered
+
+                    } // Next Group
+
+                } // Next Row
+                continue;
+
+            } // End if whole rows
+#endif // TRANSFORM_SIMD_SSE2
+
+            // One pixel at a time (blocks cut by the clip rectangle, or no SIMD)
+            for ( long y = y0; y <= y1; y++ )
+            {
+                float zRow = zOrigin + (float)bx * dzdx + (float)y * dzdy;
+
+                for ( long x = x0; x <= x1; x++ )
+                {
+                    long   Offset = y * (long)m_nPitch + x;
+                    float  z = zRow + (float)(x - bx) * dzdx;
+
+                    // Coverage
+                    if ( !bInside )
+                    {
+                        bool bCovered = true;
+                        for ( int i = 0; i < 3; i++ )
+                            if ( E[i] + (x - bx) * A[i] * One + (y - by) * B[i] * One < 0 ) { bCovered = false; break; }
+                        if ( !bCovered ) continue;
+
+                    } // End if partial block
+
+                    // Depth test
+                    if ( m_pDepth )
+                    {
+                        if ( !(z < m_pDepth[ Offset ]) ) continue;
+                        m_pDepth[ Offset ] = z;
+
+                    } // End if depth
+
+                    m_pBits[ Offset ] = m_nColor;
+
+                } // Next Pixel
+
+            } // Next Row
+
+        } // Next Block Column
+
+    } // Next Block Row
+}
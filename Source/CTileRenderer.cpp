@@ -0,0 +1,470 @@
+//-----------------------------------------------------------------------------
+// File: CTileRenderer.cpp
+//
+// Desc: Tile binning renderer. Primitives are gathered and sorted into screen
+//       tiles, and the tiles are then rasterized in parallel.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTileRenderer Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CTileRenderer.h"
+#include "../Includes/CProfiler.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Name : CTileRenderer () (Constructor)
+// Desc : CTileRenderer Class Constructor
+//-----------------------------------------------------------------------------
+CTileRenderer::CTileRenderer()
+{
+	// Reset / Clear all required values
+    m_pFrameBuffer  = NULL;
+    m_pJobSystem    = NULL;
+    m_nClipLeft     = 0;
+    m_nClipTop      = 0;
+    m_nClipRight    = 0;
+    m_nClipBottom   = 0;
+    m_nTilesX       = 0;
+    m_nTilesY       = 0;
+    m_pLines        = NULL;
+    m_nLineCount    = 0;
+    m_nLineMax      = 0;
+    m_pTriangles    = NULL;
+    m_nTriangleCount= 0;
+    m_nTriangleMax  = 0;
+    m_pTileStart    = NULL;
+    m_pTileFill     = NULL;
+    m_pBins         = NULL;
+    m_nBinnedCount  = 0;
+    m_nBinMax       = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CTileRenderer () (Destructor)
+// Desc : CTileRenderer Class Destructor
+//-----------------------------------------------------------------------------
+CTileRenderer::~CTileRenderer()
+{
+    Release();
+}
+
+//-----------------------------------------------------------------------------
+// Name : Release ()
+// Desc : Frees all primitive and bin storage, and detaches from the target.
+//-----------------------------------------------------------------------------
+void CTileRenderer::Release( )
+{
+    if ( m_pLines )     delete []m_pLines;
+    if ( m_pTriangles ) delete []m_pTriangles;
+    if ( m_pTileStart ) delete []m_pTileStart;
+    if ( m_pTileFill )  delete []m_pTileFill;
+    if ( m_pBins )      delete []m_pBins;
+
+    m_pLines        = NULL;
+    m_pTileStart    = NULL;
+    m_pTileFill     = NULL;
+    m_pBins         = NULL;
+    m_nLineCount    = 0;
+    m_nLineMax      = 0;
+    m_pTriangles    = NULL;
+    m_nTriangleCount= 0;
+    m_nTriangleMax  = 0;
+    m_nBinnedCount  = 0;
+    m_nBinMax       = 0;
+    m_nTilesX       = 0;
+    m_nTilesY       = 0;
+    m_pFrameBuffer  = NULL;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetRenderTarget ()
+// Desc : Selects the frame buffer to draw into, and resets the clip rectangle
+//        to cover the whole buffer.
+// Note : Must be called again whenever the frame buffer is re-created.
+//-----------------------------------------------------------------------------
+void CTileRenderer::SetRenderTarget( CFrameBuffer * pFrameBuffer )
+{
+    ULONG Width  = (pFrameBuffer) ? pFrameBuffer->GetWidth()  : 0;
+    ULONG Height = (pFrameBuffer) ? pFrameBuffer->GetHeight() : 0;
+
+    // Throw away any per tile storage sized for the previous target
+    if ( m_pTileStart ) delete []m_pTileStart;
+    if ( m_pTileFill )  delete []m_pTileFill;
+    m_pTileStart    = NULL;
+    m_pTileFill     = NULL;
+    m_nLineCount    = 0;
+    m_nTriangleCount= 0;
+    m_nBinnedCount  = 0;
+
+    // Store target details
+    m_pFrameBuffer  = pFrameBuffer;
+    m_nTilesX       = (Width  + TILE_SIZE - 1) / TILE_SIZE;
+    m_nTilesY       = (Height + TILE_SIZE - 1) / TILE_SIZE;
+
+    // Allocate per tile storage
+    if ( m_nTilesX * m_nTilesY > 0 )
+    {
+        m_pTileStart = new (std::nothrow) ULONG[ m_nTilesX * m_nTilesY + 1 ];
+        m_pTileFill  = new (std::nothrow) ULONG[ m_nTilesX * m_nTilesY ];
+        if ( !m_pTileStart || !m_pTileFill ) { m_pFrameBuffer = NULL; m_nTilesX = m_nTilesY = 0; }
+
+    } // End if tiles
+
+    // Clip to the entire buffer
+    m_nClipLeft     = 0;
+    m_nClipTop      = 0;
+    m_nClipRight    = (long)Width;
+    m_nClipBottom   = (long)Height;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetClipRect ()
+// Desc : Restricts drawing to the specified rectangle (right / bottom edges
+//        exclusive), limited to the bounds of the render target.
+//-----------------------------------------------------------------------------
+void CTileRenderer::SetClipRect( long Left, long Top, long Right, long Bottom )
+{
+    long Width  = (m_pFrameBuffer) ? (long)m_pFrameBuffer->GetWidth()  : 0;
+    long Height = (m_pFrameBuffer) ? (long)m_pFrameBuffer->GetHeight() : 0;
+
+    m_nClipLeft     = (Left   > 0) ? Left : 0;
+    m_nClipTop      = (Top    > 0) ? Top  : 0;
+    m_nClipRight    = (Right  < Width)  ? Right  : Width;
+    m_nClipBottom   = (Bottom < Height) ? Bottom : Height;
+}
+
+//-----------------------------------------------------------------------------
+// Name : BeginFrame ()
+// Desc : Discards the primitives recorded for the previous frame.
+//-----------------------------------------------------------------------------
+void CTileRenderer::BeginFrame( )
+{
+    m_nLineCount    = 0;
+    m_nTriangleCount= 0;
+    m_nBinnedCount  = 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddLine ()
+// Desc : Records a line in floating point screen coordinates, snapped to
+//        pixels exactly as CRasterizer would draw it.
+//-----------------------------------------------------------------------------
+void CTileRenderer::AddLine( float X1, float Y1, float X2, float Y2, ULONG Color )
+{
+    long nX1, nY1, nX2, nY2;
+
+    if ( CRasterizer::SnapLine( X1, Y1, X2, Y2, nX1, nY1, nX2, nY2 ) ) AddLine( nX1, nY1, nX2, nY2, Color );
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddLine ()
+// Desc : Records a line in integer pixel coordinates (GDI semantics, the
+//        final pixel is not drawn).
+//-----------------------------------------------------------------------------
+void CTileRenderer::AddLine( long X1, long Y1, long X2, long Y2, ULONG Color )
+{
+    TILELINE * pNewLines;
+    ULONG      nNewMax;
+
+    // Lines which are entirely outside the clip rectangle are never recorded
+    if ( !m_pFrameBuffer ) return;
+    if ( (X1 < m_nClipLeft   && X2 < m_nClipLeft)   || (Y1 < m_nClipTop    && Y2 < m_nClipTop) ||
+         (X1 >= m_nClipRight && X2 >= m_nClipRight) || (Y1 >= m_nClipBottom && Y2 >= m_nClipBottom) ) return;
+
+    // Grow the line array if required
+    if ( m_nLineCount == m_nLineMax )
+    {
+        nNewMax = (m_nLineMax > 0) ? m_nLineMax * 2 : 1024;
+        if (!( pNewLines = new (std::nothrow) TILELINE[ nNewMax ] )) return;
+        if ( m_pLines )
+        {
+            memcpy( pNewLines, m_pLines, m_nLineCount * sizeof(TILELINE) );
+            delete []m_pLines;
+
+        } // End if existing lines
+        m_pLines   = pNewLines;
+        m_nLineMax = nNewMax;
+
+    } // End if full
+
+    // Store the line
+    TILELINE & Line = m_pLines[ m_nLineCount++ ];
+    Line.X1 = X1; Line.Y1 = Y1;
+    Line.X2 = X2; Line.Y2 = Y2;
+    Line.Color = Color;
+}
+
+//-----------------------------------------------------------------------------
+// Name : AddTriangle ()
+// Desc : Records a filled triangle in screen space (see
+//        CRasterizer::DrawTriangle).
+//-----------------------------------------------------------------------------
+void CTileRenderer::AddTriangle( const CScreenVertex & vtx1, const CScreenVertex & vtx2, const CScreenVertex & vtx3, ULONG Color )
+{
+    TILETRIANGLE * pNewTriangles;
+    ULONG          nNewMax;
+
+    // Validate
+    if ( !m_pFrameBuffer ) return;
+
+    // Grow the triangle array if required
+    if ( m_nTriangleCount == m_nTriangleMax )
+    {
+        nNewMax = (m_nTriangleMax > 0) ? m_nTriangleMax * 2 : 1024;
+        if (!( pNewTriangles = new (std::nothrow) TILETRIANGLE[ nNewMax ] )) return;
+        if ( m_pTriangles )
+        {
+            memcpy( pNewTriangles, m_pTriangles, m_nTriangleCount * sizeof(TILETRIANGLE) );
+            delete []m_pTriangles;
+
+        } // End if existing triangles
+        m_pTriangles   = pNewTriangles;
+        m_nTriangleMax = nNewMax;
+
+    } // End if full
+
+    // Store the triangle
+    TILETRIANGLE & Triangle = m_pTriangles[ m_nTriangleCount++ ];
+    Triangle.Vertex[0] = vtx1;
+    Triangle.Vertex[1] = vtx2;
+    Triangle.Vertex[2] = vtx3;
+    Triangle.Color     = Color;
+}
+
+//-----------------------------------------------------------------------------
+// Name : EndFrame ()
+// Desc : Bins all the primitives recorded this frame, then rasterizes every
+//        tile.
+// Note : Binning is a counting sort, the first pass counts the primitives
+//        touching each tile, the second scatters their indices. Each tile
+//        therefore sees its primitives in the order they were submitted
+//        (triangles first, then lines).
+//-----------------------------------------------------------------------------
+void CTileRenderer::EndFrame( )
+{
+    ULONG TileCount = m_nTilesX * m_nTilesY, Total = 0, Count;
+
+    // Validate
+    if ( !m_pFrameBuffer || TileCount == 0 || (m_nLineCount == 0 && m_nTriangleCount == 0) ) return;
+    if ( m_nClipLeft >= m_nClipRight || m_nClipTop >= m_nClipBottom ) return;
+
+    // Count the primitives per tile
+    memset( m_pTileStart, 0, (TileCount + 1) * sizeof(ULONG) );
+    for ( ULONG i = 0; i < m_nTriangleCount; i++ ) BinTriangle( i, false );
+    for ( ULONG i = 0; i < m_nLineCount; i++ ) BinLine( i, false );
+
+    // Convert counts into starting positions
+    for ( ULONG t = 0; t < TileCount; t++ )
+    {
+        Count            = m_pTileStart[t];
+        m_pTileStart[t]  = Total;
+        m_pTileFill[t]   = Total;
+        Total           += Count;
+
+    } // Next Tile
+    m_pTileStart[ TileCount ] = Total;
+
+    // Scatter the primitive indices into their tiles
+    if ( !ReserveBins( Total ) ) return;
+    for ( ULONG i = 0; i < m_nTriangleCount; i++ ) BinTriangle( i, true );
+    for ( ULONG i = 0; i < m_nLineCount; i++ ) BinLine( i, true );
+    m_nBinnedCount = Total;
+
+    // Rasterize the tiles
+    if ( m_pJobSystem )
+        m_pJobSystem->ParallelFor( DrawTilesJob, this, TileCount, TILE_JOB_GRAIN );
+    else
+        for ( ULONG t = 0; t < TileCount; t++ ) DrawTile( t );
+}
+
+//-----------------------------------------------------------------------------
+// Name : BinLine () (Private)
+// Desc : Visits every tile the line may touch, either counting it against
+//        the tile or (when scattering) storing its index in the tile's bin.
+// Note : A Bresenham pixel never strays more than half a pixel from the true
+//        line, so for each tile row we take the x range covered by the line
+//        over that row widened by half a pixel vertically, plus one pixel of
+//        margin horizontally. This is conservative, which is all that is
+//        required as each tile clips precisely.
+//-----------------------------------------------------------------------------
+void CTileRenderer::BinLine( ULONG Line, bool bScatter )
+{
+    const TILELINE & l = m_pLines[ Line ];
+    long   MinX = (l.X1 < l.X2) ? l.X1 : l.X2, MaxX = (l.X1 < l.X2) ? l.X2 : l.X1;
+    long   MinY = (l.Y1 < l.Y2) ? l.Y1 : l.Y2, MaxY = (l.Y1 < l.Y2) ? l.Y2 : l.Y1;
+    long   dx = l.X2 - l.X1, dy = l.Y2 - l.Y1;
+    long   Row0, Row1, Col0, Col1, RowTop, RowBottom, SpanL, SpanR;
+    double xa, xb;
+
+    // Restrict to the clip rectangle
+    if ( MinX < m_nClipLeft )       MinX = m_nClipLeft;
+    if ( MinY < m_nClipTop )        MinY = m_nClipTop;
+    if ( MaxX > m_nClipRight - 1 )  MaxX = m_nClipRight - 1;
+    if ( MaxY > m_nClipBottom - 1 ) MaxY = m_nClipBottom - 1;
+    if ( MinX > MaxX || MinY > MaxY ) return;
+
+    Row0 = MinY / TILE_SIZE; Row1 = MaxY / TILE_SIZE;
+    for ( long Row = Row0; Row <= Row1; Row++ )
+    {
+        // Horizontal span of the line within this tile row
+        if ( dy == 0 || Row0 == Row1 )
+        {
+            SpanL = MinX; SpanR = MaxX;
+
+        } // End if single row
+        else
+        {
+            RowTop    = (Row * TILE_SIZE > MinY) ? Row * TILE_SIZE : MinY;
+            RowBottom = (Row * TILE_SIZE + TILE_SIZE - 1 < MaxY) ? Row * TILE_SIZE + TILE_SIZE - 1 : MaxY;
+            xa = l.X1 + ((RowTop    - 0.5) - l.Y1) * (double)dx / (double)dy;
+            xb = l.X1 + ((RowBottom + 0.5) - l.Y1) * (double)dx / (double)dy;
+            if ( xa > xb ) { double t = xa; xa = xb; xb = t; }
+            SpanL = (xa - 1.0 > (double)MinX) ? (long)floor( xa - 1.0 ) : MinX;
+            SpanR = (xb + 1.0 < (double)MaxX) ? (long)ceil( xb + 1.0 )  : MaxX;
+            if ( SpanL > SpanR ) continue;
+
+        } // End if sloped
+
+        // Visit each tile in the span
+        Col0 = SpanL / TILE_SIZE; Col1 = SpanR / TILE_SIZE;
+        for ( long Col = Col0; Col <= Col1; Col++ )
+        {
+            ULONG Tile = (ULONG)Row * m_nTilesX + (ULONG)Col;
+            if ( bScatter )
+                m_pBins[ m_pTileFill[ Tile ]++ ] = Line;
+            else
+                m_pTileStart[ Tile ]++;
+
+        } // Next Column
+
+    } // Next Row
+}
+
+//-----------------------------------------------------------------------------
+// Name : BinTriangle () (Private)
+// Desc : Visits every tile overlapped by the triangle's bounding box, either
+//        counting it against the tile or storing its (flagged) index.
+// Note : Triangles rejected here (invalid or beyond the guard band) would be
+//        rejected by the rasterizer anyway.
+//-----------------------------------------------------------------------------
+void CTileRenderer::BinTriangle( ULONG Triangle, bool bScatter )
+{
+    const CScreenVertex * v = m_pTriangles[ Triangle ].Vertex;
+    float fMinX = v[0].x, fMaxX = v[0].x, fMinY = v[0].y, fMaxY = v[0].y;
+    long  MinX, MinY, MaxX, MaxY;
+
+    // Bounding box, rejecting NaN / anything outside the guard band
+    for ( int i = 0; i < 3; i++ )
+    {
+        if ( !(fabsf( v[i].x ) <= RASTER_TRIANGLE_GUARD && fabsf( v[i].y ) <= RASTER_TRIANGLE_GUARD) ) return;
+        if ( v[i].x < fMinX ) fMinX = v[i].x;
+        if ( v[i].x > fMaxX ) fMaxX = v[i].x;
+        if ( v[i].y < fMinY ) fMinY = v[i].y;
+        if ( v[i].y > fMaxY ) fMaxY = v[i].y;
+
+    } // Next Vertex
+
+    // Widened by a pixel, then restricted to the clip rectangle
+    MinX = (long)floorf( fMinX ) - 1; MaxX = (long)ceilf( fMaxX ) + 1;
+    MinY = (long)floorf( fMinY ) - 1; MaxY = (long)ceilf( fMaxY ) + 1;
+    if ( MinX < m_nClipLeft )       MinX = m_nClipLeft;
+    if ( MinY < m_nClipTop )        MinY = m_nClipTop;
+    if ( MaxX > m_nClipRight - 1 )  MaxX = m_nClipRight - 1;
+    if ( MaxY > m_nClipBottom - 1 ) MaxY = m_nClipBottom - 1;
+    if ( MinX > MaxX || MinY > MaxY ) return;
+
+    for ( long Row = MinY / TILE_SIZE; Row <= MaxY / TILE_SIZE; Row++ )
+    {
+        for ( long Col = MinX / TILE_SIZE; Col <= MaxX / TILE_SIZE; Col++ )
+        {
+            ULONG Tile = (ULONG)Row * m_nTilesX + (ULONG)Col;
+            if ( bScatter )
+                m_pBins[ m_pTileFill[ Tile ]++ ] = Triangle | TILE_TRIANGLE;
+            else
+                m_pTileStart[ Tile ]++;
+
+        } // Next Column
+
+    } // Next Row
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReserveBins () (Private)
+// Desc : Ensures the bin array can hold at least the number of entries
+//        specified, growing it geometrically if not.
+//-----------------------------------------------------------------------------
+bool CTileRenderer::ReserveBins( ULONG Count )
+{
+    ULONG nNewMax;
+
+    // Already large enough?
+    if ( Count <= m_nBinMax ) return true;
+
+    // Grow to at least double the current size
+    nNewMax = (m_nBinMax > 0) ? m_nBinMax * 2 : 4096;
+    if ( nNewMax < Count ) nNewMax = Count;
+
+    // Contents are rebuilt every frame, so there is nothing to copy
+    if ( m_pBins ) delete []m_pBins;
+    m_nBinMax = 0;
+    if (!( m_pBins = new (std::nothrow) ULONG[ nNewMax ] )) return false;
+    m_nBinMax = nNewMax;
+
+    // Success!
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawTile () (Private)
+// Desc : Draws every primitive binned into the tile, clipped to the tile.
+//-----------------------------------------------------------------------------
+void CTileRenderer::DrawTile( ULONG Tile )
+{
+    ULONG       First = m_pTileStart[ Tile ], Last = m_pTileStart[ Tile + 1 ];
+    long        Left  = (long)(Tile % m_nTilesX) * TILE_SIZE;
+    long        Top   = (long)(Tile / m_nTilesX) * TILE_SIZE;
+    CRasterizer Rasterizer;
+
+    // Anything to draw?
+    if ( First == Last ) return;
+
+    // Clip to the intersection of the tile and the clip rectangle
+    Rasterizer.SetRenderTarget( m_pFrameBuffer );
+    Rasterizer.SetClipRect( (Left > m_nClipLeft) ? Left : m_nClipLeft,
+                            (Top  > m_nClipTop)  ? Top  : m_nClipTop,
+                            (Left + TILE_SIZE < m_nClipRight)  ? Left + TILE_SIZE : m_nClipRight,
+                            (Top  + TILE_SIZE < m_nClipBottom) ? Top  + TILE_SIZE : m_nClipBottom );
+
+    // Draw the primitives in submission order
+    for ( ULONG i = First; i < Last; i++ )
+    {
+        if ( m_pBins[i] & TILE_TRIANGLE )
+        {
+            const TILETRIANGLE & t = m_pTriangles[ m_pBins[i] & ~TILE_TRIANGLE ];
+            Rasterizer.SetColor( t.Color );
+            Rasterizer.DrawTriangle( t.Vertex[0], t.Vertex[1], t.Vertex[2] );
+
+        } // End if triangle
+        else
+        {
+            const TILELINE & l = m_pLines[ m_pBins[i] ];
+            Rasterizer.SetColor( l.Color );
+            Rasterizer.DrawLine( l.X1, l.Y1, l.X2, l.Y2 );
+
+        } // End if line
+
+    } // Next Primitive
+}
+
+//-----------------------------------------------------------------------------
+// Name : DrawTilesJob () (Private, Static)
+// Desc : Job system entry point, draws a range of tiles.
+//-----------------------------------------------------------------------------
+void CTileRenderer::DrawTilesJob( void * pContext, ULONG Begin, ULONG End )
+{
+    PROFILE_ZONE( "DrawTiles" );
+    for ( ULONG t = Begin; t < End; t++ ) ((CTileRenderer*)pContext)->DrawTile( t );
+}
@@ -3,7 +3,10 @@
 //
 // Desc: This class handles all timing functionality. This includes counting
 //       the number of frames per second, to scaling vectors and values
-//       relative to the time that has passed since the previous frame.
+//       relative to the time that has passed since the previous frame, and
+//       holding the frame rate to a lock without burning a core to do so.
+//       Every frame time is also kept for statistics on the slowest frames,
+//       which an average frame rate hides.
 //
 // Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
 //-----------------------------------------------------------------------------
@@ -11,7 +14,53 @@
 //-----------------------------------------------------------------------------
 // CTimer Specific Includes
 //-----------------------------------------------------------------------------
-#include "..\\Includes\\CTimer.h"
+#include "../Includes/CTimer.h"
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : GetBucket () (Local)
+// Desc : Returns the histogram bucket a frame time falls in. Bucket 0 holds
+//        everything up to TIMER_BUCKET_MIN, each one after covers a further
+//        1 / TIMER_BUCKET_OCTAVE of a doubling, and the last everything over.
+//-----------------------------------------------------------------------------
+static ULONG GetBucket( float fTime )
+{
+    if ( fTime <= TIMER_BUCKET_MIN ) return 0;
+    float fBucket = log2f( fTime / TIMER_BUCKET_MIN ) * TIMER_BUCKET_OCTAVE + 1.0f;
+    return ( fBucket < (float)(TIMER_BUCKET_COUNT - 1) ) ? (ULONG)fBucket : TIMER_BUCKET_COUNT - 1;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetPercentile () (Local)
+// Desc : Returns the frame time below which the given fraction of a
+//        histogram's frames fall (and no more than the longest frame).
+// Note : Frames are taken as spread evenly through the bucket reached, on
+//        the same log scale as the buckets, rather than all at its middle;
+//        otherwise the result moves in whole bucket steps (over 4%) and a
+//        run cannot be compared closely with another.
+//-----------------------------------------------------------------------------
+static float GetPercentile( const ULONG pBuckets[], ULONG Frames, float fFraction, float fMax )
+{
+    ULONG Rank = (ULONG)ceilf( fFraction * Frames ), Count = 0, Bucket;
+    float fTime, fPosition = 0.5f;
+
+    if ( Rank == 0 ) Rank = 1;
+    for ( Bucket = 0; Bucket < TIMER_BUCKET_COUNT - 1; Bucket++ )
+    {
+        Count += pBuckets[ Bucket ];
+        if ( Count >= Rank ) break;
+
+    } // Next Bucket
+
+    // Place the rank among the frames in its bucket
+    if ( Count >= Rank && pBuckets[ Bucket ] > 0 )
+        fPosition = ((float)(Rank - (Count - pBuckets[ Bucket ])) - 0.5f) / (float)pBuckets[ Bucket ];
+
+    fTime = ( Bucket == 0 ) ? TIMER_BUCKET_MIN : TIMER_BUCKET_MIN * exp2f( ((float)Bucket - 1.0f + fPosition) / TIMER_BUCKET_OCTAVE );
+    return ( fTime < fMax ) ? fTime : fMax;
+}
 
 //-----------------------------------------------------------------------------
 // Name : CTimer () (Constructor)
@@ -37,9 +86,22 @@ CTimer::CTimer()
 
 	// Clear any needed values
     m_SampleCount       = 0;
+    m_SampleHead        = 0;
+    m_SampleTotal       = 0.0;
 	m_FrameRate			= 0;
 	m_FPSFrameCount		= 0;
 	m_FPSTimeElapsed	= 0.0f;
+    m_TimeElapsed       = 0.0f;
+    m_FixedStep         = 0.0f;
+
+    // Sleep in the bulk of locked frames, as finely as the system allows
+    m_Pacing            = PACING_ADAPTIVE;
+    m_SpinMargin        = TIMER_LOCK_MARGIN;
+    timeBeginPeriod( 1 );
+
+    // Start with no frames measured
+    m_HitchTime         = TIMER_HITCH_TIME;
+    ResetStats();
 }
 
 //-----------------------------------------------------------------------------
@@ -48,30 +110,22 @@ CTimer::CTimer()
 //-----------------------------------------------------------------------------
 CTimer::~CTimer()
 {
+    timeEndPeriod( 1 );
 }
 
 //-----------------------------------------------------------------------------
 // Name : Tick () 
 // Desc : Function which signals that frame has advanced
 // Note : You can specify a number of frames per second to lock the frame rate
-//        to. This will simply soak up the remaining time to hit that target.
+//        to. This will soak up the remaining time to hit that target, in the
+//        manner selected with SetPacing.
 //-----------------------------------------------------------------------------
 void CTimer::Tick( float fLockFPS )
 {
     float fTimeElapsed; 
 
-    // Is performance hardware available?
-	if ( m_PerfHardware ) 
-    {
-        // Query high-resolution performance hardware
-		QueryPerformanceCounter((LARGE_INTEGER *)&m_CurrentTime);
-	} 
-    else 
-    {
-        // Fall back to less accurate timer
-		m_CurrentTime = timeGetTime();
-
-	} // End If no hardware available
+    // Query the counter
+    m_CurrentTime = ReadCounter();
 
 	// Calculate elapsed time in seconds
 	fTimeElapsed = (m_CurrentTime - m_LastTime) * m_TimeScale;
@@ -80,39 +134,24 @@ void CTimer::Tick( float fLockFPS )
     //if ( fLockFPS == 0.0f ) fLockFPS = (1.0f / GetTimeElapsed()) + 20.0f;
     
     // Should we lock the frame rate ?
-    if ( fLockFPS > 0.0f )
-    {
-        while ( fTimeElapsed < (1.0f / fLockFPS))
-        {
-            // Is performance hardware available?
-	        if ( m_PerfHardware ) 
-            {
-                // Query high-resolution performance hardware
-		        QueryPerformanceCounter((LARGE_INTEGER*)&m_CurrentTime);
-	        } 
-            else 
-            {
-                // Fall back to less accurate timer
-		        m_CurrentTime = timeGetTime();
-
-	        } // End If no hardware available
-
-	        // Calculate elapsed time in seconds
-	        fTimeElapsed = (m_CurrentTime - m_LastTime) * m_TimeScale;
-
-        } // End While
-    } // End If
+    if ( fLockFPS > 0.0f && m_Pacing != PACING_UNCAPPED ) fTimeElapsed = WaitForFrame( fTimeElapsed, 1.0f / fLockFPS );
 
 	// Save current frame time
 	m_LastTime = m_CurrentTime;
 
+    // Every frame counts toward the statistics, however long
+    RecordFrame( fTimeElapsed );
+
     // Filter out values wildly different from current average
     if ( fabsf(fTimeElapsed - m_TimeElapsed) < 1.0f  )
     {
-        // Wrap FIFO frame time buffer.
-        memmove( &m_FrameTime[1], m_FrameTime, (MAX_SAMPLE_COUNT - 1) * sizeof(float) );
-        m_FrameTime[ 0 ] = fTimeElapsed;
-        if ( m_SampleCount < MAX_SAMPLE_COUNT ) m_SampleCount++;
+        // Replace the oldest sample in the ring once it is full, keeping
+        // the running total in step
+        if ( m_SampleCount == MAX_SAMPLE_COUNT ) m_SampleTotal -= m_FrameTime[ m_SampleHead ];
+        else m_SampleCount++;
+        m_FrameTime[ m_SampleHead ] = fTimeElapsed;
+        m_SampleTotal += fTimeElapsed;
+        m_SampleHead   = (m_SampleHead + 1) % MAX_SAMPLE_COUNT;
 
     } // End if
     
@@ -127,11 +166,209 @@ void CTimer::Tick( float fLockFPS )
 		m_FPSTimeElapsed	= 0.0f;
 	} // End If Second Elapsed
 
-    // Count up the new average elapsed time
-    m_TimeElapsed = 0.0f;
-    for ( ULONG i = 0; i < m_SampleCount; i++ ) m_TimeElapsed += m_FrameTime[ i ];
-    if ( m_SampleCount > 0 ) m_TimeElapsed /= m_SampleCount;
+    // The new average elapsed time
+    m_TimeElapsed = ( m_SampleCount > 0 ) ? (float)(m_SampleTotal / m_SampleCount) : 0.0f;
+
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFrameTime () 
+// Desc : Returns the time the last frame actually took (Seconds), which
+//        GetTimeElapsed smooths.
+//-----------------------------------------------------------------------------
+float CTimer::GetFrameTime() const
+{
+    if ( m_HistoryCount == 0 ) return 0.0f;
+    return m_History[ (m_HistoryHead + TIMER_HISTORY_SIZE - 1) % TIMER_HISTORY_SIZE ];
+}
+
+//-----------------------------------------------------------------------------
+// Name : ResetStats () 
+// Desc : Clears the pacing and frame time statistics, including the rolling
+//        window.
+//-----------------------------------------------------------------------------
+void CTimer::ResetStats()
+{
+    ZeroMemory( &m_Stats, sizeof(TIMERSTATS) );
+    ZeroMemory( m_WindowBuckets, sizeof(m_WindowBuckets) );
+    ZeroMemory( m_TotalBuckets, sizeof(m_TotalBuckets) );
+    m_HistoryCount  = 0;
+    m_HistoryHead   = 0;
+    m_TotalFrames   = 0;
+    m_TotalHitches  = 0;
+    m_TotalTime     = 0.0;
+    m_TotalMax      = 0.0f;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFrameStats () 
+// Desc : Retrieves frame time statistics over every frame since the last
+//        reset, or over the last TIMER_HISTORY_SIZE frames if bWindow is set.
+// Note : The window's mean, maximum and hitches are counted afresh from the
+//        ring (the hitch threshold may have changed since), a pass over a
+//        few kilobytes.
+//-----------------------------------------------------------------------------
+void CTimer::GetFrameStats( TIMERFRAMESTATS & Stats, bool bWindow ) const
+{
+    const ULONG * pBuckets = bWindow ? m_WindowBuckets : m_TotalBuckets;
+    double        fTotal   = m_TotalTime;
+
+    ZeroMemory( &Stats, sizeof(TIMERFRAMESTATS) );
+    if ( bWindow )
+    {
+        Stats.Frames = m_HistoryCount;
+        fTotal       = 0.0;
+        for ( ULONG i = 0; i < m_HistoryCount; i++ )
+        {
+            float fTime = m_History[ i ];
+            fTotal += fTime;
+            if ( fTime > Stats.Max ) Stats.Max = fTime;
+            if ( m_HitchTime > 0.0f && fTime > m_HitchTime ) Stats.Hitches++;
+
+        } // Next Frame
+
+    } // End if window
+    else
+    {
+        Stats.Frames  = m_TotalFrames;
+        Stats.Hitches = m_TotalHitches;
+        Stats.Max     = m_TotalMax;
+
+    } // End if total
+    if ( Stats.Frames == 0 ) return;
+
+    Stats.Mean = (float)(fTotal / Stats.Frames);
+    Stats.P50  = GetPercentile( pBuckets, Stats.Frames, 0.50f, Stats.Max );
+    Stats.P95  = GetPercentile( pBuckets, Stats.Frames, 0.95f, Stats.Max );
+    Stats.P99  = GetPercentile( pBuckets, Stats.Frames, 0.99f, Stats.Max );
+}
+
+//-----------------------------------------------------------------------------
+// Name : RecordFrame () (Private)
+// Desc : Adds a frame time to the statistics, replacing the oldest in the
+//        rolling window once it is full.
+//-----------------------------------------------------------------------------
+void CTimer::RecordFrame( float fTimeElapsed )
+{
+    ULONG Bucket = GetBucket( fTimeElapsed );
+
+    // Slide the window on
+    if ( m_HistoryCount == TIMER_HISTORY_SIZE ) m_WindowBuckets[ GetBucket( m_History[ m_HistoryHead ] ) ]--;
+    else m_HistoryCount++;
+    m_History[ m_HistoryHead ] = fTimeElapsed;
+    m_HistoryHead = (m_HistoryHead + 1) % TIMER_HISTORY_SIZE;
+    m_WindowBuckets[ Bucket ]++;
+
+    // Add it to the totals
+    m_TotalBuckets[ Bucket ]++;
+    m_TotalFrames++;
+    m_TotalTime += fTimeElapsed;
+    if ( fTimeElapsed > m_TotalMax  ) m_TotalMax = fTimeElapsed;
+    if ( m_HitchTime > 0.0f && fTimeElapsed > m_HitchTime ) m_TotalHitches++;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ReadCounter () (Private)
+// Desc : Returns the current counter value, from the performance hardware if
+//        available.
+//-----------------------------------------------------------------------------
+__int64 CTimer::ReadCounter() const
+{
+    __int64 Counter;
+
+    // Is performance hardware available?
+	if ( m_PerfHardware ) 
+    {
+        // Query high-resolution performance hardware
+		QueryPerformanceCounter((LARGE_INTEGER *)&Counter);
+	} 
+    else 
+    {
+        // Fall back to less accurate timer
+		Counter = timeGetTime();
+
+	} // End If no hardware available
+
+    return Counter;
+}
+
+//-----------------------------------------------------------------------------
+// Name : WaitForFrame () (Private)
+// Desc : Waits until fFrameTime has passed since the last frame, returning
+//        the time elapsed on leaving. Unless spinning throughout, the time
+//        to the deadline less the margin is slept, rounded to the nearest
+//        whole millisecond, and only the rest is spun.
+// Note : Rounding down would add up to a millisecond of spin to every
+//        frame, so the sleep is only ever cut back where it would leave
+//        less than TIMER_MIN_MARGIN before the deadline.
+// Note : PACING_ADAPTIVE raises its margin straight to any late wake up, so
+//        that the next frame is not overrun too, and lets it fall slowly
+//        back toward those seen since.
+//-----------------------------------------------------------------------------
+float CTimer::WaitForFrame( float fTimeElapsed, float fFrameTime )
+{
+    float   fMargin = ( m_Pacing == PACING_ADAPTIVE ) ? m_SpinMargin : TIMER_LOCK_MARGIN;
+    float   fRemaining = fFrameTime - fTimeElapsed, fError;
+    ULONG   Milliseconds = 0;
+    __int64 Start;
+
+    // Nothing to wait for if the frame has already overrun
+    m_Stats.Frames++;
+    if ( fTimeElapsed >= fFrameTime ) { m_Stats.LateFrames++; return fTimeElapsed; }
+
+    // Work out how many whole milliseconds can be slept
+    if ( m_Pacing != PACING_SPIN && fRemaining > fMargin )
+    {
+        Milliseconds = (ULONG)((fRemaining - fMargin) * 1000.0f + 0.5f);
+        while ( Milliseconds > 0 && Milliseconds * 0.001f > fRemaining - TIMER_MIN_MARGIN ) Milliseconds--;
+
+    } // End if may sleep
+
+    // Sleep through the bulk of it
+    if ( Milliseconds > 0 )
+    {
+        float fWakeError;
+
+        Start = m_CurrentTime;
+        Sleep( Milliseconds );
+        m_CurrentTime = ReadCounter();
+        fTimeElapsed  = (m_CurrentTime - m_LastTime) * m_TimeScale;
+
+        fWakeError = (m_CurrentTime - Start) * m_TimeScale - Milliseconds * 0.001f;
+        if ( fWakeError < 0.0f ) fWakeError = 0.0f;
+        m_Stats.Sleeps++;
+        m_Stats.SleepTime += (m_CurrentTime - Start) * m_TimeScale;
+        m_Stats.WakeError += fWakeError;
+        if ( fWakeError > m_Stats.WakeErrorMax ) m_Stats.WakeErrorMax = fWakeError;
+
+        // Adapt the margin to how late we woke
+        if ( m_Pacing == PACING_ADAPTIVE )
+        {
+            if ( fWakeError > m_SpinMargin ) m_SpinMargin = fWakeError;
+            else m_SpinMargin -= (m_SpinMargin - fWakeError) * TIMER_MARGIN_DECAY;
+            if ( m_SpinMargin < TIMER_MIN_MARGIN ) m_SpinMargin = TIMER_MIN_MARGIN;
+            if ( m_SpinMargin > TIMER_MAX_MARGIN ) m_SpinMargin = TIMER_MAX_MARGIN;
+
+        } // End if adaptive
+
+    } // End if sleeping
+
+    // Spin out the remainder
+    Start = m_CurrentTime;
+    while ( fTimeElapsed < fFrameTime )
+    {
+        m_CurrentTime = ReadCounter();
+        fTimeElapsed  = (m_CurrentTime - m_LastTime) * m_TimeScale;
+
+    } // End While
+    m_Stats.SpinTime += (m_CurrentTime - Start) * m_TimeScale;
+
+    // Record how far past the deadline we are
+    fError = fTimeElapsed - fFrameTime;
+    m_Stats.PacingError += fError;
+    if ( fError > m_Stats.PacingErrorMax ) m_Stats.PacingErrorMax = fError;
 
+    return fTimeElapsed;
 }
 
 //-----------------------------------------------------------------------------
@@ -158,9 +395,12 @@ unsigned long CTimer::GetFrameRate( LPTSTR lpszString ) const
 //-----------------------------------------------------------------------------
 // Name : GetTimeElapsed () 
 // Desc : Returns the amount of time elapsed since the last frame (Seconds)
+// Note : With a fixed step set, this is the step however long frames
+//        actually take, so that runs are reproducible.
 //-----------------------------------------------------------------------------
 float CTimer::GetTimeElapsed() const
 {
+    if ( m_FixedStep > 0.0f ) return m_FixedStep;
     return m_TimeElapsed;
 
 }
@@ -0,0 +1,528 @@
+//-----------------------------------------------------------------------------
+// File: CTransformStage.cpp
+//
+// Desc: Vertex transformation stage. Takes object space vertices all the way
+//       through to screen space using a single concatenated matrix.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTransformStage Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CTransformStage.h"
+#include <float.h>
+
+#ifdef TRANSFORM_SIMD_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER) && defined(TRANSFORM_SIMD_SSE2)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : TransformScalar () (Local)
+// Desc : Reference kernel, transforms one vertex at a time.
+//-----------------------------------------------------------------------------
+static void TransformScalar( const D3DXMATRIX & m, const CVertex * pVertices, CScreenVertex * pOut, ULONG Count )
+{
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const CVertex & v = pVertices[i];
+
+        // Transform to (viewport scaled) clip space
+        float x = v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41;
+        float y = v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42;
+        float z = v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43;
+        float w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+
+        // Single divide through to screen space
+        float rhw = 1.0f / w;
+        pOut[i].x = x * rhw;
+        pOut[i].y = y * rhw;
+        pOut[i].z = z * rhw;
+        pOut[i].w = w;
+
+    } // Next Vertex
+}
+
+#ifdef TRANSFORM_SIMD_SSE2
+//-----------------------------------------------------------------------------
+// Name : TransformSSE2 () (Local)
+// Desc : Transforms four vertices at a time. The packed x/y/z triples are
+//        transposed into x, y and z registers on load, and the results
+//        transposed back into CScreenVertex order on store.
+//-----------------------------------------------------------------------------
+static void TransformSSE2( const D3DXMATRIX & m, const CVertex * pVertices, CScreenVertex * pOut, ULONG Count )
+{
+    __m128 m11 = _mm_set1_ps( m._11 ), m12 = _mm_set1_ps( m._12 ), m13 = _mm_set1_ps( m._13 ), m14 = _mm_set1_ps( m._14 );
+    __m128 m21 = _mm_set1_ps( m._21 ), m22 = _mm_set1_ps( m._22 ), m23 = _mm_set1_ps( m._23 ), m24 = _mm_set1_ps( m._24 );
+    __m128 m31 = _mm_set1_ps( m._31 ), m32 = _mm_set1_ps( m._32 ), m33 = _mm_set1_ps( m._33 ), m34 = _mm_set1_ps( m._34 );
+    __m128 m41 = _mm_set1_ps( m._41 ), m42 = _mm_set1_ps( m._42 ), m43 = _mm_set1_ps( m._43 ), m44 = _mm_set1_ps( m._44 );
+    __m128 One = _mm_set1_ps( 1.0f );
+    ULONG  i;
+
+    for ( i = 0; i + 4 <= Count; i += 4 )
+    {
+        const float * pIn = &pVertices[i].x;
+        float       * pDst = &pOut[i].x;
+
+        // a = x0 y0 z0 x1, b = y1 z1 x2 y2, c = z2 x3 y3 z3
+        __m128 a = _mm_loadu_ps( pIn );
+        __m128 b = _mm_loadu_ps( pIn + 4 );
+        __m128 c = _mm_loadu_ps( pIn + 8 );
+
+        // Transpose into x0..x3, y0..y3, z0..z3
+        __m128 t = _mm_shuffle_ps( b, c, _MM_SHUFFLE( 2, 1, 3, 2 ) );    // x2 y2 x3 y3
+        __m128 X = _mm_shuffle_ps( a, t, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+        __m128 Y = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), t, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        __m128 Z = _mm_shuffle_ps( _mm_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ),
+                                   _mm_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+        // Transform, evaluated in the same order as the scalar kernel
+        __m128 x = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, m11 ), _mm_mul_ps( Y, m21 ) ), _mm_mul_ps( Z, m31 ) ), m41 );
+        __m128 y = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, m12 ), _mm_mul_ps( Y, m22 ) ), _mm_mul_ps( Z, m32 ) ), m42 );
+        __m128 z = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, m13 ), _mm_mul_ps( Y, m23 ) ), _mm_mul_ps( Z, m33 ) ), m43 );
+        __m128 w = _mm_add_ps( _mm_add_ps( _mm_add_ps( _mm_mul_ps( X, m14 ), _mm_mul_ps( Y, m24 ) ), _mm_mul_ps( Z, m34 ) ), m44 );
+
+        // Divide through
+        __m128 rhw = _mm_div_ps( One, w );
+        x = _mm_mul_ps( x, rhw );
+        y = _mm_mul_ps( y, rhw );
+        z = _mm_mul_ps( z, rhw );
+
+        // Transpose back to x y z w per vertex and store
+        __m128 xy0 = _mm_unpacklo_ps( x, y ), xy1 = _mm_unpackhi_ps( x, y );
+        __m128 zw0 = _mm_unpacklo_ps( z, w ), zw1 = _mm_unpackhi_ps( z, w );
+        _mm_storeu_ps( pDst,      _mm_movelh_ps( xy0, zw0 ) );
+        _mm_storeu_ps( pDst + 4,  _mm_movehl_ps( zw0, xy0 ) );
+        _mm_storeu_ps( pDst + 8,  _mm_movelh_ps( xy1, zw1 ) );
+        _mm_storeu_ps( pDst + 12, _mm_movehl_ps( zw1, xy1 ) );
+
+    } // Next Batch
+
+    // Remaining vertices
+    TransformScalar( m, pVertices + i, pOut + i, Count - i );
+}
+
+//-----------------------------------------------------------------------------
+// Name : CPUSupportsAVX2 () (Local)
+// Desc : Determine whether both the CPU and the OS support AVX2.
+//-----------------------------------------------------------------------------
+static bool CPUSupportsAVX2( )
+{
+#if defined(_MSC_VER)
+    int Info[4];
+
+    __cpuid( Info, 0 );
+    if ( Info[0] < 7 ) return false;
+
+    // OS must have enabled XSAVE, and be saving the YMM registers
+    __cpuid( Info, 1 );
+    if ( (Info[2] & (1 << 27)) == 0 || (Info[2] & (1 << 28)) == 0 ) return false;
+    if ( (_xgetbv( 0 ) & 6) != 6 ) return false;
+
+    __cpuidex( Info, 7, 0 );
+    return (Info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports( "avx2" ) != 0;
+#else
+    return false;
+#endif
+}
+#endif // TRANSFORM_SIMD_SSE2
+
+//-----------------------------------------------------------------------------
+// Name : CTransformStage () (Constructor)
+// Desc : CTransformStage Class Constructor
+//-----------------------------------------------------------------------------
+CTransformStage::CTransformStage()
+{
+	// Reset / Clear all required values
+    D3DXMatrixIdentity( &m_mtxViewport );
+    D3DXMatrixIdentity( &m_mtxViewProj );
+    D3DXMatrixIdentity( &m_mtxViewProjView );
+    D3DXMatrixIdentity( &m_mtxWorldViewProj );
+    D3DXMatrixIdentity( &m_mtxCombined );
+    m_Kernel        = TRANSFORM_SCALAR;
+    m_pfnTransform  = TransformScalar;
+
+    // Use the widest kernel available
+    SetKernel( GetBestKernel() );
+}
+
+//-----------------------------------------------------------------------------
+// Name : ~CTransformStage () (Destructor)
+// Desc : CTransformStage Class Destructor
+//-----------------------------------------------------------------------------
+CTransformStage::~CTransformStage()
+{
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetViewport ()
+// Desc : Builds the matrix which maps clip space into the viewport.
+// Note : Applied before the divide, x' = x * Scale + w * Offset, so that the
+//        divide by w yields the final pixel position directly. Call this
+//        before SetViewProjection.
+//-----------------------------------------------------------------------------
+void CTransformStage::SetViewport( ULONG X, ULONG Y, ULONG Width, ULONG Height )
+{
+    D3DXMatrixIdentity( &m_mtxViewport );
+    m_mtxViewport._11 =  (float)Width  / 2.0f;
+    m_mtxViewport._22 = -(float)Height / 2.0f;
+    m_mtxViewport._41 =  (float)(X + Width  / 2);
+    m_mtxViewport._42 =  (float)(Y + Height / 2);
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetViewProjection ()
+// Desc : Caches the view * projection * viewport matrix for the frame.
+//-----------------------------------------------------------------------------
+void CTransformStage::SetViewProjection( const D3DXMATRIX & mtxView, const D3DXMATRIX & mtxProjection )
+{
+    D3DXMatrixMultiply( &m_mtxViewProj, &mtxView, &mtxProjection );
+    D3DXMatrixMultiply( &m_mtxViewProjView, &m_mtxViewProj, &m_mtxViewport );
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetWorld ()
+// Desc : Concatenates the object's world matrix onto the cached frame matrix.
+//        Called once per object, per frame.
+//-----------------------------------------------------------------------------
+void CTransformStage::SetWorld( const D3DXMATRIX & mtxWorld )
+{
+    D3DXMatrixMultiply( &m_mtxCombined, &mtxWorld, &m_mtxViewProjView );
+    D3DXMatrixMultiply( &m_mtxWorldViewProj, &mtxWorld, &m_mtxViewProj );
+}
+
+//-----------------------------------------------------------------------------
+// Name : Transform ()
+// Desc : Transforms the vertices specified into screen space.
+//-----------------------------------------------------------------------------
+void CTransformStage::Transform( const CVertex * pVertices, CScreenVertex * pOut, ULONG Count ) const
+{
+    m_pfnTransform( m_mtxCombined, pVertices, pOut, Count );
+}
+
+//-----------------------------------------------------------------------------
+// Name : TransformHomogeneous ()
+// Desc : Transforms the vertices specified into (viewport scaled) clip space,
+//        without the divide, ready for clipping.
+//-----------------------------------------------------------------------------
+void CTransformStage::TransformHomogeneous( const CVertex * pVertices, CClipVertex * pOut, ULONG Count ) const
+{
+    const D3DXMATRIX & m = m_mtxCombined;
+
+    for ( ULONG i = 0; i < Count; i++ )
+    {
+        const CVertex & v = pVertices[i];
+
+        // Same evaluation order as the transform kernels
+        pOut[i].x = v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41;
+        pOut[i].y = v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42;
+        pOut[i].z = v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43;
+        pOut[i].w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+
+    } // Next Vertex
+}
+
+//-----------------------------------------------------------------------------
+// Name : Project () (Static)
+// Desc : Divides a clip space vertex through to screen space.
+// Note : Matches the transform kernels exactly, so a vertex projected here
+//        lands on the same pixel as one output by Transform.
+//-----------------------------------------------------------------------------
+void CTransformStage::Project( const CClipVertex & In, CScreenVertex & Out )
+{
+    float rhw = 1.0f / In.w;
+    Out.x = In.x * rhw;
+    Out.y = In.y * rhw;
+    Out.z = In.z * rhw;
+    Out.w = In.w;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetClipCode () (Static)
+// Desc : Returns the FRUSTUM_ flags of the planes the clip space vertex lies
+//        outside of. The side planes are not the frustum's own, but a guard
+//        band fGuardBand pixels either side of the screen origin, beyond
+//        which the rasterizer cannot represent coordinates.
+//-----------------------------------------------------------------------------
+ULONG CTransformStage::GetClipCode( const CClipVertex & Vertex, float fGuardBand )
+{
+    float Guard = fGuardBand * Vertex.w;
+    ULONG Code  = 0;
+
+    if ( Vertex.z < 0.0f )          Code |= FRUSTUM_NEAR;
+    if ( Vertex.z > Vertex.w )      Code |= FRUSTUM_FAR;
+    if ( Vertex.x < -Guard )        Code |= FRUSTUM_LEFT;
+    if ( Vertex.x >  Guard )        Code |= FRUSTUM_RIGHT;
+    if ( Vertex.y < -Guard )        Code |= FRUSTUM_TOP;
+    if ( Vertex.y >  Guard )        Code |= FRUSTUM_BOTTOM;
+    return Code;
+}
+
+//-----------------------------------------------------------------------------
+// Name : ClipTriangle () (Static)
+// Desc : Clips a clip space triangle against the near and far planes, then
+//        the guard band (see GetClipCode), returning the number of vertices
+//        of the resulting convex polygon written to pOut (zero if nothing
+//        remains). pOut must hold TRANSFORM_CLIP_MAX vertices.
+// Note : Sutherland-Hodgman, each plane adding at most one vertex. The near
+//        plane goes first so that w is positive for every later plane.
+//-----------------------------------------------------------------------------
+ULONG CTransformStage::ClipTriangle( const CClipVertex * pIn, CClipVertex * pOut, float fGuardBand )
+{
+    CClipVertex   Buffer[ TRANSFORM_CLIP_MAX ];
+    ULONG         Count = 3;
+
+    // Start in pOut, the six planes ping-pong back into it
+    pOut[0] = pIn[0]; pOut[1] = pIn[1]; pOut[2] = pIn[2];
+
+    for ( ULONG Plane = 0; Plane < 6 && Count > 0; Plane++ )
+    {
+        const CClipVertex * pSrc = (Plane & 1) ? Buffer : pOut;
+        CClipVertex       * pDst = (Plane & 1) ? pOut : Buffer;
+        ULONG               nOut = 0;
+        float               d0, d1;
+
+        for ( ULONG i = 0; i < Count; i++ )
+        {
+            const CClipVertex & v0 = pSrc[i], & v1 = pSrc[ (i + 1) % Count ];
+
+            // Signed distance of each end from the plane, positive inside
+            switch ( Plane )
+            {
+                case 0:  d0 = v0.z;                        d1 = v1.z;                        break;
+                case 1:  d0 = v0.w - v0.z;                 d1 = v1.w - v1.z;                 break;
+                case 2:  d0 = v0.x + fGuardBand * v0.w;    d1 = v1.x + fGuardBand * v1.w;    break;
+                case 3:  d0 = fGuardBand * v0.w - v0.x;    d1 = fGuardBand * v1.w - v1.x;    break;
+                case 4:  d0 = v0.y + fGuardBand * v0.w;    d1 = v1.y + fGuardBand * v1.w;    break;
+                default: d0 = fGuardBand * v0.w - v0.y;    d1 = fGuardBand * v1.w - v1.y;    break;
+
+            } // End Switch
+
+            // Keep inside vertices, and add the crossing point of edges which cross.
+            // The crossing is always measured from the inside end, so that the
+            // triangles either side of a shared edge agree on it exactly.
+            if ( d0 >= 0.0f ) pDst[ nOut++ ] = v0;
+            if ( (d0 >= 0.0f) != (d1 >= 0.0f) )
+            {
+                const CClipVertex & a = (d0 >= 0.0f) ? v0 : v1, & b = (d0 >= 0.0f) ? v1 : v0;
+                float               t = (d0 >= 0.0f) ? d0 / (d0 - d1) : d1 / (d1 - d0);
+                CClipVertex       & v = pDst[ nOut++ ];
+
+                v.x = a.x + (b.x - a.x) * t;
+                v.y = a.y + (b.y - a.y) * t;
+                v.z = a.z + (b.z - a.z) * t;
+                v.w = a.w + (b.w - a.w) * t;
+
+            } // End if crossing
+
+        } // Next Edge
+        Count = nOut;
+
+    } // Next Plane
+
+    return Count;
+}
+
+//-----------------------------------------------------------------------------
+// Name : TestBounds ()
+// Desc : Classifies an object space bounding box against the view frustum
+//        of the current world matrix. If pPlanes is supplied, it receives
+//        the FRUSTUM_ flags of the planes which the box straddles.
+// Note : The planes are taken straight from the columns of the world * view
+//        * projection matrix (-w <= x <= w, -w <= y <= w, 0 <= z <= w), so
+//        they are already in object space and no vertex need be transformed.
+//        For each plane only the box corner furthest along the plane normal
+//        (to reject) and the one furthest against it (to accept) are tested.
+//-----------------------------------------------------------------------------
+CULLRESULT CTransformStage::TestBounds( const CBounds & Bounds, ULONG * pPlanes ) const
+{
+    const D3DXVECTOR3 & Min = Bounds.m_vecMin, & Max = Bounds.m_vecMax;
+    ULONG               Straddled = 0;
+    D3DXPLANE           Planes[6];
+
+    // Plane coefficients, in object space
+    GetFrustumPlanes( m_mtxWorldViewProj, Planes );
+
+    // Nothing to test?
+    if ( pPlanes ) *pPlanes = 0;
+    if ( Bounds.IsEmpty() ) return CULL_OUTSIDE;
+
+    for ( ULONG i = 0; i < 6; i++ )
+    {
+        const float * p = &Planes[i].a;
+
+        // Corner furthest inside the plane, if that is outside so is the box
+        float fInside  = p[0] * (p[0] > 0.0f ? Max.x : Min.x) + p[1] * (p[1] > 0.0f ? Max.y : Min.y) +
+                         p[2] * (p[2] > 0.0f ? Max.z : Min.z) + p[3];
+        if ( fInside < 0.0f ) return CULL_OUTSIDE;
+
+        // Corner furthest outside the plane, if that is outside the box straddles it
+        float fOutside = p[0] * (p[0] > 0.0f ? Min.x : Max.x) + p[1] * (p[1] > 0.0f ? Min.y : Max.y) +
+                         p[2] * (p[2] > 0.0f ? Min.z : Max.z) + p[3];
+        if ( fOutside < 0.0f ) Straddled |= (1 << i);
+
+    } // Next Plane
+
+    if ( pPlanes ) *pPlanes = Straddled;
+    return (Straddled != 0) ? CULL_INTERSECT : CULL_INSIDE;
+}
+
+//-----------------------------------------------------------------------------
+// Name : SetKernel ()
+// Desc : Selects the kernel used by Transform.
+// Note : Returns false, leaving the current kernel in place, if the kernel
+//        requested is not supported on this machine.
+//-----------------------------------------------------------------------------
+bool CTransformStage::SetKernel( TRANSFORMKERNEL Kernel )
+{
+    if ( !IsKernelSupported( Kernel ) ) return false;
+
+    switch ( Kernel )
+    {
+#ifdef TRANSFORM_SIMD_SSE2
+        case TRANSFORM_SSE2:
+            m_pfnTransform = TransformSSE2;
+            break;
+
+        case TRANSFORM_AVX2:
+            m_pfnTransform = GetTransformKernelAVX2();
+            break;
+#endif
+        default:
+            m_pfnTransform = TransformScalar;
+            break;
+
+    } // End Switch
+
+    m_Kernel = Kernel;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+// Name : IsKernelSupported () (Static)
+// Desc : Determine whether the specified kernel was compiled in, and whether
+//        the CPU we are running on is able to execute it.
+//-----------------------------------------------------------------------------
+bool CTransformStage::IsKernelSupported( TRANSFORMKERNEL Kernel )
+{
+    switch ( Kernel )
+    {
+        case TRANSFORM_SCALAR:
+            return true;
+
+#ifdef TRANSFORM_SIMD_SSE2
+        case TRANSFORM_SSE2:
+            return true;
+
+        case TRANSFORM_AVX2:
+        {
+            static const bool bAVX2 = (GetTransformKernelAVX2() != NULL) && CPUSupportsAVX2();
+            return bAVX2;
+        }
+#endif
+        default:
+            return false;
+
+    } // End Switch
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetBestKernel () (Static)
+// Desc : Returns the widest kernel supported on this machine.
+//-----------------------------------------------------------------------------
+TRANSFORMKERNEL CTransformStage::GetBestKernel( )
+{
+    if ( IsKernelSupported( TRANSFORM_AVX2 ) ) return TRANSFORM_AVX2;
+    if ( IsKernelSupported( TRANSFORM_SSE2 ) ) return TRANSFORM_SSE2;
+    return TRANSFORM_SCALAR;
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetKernelName () (Static)
+// Desc : Returns a printable name for the specified kernel.
+//-----------------------------------------------------------------------------
+const char * CTransformStage::GetKernelName( TRANSFORMKERNEL Kernel )
+{
+    switch ( Kernel )
+    {
+        case TRANSFORM_SCALAR: return "scalar";
+        case TRANSFORM_SSE2:   return "sse2";
+        case TRANSFORM_AVX2:   return "avx2";
+        default:               return "unknown";
+
+    } // End Switch
+}
+
+//-----------------------------------------------------------------------------
+// Name : GetFrustumPlanes () (Static)
+// Desc : Extracts the six frustum planes (in FRUSTUM_ flag order) from the
+//        columns of a projection matrix, in whichever space the matrix
+//        transforms from. Points on the positive side of every plane are
+//        inside (-w <= x <= w, -w <= y <= w, 0 <= z <= w). The planes are
+//        not normalised.
+//-----------------------------------------------------------------------------
+void CTransformStage::GetFrustumPlanes( const D3DXMATRIX & m, D3DXPLANE * pPlanes )
+{
+    pPlanes[0] = D3DXPLANE( m._14 + m._11, m._24 + m._21, m._34 + m._31, m._44 + m._41 );  // Left
+    pPlanes[1] = D3DXPLANE( m._14 - m._11, m._24 - m._21, m._34 - m._31, m._44 - m._41 );  // Right
+    pPlanes[2] = D3DXPLANE( m._14 + m._12, m._24 + m._22, m._34 + m._32, m._44 + m._42 );  // Bottom
+    pPlanes[3] = D3DXPLANE( m._14 - m._12, m._24 - m._22, m._34 - m._32, m._44 - m._42 );  // Top
+    pPlanes[4] = D3DXPLANE( m._13,         m._23,         m._33,         m._43         );  // Near
+    pPlanes[5] = D3DXPLANE( m._14 - m._13, m._24 - m._23, m._34 - m._33, m._44 - m._43 );  // Far
+}
+
+//-----------------------------------------------------------------------------
+// Name : ProjectBounds ()
+// Desc : Projects the eight corners of an object space bounding box with the
+//        current world matrix, returning the screen rectangle enclosing them
+//        and their nearest depth.
+// Note : Returns false if any corner lies in front of the near plane, as the
+//        projected rectangle would then be meaningless.
+//-----------------------------------------------------------------------------
+bool CTransformStage::ProjectBounds( const CBounds & Bounds, SCREENRECT & Rect ) const
+{
+    const D3DXMATRIX  & m = m_mtxCombined;
+    const D3DXVECTOR3 & Min = Bounds.m_vecMin, & Max = Bounds.m_vecMax;
+
+    if ( Bounds.IsEmpty() ) return false;
+
+    Rect.Left = Rect.Top = Rect.MinZ = FLT_MAX;
+    Rect.Right = Rect.Bottom = -FLT_MAX;
+
+    for ( ULONG i = 0; i < 8; i++ )
+    {
+        float x = (i & 1) ? Max.x : Min.x;
+        float y = (i & 2) ? Max.y : Min.y;
+        float z = (i & 4) ? Max.z : Min.z;
+
+        // Clip space position of the corner
+        float cx = x * m._11 + y * m._21 + z * m._31 + m._41;
+        float cy = x * m._12 + y * m._22 + z * m._32 + m._42;
+        float cz = x * m._13 + y * m._23 + z * m._33 + m._43;
+        float cw = x * m._14 + y * m._24 + z * m._34 + m._44;
+        if ( cz < 0.0f || cw <= 0.0f ) return false;
+
+        // Divide through and grow the rectangle
+        float rhw = 1.0f / cw;
+        cx *= rhw; cy *= rhw; cz *= rhw;
+        if ( cx < Rect.Left   ) Rect.Left   = cx;
+        if ( cx > Rect.Right  ) Rect.Right  = cx;
+        if ( cy < Rect.Top    ) Rect.Top    = cy;
+        if ( cy > Rect.Bottom ) Rect.Bottom = cy;
+        if ( cz < Rect.MinZ   ) Rect.MinZ   = cz;
+
+    } // Next Corner
+
+    return true;
+}
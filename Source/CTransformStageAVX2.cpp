@@ -0,0 +1,115 @@
+//-----------------------------------------------------------------------------
+// File: CTransformStageAVX2.cpp
+//
+// Desc: AVX2 vertex transform kernel. Kept in its own file so that only this
+//       code is compiled for AVX2, the rest of the engine must still run on
+//       machines without it.
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// CTransformStageAVX2 Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/CTransformStage.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : TransformAVX2 () (Local)
+// Desc : Transforms eight vertices at a time. Each 128 bit lane holds four of
+//        the vertices, so the transposes are the same as the SSE2 kernel.
+//-----------------------------------------------------------------------------
+static void TransformAVX2( const D3DXMATRIX & m, const CVertex * pVertices, CScreenVertex * pOut, ULONG Count )
+{
+    __m256 m11 = _mm256_set1_ps( m._11 ), m12 = _mm256_set1_ps( m._12 ), m13 = _mm256_set1_ps( m._13 ), m14 = _mm256_set1_ps( m._14 );
+    __m256 m21 = _mm256_set1_ps( m._21 ), m22 = _mm256_set1_ps( m._22 ), m23 = _mm256_set1_ps( m._23 ), m24 = _mm256_set1_ps( m._24 );
+    __m256 m31 = _mm256_set1_ps( m._31 ), m32 = _mm256_set1_ps( m._32 ), m33 = _mm256_set1_ps( m._33 ), m34 = _mm256_set1_ps( m._34 );
+    __m256 m41 = _mm256_set1_ps( m._41 ), m42 = _mm256_set1_ps( m._42 ), m43 = _mm256_set1_ps( m._43 ), m44 = _mm256_set1_ps( m._44 );
+    __m256 One = _mm256_set1_ps( 1.0f );
+    ULONG  i;
+
+    for ( i = 0; i + 8 <= Count; i += 8 )
+    {
+        const float * pIn = &pVertices[i].x;
+        float       * pDst = &pOut[i].x;
+
+        // Load 24 floats, then rearrange so that vertices 0..3 sit in the low
+        // lane and 4..7 in the high lane of each register
+        __m256 r0 = _mm256_loadu_ps( pIn );
+        __m256 r1 = _mm256_loadu_ps( pIn + 8 );
+        __m256 r2 = _mm256_loadu_ps( pIn + 16 );
+        __m256 a  = _mm256_permute2f128_ps( r0, r1, 0x30 );            // x0 y0 z0 x1 | x4 y4 z4 x5
+        __m256 b  = _mm256_permute2f128_ps( r0, r2, 0x21 );            // y1 z1 x2 y2 | y5 z5 x6 y6
+        __m256 c  = _mm256_permute2f128_ps( r1, r2, 0x30 );            // z2 x3 y3 z3 | z6 x7 y7 z7
+
+        // Transpose into x, y and z registers
+        __m256 t = _mm256_shuffle_ps( b, c, _MM_SHUFFLE( 2, 1, 3, 2 ) );
+        __m256 X = _mm256_shuffle_ps( a, t, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+        __m256 Y = _mm256_shuffle_ps( _mm256_shuffle_ps( a, b, _MM_SHUFFLE( 0, 0, 1, 1 ) ), t, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+        __m256 Z = _mm256_shuffle_ps( _mm256_shuffle_ps( a, b, _MM_SHUFFLE( 1, 1, 2, 2 ) ),
+                                      _mm256_shuffle_ps( c, c, _MM_SHUFFLE( 3, 3, 0, 0 ) ), _MM_SHUFFLE( 2, 0, 2, 0 ) );
+
+        // Transform, evaluated in the same order as the scalar kernel
+        __m256 x = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( X, m11 ), _mm256_mul_ps( Y, m21 ) ), _mm256_mul_ps( Z, m31 ) ), m41 );
+        __m256 y = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( X, m12 ), _mm256_mul_ps( Y, m22 ) ), _mm256_mul_ps( Z, m32 ) ), m42 );
+        __m256 z = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( X, m13 ), _mm256_mul_ps( Y, m23 ) ), _mm256_mul_ps( Z, m33 ) ), m43 );
+        __m256 w = _mm256_add_ps( _mm256_add_ps( _mm256_add_ps( _mm256_mul_ps( X, m14 ), _mm256_mul_ps( Y, m24 ) ), _mm256_mul_ps( Z, m34 ) ), m44 );
+
+        // Divide through
+        __m256 rhw = _mm256_div_ps( One, w );
+        x = _mm256_mul_ps( x, rhw );
+        y = _mm256_mul_ps( y, rhw );
+        z = _mm256_mul_ps( z, rhw );
+
+        // Transpose back within each lane (v0 | v4, v1 | v5, ...)
+        __m256 xy0 = _mm256_unpacklo_ps( x, y ), xy1 = _mm256_unpackhi_ps( x, y );
+        __m256 zw0 = _mm256_unpacklo_ps( z, w ), zw1 = _mm256_unpackhi_ps( z, w );
+        __m256 v0  = _mm256_shuffle_ps( xy0, zw0, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+        __m256 v1  = _mm256_shuffle_ps( xy0, zw0, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+        __m256 v2  = _mm256_shuffle_ps( xy1, zw1, _MM_SHUFFLE( 1, 0, 1, 0 ) );
+        __m256 v3  = _mm256_shuffle_ps( xy1, zw1, _MM_SHUFFLE( 3, 2, 3, 2 ) );
+
+        // Pair up the lanes into consecutive vertices and store
+        _mm256_storeu_ps( pDst,      _mm256_permute2f128_ps( v0, v1, 0x20 ) );
+        _mm256_storeu_ps( pDst + 8,  _mm256_permute2f128_ps( v2, v3, 0x20 ) );
+        _mm256_storeu_ps( pDst + 16, _mm256_permute2f128_ps( v0, v1, 0x31 ) );
+        _mm256_storeu_ps( pDst + 24, _mm256_permute2f128_ps( v2, v3, 0x31 ) );
+
+    } // Next Batch
+
+    // Remaining vertices, one at a time (same arithmetic as the scalar kernel)
+    for ( ; i < Count; i++ )
+    {
+        const CVertex & v = pVertices[i];
+        float x = v.x * m._11 + v.y * m._21 + v.z * m._31 + m._41;
+        float y = v.x * m._12 + v.y * m._22 + v.z * m._32 + m._42;
+        float z = v.x * m._13 + v.y * m._23 + v.z * m._33 + m._43;
+        float w = v.x * m._14 + v.y * m._24 + v.z * m._34 + m._44;
+        float rhw = 1.0f / w;
+        pOut[i].x = x * rhw;
+        pOut[i].y = y * rhw;
+        pOut[i].z = z * rhw;
+        pOut[i].w = w;
+
+    } // Next Vertex
+}
+#endif // __AVX2__
+
+//-----------------------------------------------------------------------------
+// Name : GetTransformKernelAVX2 ()
+// Desc : Returns the AVX2 kernel, or NULL if this file was not compiled with
+//        AVX2 enabled. The caller must still check that the CPU supports it.
+//-----------------------------------------------------------------------------
+TRANSFORMFUNC GetTransformKernelAVX2( )
+{
+#ifdef __AVX2__
+    return TransformAVX2;
+#else
+    return NULL;
+#endif
+}
@@ -9,14 +9,15 @@
 //-----------------------------------------------------------------------------
 // Main Module Includes
 //-----------------------------------------------------------------------------
-#include "..\\Includes\\Main.h"
-#include "..\\Includes\\CGameApp.h"
+#include "../Includes/Main.h"
+#include "../Includes/CGameApp.h"
 
 //-----------------------------------------------------------------------------
 // Global Variable Definitions
 //-----------------------------------------------------------------------------
 CGameApp    g_App;      // Core game application processing engine
 
+#ifdef _WIN32
 //-----------------------------------------------------------------------------
 // Name : WinMain() (Application Entry Point)
 // Desc : Entry point for program, App flow starts here.
@@ -37,4 +38,40 @@ int WINAPI _tWinMain( HINSTANCE hInstance, HINSTANCE hPrevInstance, LPTSTR lpCmd
     // Return the correct exit code.
     return retCode;
 
-}
\ No newline at end of file
+}
+#else
+//-----------------------------------------------------------------------------
+// Name : main() (Application Entry Point)
+// Desc : Entry point for platforms without Win32 support. The arguments are
+//        re-assembled into a single command line, and the engine is run
+//        headless.
+//-----------------------------------------------------------------------------
+int main( int argc, char * argv[] )
+{
+    static char szCmdLine[ 1024 ];
+    int retCode;
+
+    // Build the command line
+    szCmdLine[0] = '\0';
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strlen( szCmdLine ) + strlen( argv[i] ) + 2 > sizeof(szCmdLine) ) break;
+        strcat( szCmdLine, argv[i] );
+        strcat( szCmdLine, " " );
+
+    } // Next Argument
+
+	// Initialise the engine.
+	if (!g_App.InitInstance( NULL, szCmdLine, 0 )) return 1;
+
+    // Begin the gameplay process. Will return when app due to exit.
+    retCode = g_App.BeginGame();
+
+    // Shut down the engine before exiting.
+    if ( !g_App.ShutDown() ) fprintf( stderr, "Failed to shut system down correctly.\n" );
+
+    // Return the correct exit code.
+    return retCode;
+
+}
+#endif // _WIN32
@@ -0,0 +1,143 @@
+//-----------------------------------------------------------------------------
+// File: MeshConvert.cpp
+//
+// Desc: Command line tool which converts Wavefront OBJ files into a single
+//       binary mesh file (see CMeshFile), optionally generating simplified
+//       levels of detail for each mesh, and which can describe and validate
+//       existing mesh files.
+//
+//       MeshConvert [-lod <levels>] [-noflip] <output> <input.obj> [...]
+//       MeshConvert -info <file>
+//
+// Copyright (c) 1997-2002 Adam Hoult & Gary Simmons. All rights reserved.
+//-----------------------------------------------------------------------------
+
+//-----------------------------------------------------------------------------
+// MeshConvert Specific Includes
+//-----------------------------------------------------------------------------
+#include "../Includes/Main.h"
+#include "../Includes/CObject.h"
+#include "../Includes/CLODChain.h"
+#include "../Includes/CMeshFile.h"
+#include "../Includes/COBJImporter.h"
+#include "../Includes/CJobSystem.h"
+#include <new>
+
+//-----------------------------------------------------------------------------
+// Module Local Constants
+//-----------------------------------------------------------------------------
+static const ULONG  MAX_INPUTS      = 256;      // Most OBJ files per conversion
+
+//-----------------------------------------------------------------------------
+// Module Local Functions
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+// Name : PrintInfo () (Local)
+// Desc : Describes and validates an existing mesh file.
+//-----------------------------------------------------------------------------
+static int PrintInfo( const char * pFileName )
+{
+    CMeshFile File;
+
+    if ( !File.Open( pFileName ) ) { printf( "%s: not a valid mesh file\n", pFileName ); return 1; }
+
+    printf( "%s: %u meshes, %.1f MB\n", pFileName, (unsigned int)File.GetMeshCount(), File.GetFileSize() / (1024.0 * 1024.0) );
+    for ( ULONG i = 0; i < File.GetMeshCount(); i++ )
+    {
+        const MESHFILEENTRY & Entry = File.GetEntry( i );
+        printf( "  %u: level %u, %u vertices, %u polygons, %u indices, error %g, radius %g\n", (unsigned int)i,
+                (unsigned int)Entry.Level, (unsigned int)Entry.VertexCount, (unsigned int)Entry.PolygonCount,
+                (unsigned int)Entry.IndexCount, Entry.Error, Entry.BoundsRadius );
+
+    } // Next Mesh
+
+    if ( !File.Validate() ) { printf( "%s: contents are invalid\n", pFileName ); return 1; }
+    return 0;
+}
+
+//-----------------------------------------------------------------------------
+// Name : main() (Application Entry Point)
+// Desc : Parses the command line and runs the conversion.
+//-----------------------------------------------------------------------------
+int main( int argc, char * argv[] )
+{
+    const char   * pInputs[ MAX_INPUTS ], * pOutput = NULL;
+    CIndexedMesh * pMeshes = NULL;
+    CLODChain    * pChains = NULL;
+    CJobSystem     Jobs;
+    COBJImporter   Importer;
+    ULONG          nInputs = 0, nLevels = 1, nCount = 0;
+    bool           bFlip = true, bResult = true;
+
+    // Process the command line
+    for ( int i = 1; i < argc; i++ )
+    {
+        if ( strcmp( argv[i], "-info" ) == 0 && i + 1 < argc ) return PrintInfo( argv[ i + 1 ] );
+        else if ( strcmp( argv[i], "-lod" ) == 0 && i + 1 < argc ) nLevels = (ULONG)atoi( argv[++i] );
+        else if ( strcmp( argv[i], "-noflip" ) == 0 ) bFlip = false;
+        else if ( !pOutput ) pOutput = argv[i];
+        else if ( nInputs < MAX_INPUTS ) pInputs[ nInputs++ ] = argv[i];
+
+    } // Next Argument
+
+    if ( !pOutput || nInputs == 0 )
+    {
+        printf( "usage: MeshConvert [-lod <levels>] [-noflip] <output> <input.obj> [...]\n"
+                "       MeshConvert -info <file>\n" );
+        return 1;
+
+    } // End if usage
+
+    // Load each input, generating its levels of detail
+    if ( Jobs.Create( CJobSystem::GetHardwareThreads() ) ) Importer.SetJobSystem( &Jobs );
+    Importer.SetFlip( bFlip );
+    pMeshes = new (std::nothrow) CIndexedMesh[ nInputs ];
+    pChains = new (std::nothrow) CLODChain[ nInputs ];
+    if ( !pMeshes || !pChains ) return 1;
+
+    for ( ULONG i = 0; i < nInputs && bResult; i++ )
+    {
+        if ( !Importer.Import( pInputs[i], pMeshes[i] ) ) { printf( "%s: could not be read\n", pInputs[i] ); bResult = false; break; }
+        if ( !pChains[i].Build( &pMeshes[i], nLevels, 0.0f ) ) { printf( "%s: could not be simplified\n", pInputs[i] ); bResult = false; break; }
+        nCount += pChains[i].GetLevelCount();
+
+    } // Next Input
+
+    // Every level goes into the file, each chain in order
+    if ( bResult )
+    {
+        const CIndexedMesh ** ppMeshes = new (std::nothrow) const CIndexedMesh*[ nCount ];
+        ULONG               * pLevels  = new (std::nothrow) ULONG[ nCount ];
+        float               * pErrors  = new (std::nothrow) float[ nCount ];
+        ULONG                 n = 0;
+
+        if ( ppMeshes && pLevels && pErrors )
+        {
+            for ( ULONG i = 0; i < nInputs; i++ )
+            {
+                for ( ULONG l = 0; l < pChains[i].GetLevelCount(); l++, n++ )
+                {
+                    ppMeshes[n] = pChains[i].GetLevel( l );
+                    pLevels[n]  = l;
+                    pErrors[n]  = pChains[i].GetLevelError( l );
+
+                } // Next Level
+
+            } // Next Input
+            bResult = CMeshFile::Write( pOutput, ppMeshes, pLevels, pErrors, nCount );
+            if ( !bResult ) printf( "%s: could not be written\n", pOutput );
+
+        } // End if allocated
+        else bResult = false;
+
+        if ( ppMeshes ) delete []ppMeshes;
+        if ( pLevels  ) delete []pLevels;
+        if ( pErrors  ) delete []pErrors;
+
+    } // End if loaded
+
+    delete []pChains;
+    delete []pMeshes;
+    if ( bResult ) return PrintInfo( pOutput );
+    return 1;
+}